@@ -16,7 +16,7 @@
 show_usage()
 {
     echo "Vortex BlackBox Test Driver v1.0"
-    echo "Usage: $0 [[--clusters=#n] [--cores=#n] [--warps=#n] [--threads=#n] [--l2cache] [--l3cache] [[--driver=#name] [--app=#app] [--args=#args] [--debug=#level] [--scope] [--perf=#class] [--rebuild=0|1] [--log=logfile] [--help]]"
+    echo "Usage: $0 [[--clusters=#n] [--cores=#n] [--warps=#n] [--threads=#n] [--l2cache] [--l3cache] [[--driver=#name] [--app=#app] [--args=#args] [--debug=#level] [--scope] [--perf=#class] [--perf-format=text|json|csv] [--rebuild=0|1] [--log=logfile] [--help]]"
 }
 
 SCRIPT_DIR=$(dirname "$0")
@@ -35,6 +35,7 @@ DEBUG_LEVEL=0
 SCOPE=0
 HAS_ARGS=0
 PERF_CLASS=0
+PERF_FORMAT=text
 REBUILD=2
 LOGFILE=run.log
 
@@ -88,6 +89,10 @@ case $i in
         PERF_CLASS=${i#*=}    
         shift
         ;;
+    --perf-format=*)
+        PERF_FORMAT=${i#*=}
+        shift
+        ;;
     --args=*)
         ARGS=${i#*=}
         HAS_ARGS=1
@@ -154,16 +159,19 @@ then
         LAST_CONFIGS=`cat $BLACKBOX_CACHE`
     fi
 
-    if [ $REBUILD -eq 1 ] || [ "$CONFIGS+$DEBUG+$SCOPE" != "$LAST_CONFIGS" ];
+    if [ $REBUILD -eq 1 ] || [ "$CONFIGS+$DEBUG+$SCOPE+$VL_THREADS+$MEMORY_BANKS" != "$LAST_CONFIGS" ];
     then
         make -C $DRIVER_PATH clean > /dev/null
-        echo "$CONFIGS+$DEBUG+$SCOPE" > $BLACKBOX_CACHE
+        echo "$CONFIGS+$DEBUG+$SCOPE+$VL_THREADS+$MEMORY_BANKS" > $BLACKBOX_CACHE
     fi
 fi
 
 # export performance monitor class identifier
 export PERF_CLASS=$PERF_CLASS
 
+# export performance counters output format
+export PERF_FORMAT=$PERF_FORMAT
+
 status=0
 
 # ensure config update
@@ -196,10 +204,13 @@ then
         status=$?
     fi
     
-    if [ -f "$APP_PATH/trace.vcd" ]
-    then 
-        mv -f $APP_PATH/trace.vcd .
-    fi
+    for TRACE in $APP_PATH/trace*.vcd $APP_PATH/trace*.fst
+    do
+        if [ -f "$TRACE" ]
+        then
+            mv -f $TRACE .
+        fi
+    done
 else
     # driver initialization
     if [ $SCOPE -eq 1 ]
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+# 
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import sys
+import argparse
+import json
+import re
+
+COUNTERS = ['issued', 'threads', 'scrb_stalls', 'dispatch_stalls', 'mem_reqs', 'mem_latency', 'splits', 'diverged', 'joins']
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Annotate an objdump listing with a SimX per-PC profile.')
+    parser.add_argument('-p', '--profile', action='append', required=True, help='SimX profile (SIMX_PROFILE output), can be repeated')
+    parser.add_argument('-s', '--sort', default=None, help='print the top PCs sorted by this counter instead of the listing')
+    parser.add_argument('-n', '--top', type=int, default=20, help='number of PCs to print with --sort')
+    parser.add_argument('-o', '--output', default=None, help='output file (default: stdout)')
+    parser.add_argument('dump', help='objdump -D listing of the kernel')
+    return parser.parse_args()
+
+def load_profiles(filenames):
+    levels = []
+    cycles = 0
+    pcs = {}
+    for filename in filenames:
+        with open(filename, 'r') as f:
+            profile = json.load(f)
+        levels = profile['levels']
+        cycles += profile['cycles']
+        for entry in profile['pcs']:
+            pc = int(entry['pc'], 16)
+            stats = pcs.setdefault(pc, { 'misses': [0] * len(levels) })
+            for name in COUNTERS:
+                stats[name] = stats.get(name, 0) + entry.get(name, 0)
+            stats['misses'] = [a + b for a, b in zip(stats['misses'], entry['misses'])]
+    return levels, cycles, pcs
+
+def load_dump(filename):
+    addr_pattern = re.compile(r"^\s*([0-9a-fA-F]+):\s")
+    lines = []
+    with open(filename, 'r') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            match = addr_pattern.match(line)
+            pc = int(match.group(1), 16) if match else None
+            lines.append((pc, line))
+    return lines
+
+def format_stats(stats, levels):
+    if stats is None:
+        return ' ' * 8 + ' ' * 6 + ' ' * 8 * 2 + ' ' * 7 + ' ' * 7 + ' ' * 7 * len(levels) + ' |'
+    issued = stats['issued']
+    util = stats['threads'] / issued if issued else 0
+    latency = stats['mem_latency'] / stats['mem_reqs'] if stats['mem_reqs'] else 0
+    text = '%8d%6.1f%8d%8d%7.1f%7d' % (issued, util, stats['scrb_stalls'], stats['dispatch_stalls'], latency, stats['diverged'])
+    for misses in stats['misses']:
+        text += '%7d' % misses
+    return text + ' |'
+
+def format_header(levels):
+    text = '%8s%6s%8s%8s%7s%7s' % ('issued', 'thrds', 'scrb', 'disp', 'mlat', 'div')
+    for level in levels:
+        text += '%7s' % level.replace('cache', '$')
+    return text + ' |'
+
+def main():
+    args = parse_args()
+    levels, cycles, pcs = load_profiles(args.profile)
+    lines = load_dump(args.dump)
+    out = open(args.output, 'w') if args.output else sys.stdout
+
+    if args.sort:
+        if args.sort != 'misses' and args.sort not in COUNTERS:
+            print('Error: invalid sort key: ' + args.sort, file=sys.stderr)
+            sys.exit(1)
+        asm = {}
+        for pc, line in lines:
+            if pc is not None and pc not in asm:
+                asm[pc] = line.strip()
+        def key(pc):
+            value = pcs[pc][args.sort]
+            return sum(value) if isinstance(value, list) else value
+        print('cycles: %d' % cycles, file=out)
+        print(format_header(levels), file=out)
+        for pc in sorted(pcs, key=key, reverse=True)[:args.top]:
+            print(format_stats(pcs[pc], levels) + ' ' + asm.get(pc, '%x:' % pc), file=out)
+    else:
+        print('cycles: %d' % cycles, file=out)
+        print(format_header(levels), file=out)
+        for pc, line in lines:
+            print(format_stats(pcs.get(pc) if pc is not None else None, levels) + ' ' + line, file=out)
+
+    if out is not sys.stdout:
+        out.close()
+
+if __name__ == "__main__":
+    main()
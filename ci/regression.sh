@@ -209,6 +209,16 @@ CONFIGS="-DNUM_DCACHES=2 -DNUM_ICACHES=2" ./ci/blackbox.sh --driver=rtlsim --app
 # test AXI bus
 AXI_BUS=1 ./ci/blackbox.sh --driver=rtlsim --cores=1 --app=demo
 
+# memory response ordering
+CONFIGS="-DMEM_RSP_ORDER=0" ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+CONFIGS="-DMEM_RSP_ORDER=2" ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+AXI_BUS=1 CONFIGS="-DMEM_RSP_ORDER=2" ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+
+# memory banks
+MEMORY_BANKS=1 ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+AXI_BUS=1 MEMORY_BANKS=4 ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+CONFIGS="-DMEM_ANALYTICAL" MEMORY_BANKS=4 ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=sgemm
+
 # adjust l1 block size to match l2
 CONFIGS="-DL1_LINE_SIZE=64" ./ci/blackbox.sh --driver=rtlsim --cores=2 --l2cache --app=io_addr --args="-n1"
 
@@ -229,6 +239,23 @@ CONFIGS="-DPLATFORM_PARAM_LOCAL_MEMORY_BANKS=1" ./ci/blackbox.sh --driver=opae -
 # test 27-bit DRAM address
 CONFIGS="-DPLATFORM_PARAM_LOCAL_MEMORY_ADDR_WIDTH=27" ./ci/blackbox.sh --driver=opae --cores=1 --app=demo
 
+# test chunked DMA staging
+CONFIGS="-DSTAGING_CHUNK_SIZE=4096" ./ci/blackbox.sh --driver=opae --cores=1 --app=demo --args="-n256"
+CONFIGS="-DSTAGING_CHUNK_SIZE=4096 -DSTAGING_NUM_CHUNKS=3" ./ci/blackbox.sh --driver=opae --cores=1 --app=demo --args="-n200"
+
+# test zero-copy pinned transfers
+./ci/blackbox.sh --driver=opae --cores=1 --app=demo --args="-n64 -z"
+./ci/blackbox.sh --driver=simx --cores=1 --app=demo --args="-n64 -z"
+
+# test kernel relaunch by handle
+./ci/blackbox.sh --driver=simx --cores=1 --app=demo --args="-n64 -r4"
+./ci/blackbox.sh --driver=rtlsim --cores=1 --app=demo --args="-n64 -r2"
+
+# test multi-threaded verilator models, cycle counts must match the single-threaded model
+VL_THREADS=4 ./ci/blackbox.sh --driver=rtlsim --cores=4 --app=diverge
+VL_THREADS=2 ./ci/blackbox.sh --driver=opae --cores=2 --app=demo
+./ci/simbench.py --driver=rtlsim --app=sgemm --configs="-DNUM_CORES=4" --vl-threads=1 --vl-threads=4 --repeat=1 -o simbench.threads.json
+
 echo "configuration tests done!"
 }
 
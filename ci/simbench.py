@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Simulator throughput benchmark.
+# Runs a fixed set of workloads on the simulation drivers and reports the
+# simulated instructions and cycles per host second and the peak host RSS,
+# optionally comparing them against a previous result file. RTL models can be
+# built for several Verilator thread counts, which must all simulate the same
+# number of cycles.
+
+import os
+import sys
+import argparse
+import csv
+import json
+import platform
+import subprocess
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+VORTEX_HOME = os.path.abspath(os.path.join(SCRIPT_DIR, '..'))
+
+# (suite, application, arguments)
+WORKLOADS = [
+    ('regression', 'sort',    '-n256'),
+    ('regression', 'mstress', '-n256'),
+    ('opencl',     'sgemm',   '-n32'),
+    ('opencl',     'vecadd',  '-n4096'),
+    ('opencl',     'bfs',     ''),
+]
+
+DRIVERS = ['simx', 'rtlsim']
+
+METRICS = ['kips', 'khz']
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Measure the throughput of the Vortex simulators on a fixed workload set.')
+    parser.add_argument('-d', '--driver', action='append', default=None, help='driver to benchmark (default: simx and rtlsim), can be repeated')
+    parser.add_argument('-a', '--app', action='append', default=None, help='restrict the workload set to this application, can be repeated')
+    parser.add_argument('-c', '--configs', default='', help='build configuration (CONFIGS), e.g. "-DNUM_CORES=4"')
+    parser.add_argument('-j', '--vl-threads', type=int, action='append', default=None, help='Verilator model threads of the RTL drivers, can be repeated')
+    parser.add_argument('-r', '--repeat', type=int, default=3, help='runs per workload, the fastest is reported')
+    parser.add_argument('-b', '--baseline', default=None, help='previous result file to compare against')
+    parser.add_argument('-t', '--threshold', type=float, default=5.0, help='slowdown in percent reported as a regression')
+    parser.add_argument('-o', '--output', default='simbench.json', help='output JSON file')
+    return parser.parse_args()
+
+def git_revision():
+    try:
+        return subprocess.check_output(['git', '-C', VORTEX_HOME, 'rev-parse', '--short', 'HEAD'], universal_newlines=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+
+def build(driver, workloads, configs, vl_threads):
+    env = dict(os.environ)
+    env['CONFIGS'] = configs
+    if vl_threads is not None:
+        env['VL_THREADS'] = str(vl_threads)
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'hw'), 'config'], check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'runtime', 'stub')], check=True, stdout=subprocess.DEVNULL)
+    if configs or vl_threads is not None:
+        subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'runtime', driver), 'clean'], check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'runtime', driver)], env=env, check=True, stdout=subprocess.DEVNULL)
+    for suite, app, _ in workloads:
+        subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'tests', suite, app)], check=True, stdout=subprocess.DEVNULL)
+
+def run_once(driver, suite, app, args):
+    with tempfile.NamedTemporaryFile(mode='r', suffix='.csv') as perf_file:
+        env = dict(os.environ)
+        env['PERF_FORMAT'] = 'csv'
+        env['PERF_OUTPUT'] = perf_file.name
+        env['OPTS'] = args
+        start = time.monotonic()
+        proc = subprocess.Popen(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'tests', suite, app), 'run-' + driver], env=env,
+                                stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        # the rusage of make includes the application it waited for
+        _, status, rusage = os.wait4(proc.pid, 0)
+        elapsed = time.monotonic() - start
+        success = os.WIFEXITED(status) and 0 == os.WEXITSTATUS(status)
+        totals = {}
+        for row in csv.reader(perf_file):
+            if len(row) == 3 and row[0] == 'total':
+                totals[row[1]] = float(row[2])
+    if not success:
+        return None
+    return {
+        'time': elapsed,
+        'instrs': int(totals.get('instrs', 0)),
+        'cycles': int(totals.get('cycles', 0)),
+        'max_rss_kb': rusage.ru_maxrss,
+    }
+
+def run_workload(driver, suite, app, args, repeat):
+    best = None
+    for _ in range(max(repeat, 1)):
+        result = run_once(driver, suite, app, args)
+        if result is None:
+            print('error: {} {} failed'.format(driver, app), file=sys.stderr)
+            return None
+        if best is None or result['time'] < best['time']:
+            best = result
+    best['kips'] = best['instrs'] / best['time'] / 1e3
+    best['khz'] = best['cycles'] / best['time'] / 1e3
+    return best
+
+def compare(results, baseline_file, threshold):
+    with open(baseline_file, 'r') as f:
+        baseline = json.load(f)
+    def key(entry):
+        return (entry['driver'], entry['app'], entry.get('configs', ''), entry.get('vl_threads'))
+    reference = {key(entry): entry for entry in baseline['results']}
+    regressions = 0
+    print('baseline: {} ({})'.format(baseline_file, baseline.get('revision', 'unknown')))
+    for entry in results:
+        ref = reference.get(key(entry))
+        if ref is None:
+            continue
+        for metric in METRICS:
+            if ref[metric] == 0:
+                continue
+            change = 100.0 * (entry[metric] - ref[metric]) / ref[metric]
+            entry[metric + '_change'] = change
+            if change < -threshold:
+                regressions += 1
+                print('regression: {} {} {} {:.1f} -> {:.1f} ({:+.1f}%)'.format(entry['driver'], entry['app'], metric, ref[metric], entry[metric], change))
+    return regressions
+
+def check_threads(results):
+    # a multi-threaded model must be cycle-exact with the single-threaded one
+    mismatches = 0
+    reference = {}
+    for entry in sorted(results, key=lambda e: e['vl_threads']):
+        ref = reference.setdefault((entry['driver'], entry['app']), entry)
+        entry['speedup'] = ref['time'] / entry['time']
+        if entry['instrs'] != ref['instrs'] or entry['cycles'] != ref['cycles']:
+            mismatches += 1
+            print('mismatch: {} {} threads={} instrs={} cycles={}, threads={} instrs={} cycles={}'.format(
+                entry['driver'], entry['app'], ref['vl_threads'], ref['instrs'], ref['cycles'],
+                entry['vl_threads'], entry['instrs'], entry['cycles']))
+        elif entry is not ref:
+            print('{:8s} {:10s} threads={} speedup={:.2f}x'.format(entry['driver'], entry['app'], entry['vl_threads'], entry['speedup']))
+    return mismatches
+
+def main():
+    args = parse_args()
+    drivers = args.driver or DRIVERS
+    workloads = [w for w in WORKLOADS if args.app is None or w[1] in args.app]
+
+    results = []
+    failures = 0
+    for driver in drivers:
+        # simx has no model threads
+        thread_counts = [None] if (driver == 'simx' or not args.vl_threads) else args.vl_threads
+        for vl_threads in thread_counts:
+            build(driver, workloads, args.configs, vl_threads)
+            for suite, app, app_args in workloads:
+                result = run_workload(driver, suite, app, app_args, args.repeat)
+                if result is None:
+                    failures += 1
+                    continue
+                entry = dict(driver=driver, app=app, args=app_args, configs=args.configs, **result)
+                if vl_threads is not None:
+                    entry['vl_threads'] = vl_threads
+                results.append(entry)
+                print('{:8s} {:10s} time={:.2f}s instrs={} cycles={} KIPS={:.1f} KHz={:.1f} RSS={}KB'.format(
+                    driver, app, entry['time'], entry['instrs'], entry['cycles'], entry['kips'], entry['khz'], entry['max_rss_kb']))
+
+    if args.vl_threads and len(args.vl_threads) > 1:
+        failures += check_threads([entry for entry in results if 'vl_threads' in entry])
+
+    regressions = 0
+    if args.baseline:
+        regressions = compare(results, args.baseline, args.threshold)
+
+    with open(args.output, 'w') as f:
+        json.dump({
+            'revision': git_revision(),
+            'host': platform.node(),
+            'results': results
+        }, f, indent=2)
+    print('results written to {}'.format(args.output))
+
+    return 1 if (failures or regressions) else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
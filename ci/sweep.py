@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# SimX design-space sweep driver.
+# The simx driver and the application are built once, then every point of the
+# parameter grid runs as a separate host process with its parameters passed
+# through SIMX_CONFIG. The device totals of each run are merged into one CSV.
+
+import os
+import sys
+import argparse
+import csv
+import itertools
+import subprocess
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+VORTEX_HOME = os.path.abspath(os.path.join(SCRIPT_DIR, '..'))
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Run a SimX parameter grid in parallel and collect the performance counters into a CSV file.')
+    parser.add_argument('-a', '--app', action='append', required=True, help='application under tests/regression or tests/opencl, can be repeated')
+    parser.add_argument('-p', '--param', action='append', default=[], help='grid axis as name=v1,v2,... (see sim/simx/arch.cpp for names), can be repeated')
+    parser.add_argument('--args', default='', help='application arguments')
+    parser.add_argument('--perf', type=int, default=1, help='performance counters class')
+    parser.add_argument('--configs', default='', help='extra build CONFIGS')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(), help='number of parallel simulations')
+    parser.add_argument('-o', '--output', default='sweep.csv', help='output CSV file')
+    return parser.parse_args()
+
+def parse_grid(params):
+    axes = []
+    for param in params:
+        name, sep, values = param.partition('=')
+        if not sep or not values:
+            sys.exit("error: invalid grid axis '{}', expected name=v1,v2,...".format(param))
+        axes.append((name, values.split(',')))
+    names = [name for name, _ in axes]
+    points = [dict(zip(names, values)) for values in itertools.product(*[values for _, values in axes])]
+    return names, points
+
+def app_path(app):
+    for suite in ['regression', 'opencl']:
+        path = os.path.join(VORTEX_HOME, 'tests', suite, app)
+        if os.path.isdir(path):
+            return path
+    sys.exit('error: application folder not found: ' + app)
+
+def build(apps, args):
+    env = dict(os.environ)
+    env['CONFIGS'] = ' '.join(filter(None, ['-DPERF_ENABLE', args.configs]))
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'hw'), 'config'], env=env, check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'runtime', 'stub')], env=env, check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(['make', '-s', '-C', os.path.join(VORTEX_HOME, 'runtime', 'simx')], env=env, check=True, stdout=subprocess.DEVNULL)
+    for app in apps:
+        subprocess.run(['make', '-s', '-C', app_path(app)], env=env, check=True, stdout=subprocess.DEVNULL)
+
+def run_point(app, point, args):
+    config = ','.join('{}={}'.format(name, value) for name, value in point.items())
+    with tempfile.NamedTemporaryFile(mode='r', suffix='.csv') as perf_file:
+        env = dict(os.environ)
+        env['SIMX_CONFIG'] = config
+        env['PERF_CLASS'] = str(args.perf)
+        env['PERF_FORMAT'] = 'csv'
+        env['PERF_OUTPUT'] = perf_file.name
+        env['OPTS'] = args.args
+        result = subprocess.run(['make', '-s', '-C', app_path(app), 'run-simx'], env=env,
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        counters = {}
+        for row in csv.reader(perf_file):
+            if len(row) == 3 and row[0] == 'total':
+                counters[row[1]] = row[2]
+    if result.returncode != 0:
+        print('error: {} [{}] failed (exitcode={})'.format(app, config, result.returncode), file=sys.stderr)
+        print(result.stdout, file=sys.stderr)
+    return result.returncode, counters
+
+def main():
+    args = parse_args()
+    names, points = parse_grid(args.param)
+    build(args.app, args)
+
+    jobs = [(app, point) for app in args.app for point in points]
+    print('running {} simulations on {} jobs'.format(len(jobs), args.jobs))
+    with ThreadPoolExecutor(max_workers=max(args.jobs, 1)) as executor:
+        results = list(executor.map(lambda job: run_point(job[0], job[1], args), jobs))
+
+    # union of the counters, in order of first appearance
+    counter_names = []
+    for _, counters in results:
+        for name in counters:
+            if name not in counter_names:
+                counter_names.append(name)
+
+    failures = 0
+    with open(args.output, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['app'] + names + ['exitcode'] + counter_names)
+        for (app, point), (exitcode, counters) in zip(jobs, results):
+            failures += (exitcode != 0)
+            writer.writerow([app] + [point[name] for name in names] + [exitcode] + [counters.get(name, '') for name in counter_names])
+
+    print('results written to {} ({} failed)'.format(args.output, failures))
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
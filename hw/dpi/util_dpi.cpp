@@ -16,12 +16,14 @@
 #include <unordered_map>
 #include <vector>
 #include <mutex>
+#include <memory>
 #include <iostream>
 
 #include "svdpi.h"
 #include "verilated_vpi.h"
 
 #include "uuid_gen.h"
+#include "checkpoint.h"
 
 #ifdef XLEN_64
 #define iword_t   int64_t
@@ -51,6 +53,12 @@ extern "C" {
   void dpi_trace_stop();
 
   uint64_t dpi_uuid_gen(bool reset, int wid, uint64_t PC);
+
+  int dpi_restore_enabled();
+  int dpi_restore_tmask(int core_id, int wid);
+  uint64_t dpi_restore_pc(int core_id, int wid);
+  uint64_t dpi_restore_reg(int core_id, int wid, int tid, int rid);
+  int dpi_restore_fcsr(int core_id, int wid);
 }
 
 bool sim_trace_enabled();
@@ -88,22 +96,28 @@ private:
   unsigned depth_;  
 };
 
+// The DPI imports are called concurrently by multi-threaded models,
+// instances are allocated in blocks so that their address never changes.
 class Instances {
 public:
   ShiftRegister& get(int inst) {
-    return instances_.at(inst);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_.at(inst / BLOCK_SIZE)[inst % BLOCK_SIZE];
   }
 
   int allocate() {
-    mutex_.lock();   
-    int inst = instances_.size();
-    instances_.resize(inst + 1); 
-    mutex_.unlock();
+    std::lock_guard<std::mutex> lock(mutex_);
+    int inst = size_++;
+    if (0 == (inst % BLOCK_SIZE)) {
+      blocks_.emplace_back(new ShiftRegister[BLOCK_SIZE]);
+    }
     return inst;
   }
 
 private:
-  std::vector<ShiftRegister> instances_;
+  static constexpr int BLOCK_SIZE = 64;
+  std::vector<std::unique_ptr<ShiftRegister[]>> blocks_;
+  int size_ = 0;
   std::mutex mutex_;
 };
 
@@ -122,6 +136,7 @@ void dpi_assert(int inst, bool cond, int delay) {
   auto status = sr.top();
   if (status) {
     printf("delayed assertion at %s!\n", svGetNameFromScope(svGetScope()));
+    Verilated::runFlushCallbacks();
     std::abort();
   }
 }
@@ -210,8 +225,10 @@ void dpi_trace_stop() {
 ///////////////////////////////////////////////////////////////////////////////
 
 std::unordered_map<uint32_t, std::shared_ptr<vortex::UUIDGenerator>> g_uuid_gens;
+std::mutex g_uuid_mutex;
 
 uint64_t dpi_uuid_gen(bool reset, int wid, uint64_t PC) {
+  std::lock_guard<std::mutex> lock(g_uuid_mutex);
   if (reset) {
     g_uuid_gens.clear();
     return 0;
@@ -229,4 +246,33 @@ uint64_t dpi_uuid_gen(bool reset, int wid, uint64_t PC) {
   uint32_t instr_ref = instr_uuid >> 16;
   uint64_t uuid = (uint64_t(instr_ref) << 32) | (wid << 16) | instr_id;
   return uuid;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// checkpoint restored by the RTL at reset, installed by the simulator
+static const vortex::Checkpoint* g_restore = nullptr;
+
+void dpi_restore_state(const vortex::Checkpoint* checkpoint) {
+  g_restore = checkpoint;
+}
+
+int dpi_restore_enabled() {
+  return (g_restore != nullptr);
+}
+
+int dpi_restore_tmask(int core_id, int wid) {
+  return g_restore->warp(core_id, wid).tmask;
+}
+
+uint64_t dpi_restore_pc(int core_id, int wid) {
+  return g_restore->warp(core_id, wid).pc;
+}
+
+uint64_t dpi_restore_reg(int core_id, int wid, int tid, int rid) {
+  return g_restore->reg(core_id, wid, tid, rid);
+}
+
+int dpi_restore_fcsr(int core_id, int wid) {
+  return g_restore->warp(core_id, wid).fcsr;
+}
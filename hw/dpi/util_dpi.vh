@@ -34,4 +34,10 @@ import "DPI-C" function void dpi_trace_stop();
 
 import "DPI-C" function longint dpi_uuid_gen(input logic reset, input int wid, input longint PC);
 
+import "DPI-C" function int dpi_restore_enabled();
+import "DPI-C" function int dpi_restore_tmask(input int core_id, input int wid);
+import "DPI-C" function longint dpi_restore_pc(input int core_id, input int wid);
+import "DPI-C" function longint dpi_restore_reg(input int core_id, input int wid, input int tid, input int rid);
+import "DPI-C" function int dpi_restore_fcsr(input int core_id, input int wid);
+
 `endif
@@ -33,12 +33,23 @@
 `define VX_DCR_MPM_CLASS_NONE           0           
 `define VX_DCR_MPM_CLASS_CORE           1
 `define VX_DCR_MPM_CLASS_MEM            2
+`define VX_DCR_MPM_CLASS_SIMX           3           // simulator-only counters, read as zero by the RTL
 
 // User Floating-Point CSRs
 
 `define VX_CSR_FFLAGS                   12'h001
 `define VX_CSR_FRM                      12'h002
 `define VX_CSR_FCSR                     12'h003
+
+// User Vector CSRs
+
+`define VX_CSR_VSTART                   12'h008
+`define VX_CSR_VXSAT                    12'h009
+`define VX_CSR_VXRM                     12'h00A
+`define VX_CSR_VCSR                     12'h00F
+`define VX_CSR_VL                       12'hC20
+`define VX_CSR_VTYPE                    12'hC21
+`define VX_CSR_VLENB                    12'hC22
  
 `define VX_CSR_SATP                     12'h180
 
@@ -80,6 +91,8 @@
 `define VX_CSR_MPM_FPU_ST_H             12'hB87
 `define VX_CSR_MPM_SFU_ST               12'hB08
 `define VX_CSR_MPM_SFU_ST_H             12'hB88
+`define VX_CSR_MPM_OPDS_BANK_ST         12'hB09     // register file bank conflicts
+`define VX_CSR_MPM_OPDS_BANK_ST_H       12'hB89
 // PERF: memory
 `define VX_CSR_MPM_IFETCHES             12'hB0A
 `define VX_CSR_MPM_IFETCHES_H           12'hB8A
@@ -91,6 +104,42 @@
 `define VX_CSR_MPM_IFETCH_LAT_H         12'hB8D
 `define VX_CSR_MPM_LOAD_LAT             12'hB0E 
 `define VX_CSR_MPM_LOAD_LAT_H           12'hB8E
+// PERF: divergence
+`define VX_CSR_MPM_WARP_INSTRS          12'hB0F     // retired warp instructions
+`define VX_CSR_MPM_WARP_INSTRS_H        12'hB8F
+`define VX_CSR_MPM_DIVERGED_INSTRS      12'hB10     // warp instructions with inactive lanes
+`define VX_CSR_MPM_DIVERGED_INSTRS_H    12'hB90
+`define VX_CSR_MPM_DIVERGED_CYCLES      12'hB11     // warp cycles with inactive lanes
+`define VX_CSR_MPM_DIVERGED_CYCLES_H    12'hB91
+`define VX_CSR_MPM_SPLITS               12'hB12     // executed splits
+`define VX_CSR_MPM_SPLITS_H             12'hB92
+`define VX_CSR_MPM_DIVERGENT_SPLITS     12'hB13     // splits that diverged
+`define VX_CSR_MPM_DIVERGENT_SPLITS_H   12'hB93
+`define VX_CSR_MPM_IPDOM_DEPTH          12'hB14     // max IPDOM stack depth
+`define VX_CSR_MPM_IPDOM_DEPTH_H        12'hB94
+`define VX_CSR_MPM_LANES_Q1             12'hB15     // warp instructions with (0, 25%] active lanes
+`define VX_CSR_MPM_LANES_Q1_H           12'hB95
+`define VX_CSR_MPM_LANES_Q2             12'hB16     // warp instructions with (25%, 50%] active lanes
+`define VX_CSR_MPM_LANES_Q2_H           12'hB96
+`define VX_CSR_MPM_LANES_Q3             12'hB17     // warp instructions with (50%, 75%] active lanes
+`define VX_CSR_MPM_LANES_Q3_H           12'hB97
+`define VX_CSR_MPM_LANES_Q4             12'hB18     // warp instructions with (75%, 100%] active lanes
+`define VX_CSR_MPM_LANES_Q4_H           12'hB98
+// PERF: functional units
+`define VX_CSR_MPM_IDIV_BUSY            12'hB19     // integer divider busy cycles
+`define VX_CSR_MPM_IDIV_BUSY_H          12'hB99
+`define VX_CSR_MPM_IDIV_ST              12'hB1A     // integer divider structural stalls
+`define VX_CSR_MPM_IDIV_ST_H            12'hB9A
+`define VX_CSR_MPM_FDIV_BUSY            12'hB1B     // FP divider busy cycles
+`define VX_CSR_MPM_FDIV_BUSY_H          12'hB9B
+`define VX_CSR_MPM_FDIV_ST              12'hB1C     // FP divider structural stalls
+`define VX_CSR_MPM_FDIV_ST_H            12'hB9C
+`define VX_CSR_MPM_FSQRT_BUSY           12'hB1D     // FP square root busy cycles
+`define VX_CSR_MPM_FSQRT_BUSY_H         12'hB9D
+`define VX_CSR_MPM_FSQRT_ST             12'hB1E     // FP square root structural stalls
+`define VX_CSR_MPM_FSQRT_ST_H           12'hB9E
+`define VX_CSR_MPM_FU_ST                12'hB1F     // structural stalls of all ALU and FPU units
+`define VX_CSR_MPM_FU_ST_H              12'hB9F
 
 // Machine Performance-monitoring memory counters
 // PERF: icache
@@ -152,6 +201,18 @@
 `define VX_CSR_MPM_MEM_LAT              12'hB1C     // memory latency
 `define VX_CSR_MPM_MEM_LAT_H            12'hB9C
 
+// Machine Performance-monitoring simulator counters
+// PERF: operand collection
+`define VX_CSR_MPM_OPDS_OCC             12'hB03     // busy operand collectors, summed over cycles
+`define VX_CSR_MPM_OPDS_OCC_H           12'hB83
+`define VX_CSR_MPM_OPDS_ST              12'hB04     // cycles waiting for a free collector
+`define VX_CSR_MPM_OPDS_ST_H            12'hB84
+// PERF: vector unit
+`define VX_CSR_MPM_VPU_BUSY             12'hB05     // cycles the vector pipes could not accept an input
+`define VX_CSR_MPM_VPU_BUSY_H           12'hB85
+`define VX_CSR_MPM_VPU_ST               12'hB06     // cycles a vector input waited on a busy pipe
+`define VX_CSR_MPM_VPU_ST_H             12'hB86
+
 // Machine Information Registers
 
 `define VX_CSR_MVENDORID                12'hF11
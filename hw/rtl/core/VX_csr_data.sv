@@ -101,6 +101,14 @@ import VX_fpu_pkg::*;
     always @(posedge clk) begin
         if (reset) begin
             fcsr <= '0;
+        `ifdef SIMULATION
+            // resume from a simx checkpoint
+            if (dpi_restore_enabled() != 0) begin
+                for (integer i = 0; i < `NUM_WARPS; ++i) begin
+                    fcsr[i] <= (`INST_FRM_BITS+`FP_FLAGS_BITS)'(dpi_restore_fcsr(CORE_ID, i));
+                end
+            end
+        `endif
         end else begin
             fcsr <= fcsr_n;
         end
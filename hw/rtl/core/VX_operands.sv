@@ -209,6 +209,52 @@ module VX_operands import VX_gpu_pkg::*; #(
         wire wr_enabled = 1;
     `endif
         
+        // restore the registers of a simx checkpoint, one entry per cycle after
+        // reset while VX_schedule holds the warps
+        wire                              restore_write;
+        wire [ISSUE_ADDRW-1:0]            restore_waddr;
+        wire [`NUM_THREADS-1:0][`XLEN-1:0] restore_wdata;
+    `ifdef SIMULATION
+        localparam RESTORE_SIZE = `NUM_REGS * ISSUE_RATIO;
+        localparam RESTORE_WIS_BITS = `CLOG2(ISSUE_RATIO);
+        reg                              restore_busy;
+        reg [ISSUE_ADDRW-1:0]            restore_addr;
+        reg                              restore_write_r;
+        reg [ISSUE_ADDRW-1:0]            restore_waddr_r;
+        reg [`NUM_THREADS-1:0][`XLEN-1:0] restore_wdata_r;
+
+        // the register file address is {rid, wis}
+        wire [`NR_BITS-1:0] restore_rid = `NR_BITS'(restore_addr >> RESTORE_WIS_BITS);
+        wire [ISSUE_WIS_W-1:0] restore_wis = ISSUE_WIS_W'(restore_addr & ISSUE_ADDRW'(ISSUE_RATIO-1));
+        wire [`NW_WIDTH-1:0] restore_wid = wis_to_wid(restore_wis, ISSUE_IDX_W'(i));
+
+        always @(posedge clk) begin
+            restore_write_r <= 0;
+            if (reset) begin
+                restore_busy <= (dpi_restore_enabled() != 0);
+                restore_addr <= '0;
+            end else if (restore_busy) begin
+                for (integer j = 0; j < `NUM_THREADS; ++j) begin
+                    restore_wdata_r[j] <= `XLEN'(dpi_restore_reg(CORE_ID, 32'(restore_wid), j, 32'(restore_rid)));
+                end
+                restore_waddr_r <= restore_addr;
+                restore_write_r <= 1;
+                restore_addr    <= restore_addr + ISSUE_ADDRW'(1);
+                if (restore_addr == ISSUE_ADDRW'(RESTORE_SIZE-1)) begin
+                    restore_busy <= 0;
+                end
+            end
+        end
+
+        assign restore_write = restore_write_r;
+        assign restore_waddr = restore_waddr_r;
+        assign restore_wdata = restore_wdata_r;
+    `else
+        assign restore_write = 0;
+        assign restore_waddr = '0;
+        assign restore_wdata = '0;
+    `endif
+
         for (genvar j = 0; j < `NUM_THREADS; ++j) begin
             VX_dp_ram #(
                 .DATAW (`XLEN),
@@ -222,9 +268,9 @@ module VX_operands import VX_gpu_pkg::*; #(
                 .clk   (clk),
                 .read  (1'b1),
                 `UNUSED_PIN (wren),
-                .write (wr_enabled && writeback_if[i].valid && writeback_if[i].data.tmask[j]),                
-                .waddr (wis_to_addr(writeback_if[i].data.rd, writeback_if[i].data.wis)),
-                .wdata (writeback_if[i].data.data[j]),
+                .write ((wr_enabled && writeback_if[i].valid && writeback_if[i].data.tmask[j]) || restore_write),
+                .waddr (restore_write ? restore_waddr : wis_to_addr(writeback_if[i].data.rd, writeback_if[i].data.wis)),
+                .wdata (restore_write ? restore_wdata[j] : writeback_if[i].data.data[j]),
                 .raddr (wis_to_addr(gpr_rd_rid, gpr_rd_wis)),
                 .rdata (gpr_rd_data[j])
             );
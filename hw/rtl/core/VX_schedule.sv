@@ -215,6 +215,17 @@ module VX_schedule import VX_gpu_pkg::*; #(
             warp_pcs[0]     <= base_dcrs.startup_addr;
             active_warps[0] <= 1;
             thread_masks[0][0] <= 1;
+
+        `ifdef SIMULATION
+            // resume the warps of a simx checkpoint
+            if (dpi_restore_enabled() != 0) begin
+                for (integer i = 0; i < `NUM_WARPS; ++i) begin
+                    warp_pcs[i]     <= `XLEN'(dpi_restore_pc(CORE_ID, i));
+                    thread_masks[i] <= `NUM_THREADS'(dpi_restore_tmask(CORE_ID, i));
+                    active_warps[i] <= (dpi_restore_tmask(CORE_ID, i) != 0);
+                end
+            end
+        `endif
         end else begin
             active_warps   <= active_warps_n;
             stalled_warps  <= stalled_warps_n;
@@ -279,7 +290,25 @@ module VX_schedule import VX_gpu_pkg::*; #(
 
     // schedule the next ready warp
 
-    wire [`NUM_WARPS-1:0] ready_warps = active_warps & ~(stalled_warps | barrier_stalls);
+    // hold the warps while VX_operands restores the register file of a checkpoint
+    wire restore_stall;
+`ifdef SIMULATION
+    localparam RESTORE_CYCLES = `NUM_REGS * ISSUE_RATIO + 1;
+    localparam RESTORE_CTR_W = `CLOG2(RESTORE_CYCLES+1);
+    reg [RESTORE_CTR_W-1:0] restore_ctr;
+    always @(posedge clk) begin
+        if (reset) begin
+            restore_ctr <= (dpi_restore_enabled() != 0) ? RESTORE_CTR_W'(RESTORE_CYCLES) : '0;
+        end else if (restore_ctr != 0) begin
+            restore_ctr <= restore_ctr - RESTORE_CTR_W'(1);
+        end
+    end
+    assign restore_stall = (restore_ctr != 0);
+`else
+    assign restore_stall = 0;
+`endif
+
+    wire [`NUM_WARPS-1:0] ready_warps = active_warps & ~(stalled_warps | barrier_stalls) & {`NUM_WARPS{~restore_stall}};
 
     VX_lzc #(
         .N       (`NUM_WARPS),
@@ -1,5 +1,10 @@
 #!/bin/bash
 
+# Cache associativity tests on sgemm.
+# The icache and dcache ways are varied one at a time, as the former rtlsim runs did,
+# but on simx: each set runs in parallel from a single simx build via ci/sweep.py,
+# and its memory counters (--perf=2) are written to a CSV file.
+
 # exit when any command fails
 set -e
 
@@ -10,32 +15,40 @@ sgemm()
 {
 echo "begin cache tests"
 
-CONFIGS="-DICACHE_NUM_WAYS=2" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' > ./perf/cache/cache_perf.log
-echo -e "\n**************************************\n" >> ./perf/cache/cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=2" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> ./perf/cache/cache_perf.log
-echo -e "\n**************************************\n" >> ./perf/cache/cache_perf.log 
-CONFIGS="-DICACHE_NUM_WAYS=4" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> ./perf/cache/cache_perf.log
-echo -e "\n**************************************\n" >> ./perf/cache/cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=4" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> ./perf/cache/cache_perf.log
-echo -e "\n**************************************\n" >> ./perf/cache/cache_perf.log
-CONFIGS="-DICACHE_NUM_WAYS=8" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> ./perf/cache/cache_perf.log
-echo -e "\n**************************************\n" >> ./perf/cache/cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=8" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> ./perf/cache/cache_perf.log
+./ci/sweep.py --app=sgemm --args="-n64" --perf=2 \
+    --param=icache_num_ways=2,4,8 \
+    --output=./perf/cache/icache_perf.csv
+
+./ci/sweep.py --app=sgemm --args="-n64" --perf=2 \
+    --param=dcache_num_ways=2,4,8 \
+    --output=./perf/cache/dcache_perf.csv
 
 echo "cache tests done!"
 }
 
+reuse()
+{
+echo "begin reuse distance profiling"
+
+# a single simx run gives the miss-ratio curve for all cache sizes
+SIMX_REUSE=./perf/cache/reuse.jsonl ./ci/blackbox.sh --driver=simx --app=sgemm --args="-n64"
+
+echo "reuse distance profiling done!"
+}
+
 usage()
 {
-    echo "usage: [-s] [-h|--help]"
+    echo "usage: [-s] [-r] [-h|--help]"
 }
 
 case $1 in
     -s ) sgemm
             ;;
+    -r ) reuse
+            ;;
     -h | --help ) usage
                     ;;
     * ) sgemm
         ;;             
 esac
-shift
\ No newline at end of file
+shift
@@ -14,11 +14,20 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <iterator>
 #include <assert.h>
 #include <stdio.h>
 
 namespace vortex {
 
+// Device memory allocator.
+// Memory is reserved in page-aligned chunks growing from the base address and
+// carved into block-aligned allocations. Free blocks are indexed both by size
+// (best-fit lookup on allocation) and by address (neighbor coalescing on release),
+// and allocated blocks by address, so that allocate and release are O(log n).
 class MemoryAllocator {
 public:
     MemoryAllocator(
@@ -30,20 +39,11 @@ public:
         , capacity_(capacity)
         , pageAlign_(pageAlign)
         , blockAlign_(blockAlign)
-        , pages_(nullptr)
         , nextAddress_(0)
         , allocated_(0)
     {}
 
-    ~MemoryAllocator() {
-        // Free allocated pages
-        page_t* currPage = pages_;
-        while (currPage) {
-            auto nextPage = currPage->next;
-            this->DeletePage(currPage);
-            currPage = nextPage;
-        }
-    }
+    ~MemoryAllocator() {}
     
     uint32_t baseAddress() const {
         return baseAddress_;
@@ -70,64 +70,44 @@ public:
         // Align allocation size
         size = AlignSize(size, blockAlign_);
 
-        // Walk thru all pages to find a free block
-        block_t* freeBlock = nullptr;
-        auto currPage = pages_;
-        while (currPage) {
-            auto currBlock = currPage->freeSList;
-            if (currBlock) {
-                // The free S-list is already sorted with the largest block first
-                // Quick check if the head block has enough space.
-                if (currBlock->size >= size) {
-                    // Find the smallest matching block in the S-list
-                    while (currBlock->nextFreeS 
-                        && (currBlock->nextFreeS->size >= size)) {
-                        currBlock = currBlock->nextFreeS;
-                    }
-                    // Return the free block
-                    freeBlock = currBlock;
-                    break;
-                }
-            }
-            currPage = currPage->next;
-        }
-
-        if (nullptr == freeBlock) {
+        // Find the smallest free block that fits, lowest address first
+        page_t* page;
+        uint64_t blockAddr, blockSize;
+        auto it = freeSizes_.lower_bound(std::make_pair(size, uint64_t(0)));
+        if (it != freeSizes_.end()) {
+            blockSize = it->first;
+            blockAddr = it->second;
+            page = this->FindPage(blockAddr);
+        } else {
             // Allocate a new page for this request
-            currPage = this->NewPage(size);
-            if (nullptr == currPage) {
+            page = this->NewPage(size);
+            if (nullptr == page) {
                 printf("error: out of memory\n");
                 return -1;
             }
-            freeBlock = currPage->freeSList;
-        }   
+            blockAddr = page->addr;
+            blockSize = page->size;
+        }
 
         // Remove the block from the free lists
-        assert(freeBlock->size >= size);
-        currPage->RemoveFreeMList(freeBlock);
-        currPage->RemoveFreeSList(freeBlock);
+        assert(blockSize >= size);
+        this->RemoveFreeBlock(page, blockAddr, blockSize);
 
         // If the free block we have found is larger than what we are looking for,
-        // we may be able to split our free block in two.
-        uint64_t extraBytes = freeBlock->size - size;
+        // return the remaining space to the free lists.
+        uint64_t extraBytes = blockSize - size;
         if (extraBytes >= blockAlign_) {
-            // Reduce the free block size to the requested value
-            freeBlock->size = size;
-
-            // Allocate a new block to contain the extra buffer
-            auto nextAddr = freeBlock->addr + size;
-            auto newBlock = new block_t(nextAddr, extraBytes);
-
-            // Add the new block to the free lists
-            currPage->InsertFreeMList(newBlock);
-            currPage->InsertFreeSList(newBlock);
+            this->InsertFreeBlock(page, blockAddr + size, extraBytes);
+        } else {
+            size = blockSize;
         }
 
-        // Insert the free block into the used list
-        currPage->InsertUsedList(freeBlock);
+        // Insert the block into the used list
+        usedBlocks_.emplace(blockAddr, size);
+        ++page->usedCount;
 
-        // Return the free block address
-        *addr = baseAddress_ + freeBlock->addr;
+        // Return the block address
+        *addr = baseAddress_ + blockAddr;
 
         // Update allocated size
         allocated_ += size;
@@ -136,93 +116,51 @@ public:
     }
 
     int release(uint64_t addr) {
-        // Walk all pages to find the pointer
+        // Find the corresponding block
         uint64_t local_addr = addr - baseAddress_;
-        block_t* usedBlock = nullptr;
-        auto currPage = pages_;
-        while (currPage) {
-            if (local_addr >= currPage->addr
-            &&  local_addr < (currPage->addr + currPage->size)) {
-                auto currBlock = currPage->usedList;
-                while (currBlock) {
-                    if (currBlock->addr == local_addr) {
-                        usedBlock = currBlock;
-                        break;
-                    }
-                    currBlock = currBlock->nextUsed;
-                }
-                break;
-            }
-            currPage = currPage->next;
-        }
-
-        // found the corresponding block?
-        if (nullptr == usedBlock) {
+        auto it = usedBlocks_.find(local_addr);
+        if (it == usedBlocks_.end()) {
             printf("error: invalid address to release: 0x%lx\n", addr);
             return -1;
         }
 
-        auto size = usedBlock->size;
+        auto size = it->second;
 
         // Remove the block from the used list
-        currPage->RemoveUsedList(usedBlock);
-
-        // Insert the block into the free M-list.
-        currPage->InsertFreeMList(usedBlock);
-
-        // Check if we can merge adjacent free blocks from the left.        
-        if (usedBlock->prevFreeM) {
-            // Calculate the previous address
-            auto prevAddr = usedBlock->prevFreeM->addr + usedBlock->prevFreeM->size;
-            if (usedBlock->addr == prevAddr) {
-                auto prevBlock = usedBlock->prevFreeM;
-
-                // Merge the blocks to the left
-                prevBlock->size += usedBlock->size;
-                prevBlock->nextFreeM = usedBlock->nextFreeM;
-                if (prevBlock->nextFreeM) {
-                    prevBlock->nextFreeM->prevFreeM = prevBlock;
-                }
-
-                // Detach previous block from the free S-list since size increased
-                currPage->RemoveFreeSList(prevBlock);
-
-                // reset usedBlock
-                delete usedBlock;
-                usedBlock = prevBlock;
-            }
+        usedBlocks_.erase(it);
+        auto page = this->FindPage(local_addr);
+        assert(page->usedCount != 0);
+        --page->usedCount;
+
+        // Merge with adjacent free blocks within the page
+        uint64_t blockAddr = local_addr;
+        uint64_t blockSize = size;
+        auto& freeBlocks = page->freeBlocks;
+        auto next = freeBlocks.lower_bound(local_addr);
+        if (next != freeBlocks.end() 
+         && next->first == (blockAddr + blockSize)) {
+            // Merge the block to the right
+            blockSize += next->second;
+            freeSizes_.erase(std::make_pair(next->second, next->first));
+            next = freeBlocks.erase(next);
         }
-
-        // Check if we can merge adjacent free blocks from the right.
-        if (usedBlock->nextFreeM) {
-            // Calculate the next allocation start address
-            auto nextAddr = usedBlock->addr + usedBlock->size;
-            if (usedBlock->nextFreeM->addr == nextAddr) {
-                auto nextBlock = usedBlock->nextFreeM;
-
-                // Merge the blocks to the right
-                usedBlock->size += nextBlock->size;
-                usedBlock->nextFreeM = nextBlock->nextFreeM;
-                if (usedBlock->nextFreeM) {
-                    usedBlock->nextFreeM->prevFreeM = usedBlock;
-                }
-
-                // Delete next block
-                currPage->RemoveFreeSList(nextBlock);
-                delete nextBlock;
+        if (next != freeBlocks.begin()) {
+            auto prev = std::prev(next);
+            if ((prev->first + prev->second) == blockAddr) {
+                // Merge the block to the left
+                blockAddr = prev->first;
+                blockSize += prev->second;
+                freeSizes_.erase(std::make_pair(prev->second, prev->first));
+                freeBlocks.erase(prev);
             }
         }
 
-        // Insert the block into the free S-list.
-        currPage->InsertFreeSList(usedBlock);
+        // Insert the merged block into the free lists
+        this->InsertFreeBlock(page, blockAddr, blockSize);
 
         // Check if we can free empty pages
-        if (nullptr == currPage->usedList) {
-            // Try to delete the page
-            while (currPage && this->DeletePage(currPage)) {
-                currPage = this->FindNextEmptyPage();
-            }
-
+        if (0 == page->usedCount) {
+            this->DeleteEmptyPages();
         }
 
         // update allocated size
@@ -233,209 +171,78 @@ public:
 
 private:
 
-    struct block_t {
-        block_t* nextFreeS;
-        block_t* prevFreeS;
-        
-        block_t* nextFreeM;
-        block_t* prevFreeM;
-        
-        block_t* nextUsed;
-        block_t* prevUsed;
-
-        uint64_t addr;
-        uint64_t size;
-
-        block_t(uint64_t addr, uint64_t size) 
-            : nextFreeS(nullptr)
-            , prevFreeS(nullptr)
-            , nextFreeM(nullptr)
-            , prevFreeM(nullptr)
-            , nextUsed(nullptr)
-            , prevUsed(nullptr)
-            , addr(addr)
-            , size(size)
-        {}
-    };
-
     struct page_t {
-        page_t*  next;        
-        
-        // List of used blocks
-        block_t* usedList;
-        
-        // List with blocks sorted by descreasing sizes
-        // Used for block lookup during memory allocation.
-        block_t* freeSList;
-        
-        // List with blocks sorted by increasing memory addresses
-        // Used for block merging during memory release.
-        block_t* freeMList;
-        
         uint64_t addr;
         uint64_t size;
 
-        page_t(uint64_t addr, uint64_t size) : 
-            next(nullptr),            
-            usedList(nullptr),
-            addr(addr),
-            size(size) {
-            freeSList = freeMList = new block_t(addr, size);
-        }
+        // Number of allocated blocks in the page
+        uint32_t usedCount;
 
-        void InsertUsedList(block_t* block) {
-            block->nextUsed = usedList;
-            if (usedList) {
-                usedList->prevUsed = block;
-            }
-            usedList = block;
-        }
-
-        void RemoveUsedList(block_t* block) {
-            if (block->prevUsed) {
-                block->prevUsed->nextUsed = block->nextUsed;
-            } else {
-                usedList = block->nextUsed;
-            }
-            if (block->nextUsed) {
-                block->nextUsed->prevUsed = block->prevUsed;
-            }
-            block->nextUsed = nullptr;
-            block->prevUsed = nullptr;
-        }
-
-        void InsertFreeMList(block_t* block) {
-            block_t* currBlock = freeMList;
-            block_t* prevBlock = nullptr;
-            while (currBlock && (currBlock->addr < block->addr)) {
-                prevBlock = currBlock;
-                currBlock = currBlock->nextFreeM;
-            }
-            block->nextFreeM = currBlock;
-            block->prevFreeM = prevBlock;
-            if (prevBlock) {
-                prevBlock->nextFreeM = block;
-            } else {
-                freeMList = block;
-            }
-            if (currBlock) {
-                currBlock->prevFreeM = block;
-            }    
-        }
-
-        void RemoveFreeMList(block_t* block) {
-            if (block->prevFreeM) {
-                block->prevFreeM->nextFreeM = block->nextFreeM;
-            } else {
-                freeMList = block->nextFreeM;
-            }
-            if (block->nextFreeM) {
-                block->nextFreeM->prevFreeM = block->prevFreeM;
-            }
-            block->nextFreeM = nullptr;
-            block->prevFreeM = nullptr;
-        }
-
-        void InsertFreeSList(block_t* block) {
-            block_t* currBlock = this->freeSList;
-            block_t* prevBlock = nullptr;
-            while (currBlock && (currBlock->size > block->size)) {
-                prevBlock = currBlock;
-                currBlock = currBlock->nextFreeS;
-            }
-            block->nextFreeS = currBlock;
-            block->prevFreeS = prevBlock;
-            if (prevBlock) {
-                prevBlock->nextFreeS = block;
-            } else {
-                this->freeSList = block;
-            }
-            if (currBlock) {
-                currBlock->prevFreeS = block;
-            }
-        }
+        // Free blocks sorted by increasing memory addresses (addr -> size)
+        // Used for block merging during memory release.
+        std::map<uint64_t, uint64_t> freeBlocks;
 
-        void RemoveFreeSList(block_t* block) {
-            if (block->prevFreeS) {
-                block->prevFreeS->nextFreeS = block->nextFreeS;
-            } else {
-                freeSList = block->nextFreeS;
-            }
-            if (block->nextFreeS) {
-                block->nextFreeS->prevFreeS = block->prevFreeS;
-            }
-            block->nextFreeS = nullptr;
-            block->prevFreeS = nullptr;    
-        }
+        page_t(uint64_t addr, uint64_t size) 
+            : addr(addr)
+            , size(size)
+            , usedCount(0)
+        {}
     };
 
     page_t* NewPage(uint64_t size) {
-        // Increase buffer size to include the page and first block size
-        // also add padding to ensure page alignment
+        // Add padding to ensure page alignment
         size = AlignSize(size, pageAlign_);
 
-        // Allocate page memory
-        auto addr = nextAddress_;
-        nextAddress_ += size;
-
         // Overflow check
-        if (nextAddress_ > capacity_)
+        if (size > (capacity_ - nextAddress_))
             return nullptr;
 
-        // Allocate object
-        auto newPage = new page_t(addr, size);
+        // Allocate page memory
+        auto addr = nextAddress_;
+        nextAddress_ += size;
 
-        // Insert the new page into the list
-        newPage->next = pages_;
-        pages_ = newPage;
+        // Insert the new page with a single free block
+        auto newPage = &pages_.emplace(addr, page_t(addr, size)).first->second;
+        this->InsertFreeBlock(newPage, addr, size);
 
         return newPage;
     }
 
-    bool DeletePage(page_t* page) {
-        // The page should be empty
-        assert(nullptr == page->usedList);
-        assert(page->freeMList && (nullptr == page->freeMList->nextFreeM));
-
-        // Only delete top-level pages
-        auto nextAddr = page->addr + page->size;
-        if (nextAddr != nextAddress_)
-            return false;
-
-        // Remove the page from the list
-        page_t* prevPage = nullptr;
-        auto currPage = pages_;
-        while (currPage) {
-            if (currPage == page) {
-                if (prevPage) {
-                    prevPage->next = currPage->next;
-                } else {
-                    pages_ = currPage->next;
-                }
+    void DeleteEmptyPages() {
+        // Only top-level pages can be returned to the heap
+        while (!pages_.empty()) {
+            auto it = std::prev(pages_.end());
+            auto& page = it->second;
+            if (page.usedCount != 0)
                 break;
-            }
-            prevPage = currPage;
-            currPage = currPage->next;
+
+            // The page should be a single free block
+            assert(page.freeBlocks.size() == 1 
+                && page.freeBlocks.begin()->second == page.size);
+            freeSizes_.erase(std::make_pair(page.size, page.addr));
+
+            // Update next allocation address
+            nextAddress_ = page.addr;
+            pages_.erase(it);
         }
+    }
 
-        // Update next allocation address
-        nextAddress_ = page->addr;
-        
-        // free object
-        delete page->freeMList;
-        delete page;
+    page_t* FindPage(uint64_t addr) {
+        auto it = pages_.upper_bound(addr);
+        assert(it != pages_.begin());
+        --it;
+        assert(addr < (it->second.addr + it->second.size));
+        return &it->second;
+    }
 
-        return true;
+    void InsertFreeBlock(page_t* page, uint64_t addr, uint64_t size) {
+        page->freeBlocks.emplace(addr, size);
+        freeSizes_.emplace(size, addr);
     }
 
-    page_t* FindNextEmptyPage() {
-       auto currPage = pages_;
-        while (currPage) {
-            if (nullptr == currPage->usedList)
-                return currPage;
-            currPage = currPage->next;
-        } 
-        return nullptr;
+    void RemoveFreeBlock(page_t* page, uint64_t addr, uint64_t size) {
+        page->freeBlocks.erase(addr);
+        freeSizes_.erase(std::make_pair(size, addr));
     }
 
     static uint64_t AlignSize(uint64_t size, uint64_t alignment) {
@@ -446,8 +253,18 @@ private:
     uint64_t baseAddress_;
     uint64_t capacity_;
     uint32_t pageAlign_;    
-    uint32_t blockAlign_;    
-    page_t*  pages_;
+    uint32_t blockAlign_;
+
+    // Pages sorted by address
+    std::map<uint64_t, page_t> pages_;
+
+    // Free blocks across all pages sorted by (size, addr)
+    // Used for block lookup during memory allocation.
+    std::set<std::pair<uint64_t, uint64_t>> freeSizes_;
+
+    // Allocated blocks (addr -> size)
+    std::map<uint64_t, uint64_t> usedBlocks_;
+
     uint64_t nextAddress_;
     uint64_t allocated_;
 };
@@ -20,15 +20,20 @@
 #include <chrono>
 #include <vector>
 #include <list>
+#include <deque>
+#include <algorithm>
 #include <assert.h>
-#include <chrono>
-#include <thread>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_set>
 #include <sstream>
+#include <zlib.h>
+
+// frames read from a tap before moving to the next one
+#define FRAME_CHUNK_SIZE 256
 
-#define FRAME_FLUSH_SIZE 100
+// output buffered before each write
+#define OUTPUT_BUFFER_SIZE (1 << 20)
 
 #define MMIO_SCOPE_READ  (AFU_IMAGE_MMIO_SCOPE_READ * 4)
 #define MMIO_SCOPE_WRITE (AFU_IMAGE_MMIO_SCOPE_WRITE * 4)
@@ -63,6 +68,13 @@ struct tap_t {
     uint64_t cycle_time;
     std::string path;
     std::vector<tap_signal_t> signals;
+
+    // each frame is a delta word followed by the data words
+    uint32_t frame_words;
+    uint32_t read_frames;
+    std::deque<std::vector<uint64_t>> chunks;
+    std::vector<uint64_t> chunk;
+    uint32_t chunk_offset;
 };
 
 static scope_callback_t g_callback;
@@ -79,18 +91,18 @@ static std::vector<std::string> split(const std::string &s, char delimiter) {
     return tokens;
 }
 
-static void dump_module(std::ofstream& ofs, 
+static void dump_module(std::ostream& ofs, 
                         const std::string& name,
                         std::unordered_map<std::string, std::unordered_set<std::string>>& hierarchy,
                         std::unordered_map<std::string, tap_t*>& tails,
                         int indentation) {
     std::string indent(indentation, ' ');
-    ofs << indent << "$scope module " << name << " $end" << std::endl;
+    ofs << indent << "$scope module " << name << " $end\n";
 
     auto itt = tails.find(name);
     if (itt != tails.end()) {
         for (auto& signal : itt->second->signals) {
-            ofs << indent << " $var reg " << signal.width << " " << signal.id << " " << signal.name << " $end" << std::endl;                        
+            ofs << indent << " $var reg " << signal.width << " " << signal.id << " " << signal.name << " $end\n";
         }
     }
 
@@ -101,14 +113,14 @@ static void dump_module(std::ofstream& ofs,
         }
     }
 
-    ofs << indent << "$upscope $end" << std::endl;
+    ofs << indent << "$upscope $end\n";
 }
 
-static void dump_header(std::ofstream& ofs, std::vector<tap_t>& taps) {
-    ofs << "$version Generated by Vortex Scope Analyzer $end" << std::endl;
-    ofs << "$timescale 1 ns $end" << std::endl; 
-    ofs << "$scope module TOP $end" << std::endl;
-    ofs << " $var reg 1 0 clk $end" << std::endl;
+static void dump_header(std::ostream& ofs, std::vector<tap_t>& taps) {
+    ofs << "$version Generated by Vortex Scope Analyzer $end\n";
+    ofs << "$timescale 1 ns $end\n"; 
+    ofs << "$scope module TOP $end\n";
+    ofs << " $var reg 1 0 clk $end\n";
 
     std::unordered_map<std::string, std::unordered_set<std::string>> hierarchy;
     std::unordered_set<std::string> heads;
@@ -131,8 +143,8 @@ static void dump_header(std::ofstream& ofs, std::vector<tap_t>& taps) {
         dump_module(ofs, head, hierarchy, tails, 1);
     }
 
-    ofs << "$upscope $end" << std::endl;    
-    ofs << "enddefinitions $end" << std::endl;
+    ofs << "$upscope $end\n";    
+    ofs << "enddefinitions $end\n";
 }
 
 static tap_t* find_nearest_tap(std::vector<tap_t>& taps) {
@@ -150,61 +162,178 @@ static tap_t* find_nearest_tap(std::vector<tap_t>& taps) {
     return nearest;
 }
 
-static uint64_t advance_time(std::ofstream& ofs, uint64_t next_time, uint64_t cur_time) {
-    while (cur_time < next_time) {
-        ofs << '#' << (cur_time * 2 + 0) << std::endl;
-        ofs << "b0 0" << std::endl;
-        ofs << '#' << (cur_time * 2 + 1) << std::endl;
-        ofs << "b1 0" << std::endl;
-        ++cur_time;
+///////////////////////////////////////////////////////////////////////////////
+
+// Formats the frames read from the device into the waveform file on its own
+// thread, so that the MMIO readout of the next frames overlaps with it.
+// The output is gzip-compressed when the file name ends with ".gz".
+class trace_writer_t {
+public:
+    trace_writer_t(std::vector<tap_t>& taps) 
+        : taps_(taps)
+        , file_(nullptr)
+        , done_(false)
+        , error_(false) 
+    {}
+
+    ~trace_writer_t() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (file_) {
+            gzclose(file_);
+        }
     }
-    return cur_time;
-}
 
-static int dump_tap(std::ofstream& ofs, tap_t* tap, vx_device_h hdevice) {
-    uint32_t signal_offset = 0;   
-    uint32_t frame_offset = 0;
-    uint64_t word;
+    int open(const std::string& filename) {
+        bool compress = (filename.size() > 3 && 0 == filename.compare(filename.size() - 3, 3, ".gz"));
+        // favor speed over ratio, the transparent mode writes plain text
+        file_ = gzopen(filename.c_str(), compress ? "wb1" : "wbT");
+        if (nullptr == file_) {
+            std::cerr << "[SCOPE] error: cannot create trace file: " << filename << std::endl;
+            return -1;
+        }
+        gzbuffer(file_, OUTPUT_BUFFER_SIZE);
+        std::ostringstream header;
+        dump_header(header, taps_);
+        buffer_ = header.str();
+        thread_ = std::thread(&trace_writer_t::run, this);
+        return 0;
+    }
 
-    std::vector<char> signal_data(tap->width);
-    auto signal_it = tap->signals.rbegin();
-    uint32_t signal_width = signal_it->width;
+    // called by the reader once a chunk of frames of a tap is available
+    void push(tap_t& tap, std::vector<uint64_t>&& chunk) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tap.chunks.emplace_back(std::move(chunk));
+        cv_.notify_one();
+    }
 
-    do {
-        // read data
-        uint64_t cmd_data = (tap->id << 3) | CMD_GET_DATA;
-        CHECK_ERR(g_callback.registerWrite(hdevice, cmd_data));        
-        CHECK_ERR(g_callback.registerRead(hdevice, &word));        
-        do {            
-            uint32_t word_offset = frame_offset % 64;
-            signal_data[signal_width - signal_offset - 1] = ((word >> word_offset) & 0x1) ? '1' : '0';
-            ++signal_offset;
-            ++frame_offset;
-            if (signal_offset == signal_width) {
-                signal_data[signal_width] = 0; // string null termination
-                ofs << 'b' << signal_data.data() << ' ' << signal_it->id << std::endl;
-                if (frame_offset == tap->width) {
-                    // end-of-frame
-                    ++tap->cur_frame;
-                    if (tap->cur_frame != tap->frames) {
-                        // read next delta
-                        CHECK_ERR(g_callback.registerWrite(hdevice, cmd_data));      
-                        CHECK_ERR(g_callback.registerRead(hdevice, &word));
-                        tap->cycle_time += 1 + word;
-                        if (0 == (tap->cur_frame % FRAME_FLUSH_SIZE)) {
-                            ofs << std::flush;
-                            std::cout << std::dec << "[SCOPE] flush tap #" << tap->id << ": "<< tap->cur_frame << "/" << tap->frames << " frames, next_time=" << tap->cycle_time << std::endl;
-                        }
-                    }
-                    break; 
-                }
-                signal_offset = 0;
-                ++signal_it;
-                signal_width = signal_it->width;
+    // called by the reader when the readout is complete or has failed
+    void finish(bool error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = error;
+            done_ = true;
+            cv_.notify_one();
+        }
+        thread_.join();
+    }
+
+    uint64_t cycles() const {
+        return cur_time_;
+    }
+
+private:
+
+    // make the next frame of the tap current, returns its delta
+    bool next_frame(tap_t& tap, uint64_t* delta) {
+        if (tap.chunk_offset == tap.chunk.size()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]{ return !tap.chunks.empty() || error_ || done_; });
+            if (tap.chunks.empty())
+                return false;
+            tap.chunk = std::move(tap.chunks.front());
+            tap.chunks.pop_front();
+            tap.chunk_offset = 0;
+        }
+        *delta = tap.chunk.at(tap.chunk_offset);
+        return true;
+    }
+
+    void advance_time(uint64_t next_time) {
+        while (cur_time_ < next_time) {
+            buffer_ += '#';
+            buffer_ += std::to_string(cur_time_ * 2 + 0);
+            buffer_ += "\nb0 0\n#";
+            buffer_ += std::to_string(cur_time_ * 2 + 1);
+            buffer_ += "\nb1 0\n";
+            ++cur_time_;
+            this->flush(false);
+        }
+    }
+
+    void dump_frame(tap_t& tap) {
+        auto words = tap.chunk.data() + tap.chunk_offset + 1;
+        uint32_t frame_offset = 0;
+        for (auto it = tap.signals.rbegin(); it != tap.signals.rend(); ++it) {
+            uint32_t width = it->width;
+            buffer_ += 'b';
+            auto pos = buffer_.size();
+            buffer_.resize(pos + width);
+            for (uint32_t i = 0; i < width; ++i, ++frame_offset) {
+                bool bit = (words[frame_offset / 64] >> (frame_offset % 64)) & 0x1;
+                buffer_[pos + width - i - 1] = bit ? '1' : '0';
             }
-        } while ((frame_offset % 64) != 0);
-    } while (frame_offset != tap->width);
+            buffer_ += ' ';
+            buffer_ += std::to_string(it->id);
+            buffer_ += '\n';
+        }
+        tap.chunk_offset += tap.frame_words;
+        this->flush(false);
+    }
+
+    void flush(bool force) {
+        if (buffer_.empty() || (!force && buffer_.size() < OUTPUT_BUFFER_SIZE))
+            return;
+        gzwrite(file_, buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+    void run() {
+        cur_time_ = 0;
+
+        // the first delta is relative to the start time
+        for (auto& tap : taps_) {
+            if (0 == tap.frames)
+                continue;
+            uint64_t delta;
+            if (!this->next_frame(tap, &delta))
+                return;
+            tap.cycle_time += 1 + delta;
+        }
+
+        while (true) {
+            // find the nearest tap
+            auto tap = find_nearest_tap(taps_);
+            if (tap == nullptr)
+                break;
+            // advance clock
+            this->advance_time(tap->cycle_time);
+            // dump tap
+            this->dump_frame(*tap);
+            ++tap->cur_frame;
+            if (tap->cur_frame != tap->frames) {
+                uint64_t delta;
+                if (!this->next_frame(*tap, &delta))
+                    return;
+                tap->cycle_time += 1 + delta;
+            }
+        }
+
+        this->flush(true);
+    }
 
+    std::vector<tap_t>& taps_;
+    gzFile file_;
+    std::string buffer_;
+    uint64_t cur_time_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_;
+    bool error_;
+};
+
+// read the next chunk of frames of a tap
+static int read_chunk(tap_t& tap, vx_device_h hdevice, std::vector<uint64_t>* chunk) {
+    uint32_t frames = std::min<uint32_t>(tap.frames - tap.read_frames, FRAME_CHUNK_SIZE);
+    chunk->resize(frames * tap.frame_words);
+    uint64_t cmd_data = (tap.id << 3) | CMD_GET_DATA;
+    for (auto& word : *chunk) {
+        CHECK_ERR(g_callback.registerWrite(hdevice, cmd_data));
+        CHECK_ERR(g_callback.registerRead(hdevice, &word));
+    }
+    tap.read_frames += frames;
     return 0;
 }
 
@@ -307,13 +436,9 @@ int vx_scope_stop(vx_device_h hdevice) {
 
     std::cout << "[SCOPE] trace dump begin..." << std::endl;
 
-    std::ofstream ofs("scope.vcd");
-
-    dump_header(ofs, taps);
-
     // load trace info
     for (auto& tap : taps) {
-        uint64_t count, start, delta;
+        uint64_t count, start;
 
         // get count
         uint64_t cmd_count = (tap.id << 3) | CMD_GET_COUNT;
@@ -325,35 +450,48 @@ int vx_scope_stop(vx_device_h hdevice) {
         CHECK_ERR(g_callback.registerWrite(hdevice, cmd_start));
         CHECK_ERR(g_callback.registerRead(hdevice, &start));
 
-        // get data
-        uint64_t cmd_data = (tap.id << 3) | CMD_GET_DATA;
-        CHECK_ERR(g_callback.registerWrite(hdevice, cmd_data));
-        CHECK_ERR(g_callback.registerRead(hdevice, &delta));
-
         tap.frames = count;
-        tap.cycle_time = 1 + start + delta;
+        tap.cycle_time = start;
+        tap.frame_words = 1 + (tap.width + 63) / 64;
+        tap.read_frames = 0;
+        tap.chunk_offset = 0;
 
         std::cout << std::dec << "[SCOPE] tap #" << tap.id 
                               << ": width=" << tap.width 
                               << ", num_frames=" << tap.frames 
-                              << ", start_time=" << tap.cycle_time 
+                              << ", start_time=" << start 
                               << ", path=" << tap.path << std::endl;
     }  
 
-    uint64_t cur_time = 0;
+    // SCOPE_OUTPUT=<file>, gzip-compressed when ending with ".gz"
+    auto output = getenv("SCOPE_OUTPUT");
+    std::string filename = (output && output[0]) ? output : "scope.vcd";
+
+    trace_writer_t writer(taps);
+    CHECK_ERR(writer.open(filename));
 
-    while (true) {
-        // find the nearest tap
-        auto tap = find_nearest_tap(taps);
-        if (tap == nullptr)
-            break;
-        // advance clock
-        cur_time = advance_time(ofs, tap->cycle_time, cur_time);        
-        // dump tap
-        CHECK_ERR(dump_tap(ofs, tap, hdevice));
-    };
+    // read the taps round-robin, one chunk at a time, while the writer
+    // formats the frames already read
+    int err = 0;
+    bool pending;
+    do {
+        pending = false;
+        for (auto& tap : taps) {
+            if (tap.read_frames == tap.frames)
+                continue;
+            std::vector<uint64_t> chunk;
+            err = read_chunk(tap, hdevice, &chunk);
+            if (err != 0)
+                break;
+            writer.push(tap, std::move(chunk));
+            pending |= (tap.read_frames != tap.frames);
+        }
+    } while (pending && 0 == err);
+    writer.finish(err != 0);
+    if (err != 0)
+        return err;
 
-    std::cout << "[SCOPE] trace dump done! - " << (cur_time/2) << " cycles" << std::endl;
+    std::cout << "[SCOPE] trace dump done! - " << writer.cycles() << " cycles" << std::endl;
 
     return 0;
 }
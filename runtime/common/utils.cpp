@@ -13,12 +13,19 @@
 
 #include "utils.h"
 #include <iostream>
-#include <fstream>
 #include <list>
 #include <cstring>
 #include <vector>
+#include <string>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vortex.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define RT_CHECK(_expr, _cleanup)                               \
    do {                                                         \
@@ -43,15 +50,40 @@ bool is_aligned(uint64_t addr, uint64_t alignment) {
 
 class AutoPerfDump {
 public:
-    AutoPerfDump() : perf_class_(0) {}
+    AutoPerfDump() 
+      : perf_class_(0)
+      , perf_format_(VX_PERF_FORMAT_TEXT)
+      , stream_(stdout) {
+      auto perf_format_s = getenv("PERF_FORMAT");
+      if (perf_format_s) {
+        std::string perf_format(perf_format_s);
+        if (perf_format == "json") {
+          perf_format_ = VX_PERF_FORMAT_JSON;
+        } else if (perf_format == "csv") {
+          perf_format_ = VX_PERF_FORMAT_CSV;
+        }
+      }
+      auto perf_output_s = getenv("PERF_OUTPUT");
+      if (perf_output_s) {
+        stream_ = fopen(perf_output_s, "a");
+        if (nullptr == stream_) {
+          printf("Error: failed to open perf output file %s\n", perf_output_s);
+          stream_ = stdout;
+        }
+      }
+    }
 
     ~AutoPerfDump() {
       for (auto hdevice : hdevices_) {
-        vx_dump_perf(hdevice, stdout);
+        vx_dump_perf_ex(hdevice, stream_, perf_format_);
+      }
+      if (stream_ != stdout) {
+        fclose(stream_);
       }
     }
 
     void add_device(vx_device_h hdevice) {
+      std::lock_guard<std::mutex> lock(mutex_);
       auto perf_class_s = getenv("PERF_CLASS");
       if (perf_class_s) {
         perf_class_ = std::atoi(perf_class_s);
@@ -61,8 +93,11 @@ public:
     }
 
     void remove_device(vx_device_h hdevice) {
-      hdevices_.remove(hdevice);
-      vx_dump_perf(hdevice, stdout);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hdevices_.remove(hdevice);
+      }
+      vx_dump_perf_ex(hdevice, stream_, perf_format_);
     }
 
     int get_perf_class() const {
@@ -71,7 +106,10 @@ public:
     
 private:
     std::list<vx_device_h> hdevices_;
+    std::mutex mutex_;
     int perf_class_;
+    int perf_format_;
+    FILE* stream_;
 };
 
 #ifdef DUMP_PERF_STATS
@@ -96,6 +134,183 @@ void perf_remove_device(vx_device_h hdevice) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// read-only memory mapping of a host file
+class MappedFile {
+public:
+  MappedFile() : data_(nullptr), size_(0) {}
+
+  ~MappedFile() {
+    if (data_) {
+      munmap(data_, size_);
+    }
+  }
+
+  int open(const char* filename) {
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) {
+      std::cout << "error: " << filename << " not found" << std::endl;
+      return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      std::cout << "error: " << filename << " is empty" << std::endl;
+      close(fd);
+      return -1;
+    }
+    auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      std::cout << "error: failed to map " << filename << std::endl;
+      return -1;
+    }
+    data_ = data;
+    size_ = st.st_size;
+    return 0;
+  }
+
+  const void* data() const {
+    return data_;
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+private:
+  void*    data_;
+  uint64_t size_;
+};
+
+// FNV-1a
+uint64_t content_hash(const void* content, uint64_t size) {
+  auto bytes = reinterpret_cast<const uint8_t*>(content);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (uint64_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+struct kernel_entry_t {
+  std::vector<uint8_t> content;
+  uint64_t hash;
+  uint64_t base_addr;
+  bool     resident;
+};
+
+// Device-side kernel registry.
+// Each registered binary keeps a host copy so that it can be restored if a copy to
+// the device overwrote its image; otherwise a launch only rewrites the startup DCRs.
+// Writes of the kernel itself to its image (e.g. initialized .data) are not tracked.
+class KernelRegistry {
+public:
+  int add(vx_device_h hdevice, const void* content, uint64_t size, uint64_t base_addr, vx_kernel_h* hkernel) {
+    auto hash = content_hash(content, size);
+    for (auto& kernel : kernels_) {
+      if (kernel->hash == hash
+       && kernel->base_addr == base_addr
+       && kernel->content.size() == size
+       && 0 == memcmp(kernel->content.data(), content, size)) {
+        *hkernel = kernel.get();
+        return 0;
+      }
+    }
+    auto kernel = new kernel_entry_t();
+    kernel->content.assign((const uint8_t*)content, (const uint8_t*)content + size);
+    kernel->hash = hash;
+    kernel->base_addr = base_addr;
+    kernel->resident = false;
+    kernels_.emplace_back(kernel);
+    int err = this->upload(hdevice, kernel);
+    if (err != 0) {
+      kernels_.pop_back();
+      return err;
+    }
+    *hkernel = kernel;
+    return 0;
+  }
+
+  int select(vx_device_h hdevice, vx_kernel_h hkernel) {
+    auto kernel = this->find(hkernel);
+    if (nullptr == kernel)
+      return -1;
+    if (!kernel->resident) {
+      int err = this->upload(hdevice, kernel);
+      if (err != 0)
+        return err;
+    }
+    RT_CHECK(vx_dcr_write(hdevice, VX_DCR_BASE_STARTUP_ADDR0, kernel->base_addr & 0xffffffff), {
+      return -1;
+    });
+    RT_CHECK(vx_dcr_write(hdevice, VX_DCR_BASE_STARTUP_ADDR1, kernel->base_addr >> 32), {
+      return -1;
+    });
+    return 0;
+  }
+
+  int remove(vx_kernel_h hkernel) {
+    for (auto it = kernels_.begin(); it != kernels_.end(); ++it) {
+      if (it->get() == hkernel) {
+        kernels_.erase(it);
+        return 0;
+      }
+    }
+    return -1;
+  }
+
+  // mark kernels whose image overlaps the given device range as overwritten
+  void invalidate(uint64_t addr, uint64_t size) {
+    for (auto& kernel : kernels_) {
+      if (addr < (kernel->base_addr + kernel->content.size())
+       && kernel->base_addr < (addr + size)) {
+        kernel->resident = false;
+      }
+    }
+  }
+
+private:
+
+  kernel_entry_t* find(vx_kernel_h hkernel) const {
+    for (auto& kernel : kernels_) {
+      if (kernel.get() == hkernel)
+        return kernel.get();
+    }
+    return nullptr;
+  }
+
+  int upload(vx_device_h hdevice, kernel_entry_t* kernel) {
+    // the copy invalidates every kernel overlapping the range, this one included
+    int err = vx_copy_to_dev(hdevice, kernel->base_addr, kernel->content.data(), kernel->content.size());
+    if (err != 0)
+      return err;
+    kernel->resident = true;
+    return 0;
+  }
+
+  std::list<std::unique_ptr<kernel_entry_t>> kernels_;
+};
+
+// recursive: registry uploads go through vx_copy_to_dev, which calls kernel_invalidate
+std::recursive_mutex g_kernel_mutex;
+std::unordered_map<vx_device_h, KernelRegistry> g_kernel_registries;
+
+}
+
+void kernel_remove_device(vx_device_h hdevice) {
+  std::lock_guard<std::recursive_mutex> lock(g_kernel_mutex);
+  g_kernel_registries.erase(hdevice);
+}
+
+void kernel_invalidate(vx_device_h hdevice, uint64_t addr, uint64_t size) {
+  std::lock_guard<std::recursive_mutex> lock(g_kernel_mutex);
+  auto it = g_kernel_registries.find(hdevice);
+  if (it != g_kernel_registries.end()) {
+    it->second.invalidate(addr, size);
+  }
+}
+
 extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint64_t size) {
   int err = 0;
 
@@ -111,26 +326,58 @@ extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint
 }
 
 extern int vx_upload_kernel_file(vx_device_h hdevice, const char* filename) {
-  std::ifstream ifs(filename);
-  if (!ifs) {
-    std::cout << "error: " << filename << " not found" << std::endl;
+  MappedFile file;
+  int err = file.open(filename);
+  if (err != 0)
+    return err;
+
+  return vx_upload_kernel_bytes(hdevice, file.data(), file.size());
+}
+
+extern int vx_kernel_register(vx_device_h hdevice, const void* content, uint64_t size, uint64_t base_addr, vx_kernel_h* hkernel) {
+  if (nullptr == hdevice
+   || nullptr == content
+   || 0 == size
+   || nullptr == hkernel)
     return -1;
-  }
 
-  // read file content
-  ifs.seekg(0, ifs.end);
-  auto size = ifs.tellg();
-  auto content = new char [size];   
-  ifs.seekg(0, ifs.beg);
-  ifs.read(content, size);
+  std::lock_guard<std::recursive_mutex> lock(g_kernel_mutex);
+  return g_kernel_registries[hdevice].add(hdevice, content, size, base_addr, hkernel);
+}
+
+extern int vx_kernel_register_file(vx_device_h hdevice, const char* filename, uint64_t base_addr, vx_kernel_h* hkernel) {
+  MappedFile file;
+  int err = file.open(filename);
+  if (err != 0)
+    return err;
+
+  return vx_kernel_register(hdevice, file.data(), file.size(), base_addr, hkernel);
+}
+
+extern int vx_kernel_select(vx_device_h hdevice, vx_kernel_h hkernel) {
+  if (nullptr == hdevice
+   || nullptr == hkernel)
+    return -1;
+
+  std::lock_guard<std::recursive_mutex> lock(g_kernel_mutex);
+  auto it = g_kernel_registries.find(hdevice);
+  if (it == g_kernel_registries.end())
+    return -1;
 
-  // upload
-  int err = vx_upload_kernel_bytes(hdevice, content, size);
+  return it->second.select(hdevice, hkernel);
+}
 
-  // release buffer
-  delete[] content;
+extern int vx_kernel_release(vx_device_h hdevice, vx_kernel_h hkernel) {
+  if (nullptr == hdevice
+   || nullptr == hkernel)
+    return -1;
+
+  std::lock_guard<std::recursive_mutex> lock(g_kernel_mutex);
+  auto it = g_kernel_registries.find(hdevice);
+  if (it == g_kernel_registries.end())
+    return -1;
 
-  return err;
+  return it->second.remove(hkernel);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -165,13 +412,22 @@ int dcr_initialize(vx_device_h hdevice) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// per-core MPM block: 32 low words followed by 32 high words
+#define MPM_CSR_BLOCK_SIZE  (2 * VX_PERF_NUM_COUNTERS * sizeof(uint32_t))
+
 static uint64_t get_csr_64(const void* ptr, int addr) {
   auto w_ptr = reinterpret_cast<const uint32_t*>(ptr);
   uint32_t value_lo = w_ptr[addr - VX_CSR_MPM_BASE];
-  uint32_t value_hi = w_ptr[addr - VX_CSR_MPM_BASE + 32];
+  uint32_t value_hi = w_ptr[addr - VX_CSR_MPM_BASE + VX_PERF_NUM_COUNTERS];
   return (uint64_t(value_hi) << 32) | value_lo;
 }
 
+// fetch the MPM blocks of the first num_cores cores with a single copy
+static int read_mpm_csrs(vx_device_h hdevice, uint32_t num_cores, std::vector<uint8_t>& staging_buf) {
+  staging_buf.resize(num_cores * MPM_CSR_BLOCK_SIZE);
+  return vx_copy_from_dev(hdevice, staging_buf.data(), IO_CSR_ADDR, staging_buf.size());
+}
+
 extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   int ret = 0;
 
@@ -207,11 +463,33 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t fpu_stalls = 0;
   uint64_t alu_stalls = 0;
   uint64_t sfu_stalls = 0;  
+  uint64_t opds_bank_stalls = 0;
   uint64_t ifetches = 0;
   uint64_t loads = 0;
   uint64_t stores = 0;
   uint64_t ifetch_lat = 0;
   uint64_t load_lat   = 0;  
+  // PERF: divergence
+  uint64_t warp_instrs = 0;
+  uint64_t diverged_instrs = 0;
+  uint64_t diverged_cycles = 0;
+  uint64_t splits = 0;
+  uint64_t divergent_splits = 0;
+  uint64_t ipdom_depth = 0;
+  uint64_t lanes_hist[4] = {0, 0, 0, 0};
+  // PERF: simulator
+  uint64_t opds_occupancy = 0;
+  uint64_t opds_stalls = 0;
+  uint64_t vpu_busy = 0;
+  uint64_t vpu_stalls = 0;
+  // PERF: functional units
+  uint64_t idiv_busy = 0;
+  uint64_t idiv_stalls = 0;
+  uint64_t fdiv_busy = 0;
+  uint64_t fdiv_stalls = 0;
+  uint64_t fsqrt_busy = 0;
+  uint64_t fsqrt_stalls = 0;
+  uint64_t fu_stalls = 0;
   // PERF: l2cache 
   uint64_t l2cache_reads = 0;
   uint64_t l2cache_writes = 0;
@@ -248,78 +526,136 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   bool l2cache_enable = isa_flags & VX_ISA_EXT_L2CACHE;
   bool l3cache_enable = isa_flags & VX_ISA_EXT_L3CACHE;
   bool smem_enable    = isa_flags & VX_ISA_EXT_SMEM;
+
+  uint64_t num_threads;
+  ret = vx_dev_caps(hdevice, VX_CAPS_NUM_THREADS, &num_threads);
+  if (ret != 0)
+    return ret;
+
+  auto calcSimtEfficiency = [&](uint64_t thread_instrs, uint64_t warp_instrs)->int {
+    if (warp_instrs == 0)
+      return 0;
+    return int((double(thread_instrs) / double(warp_instrs * num_threads)) * 100);
+  };
 #endif
 
-  std::vector<uint8_t> staging_buf(64* sizeof(uint32_t));
+  std::vector<uint8_t> mpm_buf;
+  ret = read_mpm_csrs(hdevice, num_cores, mpm_buf);
+  if (ret != 0)
+    return ret;
       
   for (unsigned core_id = 0; core_id < num_cores; ++core_id) {    
-    uint64_t mpm_mem_addr = IO_CSR_ADDR + core_id * staging_buf.size();    
-    ret = vx_copy_from_dev(hdevice, staging_buf.data(), mpm_mem_addr, staging_buf.size());
-    if (ret != 0)
-      return ret;
+    auto staging_buf = mpm_buf.data() + core_id * MPM_CSR_BLOCK_SIZE;
 
   #ifdef PERF_ENABLE
     switch (perf_class) {
     case VX_DCR_MPM_CLASS_CORE: {
       // PERF: pipeline    
       // ibuffer_stall
-      uint64_t ibuffer_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_IBUF_ST);
+      uint64_t ibuffer_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IBUF_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: ibuffer stalls=%ld\n", core_id, ibuffer_stalls_per_core);
       ibuffer_stalls += ibuffer_stalls_per_core;
       // scoreboard_stall
-      uint64_t scoreboard_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_SCRB_ST);
+      uint64_t scoreboard_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_SCRB_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: scoreboard stalls=%ld\n", core_id, scoreboard_stalls_per_core);
       scoreboard_stalls += scoreboard_stalls_per_core;
       // alu_stall
-      uint64_t alu_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_ALU_ST);
+      uint64_t alu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_ALU_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: alu unit stalls=%ld\n", core_id, alu_stalls_per_core);
       alu_stalls += alu_stalls_per_core;      
       // lsu_stall
-      uint64_t lsu_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_LSU_ST);
+      uint64_t lsu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_LSU_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: lsu unit stalls=%ld\n", core_id, lsu_stalls_per_core);
       lsu_stalls += lsu_stalls_per_core;
       // fpu_stall
-      uint64_t fpu_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_FPU_ST);
+      uint64_t fpu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FPU_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: fpu unit stalls=%ld\n", core_id, fpu_stalls_per_core);
       fpu_stalls += fpu_stalls_per_core;      
       // sfu_stall
-      uint64_t sfu_stalls_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_SFU_ST);
+      uint64_t sfu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_SFU_ST);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: sfu unit stalls=%ld\n", core_id, sfu_stalls_per_core);
       sfu_stalls += sfu_stalls_per_core;
+      // operand collection
+      uint64_t opds_bank_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_OPDS_BANK_ST);
+      if (num_cores > 1) fprintf(stream, "PERF: core%d: operand bank conflicts=%ld\n", core_id, opds_bank_stalls_per_core);
+      opds_bank_stalls += opds_bank_stalls_per_core;
       // PERF: memory
       // ifetches
-      uint64_t ifetches_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_LOADS);
+      uint64_t ifetches_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IFETCHES);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: ifetches=%ld\n", core_id, ifetches_per_core);
       ifetches += ifetches_per_core;
       // loads
-      uint64_t loads_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_LOADS);
+      uint64_t loads_per_core = get_csr_64(staging_buf, VX_CSR_MPM_LOADS);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: loads=%ld\n", core_id, loads_per_core);
       loads += loads_per_core;
       // stores
-      uint64_t stores_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_STORES);
+      uint64_t stores_per_core = get_csr_64(staging_buf, VX_CSR_MPM_STORES);
       if (num_cores > 1) fprintf(stream, "PERF: core%d: stores=%ld\n", core_id, stores_per_core);
       stores += stores_per_core;
       // ifetch latency
-      uint64_t ifetch_lat_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_IFETCH_LAT);
+      uint64_t ifetch_lat_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IFETCH_LAT);
       if (num_cores > 1) {
         int mem_avg_lat = caclAvgLatency(ifetch_lat_per_core, ifetches_per_core);
         fprintf(stream, "PERF: core%d: ifetch latency=%d cycles\n", core_id, mem_avg_lat);
       }
       ifetch_lat += ifetch_lat_per_core;
       // load latency
-      uint64_t load_lat_per_core = get_csr_64(staging_buf.data(), VX_CSR_MPM_LOAD_LAT);
+      uint64_t load_lat_per_core = get_csr_64(staging_buf, VX_CSR_MPM_LOAD_LAT);
       if (num_cores > 1) {
         int mem_avg_lat = caclAvgLatency(load_lat_per_core, loads_per_core);
         fprintf(stream, "PERF: core%d: load latency=%d cycles\n", core_id, mem_avg_lat);
       }
       load_lat += load_lat_per_core;      
+      // PERF: divergence
+      uint64_t warp_instrs_per_core = get_csr_64(staging_buf, VX_CSR_MPM_WARP_INSTRS);
+      uint64_t diverged_instrs_per_core = get_csr_64(staging_buf, VX_CSR_MPM_DIVERGED_INSTRS);
+      uint64_t diverged_cycles_per_core = get_csr_64(staging_buf, VX_CSR_MPM_DIVERGED_CYCLES);
+      uint64_t splits_per_core = get_csr_64(staging_buf, VX_CSR_MPM_SPLITS);
+      uint64_t divergent_splits_per_core = get_csr_64(staging_buf, VX_CSR_MPM_DIVERGENT_SPLITS);
+      uint64_t ipdom_depth_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IPDOM_DEPTH);
+      if (num_cores > 1) {
+        int simt_efficiency = calcSimtEfficiency(get_csr_64(staging_buf, VX_CSR_MINSTRET), warp_instrs_per_core);
+        fprintf(stream, "PERF: core%d: warp instrs=%ld (simt efficiency=%d%%)\n", core_id, warp_instrs_per_core, simt_efficiency);
+        fprintf(stream, "PERF: core%d: diverged instrs=%ld, diverged cycles=%ld\n", core_id, diverged_instrs_per_core, diverged_cycles_per_core);
+        fprintf(stream, "PERF: core%d: splits=%ld (divergent=%ld), ipdom depth=%ld\n", core_id, splits_per_core, divergent_splits_per_core, ipdom_depth_per_core);
+      }
+      warp_instrs += warp_instrs_per_core;
+      diverged_instrs += diverged_instrs_per_core;
+      diverged_cycles += diverged_cycles_per_core;
+      splits += splits_per_core;
+      divergent_splits += divergent_splits_per_core;
+      ipdom_depth = std::max<uint64_t>(ipdom_depth_per_core, ipdom_depth);
+      for (uint32_t i = 0; i < 4; ++i) {
+        lanes_hist[i] += get_csr_64(staging_buf, VX_CSR_MPM_LANES_Q1 + i);
+      }
+      // PERF: functional units
+      uint64_t idiv_busy_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IDIV_BUSY);
+      uint64_t idiv_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_IDIV_ST);
+      uint64_t fdiv_busy_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FDIV_BUSY);
+      uint64_t fdiv_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FDIV_ST);
+      uint64_t fsqrt_busy_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FSQRT_BUSY);
+      uint64_t fsqrt_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FSQRT_ST);
+      uint64_t fu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_FU_ST);
+      if (num_cores > 1) {
+        fprintf(stream, "PERF: core%d: idiv busy=%ld, stalls=%ld\n", core_id, idiv_busy_per_core, idiv_stalls_per_core);
+        fprintf(stream, "PERF: core%d: fdiv busy=%ld, stalls=%ld\n", core_id, fdiv_busy_per_core, fdiv_stalls_per_core);
+        fprintf(stream, "PERF: core%d: fsqrt busy=%ld, stalls=%ld\n", core_id, fsqrt_busy_per_core, fsqrt_stalls_per_core);
+        fprintf(stream, "PERF: core%d: functional unit stalls=%ld\n", core_id, fu_stalls_per_core);
+      }
+      idiv_busy += idiv_busy_per_core;
+      idiv_stalls += idiv_stalls_per_core;
+      fdiv_busy += fdiv_busy_per_core;
+      fdiv_stalls += fdiv_stalls_per_core;
+      fsqrt_busy += fsqrt_busy_per_core;
+      fsqrt_stalls += fsqrt_stalls_per_core;
+      fu_stalls += fu_stalls_per_core;
     } break;
     case VX_DCR_MPM_CLASS_MEM: {      
       if (smem_enable) {
         // PERF: smem
-        uint64_t smem_reads = get_csr_64(staging_buf.data(), VX_CSR_MPM_SMEM_READS);
-        uint64_t smem_writes = get_csr_64(staging_buf.data(), VX_CSR_MPM_SMEM_WRITES);
-        uint64_t smem_bank_stalls = get_csr_64(staging_buf.data(), VX_CSR_MPM_SMEM_BANK_ST);
+        uint64_t smem_reads = get_csr_64(staging_buf, VX_CSR_MPM_SMEM_READS);
+        uint64_t smem_writes = get_csr_64(staging_buf, VX_CSR_MPM_SMEM_WRITES);
+        uint64_t smem_bank_stalls = get_csr_64(staging_buf, VX_CSR_MPM_SMEM_BANK_ST);
         int smem_bank_utilization = calcUtilization(smem_reads + smem_writes, smem_bank_stalls);
         fprintf(stream, "PERF: core%d: smem reads=%ld\n", core_id, smem_reads);
         fprintf(stream, "PERF: core%d: smem writes=%ld\n", core_id, smem_writes); 
@@ -328,8 +664,8 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
       if (icache_enable) {
         // PERF: Icache
-        uint64_t icache_reads = get_csr_64(staging_buf.data(), VX_CSR_MPM_ICACHE_READS);
-        uint64_t icache_read_misses = get_csr_64(staging_buf.data(), VX_CSR_MPM_ICACHE_MISS_R);
+        uint64_t icache_reads = get_csr_64(staging_buf, VX_CSR_MPM_ICACHE_READS);
+        uint64_t icache_read_misses = get_csr_64(staging_buf, VX_CSR_MPM_ICACHE_MISS_R);
         int icache_read_hit_ratio = calcRatio(icache_read_misses, icache_reads);    
         fprintf(stream, "PERF: core%d: icache reads=%ld\n", core_id, icache_reads);
         fprintf(stream, "PERF: core%d: icache read misses=%ld (hit ratio=%d%%)\n", core_id, icache_read_misses, icache_read_hit_ratio);
@@ -337,12 +673,12 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       
       if (dcache_enable) {
         // PERF: Dcache
-        uint64_t dcache_reads = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_READS);
-        uint64_t dcache_writes = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_WRITES);
-        uint64_t dcache_read_misses = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_MISS_R);
-        uint64_t dcache_write_misses = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_MISS_W);
-        uint64_t dcache_bank_stalls = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_BANK_ST);
-        uint64_t dcache_mshr_stalls = get_csr_64(staging_buf.data(), VX_CSR_MPM_DCACHE_MSHR_ST);
+        uint64_t dcache_reads = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_READS);
+        uint64_t dcache_writes = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_WRITES);
+        uint64_t dcache_read_misses = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_MISS_R);
+        uint64_t dcache_write_misses = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_MISS_W);
+        uint64_t dcache_bank_stalls = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_BANK_ST);
+        uint64_t dcache_mshr_stalls = get_csr_64(staging_buf, VX_CSR_MPM_DCACHE_MSHR_ST);
         int dcache_read_hit_ratio = calcRatio(dcache_read_misses, dcache_reads);
         int dcache_write_hit_ratio = calcRatio(dcache_write_misses, dcache_writes);
         int dcache_bank_utilization = calcUtilization(dcache_reads + dcache_writes, dcache_bank_stalls);
@@ -356,38 +692,52 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
       if (l2cache_enable) {
         // PERF: L2cache
-        l2cache_reads += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_READS);
-        l2cache_writes += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_WRITES);
-        l2cache_read_misses += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_MISS_R);
-        l2cache_write_misses += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_MISS_W);
-        l2cache_bank_stalls += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_BANK_ST);
-        l2cache_mshr_stalls += get_csr_64(staging_buf.data(), VX_CSR_MPM_L2CACHE_MSHR_ST);
+        l2cache_reads += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_READS);
+        l2cache_writes += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_WRITES);
+        l2cache_read_misses += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_MISS_R);
+        l2cache_write_misses += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_MISS_W);
+        l2cache_bank_stalls += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_BANK_ST);
+        l2cache_mshr_stalls += get_csr_64(staging_buf, VX_CSR_MPM_L2CACHE_MSHR_ST);
       }
 
       if (0 == core_id) {      
         if (l3cache_enable) {
           // PERF: L3cache
-          l3cache_reads = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_READS);
-          l3cache_writes = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_WRITES);
-          l3cache_read_misses = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_MISS_R);
-          l3cache_write_misses = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_MISS_W);
-          l3cache_bank_stalls = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_BANK_ST);
-          l3cache_mshr_stalls = get_csr_64(staging_buf.data(), VX_CSR_MPM_L3CACHE_MSHR_ST);
+          l3cache_reads = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_READS);
+          l3cache_writes = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_WRITES);
+          l3cache_read_misses = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_MISS_R);
+          l3cache_write_misses = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_MISS_W);
+          l3cache_bank_stalls = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_BANK_ST);
+          l3cache_mshr_stalls = get_csr_64(staging_buf, VX_CSR_MPM_L3CACHE_MSHR_ST);
         }
       
         // PERF: memory
-        mem_reads  = get_csr_64(staging_buf.data(), VX_CSR_MPM_MEM_READS);
-        mem_writes = get_csr_64(staging_buf.data(), VX_CSR_MPM_MEM_WRITES);
-        mem_lat    = get_csr_64(staging_buf.data(), VX_CSR_MPM_MEM_LAT);
+        mem_reads  = get_csr_64(staging_buf, VX_CSR_MPM_MEM_READS);
+        mem_writes = get_csr_64(staging_buf, VX_CSR_MPM_MEM_WRITES);
+        mem_lat    = get_csr_64(staging_buf, VX_CSR_MPM_MEM_LAT);
       }
     } break;
+    case VX_DCR_MPM_CLASS_SIMX: {
+      // PERF: operand collection
+      uint64_t opds_occupancy_per_core = get_csr_64(staging_buf, VX_CSR_MPM_OPDS_OCC);
+      uint64_t opds_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_OPDS_ST);
+      if (num_cores > 1) fprintf(stream, "PERF: core%d: collector occupancy=%ld, stalls=%ld\n", core_id, opds_occupancy_per_core, opds_stalls_per_core);
+      opds_occupancy += opds_occupancy_per_core;
+      opds_stalls += opds_stalls_per_core;
+      // PERF: vector unit
+      uint64_t vpu_busy_per_core = get_csr_64(staging_buf, VX_CSR_MPM_VPU_BUSY);
+      uint64_t vpu_stalls_per_core = get_csr_64(staging_buf, VX_CSR_MPM_VPU_ST);
+      if (num_cores > 1) fprintf(stream, "PERF: core%d: vpu busy=%ld, stalls=%ld\n", core_id, vpu_busy_per_core, vpu_stalls_per_core);
+      vpu_busy += vpu_busy_per_core;
+      vpu_stalls += vpu_stalls_per_core;
+    } break;
     default:
       break;
     }
   #endif 
 
-    uint64_t instrs_per_core = get_csr_64(staging_buf.data(), VX_CSR_MINSTRET);
-    uint64_t cycles_per_core = get_csr_64(staging_buf.data(), VX_CSR_MCYCLE);
+    uint64_t instrs_per_core = get_csr_64(staging_buf, VX_CSR_MINSTRET);
+    uint64_t cycles_per_core = get_csr_64(staging_buf, VX_CSR_MCYCLE);
     float IPC = (float)(double(instrs_per_core) / double(cycles_per_core));
     if (num_cores > 1) fprintf(stream, "PERF: core%d: instrs=%ld, cycles=%ld, IPC=%f\n", core_id, instrs_per_core, cycles_per_core, IPC);            
     instrs += instrs_per_core;
@@ -405,11 +755,20 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: lsu unit stalls=%ld\n", lsu_stalls);
     fprintf(stream, "PERF: fpu unit stalls=%ld\n", fpu_stalls);
     fprintf(stream, "PERF: sfu unit stalls=%ld\n", sfu_stalls);
+    fprintf(stream, "PERF: operand bank conflicts=%ld\n", opds_bank_stalls);
     fprintf(stream, "PERF: ifetches=%ld\n", ifetches);
     fprintf(stream, "PERF: loads=%ld\n", loads);
     fprintf(stream, "PERF: stores=%ld\n", stores);    
     fprintf(stream, "PERF: ifetch latency=%d cycles\n", ifetch_avg_lat);
     fprintf(stream, "PERF: load latency=%d cycles\n", load_avg_lat);    
+    fprintf(stream, "PERF: warp instrs=%ld (simt efficiency=%d%%)\n", warp_instrs, calcSimtEfficiency(instrs, warp_instrs));
+    fprintf(stream, "PERF: diverged instrs=%ld, diverged cycles=%ld\n", diverged_instrs, diverged_cycles);
+    fprintf(stream, "PERF: splits=%ld (divergent=%ld), ipdom depth=%ld\n", splits, divergent_splits, ipdom_depth);
+    fprintf(stream, "PERF: active lanes histogram: 0-25%%=%ld, 25-50%%=%ld, 50-75%%=%ld, 75-100%%=%ld\n", lanes_hist[0], lanes_hist[1], lanes_hist[2], lanes_hist[3]);
+    fprintf(stream, "PERF: idiv busy=%ld, stalls=%ld\n", idiv_busy, idiv_stalls);
+    fprintf(stream, "PERF: fdiv busy=%ld, stalls=%ld\n", fdiv_busy, fdiv_stalls);
+    fprintf(stream, "PERF: fsqrt busy=%ld, stalls=%ld\n", fsqrt_busy, fsqrt_stalls);
+    fprintf(stream, "PERF: functional unit stalls=%ld\n", fu_stalls);
   } break;  
   case VX_DCR_MPM_CLASS_MEM: {    
     if (l2cache_enable) {
@@ -447,6 +806,10 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: memory requests=%ld (reads=%ld, writes=%ld)\n", (mem_reads + mem_writes), mem_reads, mem_writes);
     fprintf(stream, "PERF: memory latency=%d cycles\n", mem_avg_lat);
   } break;
+  case VX_DCR_MPM_CLASS_SIMX: {
+    fprintf(stream, "PERF: collector occupancy=%ld, stalls=%ld\n", opds_occupancy, opds_stalls);
+    fprintf(stream, "PERF: vpu busy=%ld, stalls=%ld\n", vpu_busy, vpu_stalls);
+  } break;
   default:
     break;
   }
@@ -472,8 +835,6 @@ extern int vx_perf_counter(vx_device_h hdevice, int counter, int core_id, uint64
     return -1;
   }
 
-  std::vector<uint8_t> staging_buf(64 * sizeof(uint32_t));
-
   uint64_t _value = 0;
   
   unsigned i = 0;
@@ -481,14 +842,14 @@ extern int vx_perf_counter(vx_device_h hdevice, int counter, int core_id, uint64
     i = core_id;
     num_cores = core_id + 1;
   }
-      
-  for (i = 0; i < num_cores; ++i) {
-    uint64_t mpm_mem_addr = IO_CSR_ADDR + i * staging_buf.size();    
-    ret = vx_copy_from_dev(hdevice, staging_buf.data(), mpm_mem_addr, staging_buf.size());
-    if (ret != 0)
-      return ret;
 
-    auto per_core_value = get_csr_64(staging_buf.data(), counter);     
+  std::vector<uint8_t> staging_buf;
+  ret = read_mpm_csrs(hdevice, num_cores, staging_buf);
+  if (ret != 0)
+    return ret;
+      
+  for (; i < num_cores; ++i) {
+    auto per_core_value = get_csr_64(staging_buf.data() + i * MPM_CSR_BLOCK_SIZE, counter);     
     if (counter == VX_CSR_MCYCLE) {
       _value = std::max<uint64_t>(per_core_value, _value);
     } else {
@@ -501,3 +862,318 @@ extern int vx_perf_counter(vx_device_h hdevice, int counter, int core_id, uint64
 
   return 0;
 }
+
+extern int vx_perf_read(vx_device_h hdevice, uint64_t* counters, uint32_t num_cores) {
+  int ret = 0;
+  if (nullptr == counters)
+    return -1;
+
+  uint64_t dev_num_cores;
+  ret = vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &dev_num_cores);
+  if (ret != 0)
+    return ret;
+
+  if (num_cores > dev_num_cores) {
+    std::cout << "error: num_cores out of range" << std::endl;
+    return -1;
+  }
+
+  std::vector<uint8_t> staging_buf;
+  ret = read_mpm_csrs(hdevice, num_cores, staging_buf);
+  if (ret != 0)
+    return ret;
+
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    auto core_buf = staging_buf.data() + core_id * MPM_CSR_BLOCK_SIZE;
+    for (uint32_t i = 0; i < VX_PERF_NUM_COUNTERS; ++i) {
+      counters[core_id * VX_PERF_NUM_COUNTERS + i] = get_csr_64(core_buf, VX_CSR_MPM_BASE + i);
+    }
+  }
+
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct perf_value_t {
+  std::string name;
+  double      value;
+  bool        integral;
+};
+
+typedef std::vector<perf_value_t> perf_record_t;
+
+// Collect the raw counters and derived metrics of a scope (single core or device total).
+// Ratios are reported as fractions in [0, 1] and latencies as average cycles.
+void build_perf_record(perf_record_t& record,
+                       const std::function<uint64_t(uint32_t)>& get_csr,
+                       int perf_class,
+                       uint64_t isa_flags,
+                       uint64_t num_threads) {
+  auto add_counter = [&](const std::string& name, uint32_t addr)->uint64_t {
+    auto value = get_csr(addr);
+    record.push_back({name, double(value), true});
+    return value;
+  };
+
+  auto add_metric = [&](const std::string& name, double value) {
+    record.push_back({name, value, false});
+  };
+
+  uint64_t cycles = add_counter("cycles", VX_CSR_MCYCLE);
+  uint64_t instrs = add_counter("instrs", VX_CSR_MINSTRET);
+  add_metric("ipc", (cycles != 0) ? (double(instrs) / double(cycles)) : 0);
+
+#ifdef PERF_ENABLE
+  auto calcHitRatio = [&](uint64_t misses, uint64_t total)->double {
+    if (total == 0)
+      return 0;
+    return 1.0 - (double(misses) / double(total));
+  };
+
+  auto caclAvgLatency = [&](uint64_t sum, uint64_t requests)->double {
+    if (requests == 0)
+      return 0;
+    return double(sum) / double(requests);
+  };
+
+  auto calcUtilization = [&](uint64_t count, uint64_t stalls)->double {
+    if (count == 0)
+      return 0;
+    return double(count) / double(count + stalls);
+  };
+
+  auto add_cache = [&](const char* prefix,
+                       uint32_t reads_addr,
+                       uint32_t writes_addr,
+                       uint32_t read_misses_addr,
+                       uint32_t write_misses_addr,
+                       uint32_t bank_stalls_addr,
+                       uint32_t mshr_stalls_addr) {
+    auto name = [&](const char* suffix) {
+      return std::string(prefix) + suffix;
+    };
+    uint64_t reads = add_counter(name("_reads"), reads_addr);
+    uint64_t writes = add_counter(name("_writes"), writes_addr);
+    uint64_t read_misses = add_counter(name("_read_misses"), read_misses_addr);
+    uint64_t write_misses = add_counter(name("_write_misses"), write_misses_addr);
+    uint64_t bank_stalls = add_counter(name("_bank_stalls"), bank_stalls_addr);
+    add_counter(name("_mshr_stalls"), mshr_stalls_addr);
+    add_metric(name("_read_hit_ratio"), calcHitRatio(read_misses, reads));
+    add_metric(name("_write_hit_ratio"), calcHitRatio(write_misses, writes));
+    add_metric(name("_bank_utilization"), calcUtilization(reads + writes, bank_stalls));
+  };
+
+  switch (perf_class) {
+  case VX_DCR_MPM_CLASS_CORE: {
+    add_counter("ibuffer_stalls", VX_CSR_MPM_IBUF_ST);
+    add_counter("scoreboard_stalls", VX_CSR_MPM_SCRB_ST);
+    add_counter("alu_stalls", VX_CSR_MPM_ALU_ST);
+    add_counter("lsu_stalls", VX_CSR_MPM_LSU_ST);
+    add_counter("fpu_stalls", VX_CSR_MPM_FPU_ST);
+    add_counter("sfu_stalls", VX_CSR_MPM_SFU_ST);
+    add_counter("opds_bank_stalls", VX_CSR_MPM_OPDS_BANK_ST);
+    uint64_t ifetches = add_counter("ifetches", VX_CSR_MPM_IFETCHES);
+    uint64_t loads = add_counter("loads", VX_CSR_MPM_LOADS);
+    add_counter("stores", VX_CSR_MPM_STORES);
+    uint64_t ifetch_lat = add_counter("ifetch_lat", VX_CSR_MPM_IFETCH_LAT);
+    uint64_t load_lat = add_counter("load_lat", VX_CSR_MPM_LOAD_LAT);
+    add_metric("ifetch_avg_lat", caclAvgLatency(ifetch_lat, ifetches));
+    add_metric("load_avg_lat", caclAvgLatency(load_lat, loads));
+    uint64_t warp_instrs = add_counter("warp_instrs", VX_CSR_MPM_WARP_INSTRS);
+    add_counter("diverged_instrs", VX_CSR_MPM_DIVERGED_INSTRS);
+    add_counter("diverged_cycles", VX_CSR_MPM_DIVERGED_CYCLES);
+    add_counter("splits", VX_CSR_MPM_SPLITS);
+    add_counter("divergent_splits", VX_CSR_MPM_DIVERGENT_SPLITS);
+    add_counter("ipdom_depth", VX_CSR_MPM_IPDOM_DEPTH);
+    add_counter("lanes_q1", VX_CSR_MPM_LANES_Q1);
+    add_counter("lanes_q2", VX_CSR_MPM_LANES_Q2);
+    add_counter("lanes_q3", VX_CSR_MPM_LANES_Q3);
+    add_counter("lanes_q4", VX_CSR_MPM_LANES_Q4);
+    add_counter("idiv_busy", VX_CSR_MPM_IDIV_BUSY);
+    add_counter("idiv_stalls", VX_CSR_MPM_IDIV_ST);
+    add_counter("fdiv_busy", VX_CSR_MPM_FDIV_BUSY);
+    add_counter("fdiv_stalls", VX_CSR_MPM_FDIV_ST);
+    add_counter("fsqrt_busy", VX_CSR_MPM_FSQRT_BUSY);
+    add_counter("fsqrt_stalls", VX_CSR_MPM_FSQRT_ST);
+    add_counter("fu_stalls", VX_CSR_MPM_FU_ST);
+    add_metric("simt_efficiency", (warp_instrs != 0) ? (double(instrs) / double(warp_instrs * num_threads)) : 0);
+  } break;
+  case VX_DCR_MPM_CLASS_MEM: {
+    if (isa_flags & VX_ISA_EXT_SMEM) {
+      uint64_t reads = add_counter("smem_reads", VX_CSR_MPM_SMEM_READS);
+      uint64_t writes = add_counter("smem_writes", VX_CSR_MPM_SMEM_WRITES);
+      uint64_t bank_stalls = add_counter("smem_bank_stalls", VX_CSR_MPM_SMEM_BANK_ST);
+      add_metric("smem_bank_utilization", calcUtilization(reads + writes, bank_stalls));
+    }
+    if (isa_flags & VX_ISA_EXT_ICACHE) {
+      uint64_t reads = add_counter("icache_reads", VX_CSR_MPM_ICACHE_READS);
+      uint64_t read_misses = add_counter("icache_read_misses", VX_CSR_MPM_ICACHE_MISS_R);
+      add_metric("icache_read_hit_ratio", calcHitRatio(read_misses, reads));
+    }
+    if (isa_flags & VX_ISA_EXT_DCACHE) {
+      add_cache("dcache",
+        VX_CSR_MPM_DCACHE_READS, VX_CSR_MPM_DCACHE_WRITES,
+        VX_CSR_MPM_DCACHE_MISS_R, VX_CSR_MPM_DCACHE_MISS_W,
+        VX_CSR_MPM_DCACHE_BANK_ST, VX_CSR_MPM_DCACHE_MSHR_ST);
+    }
+    if (isa_flags & VX_ISA_EXT_L2CACHE) {
+      add_cache("l2cache",
+        VX_CSR_MPM_L2CACHE_READS, VX_CSR_MPM_L2CACHE_WRITES,
+        VX_CSR_MPM_L2CACHE_MISS_R, VX_CSR_MPM_L2CACHE_MISS_W,
+        VX_CSR_MPM_L2CACHE_BANK_ST, VX_CSR_MPM_L2CACHE_MSHR_ST);
+    }
+    if (isa_flags & VX_ISA_EXT_L3CACHE) {
+      add_cache("l3cache",
+        VX_CSR_MPM_L3CACHE_READS, VX_CSR_MPM_L3CACHE_WRITES,
+        VX_CSR_MPM_L3CACHE_MISS_R, VX_CSR_MPM_L3CACHE_MISS_W,
+        VX_CSR_MPM_L3CACHE_BANK_ST, VX_CSR_MPM_L3CACHE_MSHR_ST);
+    }
+    uint64_t mem_reads = add_counter("mem_reads", VX_CSR_MPM_MEM_READS);
+    add_counter("mem_writes", VX_CSR_MPM_MEM_WRITES);
+    uint64_t mem_lat = add_counter("mem_lat", VX_CSR_MPM_MEM_LAT);
+    add_metric("mem_avg_lat", caclAvgLatency(mem_lat, mem_reads));
+  } break;
+  case VX_DCR_MPM_CLASS_SIMX: {
+    add_counter("opds_occupancy", VX_CSR_MPM_OPDS_OCC);
+    add_counter("opds_stalls", VX_CSR_MPM_OPDS_ST);
+    add_counter("vpu_busy", VX_CSR_MPM_VPU_BUSY);
+    add_counter("vpu_stalls", VX_CSR_MPM_VPU_ST);
+  } break;
+  default:
+    break;
+  }
+#else
+  (void)perf_class;
+  (void)isa_flags;
+  (void)num_threads;
+#endif
+}
+
+void print_perf_value(FILE* stream, const perf_value_t& entry) {
+  if (entry.integral) {
+    fprintf(stream, "%ld", (uint64_t)entry.value);
+  } else {
+    fprintf(stream, "%f", entry.value);
+  }
+}
+
+void print_perf_json(FILE* stream, const perf_record_t& record) {
+  for (size_t i = 0; i < record.size(); ++i) {
+    fprintf(stream, "%s\"%s\": ", (i ? ", " : ""), record[i].name.c_str());
+    print_perf_value(stream, record[i]);
+  }
+}
+
+void print_perf_csv(FILE* stream, const char* scope, const perf_record_t& record) {
+  for (auto& entry : record) {
+    fprintf(stream, "%s,%s,", scope, entry.name.c_str());
+    print_perf_value(stream, entry);
+    fprintf(stream, "\n");
+  }
+}
+
+}
+
+extern int vx_dump_perf_ex(vx_device_h hdevice, FILE* stream, int format) {
+  int ret = 0;
+
+  if (format == VX_PERF_FORMAT_TEXT)
+    return vx_dump_perf(hdevice, stream);
+
+  if (format != VX_PERF_FORMAT_JSON
+   && format != VX_PERF_FORMAT_CSV) {
+    std::cout << "error: invalid perf format " << format << std::endl;
+    return -1;
+  }
+
+  uint64_t num_cores;
+  ret = vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &num_cores);
+  if (ret != 0)
+    return ret;
+
+  uint64_t isa_flags;
+  ret = vx_dev_caps(hdevice, VX_CAPS_ISA_FLAGS, &isa_flags);
+  if (ret != 0)
+    return ret;
+
+  int perf_class = VX_DCR_MPM_CLASS_NONE;
+#ifdef PERF_ENABLE
+  perf_class = gAutoPerfDump.get_perf_class();
+#endif
+
+  uint64_t num_threads;
+  ret = vx_dev_caps(hdevice, VX_CAPS_NUM_THREADS, &num_threads);
+  if (ret != 0)
+    return ret;
+
+  std::vector<uint64_t> counters(num_cores * VX_PERF_NUM_COUNTERS);
+  ret = vx_perf_read(hdevice, counters.data(), num_cores);
+  if (ret != 0)
+    return ret;
+
+  auto core_csr = [&](uint32_t core_id, uint32_t addr)->uint64_t {
+    return counters.at(core_id * VX_PERF_NUM_COUNTERS + (addr - VX_CSR_MPM_BASE));
+  };
+
+  // Device totals: cycles and the IPDOM depth are taken from the maximum across cores,
+  // the L2 cache counters are averaged across cores, and the L3 cache and memory
+  // counters come from core 0.
+  auto total_csr = [&](uint32_t addr)->uint64_t {
+    uint64_t value = 0;
+    if (addr == VX_CSR_MCYCLE
+     || (perf_class == VX_DCR_MPM_CLASS_CORE && addr == VX_CSR_MPM_IPDOM_DEPTH)) {
+      for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+        value = std::max<uint64_t>(core_csr(core_id, addr), value);
+      }
+      return value;
+    }
+    if (perf_class == VX_DCR_MPM_CLASS_MEM
+     && addr >= VX_CSR_MPM_L3CACHE_READS) {
+      return core_csr(0, addr);
+    }
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      value += core_csr(core_id, addr);
+    }
+    if (perf_class == VX_DCR_MPM_CLASS_MEM
+     && addr >= VX_CSR_MPM_L2CACHE_READS) {
+      value /= num_cores;
+    }
+    return value;
+  };
+
+  std::vector<perf_record_t> core_records(num_cores);
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    build_perf_record(core_records.at(core_id), [&](uint32_t addr) {
+      return core_csr(core_id, addr);
+    }, perf_class, isa_flags, num_threads);
+  }
+
+  perf_record_t total_record;
+  build_perf_record(total_record, total_csr, perf_class, isa_flags, num_threads);
+
+  if (format == VX_PERF_FORMAT_JSON) {
+    fprintf(stream, "{\"num_cores\": %ld, \"perf_class\": %d, \"cores\": [", num_cores, perf_class);
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      fprintf(stream, "%s{\"core\": %d, ", (core_id ? ", " : ""), core_id);
+      print_perf_json(stream, core_records.at(core_id));
+      fprintf(stream, "}");
+    }
+    fprintf(stream, "], \"total\": {");
+    print_perf_json(stream, total_record);
+    fprintf(stream, "}}\n");
+  } else {
+    fprintf(stream, "scope,counter,value\n");
+    for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+      auto scope = "core" + std::to_string(core_id);
+      print_perf_csv(stream, scope.c_str(), core_records.at(core_id));
+    }
+    print_perf_csv(stream, "total", total_record);
+  }
+
+  fflush(stream);
+
+  return 0;
+}
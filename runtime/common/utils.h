@@ -37,6 +37,11 @@ void perf_add_device(vx_device_h device);
 
 void perf_remove_device(vx_device_h device);
 
+void kernel_remove_device(vx_device_h device);
+
+// drop the registered kernels overlapping a device range from residency
+void kernel_invalidate(vx_device_h device, uint64_t addr, uint64_t size);
+
 #define CACHE_BLOCK_SIZE    64
 #define ALLOC_BASE_ADDR     CACHE_BLOCK_SIZE
 #define ALLOC_MAX_ADDR      STARTUP_ADDR
@@ -24,6 +24,8 @@ extern "C" {
 
 typedef void* vx_device_h;
 
+typedef void* vx_kernel_h;
+
 // device caps ids
 #define VX_CAPS_VERSION             0x0 
 #define VX_CAPS_NUM_THREADS         0x1
@@ -58,12 +60,26 @@ typedef void* vx_device_h;
 #define VX_MEM_TYPE_GLOBAL          0
 #define VX_MEM_TYPE_LOCAL           1
 
+// performance counter dump formats
+#define VX_PERF_FORMAT_TEXT         0
+#define VX_PERF_FORMAT_JSON         1
+#define VX_PERF_FORMAT_CSV          2
+
+// number of MPM counters per core
+#define VX_PERF_NUM_COUNTERS        32
+
 // ready wait timeout
 #define VX_MAX_TIMEOUT              (24*60*60*1000)   // 24 Hr
 
+// return the number of available devices
+int vx_dev_count(uint32_t* count);
+
 // open the device and connect to it
 int vx_dev_open(vx_device_h* hdevice);
 
+// open the device at the given index
+int vx_dev_open_index(uint32_t index, vx_device_h* hdevice);
+
 // Close the device when all the operations are done
 int vx_dev_close(vx_device_h hdevice);
 
@@ -79,6 +95,12 @@ int vx_mem_free(vx_device_h hdevice, uint64_t dev_addr);
 // get device memory info
 int vx_mem_info(vx_device_h hdevice, int type, uint64_t* mem_free, uint64_t* mem_used);
 
+// pin page-aligned host memory for zero-copy transfers
+int vx_mem_pin(vx_device_h hdevice, void* host_ptr, uint64_t size);
+
+// unpin host memory
+int vx_mem_unpin(vx_device_h hdevice, void* host_ptr);
+
 // Copy bytes from host to device memory
 int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size);
 
@@ -102,10 +124,30 @@ int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint64_t si
 // upload kernel file to device
 int vx_upload_kernel_file(vx_device_h hdevice, const char* filename);
 
+// register a kernel binary linked at base_addr, uploading it only if the same content is not already registered
+int vx_kernel_register(vx_device_h hdevice, const void* content, uint64_t size, uint64_t base_addr, vx_kernel_h* hkernel);
+
+// register a kernel file linked at base_addr
+int vx_kernel_register_file(vx_device_h hdevice, const char* filename, uint64_t base_addr, vx_kernel_h* hkernel);
+
+// make a registered kernel the next one to launch, re-uploading it only if a copy to the device overwrote its image;
+// relaunching by handle requires a read-only image, as the kernel's own writes to it (e.g. initialized .data) are not restored
+int vx_kernel_select(vx_device_h hdevice, vx_kernel_h hkernel);
+
+// remove a kernel from the registry
+int vx_kernel_release(vx_device_h hdevice, vx_kernel_h hkernel);
+
 // performance counters
 int vx_dump_perf(vx_device_h hdevice, FILE* stream);
 int vx_perf_counter(vx_device_h hdevice, int counter, int core_id, uint64_t* value);
 
+// read the MPM counters of all cores in a single transfer
+// counters[core_id * VX_PERF_NUM_COUNTERS + (csr_addr - VX_CSR_MPM_BASE)]
+int vx_perf_read(vx_device_h hdevice, uint64_t* counters, uint32_t num_cores);
+
+// dump per-core counters and derived metrics as text, JSON or CSV
+int vx_dump_perf_ex(vx_device_h hdevice, FILE* stream, int format);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <memory>
 #include <list>
+#include <map>
 
 #include <VX_config.h>
 #include <VX_types.h>
@@ -59,6 +60,18 @@
 
 #define RAM_PAGE_SIZE       4096
 
+// pinned staging chunks used to pipeline host copies with AFU DMA transfers
+#ifndef STAGING_NUM_CHUNKS
+#define STAGING_NUM_CHUNKS  2
+#endif
+
+#ifndef STAGING_CHUNK_SIZE
+#define STAGING_CHUNK_SIZE  0x200000  // 2 MB
+#endif
+
+static_assert(STAGING_NUM_CHUNKS >= 2, "invalid value!");
+static_assert(0 == (STAGING_CHUNK_SIZE % CACHE_BLOCK_SIZE), "invalid value!");
+
 #define CHECK_HANDLE(handle, _expr, _cleanup)   \
     auto handle = _expr;                        \
     if (handle == nullptr) {                    \
@@ -79,42 +92,107 @@
 
 class vx_device {
 public:
-    vx_device() : 
-        staging_wsid(0), 
-        staging_ioaddr(0), 
-        staging_ptr(nullptr),
-        staging_size(0) 
-    {}
+    vx_device() {}
 
     ~vx_device() {}
 
-    int ensure_staging(uint64_t size) {
-        size_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
-        if (staging_size >= asize)
-            return 0;
+    struct host_buffer_t {
+        uint8_t* ptr;
+        uint64_t size;
+        uint64_t wsid;
+        uint64_t ioaddr;
+    };
+
+    int create_staging() {
+        for (auto& chunk : staging_chunks) {
+            chunk.size = STAGING_CHUNK_SIZE;
+
+            // allocate new buffer
+            CHECK_ERR(api.fpgaPrepareBuffer(fpga, chunk.size, (void**)&chunk.ptr, &chunk.wsid, 0), {
+                chunk.size = 0;
+                return -1;
+            });
+
+            // get the physical address of the buffer in the accelerator
+            CHECK_ERR(api.fpgaGetIOAddress(fpga, chunk.wsid, &chunk.ioaddr), {
+                api.fpgaReleaseBuffer(fpga, chunk.wsid);
+                chunk.size = 0;
+                return -1;
+            });
+        }
+        return 0;
+    }
+
+    void destroy_staging() {
+        for (auto& chunk : staging_chunks) {
+            if (chunk.size != 0) {
+                api.fpgaReleaseBuffer(fpga, chunk.wsid);
+                chunk.size = 0;
+            }
+        }
+    }
 
-        if (staging_size != 0) {
-            // release existing buffer
-            api.fpgaReleaseBuffer(fpga, staging_wsid);
-            staging_size = 0;
+    int pin_buffer(void* host_ptr, uint64_t size) {
+        // OPAE requires page-aligned preallocated buffers
+        if (!is_aligned(uintptr_t(host_ptr), RAM_PAGE_SIZE)
+         || !is_aligned(size, RAM_PAGE_SIZE))
+            return -1;
+
+        // reject ranges overlapping an existing pin, their workspace would leak
+        auto addr = uintptr_t(host_ptr);
+        auto it = pinned_buffers.lower_bound(addr);
+        if (it != pinned_buffers.end() && it->first < addr + size)
+            return -1;
+        if (it != pinned_buffers.begin()) {
+            --it;
+            if (it->first + it->second.size > addr)
+                return -1;
         }
 
-        // allocate new buffer
-        CHECK_ERR(api.fpgaPrepareBuffer(fpga, asize, (void**)&staging_ptr, &staging_wsid, 0), {
+        host_buffer_t buffer;
+        buffer.ptr  = (uint8_t*)host_ptr;
+        buffer.size = size;
+
+        CHECK_ERR(api.fpgaPrepareBuffer(fpga, size, (void**)&buffer.ptr, &buffer.wsid, FPGA_BUF_PREALLOCATED), {
             return -1;
         });
 
-        // get the physical address of the buffer in the accelerator
-        CHECK_ERR(api.fpgaGetIOAddress(fpga, staging_wsid, &staging_ioaddr), {
-            api.fpgaReleaseBuffer(fpga, staging_wsid);
+        CHECK_ERR(api.fpgaGetIOAddress(fpga, buffer.wsid, &buffer.ioaddr), {
+            api.fpgaReleaseBuffer(fpga, buffer.wsid);
             return -1;
         });
 
-        staging_size = asize;
+        pinned_buffers.emplace(uintptr_t(host_ptr), buffer);
 
         return 0;
     }
 
+    int unpin_buffer(void* host_ptr) {
+        auto it = pinned_buffers.find(uintptr_t(host_ptr));
+        if (it == pinned_buffers.end())
+            return -1;
+        api.fpgaReleaseBuffer(fpga, it->second.wsid);
+        pinned_buffers.erase(it);
+        return 0;
+    }
+
+    // return the device-visible address of a pinned host range, if any
+    bool lookup_pinned(const void* host_ptr, uint64_t size, uint64_t* ioaddr) const {
+        auto addr = uintptr_t(host_ptr);
+        auto it = pinned_buffers.upper_bound(addr);
+        if (it == pinned_buffers.begin())
+            return false;
+        --it;
+        auto& buffer = it->second;
+        uint64_t offset = addr - it->first;
+        if (offset + size > buffer.size)
+            return false;
+        if (!is_aligned(buffer.ioaddr + offset, CACHE_BLOCK_SIZE))
+            return false;
+        *ioaddr = buffer.ioaddr + offset;
+        return true;
+    }
+
     opae_drv_api_t api;
     fpga_handle fpga;
     std::shared_ptr<vortex::MemoryAllocator> global_mem;
@@ -123,10 +201,8 @@ public:
     uint64_t dev_caps;
     uint64_t isa_caps;
     uint64_t global_mem_size;
-    uint64_t staging_wsid;
-    uint64_t staging_ioaddr;
-    uint8_t* staging_ptr;
-    uint64_t staging_size;
+    host_buffer_t staging_chunks[STAGING_NUM_CHUNKS] = {};
+    std::map<uintptr_t, host_buffer_t> pinned_buffers;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -175,6 +251,20 @@ extern int vx_dev_caps(vx_device_h hdevice, uint32_t caps_id, uint64_t *value) {
     return 0;
 }
 
+// a single device is exposed per process
+extern int vx_dev_count(uint32_t* count) {
+    if (nullptr == count)
+        return -1;
+    *count = 1;
+    return 0;
+}
+
+extern int vx_dev_open_index(uint32_t index, vx_device_h* hdevice) {
+    if (index != 0)
+        return -1;
+    return vx_dev_open(hdevice);
+}
+
 extern int vx_dev_open(vx_device_h* hdevice) {
     if (nullptr == hdevice)
         return  -1;
@@ -282,6 +372,14 @@ extern int vx_dev_open(vx_device_h* hdevice) {
         device->local_mem = std::make_shared<vortex::MemoryAllocator>(
             SMEM_BASE_ADDR, local_mem_size, RAM_PAGE_SIZE, 1);
     }
+
+    // allocate staging buffers
+    if (device->create_staging() != 0) {
+        device->destroy_staging();
+        api.fpgaClose(accel_handle);
+        delete device;
+        return -1;
+    }
     
 #ifdef SCOPE
     {
@@ -332,11 +430,16 @@ extern int vx_dev_close(vx_device_h hdevice) {
     perf_remove_device(hdevice);
 #endif
 
-    // release staging buffer
-    if (device->staging_size != 0) {
-        api.fpgaReleaseBuffer(device->fpga, device->staging_wsid);
-        device->staging_size = 0;
+    kernel_remove_device(hdevice);
+
+    // release pinned buffers
+    for (auto& entry : device->pinned_buffers) {
+        api.fpgaReleaseBuffer(device->fpga, entry.second.wsid);
     }
+    device->pinned_buffers.clear();
+
+    // release staging buffers
+    device->destroy_staging();
 
     // close the device
     api.fpgaClose(device->fpga);
@@ -399,15 +502,52 @@ extern int vx_mem_info(vx_device_h hdevice, int type, uint64_t* mem_free, uint64
     return 0;
 }
 
-extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size) {
+extern int vx_mem_pin(vx_device_h hdevice, void* host_ptr, uint64_t size) {
+    if (nullptr == hdevice 
+     || nullptr == host_ptr
+     || 0 == size)
+        return -1;
+
+    auto device = ((vx_device*)hdevice);
+    return device->pin_buffer(host_ptr, size);
+}
+
+extern int vx_mem_unpin(vx_device_h hdevice, void* host_ptr) {
     if (nullptr == hdevice)
         return -1;
 
-    auto device = (vx_device*)hdevice;
+    auto device = ((vx_device*)hdevice);
+    return device->unpin_buffer(host_ptr);
+}
+
+static int issue_mem_cmd(vx_device* device, uint32_t cmd, uint64_t ioaddr, uint64_t dev_addr, uint64_t size) {
     auto& api = device->api;
+    
+    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
 
-    if (device->ensure_staging(size) != 0)
+    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG0, ioaddr >> ls_shift), {
+        return -1; 
+    });    
+    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
+        return -1; 
+    });
+    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG2, size >> ls_shift), {
+        return -1; 
+    });
+    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_TYPE, cmd), {
         return -1; 
+    });
+
+    return 0;
+}
+
+extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size) {
+    if (nullptr == hdevice)
+        return -1;
+
+    kernel_invalidate(hdevice, dev_addr, size);
+
+    auto device = (vx_device*)hdevice;
 
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
 
@@ -423,25 +563,36 @@ extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* ho
     if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
         return -1;
 
-    // update staging buffer
-    memcpy(device->staging_ptr, host_ptr, size);
+    // zero-copy transfer from pinned memory
+    uint64_t pinned_ioaddr;
+    if (device->lookup_pinned(host_ptr, asize, &pinned_ioaddr)) {
+        if (issue_mem_cmd(device, CMD_MEM_WRITE, pinned_ioaddr, dev_addr, asize) != 0)
+            return -1;
+        return vx_ready_wait(hdevice, VX_MAX_TIMEOUT);
+    }
 
-    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
+    // stream the transfer through the staging chunks,
+    // filling the next chunk while the AFU is draining the current one
+    auto src = (const uint8_t*)host_ptr;
+    uint32_t index = 0;
+    for (uint64_t offset = 0; offset < asize; offset += STAGING_CHUNK_SIZE) {
+        auto& chunk = device->staging_chunks[index];
+        uint64_t chunk_size = std::min<uint64_t>(asize - offset, STAGING_CHUNK_SIZE);
 
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG0, device->staging_ioaddr >> ls_shift), {
-        return -1; 
-    });    
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
-        return -1; 
-    });
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG2, asize >> ls_shift), {
-        return -1; 
-    });
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_TYPE, CMD_MEM_WRITE), {
-        return -1; 
-    });
+        // update staging buffer
+        memcpy(chunk.ptr, src + offset, std::min<uint64_t>(size - offset, chunk_size));
+
+        // wait for the previous chunk to complete
+        if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
+            return -1;
+
+        if (issue_mem_cmd(device, CMD_MEM_WRITE, chunk.ioaddr, dev_addr + offset, chunk_size) != 0)
+            return -1;
+
+        index = (index + 1) % STAGING_NUM_CHUNKS;
+    }
 
-    // Wait for the write operation to finish
+    // wait for the write operation to finish
     if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
         return -1;
 
@@ -453,10 +604,6 @@ extern int vx_copy_from_dev(vx_device_h hdevice, void* host_ptr, uint64_t dev_ad
         return -1;
 
     auto device = (vx_device*)hdevice;
-    auto& api = device->api;
-
-    if (device->ensure_staging(size) != 0)
-        return -1;
 
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
 
@@ -472,27 +619,56 @@ extern int vx_copy_from_dev(vx_device_h hdevice, void* host_ptr, uint64_t dev_ad
     if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
         return -1;
 
-    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
+    // zero-copy transfer into pinned memory,
+    // the DMA only covers whole blocks so that it never writes past the caller's range
+    uint64_t pinned_ioaddr;
+    uint64_t bsize = size - (size % CACHE_BLOCK_SIZE);
+    if (bsize != 0 && device->lookup_pinned(host_ptr, bsize, &pinned_ioaddr)) {
+        if (issue_mem_cmd(device, CMD_MEM_READ, pinned_ioaddr, dev_addr, bsize) != 0)
+            return -1;
+        if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
+            return -1;
+        if (bsize == size)
+            return 0;
 
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG0, device->staging_ioaddr >> ls_shift), {
-        return -1; 
-    });
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
-        return -1; 
-    });
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_ARG2, asize >> ls_shift), {
-        return -1; 
-    });
-    CHECK_ERR(api.fpgaWriteMMIO64(device->fpga, 0, MMIO_CMD_TYPE, CMD_MEM_READ), {
-        return -1; 
-    });
+        // read the partial tail block through a staging chunk
+        auto& chunk = device->staging_chunks[0];
+        if (issue_mem_cmd(device, CMD_MEM_READ, chunk.ioaddr, dev_addr + bsize, CACHE_BLOCK_SIZE) != 0)
+            return -1;
+        if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
+            return -1;
+        memcpy((uint8_t*)host_ptr + bsize, chunk.ptr, size - bsize);
+        return 0;
+    }
 
-    // wait for the write operation to finish
-    if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
+    // stream the transfer through the staging chunks,
+    // draining the previous chunk while the AFU is filling the current one
+    auto dst = (uint8_t*)host_ptr;
+    uint32_t index = 0;
+    uint64_t chunk_size = std::min<uint64_t>(asize, STAGING_CHUNK_SIZE);
+    if (issue_mem_cmd(device, CMD_MEM_READ, device->staging_chunks[0].ioaddr, dev_addr, chunk_size) != 0)
         return -1;
+    
+    for (uint64_t offset = 0; offset < asize; offset += STAGING_CHUNK_SIZE) {
+        auto& chunk = device->staging_chunks[index];
+        uint64_t next_offset = offset + STAGING_CHUNK_SIZE;
+        index = (index + 1) % STAGING_NUM_CHUNKS;
+
+        // wait for the current chunk to complete
+        if (vx_ready_wait(hdevice, VX_MAX_TIMEOUT) != 0)
+            return -1;
 
-    // read staging buffer
-    memcpy(host_ptr, device->staging_ptr, size);
+        // schedule the next chunk
+        if (next_offset < asize) {
+            uint64_t next_size = std::min<uint64_t>(asize - next_offset, STAGING_CHUNK_SIZE);
+            if (issue_mem_cmd(device, CMD_MEM_READ, device->staging_chunks[index].ioaddr, dev_addr + next_offset, next_size) != 0)
+                return -1;
+        }
+
+        // read staging buffer
+        chunk_size = std::min<uint64_t>(asize - offset, STAGING_CHUNK_SIZE);
+        memcpy(dst + offset, chunk.ptr, std::min<uint64_t>(size - offset, chunk_size));
+    }
 
     return 0;
 }
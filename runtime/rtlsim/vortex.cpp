@@ -224,6 +224,20 @@ extern int vx_dev_caps(vx_device_h hdevice, uint32_t caps_id, uint64_t *value) {
     return 0;
 }
 
+// a single device is exposed per process
+extern int vx_dev_count(uint32_t* count) {
+    if (nullptr == count)
+        return -1;
+    *count = 1;
+    return 0;
+}
+
+extern int vx_dev_open_index(uint32_t index, vx_device_h* hdevice) {
+    if (index != 0)
+        return -1;
+    return vx_dev_open(hdevice);
+}
+
 extern int vx_dev_open(vx_device_h* hdevice) {
     if (nullptr == hdevice)
         return  -1;
@@ -257,6 +271,8 @@ extern int vx_dev_close(vx_device_h hdevice) {
     perf_remove_device(hdevice);
 #endif
 
+    kernel_remove_device(hdevice);
+
     delete device;
 
     return 0;
@@ -291,10 +307,30 @@ extern int vx_mem_info(vx_device_h hdevice, int type, uint64_t* mem_free, uint64
     return device->mem_info(type, mem_free, mem_used);
 }
 
+extern int vx_mem_pin(vx_device_h hdevice, void* host_ptr, uint64_t size) {
+    if (nullptr == hdevice 
+     || nullptr == host_ptr
+     || 0 == size)
+        return -1;
+
+    // host memory is directly accessible, nothing to pin
+    return 0;
+}
+
+extern int vx_mem_unpin(vx_device_h hdevice, void* host_ptr) {
+    if (nullptr == hdevice)
+        return -1;
+
+    __unused (host_ptr);
+    return 0;
+}
+
 extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size) {
     if (nullptr == hdevice)
         return -1;
 
+    kernel_invalidate(hdevice, dev_addr, size);
+
     auto device = (vx_device*)hdevice;
     return device->upload(dev_addr, host_ptr, size);
 }
@@ -41,6 +41,12 @@
 
 using namespace vortex;
 
+// number of device indices accepted by vx_dev_open_index;
+// they are plain ordinals, every index opens an identical, independent simulator
+#ifndef SIMX_NUM_DEVICES
+#define SIMX_NUM_DEVICES 8
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class vx_device;
@@ -86,8 +92,8 @@ private:
 
 class vx_device {    
 public:
-    vx_device() 
-        : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES, NUM_CLUSTERS)
+    vx_device(const Arch& arch) 
+        : arch_(arch)
         , ram_(RAM_PAGE_SIZE)
         , processor_(arch_)
         , global_mem_(
@@ -217,6 +223,10 @@ public:
         return dcrs_.read(addr);
     }
 
+    const Arch& arch() const {
+        return arch_;
+    }
+
 private:
     Arch                arch_;
     RAM                 ram_;
@@ -229,11 +239,45 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Each simulated device owns an independent processor model, so devices
+// can be driven concurrently from separate host threads.
+static uint32_t get_num_devices() {
+    auto num_devices_s = getenv("SIMX_NUM_DEVICES");
+    if (num_devices_s)
+        return std::atoi(num_devices_s);
+    return SIMX_NUM_DEVICES;
+}
+
+extern int vx_dev_count(uint32_t* count) {
+    if (nullptr == count)
+        return -1;
+    *count = get_num_devices();
+    return 0;
+}
+
 extern int vx_dev_open(vx_device_h* hdevice) {
+    return vx_dev_open_index(0, hdevice);
+}
+
+extern int vx_dev_open_index(uint32_t index, vx_device_h* hdevice) {
     if (nullptr == hdevice)
         return  -1;
 
-    auto device = new vx_device();
+    // the index is only bounds-checked: simx devices carry no per-index identity
+    if (index >= get_num_devices()) {
+        printf("Error: invalid device index %d\n", index);
+        return -1;
+    }
+
+    // apply runtime parameter overrides (SIMX_CONFIG="name=value,...")
+    Arch arch(NUM_THREADS, NUM_WARPS, NUM_CORES, NUM_CLUSTERS);
+    auto config_s = getenv("SIMX_CONFIG");
+    if (config_s && !arch.configure(config_s)) {
+        printf("Error: invalid SIMX_CONFIG \"%s\"\n", config_s);
+        return -1;
+    }
+
+    auto device = new vx_device(arch);
     if (device == nullptr)
         return -1;
 
@@ -264,6 +308,8 @@ extern int vx_dev_close(vx_device_h hdevice) {
     perf_remove_device(hdevice);
 #endif
 
+    kernel_remove_device(hdevice);
+
     delete device;
 
     DBGPRINT("device destroyed!\n");
@@ -282,13 +328,13 @@ extern int vx_dev_caps(vx_device_h hdevice, uint32_t caps_id, uint64_t *value) {
         *value = IMPLEMENTATION_ID;
         break;
     case VX_CAPS_NUM_THREADS:
-        *value = NUM_THREADS;
+        *value = device->arch().num_threads();
         break;
     case VX_CAPS_NUM_WARPS:
-        *value = NUM_WARPS;
+        *value = device->arch().num_warps();
         break;
     case VX_CAPS_NUM_CORES:
-        *value = NUM_CORES * NUM_CLUSTERS;
+        *value = device->arch().num_cores() * device->arch().num_clusters();
         break;
     case VX_CAPS_CACHE_LINE_SIZE:
         *value = CACHE_BLOCK_SIZE;
@@ -341,10 +387,30 @@ extern int vx_mem_info(vx_device_h hdevice, int type, uint64_t* mem_free, uint64
     return device->mem_info(type, mem_free, mem_used);
 }
 
+extern int vx_mem_pin(vx_device_h hdevice, void* host_ptr, uint64_t size) {
+    if (nullptr == hdevice 
+     || nullptr == host_ptr
+     || 0 == size)
+        return -1;
+
+    // host memory is directly accessible, nothing to pin
+    return 0;
+}
+
+extern int vx_mem_unpin(vx_device_h hdevice, void* host_ptr) {
+    if (nullptr == hdevice)
+        return -1;
+
+    __unused (host_ptr);
+    return 0;
+}
+
 extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size) {
     if (nullptr == hdevice)
         return -1;
 
+    kernel_invalidate(hdevice, dev_addr, size);
+
     auto device = ((vx_device*)hdevice);
 
     DBGPRINT("COPY_TO_DEV: dev_addr=0x%lx, host_addr=0x%p, size=%ld\n", dev_addr, host_ptr, size);
@@ -13,10 +13,18 @@
 
 #include <vortex.h>
 
+extern int vx_dev_count(uint32_t* /*count*/) {
+    return -1;
+}
+
 extern int vx_dev_open(vx_device_h* /*hdevice*/) {
     return -1;
 }
 
+extern int vx_dev_open_index(uint32_t /*index*/, vx_device_h* /*hdevice*/) {
+    return -1;
+}
+
 extern int vx_dev_close(vx_device_h /*hdevice*/) {
     return -1;
 }
@@ -37,6 +45,14 @@ extern int vx_mem_info(vx_device_h /*hdevice*/, int /*type*/, uint64_t* /*mem_fr
     return 0;
 }
 
+extern int vx_mem_pin(vx_device_h /*hdevice*/, void* /*host_ptr*/, uint64_t /*size*/) {
+    return -1;
+}
+
+extern int vx_mem_unpin(vx_device_h /*hdevice*/, void* /*host_ptr*/) {
+    return -1;
+}
+
 extern int vx_copy_to_dev(vx_device_h /*hdevice*/, uint64_t /*dev_addr*/, const void* /*host_ptr*/, uint64_t /*size*/) {
     return -1;
 }
@@ -20,22 +20,34 @@
 #include <util.h>
 #include <limits>
 #include <unordered_map>
+#include <vector>
+#include <future>
+#include <functional>
 
 #ifdef SCOPE
 #include "scope.h"
 #endif
 
 // XRT includes
+#ifdef XRT_MOCK
+#include "xrt_mock.h"
+#else
 #include "experimental/xrt_bo.h"
 #include "experimental/xrt_ip.h"
 #include "experimental/xrt_device.h"
 #include "experimental/xrt_kernel.h"
 #include "experimental/xrt_xclbin.h"
 #include "experimental/xrt_error.h"
+#endif
 
 #define CPP_API
 //#define BANK_INTERLEAVE
 
+// minimum transfer size to dispatch banks on parallel threads
+#ifndef BANK_PARALLEL_MIN_SIZE
+#define BANK_PARALLEL_MIN_SIZE 0x40000 // 256 KB
+#endif
+
 #define MMIO_CTL_ADDR   0x00
 #define MMIO_DEV_ADDR   0x10
 #define MMIO_ISA_ADDR   0x1C
@@ -221,6 +233,7 @@ public:
         }
 
     #ifdef BANK_INTERLEAVE
+        staging_.resize(num_banks);
         xrtBuffers_.reserve(num_banks);
         for (uint32_t i = 0; i < num_banks; ++i) {            
         #ifdef CPP_API
@@ -257,7 +270,7 @@ public:
             });
         #endif
         } else if (type == VX_MEM_TYPE_LOCAL) {
-            if CHECK_ERR(local_mem_->allocate(asize, &addr), {
+            CHECK_ERR(local_mem_->allocate(asize, &addr), {
                 return -1;
             });
         } else {
@@ -352,76 +365,161 @@ public:
         return 0;
     }
 
-    int upload(uint64_t dev_addr, uint8_t* host_ptr, uint64_t asize) {    
-        for (uint64_t end = dev_addr + asize; dev_addr < end; 
-            dev_addr += CACHE_BLOCK_SIZE, 
-            host_ptr += CACHE_BLOCK_SIZE) {      
-        #ifdef BANK_INTERLEAVE
-            asize = CACHE_BLOCK_SIZE;
-        #else
-            end = 0;
-        #endif
+#ifdef BANK_INTERLEAVE
+
+    int upload(uint64_t dev_addr, const void* src, uint64_t asize) {
+        auto host_ptr = (const uint8_t*)src;
+        uint32_t num_banks = 1 << platform_.lg2_num_banks;
+        uint64_t block_addr = dev_addr / CACHE_BLOCK_SIZE;
+        uint64_t num_blocks = asize / CACHE_BLOCK_SIZE;
+        uint32_t num_runs = std::min<uint64_t>(num_banks, num_blocks);
+
+        return this->run_banks(num_runs, asize, [&](uint32_t i)->int {
+            // gather the blocks owned by this bank into a contiguous run
             uint32_t bo_index;
             uint64_t bo_offset;
             xrt_buffer_t xrtBuffer;
-            CHECK_ERR(this->get_bank_info(dev_addr, &bo_index, &bo_offset), {
+            CHECK_ERR(this->get_bank_info((block_addr + i) * CACHE_BLOCK_SIZE, &bo_index, &bo_offset), {
                 return -1;
-            });            
+            });
             CHECK_ERR(this->get_buffer(bo_index, &xrtBuffer), {
                 return -1;
             });
-        #ifdef CPP_API        
-            xrtBuffer.write(host_ptr, asize, bo_offset);
-            xrtBuffer.sync(XCL_BO_SYNC_BO_TO_DEVICE, asize, bo_offset);
+            uint64_t count = (num_blocks - i + num_banks - 1) / num_banks;
+            uint64_t size = count * CACHE_BLOCK_SIZE;
+            const uint8_t* run_ptr = host_ptr + i * CACHE_BLOCK_SIZE;
+            if (count > 1 && num_banks > 1) {
+                auto& staging = staging_.at(bo_index);
+                if (staging.size() < size) {
+                    staging.resize(size);
+                }
+                gather_blocks(staging.data(), run_ptr, count, num_banks);
+                run_ptr = staging.data();
+            }
+        #ifdef CPP_API
+            xrtBuffer.write(run_ptr, size, bo_offset);
+            xrtBuffer.sync(XCL_BO_SYNC_BO_TO_DEVICE, size, bo_offset);
         #else
-            CHECK_ERR(xrtBOWrite(xrtBuffer, host_ptr, asize, bo_offset), {
+            CHECK_ERR(xrtBOWrite(xrtBuffer, run_ptr, size, bo_offset), {
                 dump_xrt_error(xrtDevice_, err);
                 return -1;
-            });        
-            CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_TO_DEVICE, asize, bo_offset), {
+            });
+            CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_TO_DEVICE, size, bo_offset), {
                 dump_xrt_error(xrtDevice_, err);
                 return -1;
-            });    
+            });
         #endif
-        }
-        return 0;
+            return 0;
+        });
     }
 
-    int download(uint8_t* host_ptr, uint64_t dev_addr, uint64_t asize) {
-        for (uint64_t end = dev_addr + asize; dev_addr < end; 
-            dev_addr += CACHE_BLOCK_SIZE, 
-            host_ptr += CACHE_BLOCK_SIZE) {      
-        #ifdef BANK_INTERLEAVE
-            asize = CACHE_BLOCK_SIZE;
-        #else
-            end = 0;
-        #endif
+    int download(void* dest, uint64_t dev_addr, uint64_t asize) {
+        auto host_ptr = (uint8_t*)dest;
+        uint32_t num_banks = 1 << platform_.lg2_num_banks;
+        uint64_t block_addr = dev_addr / CACHE_BLOCK_SIZE;
+        uint64_t num_blocks = asize / CACHE_BLOCK_SIZE;
+        uint32_t num_runs = std::min<uint64_t>(num_banks, num_blocks);
+
+        return this->run_banks(num_runs, asize, [&](uint32_t i)->int {
+            // fetch a contiguous run from this bank and scatter its blocks
             uint32_t bo_index;
             uint64_t bo_offset;
             xrt_buffer_t xrtBuffer;
-            CHECK_ERR(this->get_bank_info(dev_addr, &bo_index, &bo_offset), {
+            CHECK_ERR(this->get_bank_info((block_addr + i) * CACHE_BLOCK_SIZE, &bo_index, &bo_offset), {
                 return -1;
             });
             CHECK_ERR(this->get_buffer(bo_index, &xrtBuffer), {
                 return -1;
             });
+            uint64_t count = (num_blocks - i + num_banks - 1) / num_banks;
+            uint64_t size = count * CACHE_BLOCK_SIZE;
+            uint8_t* run_ptr = host_ptr + i * CACHE_BLOCK_SIZE;
+            bool scatter = (count > 1 && num_banks > 1);
+            if (scatter) {
+                auto& staging = staging_.at(bo_index);
+                if (staging.size() < size) {
+                    staging.resize(size);
+                }
+                run_ptr = staging.data();
+            }
         #ifdef CPP_API
-            xrtBuffer.sync(XCL_BO_SYNC_BO_FROM_DEVICE, asize, bo_offset);
-            xrtBuffer.read(host_ptr, asize, bo_offset);
-        #else        
-            CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_FROM_DEVICE, asize, bo_offset), {
+            xrtBuffer.sync(XCL_BO_SYNC_BO_FROM_DEVICE, size, bo_offset);
+            xrtBuffer.read(run_ptr, size, bo_offset);
+        #else
+            CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_FROM_DEVICE, size, bo_offset), {
                 dump_xrt_error(xrtDevice_, err);
                 return -1;
             });
-            CHECK_ERR(xrtBORead(xrtBuffer, host_ptr, asize, bo_offset), {
+            CHECK_ERR(xrtBORead(xrtBuffer, run_ptr, size, bo_offset), {
                 dump_xrt_error(xrtDevice_, err);
                 return -1;
-            });         
+            });
         #endif
-        }
+            if (scatter) {
+                scatter_blocks(host_ptr + i * CACHE_BLOCK_SIZE, run_ptr, count, num_banks);
+            }
+            return 0;
+        });
+    }
+
+#else
+
+    int upload(uint64_t dev_addr, const void* src, uint64_t asize) {
+        auto host_ptr = (const uint8_t*)src;
+        uint32_t bo_index;
+        uint64_t bo_offset;
+        xrt_buffer_t xrtBuffer;
+        CHECK_ERR(this->get_bank_info(dev_addr, &bo_index, &bo_offset), {
+            return -1;
+        });
+        CHECK_ERR(this->get_buffer(bo_index, &xrtBuffer), {
+            return -1;
+        });
+    #ifdef CPP_API
+        xrtBuffer.write(host_ptr, asize, bo_offset);
+        xrtBuffer.sync(XCL_BO_SYNC_BO_TO_DEVICE, asize, bo_offset);
+    #else
+        CHECK_ERR(xrtBOWrite(xrtBuffer, host_ptr, asize, bo_offset), {
+            dump_xrt_error(xrtDevice_, err);
+            return -1;
+        });
+        CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_TO_DEVICE, asize, bo_offset), {
+            dump_xrt_error(xrtDevice_, err);
+            return -1;
+        });
+    #endif
         return 0;
     }
 
+    int download(void* dest, uint64_t dev_addr, uint64_t asize) {
+        auto host_ptr = (uint8_t*)dest;
+        uint32_t bo_index;
+        uint64_t bo_offset;
+        xrt_buffer_t xrtBuffer;
+        CHECK_ERR(this->get_bank_info(dev_addr, &bo_index, &bo_offset), {
+            return -1;
+        });
+        CHECK_ERR(this->get_buffer(bo_index, &xrtBuffer), {
+            return -1;
+        });
+    #ifdef CPP_API
+        xrtBuffer.sync(XCL_BO_SYNC_BO_FROM_DEVICE, asize, bo_offset);
+        xrtBuffer.read(host_ptr, asize, bo_offset);
+    #else
+        CHECK_ERR(xrtBOSync(xrtBuffer, XCL_BO_SYNC_BO_FROM_DEVICE, asize, bo_offset), {
+            dump_xrt_error(xrtDevice_, err);
+            return -1;
+        });
+        CHECK_ERR(xrtBORead(xrtBuffer, host_ptr, asize, bo_offset), {
+            dump_xrt_error(xrtDevice_, err);
+            return -1;
+        });
+    #endif
+        return 0;
+    }
+
+#endif
+
     DeviceConfig dcrs;
     uint64_t dev_caps;
     uint64_t isa_caps;
@@ -438,6 +536,52 @@ private:
 #ifdef BANK_INTERLEAVE
 
     std::vector<xrt_buffer_t> xrtBuffers_;
+    std::vector<std::vector<uint8_t>> staging_;
+
+    // copy every 'stride'-th cache block of src into a contiguous run
+    static void gather_blocks(uint8_t* dst, const uint8_t* src, uint64_t count, uint32_t stride) {
+        uint64_t src_step = uint64_t(stride) * CACHE_BLOCK_SIZE;
+        for (uint64_t i = 0; i < count; ++i) {
+            // fixed-size block copies lower to vector loads/stores
+            memcpy(dst, src, CACHE_BLOCK_SIZE);
+            dst += CACHE_BLOCK_SIZE;
+            src += src_step;
+        }
+    }
+
+    // inverse of gather_blocks
+    static void scatter_blocks(uint8_t* dst, const uint8_t* src, uint64_t count, uint32_t stride) {
+        uint64_t dst_step = uint64_t(stride) * CACHE_BLOCK_SIZE;
+        for (uint64_t i = 0; i < count; ++i) {
+            memcpy(dst, src, CACHE_BLOCK_SIZE);
+            dst += dst_step;
+            src += CACHE_BLOCK_SIZE;
+        }
+    }
+
+    // process each bank run, in parallel for large transfers
+    int run_banks(uint32_t num_runs, uint64_t asize, const std::function<int(uint32_t)>& func) {
+        if (num_runs <= 1 || asize < BANK_PARALLEL_MIN_SIZE) {
+            for (uint32_t i = 0; i < num_runs; ++i) {
+                CHECK_ERR(func(i), {
+                    return -1;
+                });
+            }
+            return 0;
+        }
+        std::vector<std::future<int>> futures;
+        futures.reserve(num_runs);
+        for (uint32_t i = 0; i < num_runs; ++i) {
+            futures.emplace_back(std::async(std::launch::async, func, i));
+        }
+        int ret = 0;
+        for (auto& future : futures) {
+            if (future.get() != 0) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
 
     int get_bank_info(uint64_t addr, uint32_t* pIdx, uint64_t* pOff) {
         uint32_t num_banks = 1 << platform_.lg2_num_banks;
@@ -450,7 +594,6 @@ private:
         if (pOff) {
             *pOff = offset;
         }
-        printf("get_bank_info(addr=0x%lx, bank=%d, offset=0x%lx\n", addr, index, offset);
         return 0;
     }
 
@@ -485,7 +628,7 @@ private:
         if (pOff) {
             *pOff = offset;
         }        
-        printf("get_bank_info(addr=0x%lx, bank=%d, offset=0x%lx\n", addr, index, offset);
+        DBGPRINT("get_bank_info(addr=0x%lx, bank=%d, offset=0x%lx\n", addr, index, offset);
         return 0;
     }
 
@@ -565,6 +708,20 @@ extern int vx_dev_caps(vx_device_h hdevice, uint32_t caps_id, uint64_t *value) {
     return 0;
 }
 
+// a single device is exposed per process
+extern int vx_dev_count(uint32_t* count) {
+    if (nullptr == count)
+        return -1;
+    *count = 1;
+    return 0;
+}
+
+extern int vx_dev_open_index(uint32_t index, vx_device_h* hdevice) {
+    if (index != 0)
+        return -1;
+    return vx_dev_open(hdevice);
+}
+
 extern int vx_dev_open(vx_device_h* hdevice) {
     if (nullptr == hdevice)
         return -1;
@@ -755,6 +912,8 @@ extern int vx_dev_close(vx_device_h hdevice) {
 
     auto device = (vx_device*)hdevice;
 
+    kernel_remove_device(hdevice);
+
     delete device;
 
     DBGPRINT("device destroyed!\n");
@@ -791,9 +950,29 @@ extern int vx_mem_info(vx_device_h hdevice, int type, uint64_t* mem_free, uint64
     return device->mem_info(type, mem_free, mem_used);
 }
 
+extern int vx_mem_pin(vx_device_h hdevice, void* host_ptr, uint64_t size) {
+    if (nullptr == hdevice 
+     || nullptr == host_ptr
+     || 0 == size)
+        return -1;
+
+    // transfers are staged through XRT buffer objects, nothing to pin
+    return 0;
+}
+
+extern int vx_mem_unpin(vx_device_h hdevice, void* host_ptr) {
+    if (nullptr == hdevice)
+        return -1;
+
+    __unused (host_ptr);
+    return 0;
+}
+
 extern int vx_copy_to_dev(vx_device_h hdevice, uint64_t dev_addr, const void* host_ptr, uint64_t size) {
     if (nullptr == hdevice)
         return -1;
+
+    kernel_invalidate(hdevice, dev_addr, size);
     
     auto device = (vx_device*)hdevice;
 
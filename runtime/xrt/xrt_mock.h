@@ -0,0 +1,247 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimal in-process stand-in for the XRT native C++ API used by the driver.
+// It models buffer objects with separate host and device images so that
+// transfer logic (bank mapping, write/sync pairing) can be validated
+// without an FPGA or an XRT installation.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <stdexcept>
+
+enum xclBOSyncDirection {
+    XCL_BO_SYNC_BO_TO_DEVICE = 0,
+    XCL_BO_SYNC_BO_FROM_DEVICE,
+};
+
+#ifndef XRT_MOCK_DEVICE_NAME
+#define XRT_MOCK_DEVICE_NAME "xilinx_u50_mock"
+#endif
+
+namespace xrt_mock {
+
+// sparse byte-addressable storage
+class sparse_mem {
+public:
+    void write(const void* data, uint64_t addr, uint64_t size) {
+        auto src = (const uint8_t*)data;
+        while (size) {
+            auto& page = pages_[addr / PAGE_SIZE];
+            uint64_t offset = addr % PAGE_SIZE;
+            uint64_t len = std::min<uint64_t>(size, PAGE_SIZE - offset);
+            memcpy(page.data() + offset, src, len);
+            src  += len;
+            addr += len;
+            size -= len;
+        }
+    }
+
+    void read(void* data, uint64_t addr, uint64_t size) const {
+        auto dst = (uint8_t*)data;
+        while (size) {
+            uint64_t offset = addr % PAGE_SIZE;
+            uint64_t len = std::min<uint64_t>(size, PAGE_SIZE - offset);
+            auto it = pages_.find(addr / PAGE_SIZE);
+            if (it != pages_.end()) {
+                memcpy(dst, it->second.data() + offset, len);
+            } else {
+                memset(dst, 0, len);
+            }
+            dst  += len;
+            addr += len;
+            size -= len;
+        }
+    }
+
+    void copy_to(sparse_mem& other, uint64_t addr, uint64_t size) const {
+        std::vector<uint8_t> tmp(size);
+        this->read(tmp.data(), addr, size);
+        other.write(tmp.data(), addr, size);
+    }
+
+private:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    std::unordered_map<uint64_t, std::array<uint8_t, PAGE_SIZE>> pages_;
+};
+
+struct bo_impl {
+    int        bank;
+    size_t     size;
+    sparse_mem host;
+    sparse_mem device;
+    uint64_t   writes = 0;
+    uint64_t   reads  = 0;
+    uint64_t   syncs  = 0;
+    std::mutex mutex;
+};
+
+// global view of allocated buffers, used by tests to inspect bank contents
+struct registry_t {
+    std::mutex mutex;
+    std::vector<std::weak_ptr<bo_impl>> buffers;
+
+    std::shared_ptr<bo_impl> find(int bank) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : buffers) {
+            auto bo = entry.lock();
+            if (bo && bo->bank == bank)
+                return bo;
+        }
+        return nullptr;
+    }
+};
+
+inline registry_t& registry() {
+    static registry_t s_registry;
+    return s_registry;
+}
+
+struct device_impl {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, uint32_t> registers;
+};
+
+}
+
+namespace xrt {
+
+namespace info {
+    enum class device : unsigned int {
+        name
+    };
+}
+
+class uuid {};
+
+class device {
+public:
+    device() {}
+
+    explicit device(unsigned int /*index*/)
+        : impl_(std::make_shared<xrt_mock::device_impl>())
+    {}
+
+    uuid load_xclbin(const std::string& /*path*/) {
+        return uuid();
+    }
+
+    template <info::device param>
+    std::string get_info() const {
+        return XRT_MOCK_DEVICE_NAME;
+    }
+
+    std::shared_ptr<xrt_mock::device_impl> impl() const {
+        return impl_;
+    }
+
+private:
+    std::shared_ptr<xrt_mock::device_impl> impl_;
+};
+
+class xclbin {
+public:
+    xclbin() {}
+    explicit xclbin(const std::string& path) : path_(path) {}
+private:
+    std::string path_;
+};
+
+class ip {
+public:
+    ip() {}
+
+    ip(const device& dev, const uuid& /*xclbin_id*/, const std::string& /*name*/)
+        : impl_(dev.impl())
+    {}
+
+    void write_register(uint32_t offset, uint32_t data) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->registers[offset] = data;
+    }
+
+    uint32_t read_register(uint32_t offset) const {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (0 == offset)
+            return 0x6; // ap_done | ap_idle
+        auto it = impl_->registers.find(offset);
+        if (it == impl_->registers.end())
+            return 0;
+        return it->second;
+    }
+
+private:
+    std::shared_ptr<xrt_mock::device_impl> impl_;
+};
+
+class bo {
+public:
+    enum class flags : uint32_t {
+        normal = 0
+    };
+
+    bo() {}
+
+    bo(const device& /*dev*/, size_t size, flags /*flags*/, int grp)
+        : impl_(std::make_shared<xrt_mock::bo_impl>()) {
+        impl_->bank = grp;
+        impl_->size = size;
+        auto& reg = xrt_mock::registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.buffers.push_back(impl_);
+    }
+
+    void write(const void* src, size_t size, size_t seek) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        this->check_range(size, seek);
+        impl_->host.write(src, seek, size);
+        ++impl_->writes;
+    }
+
+    void read(void* dst, size_t size, size_t skip) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        this->check_range(size, skip);
+        impl_->host.read(dst, skip, size);
+        ++impl_->reads;
+    }
+
+    void sync(xclBOSyncDirection dir, size_t size, size_t offset) {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        this->check_range(size, offset);
+        if (dir == XCL_BO_SYNC_BO_TO_DEVICE) {
+            impl_->host.copy_to(impl_->device, offset, size);
+        } else {
+            impl_->device.copy_to(impl_->host, offset, size);
+        }
+        ++impl_->syncs;
+    }
+
+private:
+
+    void check_range(size_t size, size_t offset) const {
+        if (offset + size > impl_->size)
+            throw std::out_of_range("xrt::bo access out of range");
+    }
+
+    std::shared_ptr<xrt_mock::bo_impl> impl_;
+};
+
+}
@@ -0,0 +1,154 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "checkpoint.h"
+#include "mem.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+using namespace vortex;
+
+static constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+// upper bound of each configuration field, well above any buildable device
+static constexpr uint32_t CHECKPOINT_MAX_DIM = 1 << 16;
+
+struct checkpoint_header_t {
+  char     magic[4]; // "VXCP"
+  uint32_t version;
+  uint32_t xlen;
+  uint32_t num_cores;
+  uint32_t num_warps;
+  uint32_t num_threads;
+  uint32_t num_dcrs;
+  uint32_t reserved;
+};
+
+Checkpoint::Checkpoint()
+  : xlen_(0)
+  , num_cores_(0)
+  , num_warps_(0)
+  , num_threads_(0)
+{}
+
+Checkpoint::Checkpoint(uint32_t xlen, uint32_t num_cores, uint32_t num_warps, uint32_t num_threads)
+  : xlen_(xlen)
+  , num_cores_(num_cores)
+  , num_warps_(num_warps)
+  , num_threads_(num_threads)
+  , warps_(num_cores * num_warps)
+{
+  for (auto& warp : warps_) {
+    warp.pc = 0;
+    warp.tmask = 0;
+    warp.fcsr = 0;
+    warp.iregs.resize(num_threads * NUM_REGS, 0);
+    warp.fregs.resize(num_threads * NUM_REGS, 0);
+  }
+}
+
+bool Checkpoint::save(const std::string& filename, const RAM& ram) const {
+  std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+  if (!ofs) {
+    std::cout << "Error: cannot write checkpoint " << filename << std::endl;
+    return false;
+  }
+
+  checkpoint_header_t header;
+  memcpy(header.magic, "VXCP", 4);
+  header.version     = CHECKPOINT_VERSION;
+  header.xlen        = xlen_;
+  header.num_cores   = num_cores_;
+  header.num_warps   = num_warps_;
+  header.num_threads = num_threads_;
+  header.num_dcrs    = dcrs_.size();
+  header.reserved    = 0;
+  ofs.write((const char*)&header, sizeof(header));
+
+  for (auto& dcr : dcrs_) {
+    ofs.write((const char*)&dcr.first, sizeof(uint32_t));
+    ofs.write((const char*)&dcr.second, sizeof(uint32_t));
+  }
+
+  for (auto& warp : warps_) {
+    ofs.write((const char*)&warp.pc, sizeof(uint64_t));
+    ofs.write((const char*)&warp.tmask, sizeof(uint32_t));
+    ofs.write((const char*)&warp.fcsr, sizeof(uint32_t));
+    ofs.write((const char*)warp.iregs.data(), warp.iregs.size() * sizeof(uint64_t));
+    ofs.write((const char*)warp.fregs.data(), warp.fregs.size() * sizeof(uint64_t));
+  }
+
+  ram.save(ofs);
+
+  return ofs.good();
+}
+
+bool Checkpoint::load(const std::string& filename, RAM* ram) {
+  std::ifstream ifs(filename, std::ios::binary);
+  if (!ifs) {
+    std::cout << "Error: cannot open checkpoint " << filename << std::endl;
+    return false;
+  }
+
+  ifs.seekg(0, ifs.end);
+  uint64_t file_size = ifs.tellg();
+  ifs.seekg(0, ifs.beg);
+
+  // validate the header before sizing anything from it: the DCRs and the
+  // warp state must fit in the file
+  checkpoint_header_t header;
+  if (!ifs.read((char*)&header, sizeof(header))
+   || memcmp(header.magic, "VXCP", 4) != 0
+   || header.version != CHECKPOINT_VERSION
+   || (header.xlen != 32 && header.xlen != 64)
+   || header.num_cores == 0 || header.num_cores > CHECKPOINT_MAX_DIM
+   || header.num_warps == 0 || header.num_warps > CHECKPOINT_MAX_DIM
+   || header.num_threads == 0 || header.num_threads > CHECKPOINT_MAX_DIM
+   || header.num_dcrs > CHECKPOINT_MAX_DIM) {
+    std::cout << "Error: invalid checkpoint " << filename << std::endl;
+    return false;
+  }
+  uint64_t warp_size = 2 * sizeof(uint32_t) + sizeof(uint64_t)
+                     + 2 * uint64_t(header.num_threads) * NUM_REGS * sizeof(uint64_t);
+  uint64_t state_size = uint64_t(header.num_dcrs) * 2 * sizeof(uint32_t)
+                      + uint64_t(header.num_cores) * header.num_warps * warp_size;
+  if (state_size > file_size - sizeof(header)) {
+    std::cout << "Error: invalid checkpoint " << filename << std::endl;
+    return false;
+  }
+
+  *this = Checkpoint(header.xlen, header.num_cores, header.num_warps, header.num_threads);
+
+  dcrs_.resize(header.num_dcrs);
+  for (auto& dcr : dcrs_) {
+    ifs.read((char*)&dcr.first, sizeof(uint32_t));
+    ifs.read((char*)&dcr.second, sizeof(uint32_t));
+  }
+
+  for (auto& warp : warps_) {
+    ifs.read((char*)&warp.pc, sizeof(uint64_t));
+    ifs.read((char*)&warp.tmask, sizeof(uint32_t));
+    ifs.read((char*)&warp.fcsr, sizeof(uint32_t));
+    ifs.read((char*)warp.iregs.data(), warp.iregs.size() * sizeof(uint64_t));
+    ifs.read((char*)warp.fregs.data(), warp.fregs.size() * sizeof(uint64_t));
+  }
+
+  ram->load(ifs);
+
+  if (!ifs) {
+    std::cout << "Error: truncated or invalid checkpoint " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,100 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace vortex {
+
+class RAM;
+
+// Architectural state of a running kernel, handed off from simx to rtlsim.
+// Only the state the RTL can restore at reset is captured: memory, DCRs and
+// per-warp PC, thread mask, fcsr and register files. The snapshot must be
+// taken with every IPDOM stack empty and no warp waiting on a barrier.
+class Checkpoint {
+public:
+  struct warp_t {
+    uint64_t pc;
+    uint32_t tmask;  // zero for inactive warps
+    uint32_t fcsr;
+    std::vector<uint64_t> iregs; // [thread][reg]
+    std::vector<uint64_t> fregs; // [thread][reg]
+  };
+
+  static constexpr uint32_t NUM_REGS = 32;
+
+  Checkpoint();
+
+  Checkpoint(uint32_t xlen, uint32_t num_cores, uint32_t num_warps, uint32_t num_threads);
+
+  // the memory image is streamed to/from ram, the rest is kept in this object
+  bool save(const std::string& filename, const RAM& ram) const;
+  bool load(const std::string& filename, RAM* ram);
+
+  uint32_t xlen() const {
+    return xlen_;
+  }
+
+  uint32_t num_cores() const {
+    return num_cores_;
+  }
+
+  uint32_t num_warps() const {
+    return num_warps_;
+  }
+
+  uint32_t num_threads() const {
+    return num_threads_;
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>>& dcrs() {
+    return dcrs_;
+  }
+
+  const std::vector<std::pair<uint32_t, uint32_t>>& dcrs() const {
+    return dcrs_;
+  }
+
+  // cores are numbered globally, as CORE_ID in the RTL
+  warp_t& warp(uint32_t core_id, uint32_t wid) {
+    return warps_.at(core_id * num_warps_ + wid);
+  }
+
+  const warp_t& warp(uint32_t core_id, uint32_t wid) const {
+    return warps_.at(core_id * num_warps_ + wid);
+  }
+
+  // registers are indexed as in the RTL register file: FP registers follow the
+  // integer ones
+  uint64_t reg(uint32_t core_id, uint32_t wid, uint32_t tid, uint32_t rid) const {
+    auto& w = this->warp(core_id, wid);
+    if (rid < NUM_REGS)
+      return w.iregs.at(tid * NUM_REGS + rid);
+    return w.fregs.at(tid * NUM_REGS + (rid - NUM_REGS));
+  }
+
+private:
+  uint32_t xlen_;
+  uint32_t num_cores_;
+  uint32_t num_warps_;
+  uint32_t num_threads_;
+  std::vector<std::pair<uint32_t, uint32_t>> dcrs_;
+  std::vector<warp_t> warps_;
+};
+
+}
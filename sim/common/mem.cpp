@@ -16,6 +16,8 @@
 #include <iostream>
 #include <fstream>
 #include <assert.h>
+#include <cstring>
+#include <algorithm>
 #include "util.h"
 
 using namespace vortex;
@@ -208,6 +210,8 @@ void RAM::clear() {
   for (auto& page : pages_) {
     delete[] page.second;
   }
+  pages_.clear();
+  last_page_ = nullptr;
 }
 
 uint64_t RAM::size() const {
@@ -246,16 +250,80 @@ uint8_t *RAM::get(uint64_t address) const {
 }
 
 void RAM::read(void* data, uint64_t addr, uint64_t size) {
+  // copy page by page
   uint8_t* d = (uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    d[i] = *this->get(addr + i);
+  uint64_t page_size = uint64_t(1) << page_bits_;
+  while (size) {
+    uint64_t len = std::min(size, page_size - (addr & (page_size - 1)));
+    if (capacity_ != 0 && (addr + len) > capacity_) {
+      throw OutOfRange();
+    }
+    memcpy(d, this->get(addr), len);
+    d += len;
+    addr += len;
+    size -= len;
   }
 }
 
 void RAM::write(const void* data, uint64_t addr, uint64_t size) {
+  // copy page by page
+  const uint8_t* d = (const uint8_t*)data;
+  uint64_t page_size = uint64_t(1) << page_bits_;
+  while (size) {
+    uint64_t len = std::min(size, page_size - (addr & (page_size - 1)));
+    if (capacity_ != 0 && (addr + len) > capacity_) {
+      throw OutOfRange();
+    }
+    memcpy(this->get(addr), d, len);
+    d += len;
+    addr += len;
+    size -= len;
+  }
+}
+
+void RAM::write(const void* data, uint64_t addr, uint64_t size, uint64_t byteen) {
+  assert(size <= 64);
+  if (size < 64) {
+    byteen &= (uint64_t(1) << size) - 1;
+  }
+  // copy each run of enabled bytes at once
   const uint8_t* d = (const uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    *this->get(addr + i) = d[i];
+  while (byteen) {
+    uint32_t start = __builtin_ctzll(byteen);
+    uint64_t bits = ~(byteen >> start);
+    uint32_t len = bits ? __builtin_ctzll(bits) : 64;
+    this->write(d + start, addr + start, len);
+    byteen = (len == 64) ? 0 : (byteen & ~(((uint64_t(1) << len) - 1) << start));
+  }
+}
+
+void RAM::save(std::ostream& os) const {
+  uint64_t page_size = uint64_t(1) << page_bits_;
+  uint64_t num_pages = pages_.size();
+  os.write((const char*)&page_size, sizeof(uint64_t));
+  os.write((const char*)&num_pages, sizeof(uint64_t));
+  for (auto& page : pages_) {
+    os.write((const char*)&page.first, sizeof(uint64_t));
+    os.write((const char*)page.second, page_size);
+  }
+}
+
+void RAM::load(std::istream& is) {
+  uint64_t page_size, num_pages;
+  is.read((char*)&page_size, sizeof(uint64_t));
+  is.read((char*)&num_pages, sizeof(uint64_t));
+  this->clear();
+  // reject page sizes that are not a power of two or that this RAM cannot map
+  if (!is || 0 == page_size || (page_size & (page_size - 1)) || page_size > (uint64_t(1) << 30)) {
+    is.setstate(std::ios::failbit);
+    return;
+  }
+  std::vector<uint8_t> buffer(page_size);
+  for (uint64_t i = 0; i < num_pages && is; ++i) {
+    uint64_t page_index;
+    is.read((char*)&page_index, sizeof(uint64_t));
+    is.read((char*)buffer.data(), page_size);
+    this->write(buffer.data(), page_index * page_size, page_size);
   }
 }
 
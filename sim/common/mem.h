@@ -17,6 +17,7 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
+#include <iosfwd>
 
 namespace vortex {
 struct BadAddress {};
@@ -168,9 +169,16 @@ public:
   void read(void* data, uint64_t addr, uint64_t size) override;  
   void write(const void* data, uint64_t addr, uint64_t size) override;
 
+  // write the bytes of a block (up to 64 bytes) whose byteen bit is set
+  void write(const void* data, uint64_t addr, uint64_t size, uint64_t byteen);
+
   void loadBinImage(const char* filename, uint64_t destination);
   void loadHexImage(const char* filename);
 
+  // serialize the allocated pages, loading replaces the current content
+  void save(std::ostream& os) const;
+  void load(std::istream& is);
+
   uint8_t& operator[](uint64_t address) {
     return *this->get(address);
   }
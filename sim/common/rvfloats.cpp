@@ -13,6 +13,17 @@
 
 #include "rvfloats.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <cfloat>
+#if defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+// the SoftFloat rounding mode and exception flags are thread-local
+// (see third_party/Makefile), multi-threaded simulators share the library
+#define THREAD_LOCAL __thread
 
 extern "C" {
 #include <softfloat.h>
@@ -34,11 +45,180 @@ inline void rv_init(uint32_t frm) {
   softfloat_roundingMode = frm;
 }
 
+// Host FPU fast path for the arithmetic operations. It is used when the
+// operands are normal, zero or infinite and the rounding mode has a host
+// equivalent; results that are NaN or subnormal, or that underflow, are
+// recomputed with SoftFloat, which owns the RISC-V NaN and tininess rules.
+// It is opt-in (RVFLOATS_NATIVE=1) until ci/simbench.py shows it ahead of
+// SoftFloat on the reference workloads.
+#if (defined(__x86_64__) || defined(__aarch64__)) && (FLT_EVAL_METHOD == 0)
+#define RV_NATIVE_FPU
+#endif
+
+static bool& native_fpu_enabled() {
+  static bool enabled = [] {
+    auto value = getenv("RVFLOATS_NATIVE");
+    return (nullptr != value && 0 != strcmp(value, "0"));
+  }();
+  return enabled;
+}
+
+#ifdef RV_NATIVE_FPU
+
+inline bool is_native_f32(uint32_t x) {
+  uint32_t exp = (x >> 23) & 0xff;
+  uint32_t man = x & 0x7fffff;
+  return (0 == man) || (exp != 0 && exp != 0xff);
+}
+
+inline bool is_native_f64(uint64_t x) {
+  uint64_t exp = (x >> 52) & 0x7ff;
+  uint64_t man = x & 0xfffffffffffff;
+  return (0 == man) || (exp != 0 && exp != 0x7ff);
+}
+
+inline float as_float(uint32_t x) { float f; memcpy(&f, &x, 4); return f; }
+inline double as_double(uint64_t x) { double d; memcpy(&d, &x, 8); return d; }
+
+// volatile copies keep the operation between the rounding mode and flags accesses
+template <typename T>
+inline T fenced(T x) { volatile T v = x; return v; }
+
+// The rounding mode and exception flags are accessed in the SSE control and
+// status register (x86-64) or in FPCR/FPSR (AArch64) directly: the <cfenv>
+// functions also save and reload the x87 environment on x86-64, which costs
+// more than the operation. fpu_enter selects the rounding mode with clear
+// flags, fpu_leave returns the raised flags and restores the caller's state.
+#if defined(__x86_64__)
+
+// MXCSR: flags in bits 0-5, rounding control in bits 13-14
+#define FPU_FLAGS_MASK  0x003f
+#define FPU_RMODE_MASK  0x6000
+#define FPU_INVALID     0x0001
+#define FPU_DIVBYZERO   0x0004
+#define FPU_OVERFLOW    0x0008
+#define FPU_UNDERFLOW   0x0010
+#define FPU_INEXACT     0x0020
+
+// RNE, RTZ, RDN, RUP
+static const uint32_t fpu_rmodes[] = {0x0000, 0x6000, 0x2000, 0x4000};
+
+inline uint32_t fpu_enter(uint32_t frm) {
+  uint32_t saved = _mm_getcsr();
+  uint32_t csr = (saved & ~(FPU_FLAGS_MASK | FPU_RMODE_MASK)) | fpu_rmodes[frm];
+  if (csr != saved) {
+    _mm_setcsr(csr);
+  }
+  return saved;
+}
+
+inline uint32_t fpu_leave(uint32_t saved) {
+  uint32_t csr = _mm_getcsr();
+  if (csr != saved) {
+    _mm_setcsr(saved);
+  }
+  return csr;
+}
+
+#else
+
+// FPSR: flags in bits 0-4; FPCR: rounding control in bits 22-23
+#define FPU_INVALID     0x0001
+#define FPU_DIVBYZERO   0x0002
+#define FPU_OVERFLOW    0x0004
+#define FPU_UNDERFLOW   0x0008
+#define FPU_INEXACT     0x0010
+#define FPU_RMODE_SHIFT 22
+
+// RNE, RTZ, RDN, RUP
+static const uint64_t fpu_rmodes[] = {0, 3, 2, 1};
+
+struct fpu_state_t {
+  uint64_t fpcr;
+  uint64_t fpsr;
+};
+
+inline fpu_state_t fpu_enter(uint32_t frm) {
+  fpu_state_t saved;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(saved.fpcr));
+  __asm__ __volatile__("mrs %0, fpsr" : "=r"(saved.fpsr));
+  // FPCR writes are slow on some cores, only change it for directed rounding
+  uint64_t fpcr = (saved.fpcr & ~(uint64_t(3) << FPU_RMODE_SHIFT)) | (fpu_rmodes[frm] << FPU_RMODE_SHIFT);
+  if (fpcr != saved.fpcr) {
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+  }
+  if (saved.fpsr != 0) {
+    __asm__ __volatile__("msr fpsr, %0" : : "r"(uint64_t(0)));
+  }
+  return saved;
+}
+
+inline uint64_t fpu_leave(const fpu_state_t& saved) {
+  uint64_t fpsr, fpcr;
+  __asm__ __volatile__("mrs %0, fpsr" : "=r"(fpsr));
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+  if (fpcr != saved.fpcr) {
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(saved.fpcr));
+  }
+  if (fpsr != saved.fpsr) {
+    __asm__ __volatile__("msr fpsr, %0" : : "r"(saved.fpsr));
+  }
+  return fpsr;
+}
+
+#endif
+
+template <typename T, typename Op, typename... Args>
+inline bool native_fpu(uint32_t frm, uint32_t* fflags, T* result, Op op, Args... args) {
+  if (frm > softfloat_round_max || !native_fpu_enabled())
+    return false;
+  auto saved = fpu_enter(frm);
+  volatile T r = op(fenced(args)...);
+  auto ex = fpu_leave(saved);
+  T value = r;
+  if ((ex & FPU_UNDERFLOW) || std::isnan(value) || (value != 0 && !std::isnormal(value) && !std::isinf(value)))
+    return false;
+  memcpy(result, &value, sizeof(T));
+  if (fflags) {
+    *fflags = ((ex & FPU_INEXACT) ? softfloat_flag_inexact : 0)
+            | ((ex & FPU_OVERFLOW) ? softfloat_flag_overflow : 0)
+            | ((ex & FPU_DIVBYZERO) ? softfloat_flag_infinite : 0)
+            | ((ex & FPU_INVALID) ? softfloat_flag_invalid : 0);
+  }
+  return true;
+}
+
+#define RV_NATIVE_F32(cond, op, ...) do {                                   \
+  float r;                                                                  \
+  if ((cond) && native_fpu(frm, fflags, &r, op, __VA_ARGS__)) {             \
+    uint32_t bits; memcpy(&bits, &r, 4); return bits;                       \
+  }                                                                         \
+} while (false)
+
+#define RV_NATIVE_F64(cond, op, ...) do {                                   \
+  double r;                                                                 \
+  if ((cond) && native_fpu(frm, fflags, &r, op, __VA_ARGS__)) {             \
+    uint64_t bits; memcpy(&bits, &r, 8); return bits;                       \
+  }                                                                         \
+} while (false)
+
+#else
+
+#define RV_NATIVE_F32(cond, op, ...) do {} while (false)
+#define RV_NATIVE_F64(cond, op, ...) do {} while (false)
+
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+void rv_native_fpu(bool enable) {
+  native_fpu_enabled() = enable;
+}
+
 uint32_t rv_fadd_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b), [](float x, float y) { return x + y; }, as_float(a), as_float(b));
   rv_init(frm);
   auto r = f32_add(to_float32_t(a), to_float32_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -46,6 +226,7 @@ uint32_t rv_fadd_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint64_t rv_fadd_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b), [](double x, double y) { return x + y; }, as_double(a), as_double(b));
   rv_init(frm);
   auto r = f64_add(to_float64_t(a), to_float64_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -53,6 +234,7 @@ uint64_t rv_fadd_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint32_t rv_fsub_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b), [](float x, float y) { return x - y; }, as_float(a), as_float(b));
   rv_init(frm);
   auto r = f32_sub(to_float32_t(a), to_float32_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -60,6 +242,7 @@ uint32_t rv_fsub_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint64_t rv_fsub_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b), [](double x, double y) { return x - y; }, as_double(a), as_double(b));
   rv_init(frm);
   auto r = f64_sub(to_float64_t(a), to_float64_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -67,6 +250,7 @@ uint64_t rv_fsub_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint32_t rv_fmul_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b), [](float x, float y) { return x * y; }, as_float(a), as_float(b));
   rv_init(frm);
   auto r = f32_mul(to_float32_t(a), to_float32_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -74,6 +258,7 @@ uint32_t rv_fmul_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint64_t rv_fmul_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b), [](double x, double y) { return x * y; }, as_double(a), as_double(b));
   rv_init(frm);
   auto r = f64_mul(to_float64_t(a), to_float64_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -81,6 +266,7 @@ uint64_t rv_fmul_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint32_t rv_fmadd_s(uint32_t a, uint32_t b, uint32_t c, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b) && is_native_f32(c), [](float x, float y, float z) { return std::fma(x, y, z); }, as_float(a), as_float(b), as_float(c));
   rv_init(frm);
   auto r = f32_mulAdd(to_float32_t(a), to_float32_t(b), to_float32_t(c));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -88,6 +274,7 @@ uint32_t rv_fmadd_s(uint32_t a, uint32_t b, uint32_t c, uint32_t frm, uint32_t*
 }
 
 uint64_t rv_fmadd_d(uint64_t a, uint64_t b, uint64_t c, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b) && is_native_f64(c), [](double x, double y, double z) { return std::fma(x, y, z); }, as_double(a), as_double(b), as_double(c));
   rv_init(frm);
   auto r = f64_mulAdd(to_float64_t(a), to_float64_t(b), to_float64_t(c));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -95,56 +282,63 @@ uint64_t rv_fmadd_d(uint64_t a, uint64_t b, uint64_t c, uint32_t frm, uint32_t*
 }
 
 uint32_t rv_fmsub_s(uint32_t a, uint32_t b, uint32_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto c_neg = c ^ F32_SIGN;
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b) && is_native_f32(c_neg), [](float x, float y, float z) { return std::fma(x, y, z); }, as_float(a), as_float(b), as_float(c_neg));
+  rv_init(frm);
   auto r = f32_mulAdd(to_float32_t(a), to_float32_t(b), to_float32_t(c_neg));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float32_t(r);
 }
 
 uint64_t rv_fmsub_d(uint64_t a, uint64_t b, uint64_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto c_neg = c ^ F64_SIGN;
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b) && is_native_f64(c_neg), [](double x, double y, double z) { return std::fma(x, y, z); }, as_double(a), as_double(b), as_double(c_neg));
+  rv_init(frm);
   auto r = f64_mulAdd(to_float64_t(a), to_float64_t(b), to_float64_t(c_neg));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float64_t(r);
 }
 
 uint32_t rv_fnmadd_s(uint32_t a, uint32_t b, uint32_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto a_neg = a ^ F32_SIGN;
   auto c_neg = c ^ F32_SIGN;
+  RV_NATIVE_F32(is_native_f32(a_neg) && is_native_f32(b) && is_native_f32(c_neg), [](float x, float y, float z) { return std::fma(x, y, z); }, as_float(a_neg), as_float(b), as_float(c_neg));
+  rv_init(frm);
   auto r = f32_mulAdd(to_float32_t(a_neg), to_float32_t(b), to_float32_t(c_neg));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float32_t(r);
 }
 
 uint64_t rv_fnmadd_d(uint64_t a, uint64_t b, uint64_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto a_neg = a ^ F64_SIGN;
   auto c_neg = c ^ F64_SIGN;
+  RV_NATIVE_F64(is_native_f64(a_neg) && is_native_f64(b) && is_native_f64(c_neg), [](double x, double y, double z) { return std::fma(x, y, z); }, as_double(a_neg), as_double(b), as_double(c_neg));
+  rv_init(frm);
   auto r = f64_mulAdd(to_float64_t(a_neg), to_float64_t(b), to_float64_t(c_neg));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float64_t(r);
 }
 
 uint32_t rv_fnmsub_s(uint32_t a, uint32_t b, uint32_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto a_neg = a ^ F32_SIGN;
+  RV_NATIVE_F32(is_native_f32(a_neg) && is_native_f32(b) && is_native_f32(c), [](float x, float y, float z) { return std::fma(x, y, z); }, as_float(a_neg), as_float(b), as_float(c));
+  rv_init(frm);
   auto r = f32_mulAdd(to_float32_t(a_neg), to_float32_t(b), to_float32_t(c));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float32_t(r);
 }
 
 uint64_t rv_fnmsub_d(uint64_t a, uint64_t b, uint64_t c, uint32_t frm, uint32_t* fflags) {
-  rv_init(frm);
   auto a_neg = a ^ F64_SIGN;
+  RV_NATIVE_F64(is_native_f64(a_neg) && is_native_f64(b) && is_native_f64(c), [](double x, double y, double z) { return std::fma(x, y, z); }, as_double(a_neg), as_double(b), as_double(c));
+  rv_init(frm);
   auto r = f64_mulAdd(to_float64_t(a_neg), to_float64_t(b), to_float64_t(c));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
   return from_float64_t(r);
 }
 
 uint32_t rv_fdiv_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a) && is_native_f32(b), [](float x, float y) { return x / y; }, as_float(a), as_float(b));
   rv_init(frm);
   auto r = f32_div(to_float32_t(a), to_float32_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -152,6 +346,7 @@ uint32_t rv_fdiv_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint64_t rv_fdiv_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a) && is_native_f64(b), [](double x, double y) { return x / y; }, as_double(a), as_double(b));
   rv_init(frm);
   auto r = f64_div(to_float64_t(a), to_float64_t(b));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -159,6 +354,7 @@ uint64_t rv_fdiv_d(uint64_t a, uint64_t b, uint32_t frm, uint32_t* fflags) {
 }
 
 uint32_t rv_fsqrt_s(uint32_t a, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F32(is_native_f32(a), [](float x) { return std::sqrt(x); }, as_float(a));
   rv_init(frm);
   auto r = f32_sqrt(to_float32_t(a));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
@@ -166,6 +362,7 @@ uint32_t rv_fsqrt_s(uint32_t a, uint32_t frm, uint32_t* fflags) {
 }
 
 uint64_t rv_fsqrt_d(uint64_t a, uint32_t frm, uint32_t* fflags) {
+  RV_NATIVE_F64(is_native_f64(a), [](double x) { return std::sqrt(x); }, as_double(a));
   rv_init(frm);
   auto r = f64_sqrt(to_float64_t(a));
   if (fflags) { *fflags = softfloat_exceptionFlags; }
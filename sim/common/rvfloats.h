@@ -19,6 +19,11 @@
 extern "C" {
 #endif
 
+// Selects the host FPU fast path for add, sub, mul, div, sqrt and fused
+// multiply-add (enabled with RVFLOATS_NATIVE=1) or SoftFloat for all
+// operations (the default). Both give the same results and flags.
+void rv_native_fpu(bool enable);
+
 uint32_t rv_fadd_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags);
 uint32_t rv_fsub_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags);
 uint32_t rv_fmul_s(uint32_t a, uint32_t b, uint32_t frm, uint32_t* fflags);
@@ -188,7 +188,7 @@ protected:
   Pkt  pkt_;
 
   static MemoryPool<SimCallEvent<Pkt>>& allocator() {
-    static MemoryPool<SimCallEvent<Pkt>> instance(64);
+    static thread_local MemoryPool<SimCallEvent<Pkt>> instance(64);
     return instance;
   }
 };
@@ -221,7 +221,7 @@ protected:
   Pkt pkt_;
 
   static MemoryPool<SimPortEvent<Pkt>>& allocator() {
-    static MemoryPool<SimPortEvent<Pkt>> instance(64);
+    static thread_local MemoryPool<SimPortEvent<Pkt>> instance(64);
     return instance;
   }
 };
@@ -299,20 +299,41 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Simulation context holding the event queue, the object list and the clock.
+// Each simulated device owns its own platform and binds it to the thread running
+// the simulation; instance() resolves to that binding, or to a process-wide
+// default platform when none is bound.
 class SimPlatform {
 public:
+  SimPlatform() : cycles_(0) {}
+
+  virtual ~SimPlatform() {
+    this->clear();
+  }
+
   static SimPlatform& instance() {
+    auto current = current_platform();
+    if (current)
+      return *current;
     static SimPlatform s_inst;
     return s_inst;
   }
 
+  // bind a platform to the calling thread, returns the previous binding
+  static SimPlatform* bind(SimPlatform* platform) {
+    auto& current = current_platform();
+    auto prev = current;
+    current = platform;
+    return prev;
+  }
+
   bool initialize() {
     //--
     return true;
   }
 
   void finalize() {
-    instance().clear();
+    this->clear();
   }
 
   template <typename Impl, typename... Args>
@@ -370,10 +391,12 @@ public:
 
 private:
 
-  SimPlatform() : cycles_(0) {}
+  SimPlatform(const SimPlatform&) = delete;
+  SimPlatform& operator=(const SimPlatform&) = delete;
 
-  virtual ~SimPlatform() {
-    this->clear();
+  static SimPlatform*& current_platform() {
+    static thread_local SimPlatform* s_current = nullptr;
+    return s_current;
   }
 
   void clear() {
@@ -398,6 +421,23 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// binds a platform to the calling thread for the lifetime of the scope
+class SimPlatformScope {
+public:
+  SimPlatformScope(SimPlatform* platform) 
+    : prev_(SimPlatform::bind(platform)) 
+  {}
+
+  ~SimPlatformScope() {
+    SimPlatform::bind(prev_);
+  }
+
+private:
+  SimPlatform* prev_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 inline SimObjectBase::SimObjectBase(const SimContext&, const char* name) 
   : name_(name) 
 {}
@@ -0,0 +1,138 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <verilated.h>
+#ifdef FST_OUTPUT
+#include <verilated_fst_c.h>
+#else
+#include <verilated_vcd_c.h>
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+namespace vortex {
+
+// Waveform dump of a Verilator model, configured at runtime:
+//   RTL_TRACE_WINDOW=<start>[:<stop>]  only dump cycles in [start, stop)
+//   RTL_TRACE_SCOPE=<scope>[,<scope>]  only dump the given hierarchies (e.g. TOP.Vortex.cluster0)
+//   RTL_TRACE_RING=<cycles>            flight recorder: keep the last cycles in two alternating files
+// Cycles are counted in model evaluations, two per clock. Dumping outside the
+// window is also enabled by the dpi_trace_start/dpi_trace_stop events.
+class VlTrace {
+public:
+#ifdef FST_OUTPUT
+  typedef VerilatedFstC trace_file_t;
+  static constexpr const char* EXTENSION = "fst";
+#else
+  typedef VerilatedVcdC trace_file_t;
+  static constexpr const char* EXTENSION = "vcd";
+#endif
+
+  // parse RTL_TRACE_WINDOW into evaluation timestamps, leaves the defaults when unset
+  static void parse_window(uint64_t* start_time, uint64_t* stop_time) {
+    auto value = getenv("RTL_TRACE_WINDOW");
+    if (nullptr == value || 0 == value[0])
+      return;
+    char* end;
+    *start_time = 2 * std::strtoull(value, &end, 0);
+    if (':' == *end) {
+      *stop_time = 2 * std::strtoull(end + 1, nullptr, 0);
+    }
+  }
+
+  template <typename M>
+  VlTrace(M* model, const std::string& basename)
+    : basename_(basename)
+    , ring_size_(0)
+    , segment_(0)
+    , segment_start_(0)
+    , last_dump_(0)
+    , dumping_(false)
+  {
+    Verilated::traceEverOn(true);
+    trace_ = new trace_file_t();
+    auto scopes = getenv("RTL_TRACE_SCOPE");
+    if (scopes && scopes[0]) {
+      std::stringstream ss(scopes);
+      std::string scope;
+      while (std::getline(ss, scope, ',')) {
+        trace_->dumpvars(99, scope);
+      }
+    }
+    model->trace(trace_, 99);
+
+    auto ring = getenv("RTL_TRACE_RING");
+    if (ring && ring[0]) {
+      ring_size_ = 2 * std::strtoull(ring, nullptr, 0);
+    }
+    trace_->open(this->filename().c_str());
+
+    // flush on assertion failures, the flight recorder is only useful then
+    Verilated::addFlushCb(&VlTrace::flush_cb, this);
+  }
+
+  ~VlTrace() {
+    Verilated::removeFlushCb(&VlTrace::flush_cb, this);
+    trace_->close();
+    delete trace_;
+  }
+
+  void dump(uint64_t timestamp, bool enabled) {
+    if (!enabled) {
+      dumping_ = false;
+      return;
+    }
+    if (ring_size_ != 0 && (timestamp - segment_start_) >= ring_size_) {
+      // overwrite the older segment
+      trace_->close();
+      segment_ ^= 1;
+      segment_start_ = timestamp;
+      trace_->open(this->filename().c_str());
+    }
+    dumping_ = true;
+    last_dump_ = timestamp;
+    trace_->dump(timestamp);
+  }
+
+private:
+
+  std::string filename() const {
+    if (0 == ring_size_)
+      return basename_ + "." + EXTENSION;
+    return basename_ + "." + std::to_string(segment_) + "." + EXTENSION;
+  }
+
+  static void flush_cb(void* arg) {
+    auto self = reinterpret_cast<VlTrace*>(arg);
+    self->trace_->flush();
+    if (self->ring_size_ != 0 && self->dumping_) {
+      std::cout << "Flight recorder: cycles up to " << (self->last_dump_ / 2)
+                << " in " << self->basename_ << ".{0,1}." << EXTENSION << std::endl;
+    }
+  }
+
+  trace_file_t* trace_;
+  std::string basename_;
+  uint64_t ring_size_;
+  uint32_t segment_;
+  uint64_t segment_start_;
+  uint64_t last_dump_;
+  bool dumping_;
+};
+
+}
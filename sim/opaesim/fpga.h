@@ -34,6 +34,12 @@ typedef enum {
 	FPGA_RECONF_ERROR    /**< Error while reconfiguring FPGA */
 } fpga_result;
 
+typedef enum {
+	FPGA_BUF_PREALLOCATED = (1u << 0), /**< Use existing buffer */
+	FPGA_BUF_QUIET = (1u << 1),        /**< Suppress error messages */
+	FPGA_BUF_READ_ONLY = (1u << 2)     /**< Buffer is read-only */
+} fpga_buffer_flags;
+
 typedef enum { 
 	FPGA_DEVICE = 0,
 	FPGA_ACCELERATOR
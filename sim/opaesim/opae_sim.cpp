@@ -12,19 +12,21 @@
 // limitations under the License.
 
 #include "opae_sim.h"
+#include "fpga.h"
 
 #include <verilated.h>
 #include "Vvortex_afu_shim.h"
 #include "Vvortex_afu_shim__Syms.h"
 
 #ifdef VCD_OUTPUT
-#include <verilated_vcd_c.h>
+#include <vl_trace.h>
 #endif
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <mem.h>
+#include <mempool.h>
 
 #define RAMULATOR
 #include <ramulator/src/Gem5Wrapper.h>
@@ -35,7 +37,12 @@
 #include <vortex_afu.h>
 
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <list>
+#include <new>
 #include <queue>
 #include <unordered_map>
 #include <util.h>
@@ -62,6 +69,8 @@
 #define CCI_RQ_SIZE 16
 #define CCI_WQ_SIZE 16
 
+#define MEM_REQ_POOL_SIZE 64
+
 #ifndef TRACE_START_TIME
 #define TRACE_START_TIME 0ull
 #endif
@@ -78,6 +87,13 @@
 
 #define CPU_GPU_LATENCY 200
 
+// MMIO mailbox states
+#define MMIO_FREE    0 // no request
+#define MMIO_CLAIMED 1 // the host is filling a request
+#define MMIO_READ    2 // read request posted
+#define MMIO_WRITE   3 // write request posted
+#define MMIO_DONE    4 // request completed
+
 using namespace vortex;
 
 static uint64_t timestamp = 0;
@@ -86,7 +102,8 @@ double sc_time_stamp() {
   return timestamp;
 }
 
-static bool trace_enabled = false;
+// set by the DPI trace imports from the model threads
+static std::atomic<bool> trace_enabled(false);
 static uint64_t trace_start_time = TRACE_START_TIME;
 static uint64_t trace_stop_time = TRACE_STOP_TIME;
 
@@ -107,7 +124,11 @@ class opae_sim::Impl {
 public:
   Impl()
   : stop_(false)
-  , host_buffer_ids_(0) {
+  , parked_(false)
+  , mmio_state_(MMIO_FREE)
+  , afu_idle_(true)
+  , host_buffer_ids_(0)
+  , mem_req_pool_(MEM_REQ_POOL_SIZE) {
     // force random values for unitialized signals  
     Verilated::randReset(VERILATOR_RESET_VALUE);
     Verilated::randSeed(50);
@@ -119,10 +140,8 @@ public:
     device_ = new Vvortex_afu_shim();
 
   #ifdef VCD_OUTPUT
-    Verilated::traceEverOn(true);
-    trace_ = new VerilatedVcdC();
-    device_->trace(trace_, 99);
-    trace_->open("trace.vcd");
+    VlTrace::parse_window(&trace_start_time, &trace_stop_time);
+    trace_ = new VlTrace(device_, "trace");
   #endif
 
     ram_ = new RAM(RAM_PAGE_SIZE);
@@ -144,23 +163,22 @@ public:
 
     // launch execution thread
     future_ = std::async(std::launch::async, [&]{                 
-        while (!stop_) {
-            std::lock_guard<std::mutex> guard(mutex_);
-            this->tick();
-        }
+      this->run();
     }); 
   }
 
   ~Impl() {  
     stop_ = true;
+    this->wakeup();
     if (future_.valid()) {
       future_.wait();
     } 
     for (auto& buffer : host_buffers_) {
-      aligned_free(buffer.second.data);
+      if (buffer.second.owned) {
+        aligned_free(buffer.second.data);
+      }
     }   
   #ifdef VCD_OUTPUT
-    trace_->close();
     delete trace_;
   #endif
     delete device_;
@@ -175,20 +193,29 @@ public:
   }
 
   int prepare_buffer(uint64_t len, void **buf_addr, uint64_t *wsid, int flags) {
-    auto alloc = aligned_malloc(len, CACHE_BLOCK_SIZE);
-    if (alloc == NULL)
-      return -1;
-    // set uninitialized data to "baadf00d"
-    for (uint32_t i = 0; i < len; ++i) {
-        ((uint8_t*)alloc)[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
-    }
     host_buffer_t buffer;
-    buffer.data   = (uint64_t*)alloc;
+    if (flags & FPGA_BUF_PREALLOCATED) {
+      // pin the caller's buffer
+      if (*buf_addr == NULL)
+        return -1;
+      buffer.data  = (uint64_t*)*buf_addr;
+      buffer.owned = false;
+    } else {
+      auto alloc = aligned_malloc(len, CACHE_BLOCK_SIZE);
+      if (alloc == NULL)
+        return -1;
+      // set uninitialized data to "baadf00d"
+      for (uint32_t i = 0; i < len; ++i) {
+          ((uint8_t*)alloc)[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
+      }
+      buffer.data  = (uint64_t*)alloc;
+      buffer.owned = true;
+    }
     buffer.size   = len;
-    buffer.ioaddr = uintptr_t(alloc); 
+    buffer.ioaddr = uintptr_t(buffer.data); 
     auto buffer_id = host_buffer_ids_++;
     host_buffers_.emplace(buffer_id, buffer);
-    *buf_addr = alloc;
+    *buf_addr = buffer.data;
     *wsid = buffer_id;
     return 0;
   }
@@ -196,7 +223,9 @@ public:
   void release_buffer(uint64_t wsid) {
     auto it = host_buffers_.find(wsid);
     if (it != host_buffers_.end()) {
-      aligned_free(it->second.data);
+      if (it->second.owned) {
+        aligned_free(it->second.data);
+      }
       host_buffers_.erase(it);
     }
   }
@@ -206,42 +235,119 @@ public:
   }
 
   void read_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t *value) {
-    std::lock_guard<std::mutex> guard(mutex_);
+    *value = this->mmio_request(MMIO_READ, offset, 0);
+  }
 
-    // simulate CPU-GPU latency
-    for (uint32_t i = 0; i < CPU_GPU_LATENCY; ++i) 
-      this->tick();
+  void write_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t value) {
+    this->mmio_request(MMIO_WRITE, offset, value);
+  }
 
-    // simulate mmio request
-    device_->vcp2af_sRxPort_c0_mmioRdValid = 1;
-    device_->vcp2af_sRxPort_c0_ReqMmioHdr_address = offset / 4;
-    device_->vcp2af_sRxPort_c0_ReqMmioHdr_length = 1;
-    device_->vcp2af_sRxPort_c0_ReqMmioHdr_tid = 0;
-    this->tick();
-    device_->vcp2af_sRxPort_c0_mmioRdValid = 0;
-    assert(device_->af2cp_sTxPort_c2_mmioRdValid);  
-    *value = device_->af2cp_sTxPort_c2_data;
+private:
+
+  // post a request to the MMIO mailbox and wait for its completion
+  uint64_t mmio_request(uint32_t type, uint64_t offset, uint64_t value) {
+    // claim the mailbox
+    uint32_t expected = MMIO_FREE;
+    while (!mmio_state_.compare_exchange_weak(expected, MMIO_CLAIMED, std::memory_order_acquire)) {
+      expected = MMIO_FREE;
+      std::this_thread::yield();
+    }
+    mmio_offset_ = offset;
+    mmio_value_  = value;
+    mmio_state_.store(type);
+    if (parked_) {
+      this->wakeup();
+    }
+
+    // the simulation keeps running while we wait
+    while (mmio_state_.load(std::memory_order_acquire) != MMIO_DONE) {
+      std::this_thread::yield();
+    }
+    value = mmio_value_;
+    mmio_state_.store(MMIO_FREE, std::memory_order_release);
+    return value;
   }
 
-  void write_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t value) {
+  void wakeup() {
     std::lock_guard<std::mutex> guard(mutex_);
+    cv_.notify_one();
+  }
 
-    // simulate CPU-GPU latency
-    for (uint32_t i = 0; i < CPU_GPU_LATENCY; ++i) 
+  // simulation thread
+  void run() {
+    uint32_t mmio_delay = 0;
+    bool mmio_active = false;
+    while (!stop_) {
+      auto state = mmio_state_.load(std::memory_order_acquire);
+      bool mmio_posted = (state == MMIO_READ || state == MMIO_WRITE);
+      if (!mmio_posted && this->idle()) {
+        // park until the host posts the next request
+        std::unique_lock<std::mutex> lock(mutex_);
+        parked_ = true;
+        cv_.wait(lock, [&]{ 
+          auto state = mmio_state_.load();
+          return stop_ || state == MMIO_READ || state == MMIO_WRITE; 
+        });
+        parked_ = false;
+        continue;
+      }
+      if (mmio_posted) {
+        // simulate CPU-GPU latency
+        if (!mmio_active) {
+          mmio_active = true;
+          mmio_delay = CPU_GPU_LATENCY;
+        }
+        if (0 == mmio_delay) {
+          this->mmio_bus(state == MMIO_WRITE);
+          mmio_active = false;
+          continue;
+        }
+        --mmio_delay;
+      }
       this->tick();
-    
+    }
+  }
+
+  // the AFU reported idle on its last status read, and no traffic is in flight
+  bool idle() const {
+    if (!afu_idle_ 
+     || !cci_reads_.empty() 
+     || !cci_writes_.empty() 
+     || !dram_queue_.empty())
+      return false;
+    for (int b = 0; b < MEMORY_BANKS; ++b) {
+      if (!pending_mem_reqs_[b].empty())
+        return false;
+    }
+    return true;
+  }
+
+  void mmio_bus(bool write) {
     // simulate mmio request
-    device_->vcp2af_sRxPort_c0_mmioWrValid = 1;  
-    device_->vcp2af_sRxPort_c0_ReqMmioHdr_address = offset / 4;
+    device_->vcp2af_sRxPort_c0_ReqMmioHdr_address = mmio_offset_ / 4;
     device_->vcp2af_sRxPort_c0_ReqMmioHdr_length = 1;
     device_->vcp2af_sRxPort_c0_ReqMmioHdr_tid = 0;
-    memcpy(device_->vcp2af_sRxPort_c0_data, &value, 8);
-    this->tick();
-    device_->vcp2af_sRxPort_c0_mmioWrValid = 0;
+    if (write) {
+      device_->vcp2af_sRxPort_c0_mmioWrValid = 1;  
+      memcpy(device_->vcp2af_sRxPort_c0_data, &mmio_value_, 8);
+      this->tick();
+      device_->vcp2af_sRxPort_c0_mmioWrValid = 0;
+      // commands start the AFU
+      afu_idle_ = false;
+    } else {
+      device_->vcp2af_sRxPort_c0_mmioRdValid = 1;
+      this->tick();
+      device_->vcp2af_sRxPort_c0_mmioRdValid = 0;
+      assert(device_->af2cp_sTxPort_c2_mmioRdValid);  
+      mmio_value_ = device_->af2cp_sTxPort_c2_data;
+      // idle state with no console output pending
+      if ((mmio_offset_ / 4) == AFU_IMAGE_MMIO_STATUS) {
+        afu_idle_ = (0 == (mmio_value_ & 0x1ff));
+      }
+    }
+    mmio_state_.store(MMIO_DONE, std::memory_order_release);
   }
 
-private:
-
   void reset() {  
     cci_reads_.clear();
     cci_writes_.clear();
@@ -253,6 +359,9 @@ private:
     device_->vcp2af_sRxPort_c1_TxAlmFull = 0;
 
     for (int b = 0; b < MEMORY_BANKS; ++b) {
+      for (auto mem_req : pending_mem_reqs_[b]) {
+        mem_req_pool_.deallocate(mem_req);
+      }
       pending_mem_reqs_[b].clear();
       device_->avs_readdatavalid[b] = 0;  
       device_->avs_waitrequest[b] = 0;
@@ -312,9 +421,7 @@ private:
   void eval() {
     device_->eval();
   #ifdef VCD_OUTPUT
-    if (sim_trace_enabled()) {
-      trace_->dump(timestamp);
-    }
+    trace_->dump(timestamp, sim_trace_enabled());
   #endif
     ++timestamp;
   }
@@ -411,7 +518,7 @@ private:
         memcpy(device_->avs_readdata[b], mem_req->data.data(), MEM_BLOCK_SIZE);
         uint32_t addr = mem_req->addr;
         pending_mem_reqs_[b].erase(mem_rd_it);
-        delete mem_req;
+        mem_req_pool_.deallocate(mem_req);
       }
 
       // process memory requests
@@ -420,11 +527,7 @@ private:
       if (device_->avs_write[b]) {           
         uint64_t byteen = device_->avs_byteenable[b];        
         uint8_t* data = (uint8_t*)(device_->avs_writedata[b].data());
-        for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-          if ((byteen >> i) & 0x1) {            
-            (*ram_)[byte_addr + i] = data[i];
-          }
-        }
+        ram_->write(data, byte_addr, MEM_BLOCK_SIZE, byteen);
 
         /*printf("%0ld: [sim] MEM Wr Req: bank=%d, addr=%x, data=", timestamp, b, byte_addr);
         for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
@@ -441,7 +544,7 @@ private:
         dram_queue_.push(dram_req);
       } else
       if (device_->avs_read[b]) {
-        auto mem_req = new mem_rd_req_t();
+        auto mem_req = new (mem_req_pool_.allocate()) mem_rd_req_t();
         mem_req->addr = device_->avs_address[b];
         ram_->read(mem_req->data.data(), byte_addr, MEM_BLOCK_SIZE);      
         mem_req->ready = false;
@@ -494,21 +597,34 @@ private:
     uint64_t* data;
     size_t    size;
     uint64_t  ioaddr;  
+    bool      owned;
   } host_buffer_t;
 
   std::future<void> future_;
-  bool stop_;
+  std::atomic<bool> stop_;
+  std::atomic<bool> parked_;
+
+  // MMIO mailbox, the request fields are owned by the side that set the state
+  std::atomic<uint32_t> mmio_state_;
+  uint64_t mmio_offset_;
+  uint64_t mmio_value_;
+
+  bool afu_idle_;
 
   std::unordered_map<int64_t, host_buffer_t> host_buffers_;
   int64_t host_buffer_ids_;
 
+  // Avalon-MM read responses carry no tag, they are returned in request order
   std::list<mem_rd_req_t*> pending_mem_reqs_[MEMORY_BANKS];
 
+  MemoryPool<mem_rd_req_t> mem_req_pool_;
+
   std::list<cci_rd_req_t> cci_reads_;
 
   std::list<cci_wr_req_t> cci_writes_;
 
   std::mutex mutex_;
+  std::condition_variable cv_;
 
   RAM* ram_;
 
@@ -518,7 +634,7 @@ private:
 
   Vvortex_afu_shim *device_;
 #ifdef VCD_OUTPUT
-  VerilatedVcdC *trace_;
+  VlTrace *trace_;
 #endif
 };
 
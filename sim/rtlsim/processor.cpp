@@ -24,7 +24,7 @@
 #endif
 
 #ifdef VCD_OUTPUT
-#include <verilated_vcd_c.h>
+#include <vl_trace.h>
 #endif
 
 #include <iostream>
@@ -39,6 +39,12 @@
 #include <vector>
 #include <sstream> 
 #include <unordered_map>
+#include <atomic>
+#include <deque>
+#include <random>
+#include <new>
+#include <mempool.h>
+#include <checkpoint.h>
 
 #define RAMULATOR
 #include <ramulator/src/Gem5Wrapper.h>
@@ -69,6 +75,29 @@
 #define VERILATOR_RESET_VALUE 2
 #endif
 
+// memory response ordering policies
+#define MEM_RSP_ORDER_REQUEST    0 // in request order
+#define MEM_RSP_ORDER_COMPLETION 1 // as soon as the DRAM access completes
+#define MEM_RSP_ORDER_RANDOM     2 // random pick among completed accesses
+
+#ifndef MEM_RSP_ORDER
+#define MEM_RSP_ORDER MEM_RSP_ORDER_COMPLETION
+#endif
+
+#define MEM_REQ_POOL_SIZE 64
+
+// analytical DRAM channel latency (in memory cycles)
+#ifndef MEM_LATENCY
+#define MEM_LATENCY 24
+#endif
+
+// the AXI bus has a port per memory bank
+#ifdef AXI_BUS
+#define MEM_PORTS MEMORY_BANKS
+#else
+#define MEM_PORTS 1
+#endif
+
 #if (XLEN == 32)
 typedef uint32_t Word;
 #elif (XLEN == 64)
@@ -90,7 +119,8 @@ double sc_time_stamp() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static bool trace_enabled = false;
+// set by the DPI trace imports from the model threads
+static std::atomic<bool> trace_enabled(false);
 static uint64_t trace_start_time = TRACE_START_TIME;
 static uint64_t trace_stop_time  = TRACE_STOP_TIME;
 
@@ -105,11 +135,16 @@ void sim_trace_enable(bool enable) {
   trace_enabled = enable;
 }
 
+void dpi_restore_state(const vortex::Checkpoint* checkpoint);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class Processor::Impl {
 public:
-  Impl() {
+  Impl() 
+  : mem_req_pool_(MEM_REQ_POOL_SIZE)
+  , mem_epoch_(0)
+  , mem_cycles_(0) {
     // force random values for unitialized signals  
     Verilated::randReset(VERILATOR_RESET_VALUE);
     Verilated::randSeed(50);
@@ -125,15 +160,24 @@ public:
   #endif
 
   #ifdef VCD_OUTPUT
-    Verilated::traceEverOn(true);
-    trace_ = new VerilatedVcdC();
-    device_->trace(trace_, 99);
-    trace_->open("trace.vcd");
+    VlTrace::parse_window(&trace_start_time, &trace_stop_time);
+    trace_ = new VlTrace(device_, "trace");
   #endif
 
     ram_ = nullptr;
+
+    rsp_rng_.seed(50);
+
+    // RTLSIM_RESTORE=<file>: resume the first kernel from a simx checkpoint
+    auto restore = getenv("RTLSIM_RESTORE");
+    if (restore && restore[0]) {
+      restore_file_ = restore;
+    }
     
-    // initialize dram simulator
+  #ifdef MEM_ANALYTICAL
+    dram_ = nullptr;
+  #else
+    // initialize dram simulator, a channel per memory bank
     ramulator::Config ram_config;
     ram_config.add("standard", "DDR4");
     ram_config.add("channels", std::to_string(MEMORY_BANKS));
@@ -144,6 +188,7 @@ public:
     ram_config.set_core_num(1);
     dram_ = new ramulator::Gem5Wrapper(ram_config, MEM_BLOCK_SIZE);
     Stats::statlist.output("ramulator.ddr4.log");
+  #endif
 
     // reset the device
     this->reset();
@@ -156,7 +201,6 @@ public:
     this->cout_flush();
 
   #ifdef VCD_OUTPUT
-    trace_->close();
     delete trace_;
   #endif
     
@@ -189,6 +233,11 @@ public:
     std::cout << std::dec << timestamp << ": [sim] run()" << std::endl;
   #endif
 
+    if (!restore_file_.empty()) {
+      if (!this->restore())
+        return -1;
+    }
+
     // start execution
     running_ = true;
     device_->reset = 0;
@@ -208,6 +257,7 @@ public:
     }
     
     // reset device
+    dpi_restore_state(nullptr);
     this->reset();
 
     this->cout_flush();
@@ -226,15 +276,51 @@ public:
 
 private:
 
+  bool restore() {
+    auto filename = restore_file_;
+    restore_file_.clear();
+    if (!checkpoint_.load(filename, ram_))
+      return false;
+    if (checkpoint_.xlen() != XLEN
+     || checkpoint_.num_cores() != (NUM_CLUSTERS * NUM_CORES)
+     || checkpoint_.num_warps() != NUM_WARPS
+     || checkpoint_.num_threads() != NUM_THREADS) {
+      std::cout << "Error: checkpoint " << filename << " does not match the device configuration" << std::endl;
+      return false;
+    }
+    for (auto& dcr : checkpoint_.dcrs()) {
+      this->write_dcr(dcr.first, dcr.second);
+    }
+    // the warps and registers are loaded through DPI while in reset
+    dpi_restore_state(&checkpoint_);
+    this->reset();
+    std::cout << "Restored checkpoint " << filename << std::endl;
+    return true;
+  }
+
   void reset() {
     running_ = false;
 
     print_bufs_.clear();
 
-    pending_mem_reqs_.clear();
-    
-    mem_rd_rsp_active_ = false;
-    mem_wr_rsp_active_ = false;
+    // requests still in the DRAM are released by their completion
+    ++mem_epoch_;
+    for (auto& port : mem_ports_) {
+      for (auto mem_req : port.pending_reqs) {
+        if (mem_req->ready) {
+          mem_req_pool_.deallocate(mem_req);
+        }
+      }
+      port.pending_reqs.clear();
+      for (auto& ready_rsps : port.ready_rsps) {
+        for (auto mem_req : ready_rsps) {
+          mem_req_pool_.deallocate(mem_req);
+        }
+        ready_rsps.clear();
+      }
+      port.rd_rsp_active = false;
+      port.wr_rsp_active = false;
+    }
 
   #ifdef AXI_BUS
     this->reset_axi_bus();
@@ -279,15 +365,23 @@ private:
     if (MEM_CYCLE_RATIO > 0) { 
       auto cycle = timestamp / 2;
       if ((cycle % MEM_CYCLE_RATIO) == 0)
-        dram_->tick();
+        this->dram_tick();
     } else {
       for (int i = MEM_CYCLE_RATIO; i <= 0; ++i)
-        dram_->tick();            
+        this->dram_tick();            
     }
 
-    if (!dram_queue_.empty()) {
-      if (dram_->send(dram_queue_.front()))
-        dram_queue_.pop();
+    // each bank accepts a request per cycle
+    for (auto& bank : mem_banks_) {
+      if (bank.dram_queue.empty())
+        continue;
+    #ifdef MEM_ANALYTICAL
+      bank.inflight.emplace(mem_cycles_ + MEM_LATENCY, bank.dram_queue.front());
+      bank.dram_queue.pop();
+    #else
+      if (dram_->send(bank.dram_queue.front()))
+        bank.dram_queue.pop();
+    #endif
     }
 
   #ifndef NDEBUG
@@ -295,14 +389,26 @@ private:
   #endif
   }
 
+  void dram_tick() {
+    ++mem_cycles_;
+  #ifdef MEM_ANALYTICAL
+    for (auto& bank : mem_banks_) {
+      while (!bank.inflight.empty() 
+          && bank.inflight.front().first <= mem_cycles_) {
+        auto& dram_req = bank.inflight.front().second;
+        dram_req.callback(dram_req);
+        bank.inflight.pop();
+      }
+    }
+  #else
+    dram_->tick();
+  #endif
+  }
+
   void eval() {
     device_->eval();
   #ifdef VCD_OUTPUT
-    if (sim_trace_enabled()) {
-      trace_->dump(timestamp);
-    } else {
-      exit(-1);
-    }
+    trace_->dump(timestamp, sim_trace_enabled());
   #endif
     ++timestamp;
   }
@@ -310,162 +416,148 @@ private:
 #ifdef AXI_BUS
 
   void reset_axi_bus() {    
-    device_->m_axi_wready[0]  = 0;
-    device_->m_axi_awready[0] = 0;
-    device_->m_axi_arready[0] = 0;  
-    device_->m_axi_rvalid[0]  = 0;
-    device_->m_axi_bvalid[0]  = 0;
+    for (int b = 0; b < MEMORY_BANKS; ++b) {
+      device_->m_axi_wready[b]  = 0;
+      device_->m_axi_awready[b] = 0;
+      device_->m_axi_arready[b] = 0;  
+      device_->m_axi_rvalid[b]  = 0;
+      device_->m_axi_bvalid[b]  = 0;
+    }
   }
     
   void eval_axi_bus(bool clk) {
     if (!clk) {
-      mem_rd_rsp_ready_ = device_->m_axi_rready[0];
-      mem_wr_rsp_ready_ = device_->m_axi_bready[0];
+      for (int b = 0; b < MEMORY_BANKS; ++b) {
+        mem_ports_[b].rd_rsp_ready = device_->m_axi_rready[b];
+        mem_ports_[b].wr_rsp_ready = device_->m_axi_bready[b];
+      }
       return;
     }
 
     if (ram_ == nullptr) {
-      device_->m_axi_wready[0]  = 0;
-      device_->m_axi_awready[0] = 0;
-      device_->m_axi_arready[0] = 0;  
-      return;
-    }
-
-    // process memory responses
-    if (mem_rd_rsp_active_
-    && device_->m_axi_rvalid[0] && mem_rd_rsp_ready_) {
-      mem_rd_rsp_active_ = false;
-    }    
-    if (!mem_rd_rsp_active_) {      
-      if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready 
-       && !(*pending_mem_reqs_.begin())->write) {      
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
-        /*
-          printf("%0ld: [sim] MEM Rd Rsp: bank=%d, addr=%0lx, data=", timestamp, last_mem_rsp_bank_, mem_rsp->addr);
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            printf("%02x", mem_rsp->block[(MEM_BLOCK_SIZE-1)-i]);
-          }
-          printf("\n");
-        */      
-        device_->m_axi_rvalid[0] = 1;
-        device_->m_axi_rid[0]    = mem_rsp->tag;   
-        device_->m_axi_rresp[0]  = 0;
-        device_->m_axi_rlast[0]  = 1;
-        memcpy(device_->m_axi_rdata[0].data(), mem_rsp->block.data(), MEM_BLOCK_SIZE);
-        pending_mem_reqs_.erase(mem_rsp_it);
-        mem_rd_rsp_active_ = true;
-        delete mem_rsp;
-      } else {
-        device_->m_axi_rvalid[0] = 0;
+      for (int b = 0; b < MEMORY_BANKS; ++b) {
+        device_->m_axi_wready[b]  = 0;
+        device_->m_axi_awready[b] = 0;
+        device_->m_axi_arready[b] = 0;  
       }
+      return;
     }
 
-    // send memory write response  
-    if (mem_wr_rsp_active_
-    && device_->m_axi_bvalid[0] && mem_wr_rsp_ready_) {
-      mem_wr_rsp_active_ = false;
-    }
-    if (!mem_wr_rsp_active_) {
-      if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready 
-       && (*pending_mem_reqs_.begin())->write) {
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
-        /*
-          printf("%0ld: [sim] MEM Wr Rsp: bank=%d, addr=%0lx\n", timestamp, last_mem_rsp_bank_, mem_rsp->addr);        
-        */
-        device_->m_axi_bvalid[0] = 1;      
-        device_->m_axi_bid[0]    = mem_rsp->tag;
-        device_->m_axi_bresp[0]  = 0;
-        pending_mem_reqs_.erase(mem_rsp_it);        
-        mem_wr_rsp_active_ = true;
-        delete mem_rsp;
-      } else {
-        device_->m_axi_bvalid[0] = 0;
-      }      
-    }
-
-    // select the memory bank
-    uint32_t req_addr = device_->m_axi_wvalid[0] ? device_->m_axi_awaddr[0] : device_->m_axi_araddr[0];
-    
-    // process memory requests
-    if ((device_->m_axi_wvalid[0] || device_->m_axi_arvalid[0]) && running_) {
-      if (device_->m_axi_wvalid[0]) {        
-        uint64_t byteen = device_->m_axi_wstrb[0];
-        uint64_t base_addr = device_->m_axi_awaddr[0];
-        uint8_t* data = (uint8_t*)device_->m_axi_wdata[0].data();
-
-        // check console output
-        if (base_addr >= uint64_t(IO_COUT_ADDR)
-         && base_addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {          
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            if ((byteen >> i) & 0x1) {            
-              auto& ss_buf = print_bufs_[i];
-              char c = data[i];
-              ss_buf << c;
-              if (c == '\n') {
-                std::cout << std::dec << "#" << i << ": " << ss_buf.str() << std::flush;
-                ss_buf.str("");
-              }
-            }
-          }   
-        } else {
+    for (int b = 0; b < MEMORY_BANKS; ++b) {
+      auto& port = mem_ports_[b];
+
+      // process memory responses
+      if (port.rd_rsp_active
+      && device_->m_axi_rvalid[b] && port.rd_rsp_ready) {
+        port.rd_rsp_active = false;
+      }    
+      if (!port.rd_rsp_active) {      
+        auto mem_rsp = this->pop_mem_rsp(b, false);
+        if (mem_rsp) {
           /*
-            printf("%0ld: [sim] MEM Wr: addr=%0x, byteen=%0lx, data=", timestamp, base_addr, byteen);
+            printf("%0ld: [sim] MEM Rd Rsp: bank=%d, addr=%0lx, data=", timestamp, b, mem_rsp->addr);
             for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-              printf("%02x", data[(MEM_BLOCK_SIZE-1)-i]);
+              printf("%02x", mem_rsp->block[(MEM_BLOCK_SIZE-1)-i]);
             }
             printf("\n");
-          */
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            if ((byteen >> i) & 0x1) {            
-              (*ram_)[base_addr + i] = data[i];
-            }
-          }  
+          */      
+          device_->m_axi_rvalid[b] = 1;
+          device_->m_axi_rid[b]    = mem_rsp->tag;   
+          device_->m_axi_rresp[b]  = 0;
+          device_->m_axi_rlast[b]  = 1;
+          memcpy(device_->m_axi_rdata[b].data(), mem_rsp->block.data(), MEM_BLOCK_SIZE);
+          port.rd_rsp_active = true;
+          mem_req_pool_.deallocate(mem_rsp);
+        } else {
+          device_->m_axi_rvalid[b] = 0;
+        }
+      }
 
-          auto mem_req = new mem_req_t();
-          mem_req->tag   = device_->m_axi_awid[0];
-          mem_req->addr  = device_->m_axi_awaddr[0];        
-          mem_req->write = true;
-          mem_req->ready = true;
-          pending_mem_reqs_.emplace_back(mem_req);
+      // send memory write response  
+      if (port.wr_rsp_active
+      && device_->m_axi_bvalid[b] && port.wr_rsp_ready) {
+        port.wr_rsp_active = false;
+      }
+      if (!port.wr_rsp_active) {
+        auto mem_rsp = this->pop_mem_rsp(b, true);
+        if (mem_rsp) {
+          /*
+            printf("%0ld: [sim] MEM Wr Rsp: bank=%d, addr=%0lx\n", timestamp, b, mem_rsp->addr);        
+          */
+          device_->m_axi_bvalid[b] = 1;      
+          device_->m_axi_bid[b]    = mem_rsp->tag;
+          device_->m_axi_bresp[b]  = 0;
+          port.wr_rsp_active = true;
+          mem_req_pool_.deallocate(mem_rsp);
+        } else {
+          device_->m_axi_bvalid[b] = 0;
+        }      
+      }
+      
+      // process memory requests
+      if ((device_->m_axi_wvalid[b] || device_->m_axi_arvalid[b]) && running_) {
+        if (device_->m_axi_wvalid[b]) {        
+          uint64_t byteen = device_->m_axi_wstrb[b];
+          uint64_t base_addr = this->axi_byte_addr(device_->m_axi_awaddr[b], b);
+          uint8_t* data = (uint8_t*)device_->m_axi_wdata[b].data();
+
+          // check console output
+          if (base_addr >= uint64_t(IO_COUT_ADDR)
+           && base_addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {          
+            for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
+              if ((byteen >> i) & 0x1) {            
+                auto& ss_buf = print_bufs_[i];
+                char c = data[i];
+                ss_buf << c;
+                if (c == '\n') {
+                  std::cout << std::dec << "#" << i << ": " << ss_buf.str() << std::flush;
+                  ss_buf.str("");
+                }
+              }
+            }   
+          } else {
+            /*
+              printf("%0ld: [sim] MEM Wr: bank=%d, addr=%0lx, byteen=%0lx, data=", timestamp, b, base_addr, byteen);
+              for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
+                printf("%02x", data[(MEM_BLOCK_SIZE-1)-i]);
+              }
+              printf("\n");
+            */
+            ram_->write(data, base_addr, MEM_BLOCK_SIZE, byteen);
+
+            auto mem_req = this->push_mem_req(b);
+            mem_req->tag   = device_->m_axi_awid[b];
+            mem_req->addr  = base_addr;        
+            mem_req->write = true;
+            this->mem_req_done(mem_req);
+
+            // send dram request
+            this->dram_send(base_addr, nullptr);
+          }        
+        } else {
+          // process reads
+          uint64_t byte_addr = this->axi_byte_addr(device_->m_axi_araddr[b], b);
+          auto mem_req = this->push_mem_req(b);
+          mem_req->tag   = device_->m_axi_arid[b];
+          mem_req->addr  = byte_addr;
+          mem_req->write = false;
+          ram_->read(mem_req->block.data(), byte_addr, MEM_BLOCK_SIZE);
 
           // send dram request
-          ramulator::Request dram_req( 
-            device_->m_axi_awaddr[0],
-            ramulator::Request::Type::WRITE,
-            0
-          );
-          dram_queue_.push(dram_req);
-        }        
-      } else {
-        // process reads
-        auto mem_req = new mem_req_t();
-        mem_req->tag  = device_->m_axi_arid[0];
-        mem_req->addr = device_->m_axi_araddr[0];
-        ram_->read(mem_req->block.data(), device_->m_axi_araddr[0], MEM_BLOCK_SIZE);
-        mem_req->write = false;
-        mem_req->ready = false;
-        pending_mem_reqs_.emplace_back(mem_req);
-
-        // send dram request
-        ramulator::Request dram_req( 
-          device_->m_axi_araddr[0],
-          ramulator::Request::Type::READ,
-          std::bind([&](ramulator::Request& dram_req, mem_req_t* mem_req) {
-              mem_req->ready = true;
-            }, placeholders::_1, mem_req),
-          0
-        );
-        dram_queue_.push(dram_req);
+          this->dram_send(byte_addr, mem_req);
+        } 
       } 
-    } 
 
-    device_->m_axi_wready[0]  = running_;
-    device_->m_axi_awready[0] = running_;
-    device_->m_axi_arready[0] = running_;     
+      device_->m_axi_wready[b]  = running_;
+      device_->m_axi_awready[b] = running_;
+      device_->m_axi_arready[b] = running_;     
+    }
+  }
+
+  // the AXI adapter interleaves the memory blocks across the banks
+  // and passes each bank its local byte address
+  static uint64_t axi_byte_addr(uint64_t bank_addr, uint32_t bank) {
+    return ((bank_addr / MEM_BLOCK_SIZE) * MEMORY_BANKS + bank) * MEM_BLOCK_SIZE;
   }
 
 #else
@@ -477,7 +569,7 @@ private:
 
   void eval_avs_bus(bool clk) {
     if (!clk) {
-      mem_rd_rsp_ready_ = device_->mem_rsp_ready;
+      mem_ports_[0].rd_rsp_ready = device_->mem_rsp_ready;
       return;
     }
 
@@ -487,16 +579,15 @@ private:
     }
 
     // process memory responses    
-    if (mem_rd_rsp_active_
-    && device_->mem_rsp_valid && mem_rd_rsp_ready_) {
-      mem_rd_rsp_active_ = false;
+    auto& port = mem_ports_[0];
+    if (port.rd_rsp_active
+    && device_->mem_rsp_valid && port.rd_rsp_ready) {
+      port.rd_rsp_active = false;
     }
-    if (!mem_rd_rsp_active_) {
-      if (!pending_mem_reqs_.empty()
-       && (*pending_mem_reqs_.begin())->ready) {
+    if (!port.rd_rsp_active) {
+      auto mem_rsp = this->pop_mem_rsp(0, false);
+      if (mem_rsp) {
         device_->mem_rsp_valid = 1;      
-        auto mem_rsp_it = pending_mem_reqs_.begin();
-        auto mem_rsp = *mem_rsp_it;
         /*
           printf("%0ld: [sim] MEM Rd: bank=%d, tag=%0lx, addr=%0lx, data=", timestamp, last_mem_rsp_bank_, mem_rsp->tag, mem_rsp->addr);
           for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
@@ -506,9 +597,8 @@ private:
         */
         memcpy(device_->mem_rsp_data.data(), mem_rsp->block.data(), MEM_BLOCK_SIZE);
         device_->mem_rsp_tag = mem_rsp->tag;   
-        pending_mem_reqs_.erase(mem_rsp_it);
-        mem_rd_rsp_active_ = true;
-        delete mem_rsp;
+        port.rd_rsp_active = true;
+        mem_req_pool_.deallocate(mem_rsp);
       } else {
         device_->mem_rsp_valid = 0;
       }
@@ -544,42 +634,23 @@ private:
             }
             printf("\n");
           */
-          for (int i = 0; i < MEM_BLOCK_SIZE; i++) {
-            if ((byteen >> i) & 0x1) {            
-              (*ram_)[byte_addr + i] = data[i];
-            }
-          }
+          ram_->write(data, byte_addr, MEM_BLOCK_SIZE, byteen);
 
           // send dram request
-          ramulator::Request dram_req( 
-            byte_addr,
-            ramulator::Request::Type::WRITE,
-            0
-          );
-          dram_queue_.push(dram_req);
+          this->dram_send(byte_addr, nullptr);
         }         
       } else {
         // process reads
-        auto mem_req = new mem_req_t();
+        auto mem_req = this->push_mem_req(0);
         mem_req->tag   = device_->mem_req_tag;   
         mem_req->addr  = byte_addr;
         mem_req->write = false;
-        mem_req->ready = false;
         ram_->read(mem_req->block.data(), byte_addr, MEM_BLOCK_SIZE);
-        pending_mem_reqs_.emplace_back(mem_req);
 
         //printf("%0ld: [sim] MEM Rd Req: addr=%0x, tag=%0lx\n", timestamp, byte_addr, device_->mem_req_tag);
 
         // send dram request
-        ramulator::Request dram_req( 
-          byte_addr,
-          ramulator::Request::Type::READ,
-          std::bind([&](ramulator::Request& dram_req, mem_req_t* mem_req) {
-              mem_req->ready = true;
-            }, placeholders::_1, mem_req),
-          0
-        );
-        dram_queue_.push(dram_req);
+        this->dram_send(byte_addr, mem_req);
       }
     }   
 
@@ -631,32 +702,129 @@ private:
     uint64_t addr;
     uint64_t tag;
     bool write;
+    uint32_t port;
+    uint32_t epoch;
   } mem_req_t;
 
+  typedef struct {
+    // outstanding requests in request order (MEM_RSP_ORDER_REQUEST)
+    std::list<mem_req_t*> pending_reqs;
+    // completed reads and writes in completion order
+    std::deque<mem_req_t*> ready_rsps[2];
+    bool rd_rsp_active;
+    bool rd_rsp_ready;
+    bool wr_rsp_active;
+    bool wr_rsp_ready;
+  } mem_port_t;
+
+  typedef struct {
+    std::queue<ramulator::Request> dram_queue;
+  #ifdef MEM_ANALYTICAL
+    // accepted requests with their completion cycle
+    std::queue<std::pair<uint64_t, ramulator::Request>> inflight;
+  #endif
+  } mem_bank_t;
+
+  // allocate a memory request, tracked in request order when responses are in-order
+  mem_req_t* push_mem_req(uint32_t port) {
+    auto mem_req = new (mem_req_pool_.allocate()) mem_req_t();
+    mem_req->ready = false;
+    mem_req->port  = port;
+    mem_req->epoch = mem_epoch_;
+  #if (MEM_RSP_ORDER == MEM_RSP_ORDER_REQUEST)
+    mem_ports_[port].pending_reqs.push_back(mem_req);
+  #endif
+    return mem_req;
+  }
+
+  // the DRAM access of a request has completed
+  void mem_req_done(mem_req_t* mem_req) {
+    if (mem_req->epoch != mem_epoch_) {
+      // issued before the last reset
+      mem_req_pool_.deallocate(mem_req);
+      return;
+    }
+    mem_req->ready = true;
+  #if (MEM_RSP_ORDER != MEM_RSP_ORDER_REQUEST)
+    mem_ports_[mem_req->port].ready_rsps[mem_req->write].push_back(mem_req);
+  #endif
+  }
+
+  // returns the next read or write response to send, nullptr if none is ready
+  mem_req_t* pop_mem_rsp(uint32_t port, bool write) {
+  #if (MEM_RSP_ORDER == MEM_RSP_ORDER_REQUEST)
+    // the oldest request blocks the younger ones
+    auto& pending_reqs = mem_ports_[port].pending_reqs;
+    if (pending_reqs.empty())
+      return nullptr;
+    auto mem_req = pending_reqs.front();
+    if (!mem_req->ready || mem_req->write != write)
+      return nullptr;
+    pending_reqs.pop_front();
+    return mem_req;
+  #else
+    auto& ready_rsps = mem_ports_[port].ready_rsps[write];
+    if (ready_rsps.empty())
+      return nullptr;
+    size_t index = 0;
+  #if (MEM_RSP_ORDER == MEM_RSP_ORDER_RANDOM)
+    index = rsp_rng_() % ready_rsps.size();
+  #endif
+    auto mem_req = ready_rsps.at(index);
+    ready_rsps.erase(ready_rsps.begin() + index);
+    return mem_req;
+  #endif
+  }
+
+  // queue a DRAM access on the bank of the block, reads complete mem_req
+  void dram_send(uint64_t byte_addr, mem_req_t* mem_req) {
+    auto& bank = mem_banks_[(byte_addr / MEM_BLOCK_SIZE) % MEMORY_BANKS];
+    if (mem_req) {
+      bank.dram_queue.emplace( 
+        byte_addr,
+        ramulator::Request::Type::READ,
+        std::bind([this](ramulator::Request&, mem_req_t* mem_req) {
+            this->mem_req_done(mem_req);
+          }, placeholders::_1, mem_req),
+        0
+      );
+    } else {
+      bank.dram_queue.emplace( 
+        byte_addr,
+        ramulator::Request::Type::WRITE,
+        0
+      );
+    }
+  }
+
 #ifdef AXI_BUS
   VVortex_axi *device_;
 #else
   VVortex *device_;
 #endif
 #ifdef VCD_OUTPUT
-  VerilatedVcdC *trace_;
+  VlTrace *trace_;
 #endif
 
   std::unordered_map<int, std::stringstream> print_bufs_;
 
-  std::list<mem_req_t*> pending_mem_reqs_;
+  MemoryPool<mem_req_t> mem_req_pool_;
+  uint32_t mem_epoch_;
+
+  std::array<mem_port_t, MEM_PORTS> mem_ports_;
 
-  bool mem_rd_rsp_active_;
-  bool mem_rd_rsp_ready_;
+  std::array<mem_bank_t, MEMORY_BANKS> mem_banks_;
 
-  bool mem_wr_rsp_active_;
-  bool mem_wr_rsp_ready_;
+  std::mt19937 rsp_rng_;
 
   RAM *ram_;
 
   ramulator::Gem5Wrapper* dram_;
 
-  std::queue<ramulator::Request> dram_queue_;
+  uint64_t mem_cycles_;
+
+  std::string restore_file_;
+  Checkpoint checkpoint_;
 
   bool running_;
 };
@@ -0,0 +1,206 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "arch.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace vortex;
+
+namespace {
+
+struct param_t {
+  const char* name;
+  uint32_t Arch::* field;
+};
+
+}
+
+bool Arch::set(const std::string& name, uint32_t value) {
+  static const param_t params[] = {
+    {"issue_width",      &Arch::issue_width_},
+    {"num_alu_lanes",    &Arch::num_alu_lanes_},
+    {"num_alu_blocks",   &Arch::num_alu_blocks_},
+    {"num_fpu_lanes",    &Arch::num_fpu_lanes_},
+    {"num_fpu_blocks",   &Arch::num_fpu_blocks_},
+    {"num_lsu_lanes",    &Arch::num_lsu_lanes_},
+    {"num_sfu_lanes",    &Arch::num_sfu_lanes_},
+    {"vlen",             &Arch::vlen_},
+    {"num_vpu_lanes",    &Arch::num_vpu_lanes_},
+    {"ibuf_size",        &Arch::ibuf_size_},
+    {"lsuq_size",        &Arch::lsuq_size_},
+    {"gpr_num_banks",    &Arch::gpr_num_banks_},
+    {"gpr_num_ports",    &Arch::gpr_num_ports_},
+    {"num_opcs",         &Arch::num_opcs_},
+    {"num_icaches",      &Arch::num_icaches_},
+    {"icache_size",      &Arch::icache_size_},
+    {"icache_num_ways",  &Arch::icache_num_ways_},
+    {"num_dcaches",      &Arch::num_dcaches_},
+    {"dcache_size",      &Arch::dcache_size_},
+    {"dcache_num_ways",  &Arch::dcache_num_ways_},
+    {"dcache_num_banks", &Arch::dcache_num_banks_},
+    {"dcache_mshr_size", &Arch::dcache_mshr_size_},
+    {"l2_cache_size",    &Arch::l2_cache_size_},
+    {"l2_num_ways",      &Arch::l2_num_ways_},
+    {"l2_num_banks",     &Arch::l2_num_banks_},
+    {"l2_mshr_size",     &Arch::l2_mshr_size_},
+    {"l3_cache_size",    &Arch::l3_cache_size_},
+    {"l3_num_ways",      &Arch::l3_num_ways_},
+    {"l3_num_banks",     &Arch::l3_num_banks_},
+    {"l3_mshr_size",     &Arch::l3_mshr_size_},
+    {"memory_banks",     &Arch::memory_banks_},
+    {"alu_latency",      &Arch::alu_latency_},
+    {"alu_ii",           &Arch::alu_ii_},
+    {"imul_latency",     &Arch::imul_latency_},
+    {"imul_ii",          &Arch::imul_ii_},
+    {"idiv_latency",     &Arch::idiv_latency_},
+    {"idiv_ii",          &Arch::idiv_ii_},
+    {"fncp_latency",     &Arch::fncp_latency_},
+    {"fncp_ii",          &Arch::fncp_ii_},
+    {"fma_latency",      &Arch::fma_latency_},
+    {"fma_ii",           &Arch::fma_ii_},
+    {"fdiv_latency",     &Arch::fdiv_latency_},
+    {"fdiv_ii",          &Arch::fdiv_ii_},
+    {"fsqrt_latency",    &Arch::fsqrt_latency_},
+    {"fsqrt_ii",         &Arch::fsqrt_ii_},
+    {"fcvt_latency",     &Arch::fcvt_latency_},
+    {"fcvt_ii",          &Arch::fcvt_ii_},
+  };
+
+  if (name == "threads") {
+    num_threads_ = value;
+  } else if (name == "warps") {
+    num_warps_ = value;
+  } else if (name == "cores") {
+    num_cores_ = value;
+  } else if (name == "clusters") {
+    num_clusters_ = value;
+  } else {
+    auto it = std::find_if(std::begin(params), std::end(params), [&](const param_t& param) {
+      return name == param.name;
+    });
+    if (it == std::end(params)) {
+      std::cerr << "error: unknown simx parameter '" << name << "'" << std::endl;
+      return false;
+    }
+    this->*(it->field) = value;
+  }
+  return true;
+}
+
+void Arch::update_derived() {
+  // re-apply the VX_config.h derivations for parameters whose sources
+  // no longer have their build value, unless they were set explicitly.
+  auto derive = [&](const char* name, uint32_t& param, bool source_changed, uint32_t value) {
+    if (source_changed && 0 == overrides_.count(name)) {
+      param = value;
+    }
+  };
+
+  bool threads_changed = (num_threads_ != NUM_THREADS);
+  bool warps_changed = (num_warps_ != NUM_WARPS);
+  bool cores_changed = (num_cores_ != NUM_CORES);
+
+  derive("issue_width", issue_width_, warps_changed, std::min<uint32_t>(num_warps_, 4));
+  bool issue_changed = (issue_width_ != ISSUE_WIDTH);
+
+  derive("num_alu_lanes", num_alu_lanes_, threads_changed, UP(num_threads_ / 2));
+  derive("num_fpu_lanes", num_fpu_lanes_, threads_changed, UP(num_threads_ / 2));
+  derive("num_lsu_lanes", num_lsu_lanes_, threads_changed, std::min<uint32_t>(num_threads_, 4));
+  derive("num_sfu_lanes", num_sfu_lanes_, threads_changed, std::min<uint32_t>(num_threads_, 4));
+  derive("num_alu_blocks", num_alu_blocks_, issue_changed, issue_width_);
+  derive("num_fpu_blocks", num_fpu_blocks_, issue_changed, issue_width_);
+  bool lsu_changed = (num_lsu_lanes_ != NUM_LSU_LANES);
+
+  derive("ibuf_size", ibuf_size_, warps_changed || issue_changed, 2 * (num_warps_ / issue_width_));
+  derive("lsuq_size", lsuq_size_, threads_changed || lsu_changed, 2 * (num_threads_ / num_lsu_lanes_));
+
+#if ICACHE_ENABLED
+  derive("num_icaches", num_icaches_, cores_changed, UP(num_cores_ / 4));
+#endif
+#if DCACHE_ENABLED
+  derive("num_dcaches", num_dcaches_, cores_changed, UP(num_cores_ / 4));
+  derive("dcache_num_banks", dcache_num_banks_, lsu_changed, num_lsu_lanes_);
+#endif
+  (void)cores_changed;
+
+  ipdom_size_ = (num_threads_ - 1) * 2;
+}
+
+bool Arch::validate() const {
+  auto check = [](bool cond, const char* message) {
+    if (!cond) {
+      std::cerr << "error: invalid simx configuration: " << message << std::endl;
+    }
+    return cond;
+  };
+  auto pow2 = [](uint32_t value) {
+    return value != 0 && 0 == (value & (value - 1));
+  };
+  return check(num_threads_ >= 1 && num_threads_ <= MAX_NUM_THREADS, "threads out of range")
+      && check(num_warps_ >= 1 && num_warps_ <= MAX_NUM_WARPS, "warps out of range")
+      && check(num_cores_ >= 1 && num_clusters_ >= 1
+            && (num_cores_ * num_clusters_) <= MAX_NUM_CORES, "cores out of range")
+      && check(issue_width_ >= 1 && issue_width_ <= num_warps_
+            && 0 == (num_warps_ % issue_width_), "issue_width must divide warps")
+      && check(num_alu_blocks_ >= 1 && 0 == (issue_width_ % num_alu_blocks_)
+            && num_fpu_blocks_ >= 1 && 0 == (issue_width_ % num_fpu_blocks_), "blocks must divide issue_width")
+      && check(num_alu_lanes_ >= 1 && num_alu_lanes_ <= num_threads_
+            && num_fpu_lanes_ >= 1 && num_fpu_lanes_ <= num_threads_
+            && num_lsu_lanes_ >= 1 && num_lsu_lanes_ <= num_threads_
+            && num_sfu_lanes_ >= 1 && num_sfu_lanes_ <= num_threads_, "lanes must be within [1, threads]")
+      && check(pow2(vlen_) && vlen_ >= 64 && vlen_ <= 65536, "vlen must be a power of two within [64, 65536]")
+      && check(num_vpu_lanes_ >= 1, "num_vpu_lanes must be non-zero")
+      && check(ibuf_size_ >= 1 && lsuq_size_ >= 1, "queue sizes must be non-zero")
+      && check(gpr_num_banks_ >= 1 && gpr_num_ports_ >= 1 && num_opcs_ >= 1,
+               "register banks, ports and operand collectors must be non-zero")
+      && check(num_icaches_ <= num_cores_ && num_dcaches_ <= num_cores_, "more caches than cores")
+      && check(pow2(icache_size_) && pow2(icache_num_ways_)
+            && pow2(dcache_size_) && pow2(dcache_num_ways_) && pow2(dcache_num_banks_)
+            && pow2(l2_cache_size_) && pow2(l2_num_ways_) && pow2(l2_num_banks_)
+            && pow2(l3_cache_size_) && pow2(l3_num_ways_) && pow2(l3_num_banks_), "cache geometry must be a power of two")
+      && check(dcache_mshr_size_ >= 1 && l2_mshr_size_ >= 1 && l3_mshr_size_ >= 1, "mshr sizes must be non-zero")
+      && check(memory_banks_ >= 1, "memory_banks must be non-zero")
+      && check(alu_latency_ >= 1 && alu_ii_ >= 1 && imul_latency_ >= 1 && imul_ii_ >= 1
+            && idiv_latency_ >= 1 && idiv_ii_ >= 1 && fncp_latency_ >= 1 && fncp_ii_ >= 1
+            && fma_latency_ >= 1 && fma_ii_ >= 1 && fdiv_latency_ >= 1 && fdiv_ii_ >= 1
+            && fsqrt_latency_ >= 1 && fsqrt_ii_ >= 1 && fcvt_latency_ >= 1 && fcvt_ii_ >= 1,
+               "functional unit latencies and initiation intervals must be non-zero");
+}
+
+bool Arch::configure(const std::string& config) {
+  std::stringstream ss(config);
+  std::string entry;
+  while (std::getline(ss, entry, ',')) {
+    if (entry.empty())
+      continue;
+    auto pos = entry.find('=');
+    if (pos == std::string::npos) {
+      std::cerr << "error: invalid simx parameter '" << entry << "', expected name=value" << std::endl;
+      return false;
+    }
+    auto name = entry.substr(0, pos);
+    auto value_str = entry.substr(pos + 1);
+    char* end = nullptr;
+    auto value = strtoul(value_str.c_str(), &end, 0);
+    if (value_str.empty() || *end != '\0') {
+      std::cerr << "error: invalid value '" << value_str << "' for simx parameter '" << name << "'" << std::endl;
+      return false;
+    }
+    if (!this->set(name, value))
+      return false;
+    overrides_.insert(name);
+  }
+  this->update_derived();
+  return this->validate();
+}
@@ -15,10 +15,12 @@
 
 #include <string>
 #include <sstream>
+#include <set>
 
 #include <cstdlib>
 #include <stdio.h>
 #include "types.h"
+#include "constants.h"
 
 namespace vortex {
 
@@ -28,11 +30,69 @@ private:
   uint16_t num_warps_;
   uint16_t num_cores_;  
   uint16_t num_clusters_;  
-  uint16_t vsize_;
   uint16_t num_regs_;
   uint16_t num_csrs_;
   uint16_t num_barriers_;
   uint16_t ipdom_size_;
+
+  // microarchitecture parameters, defaults come from VX_config.h
+  uint32_t issue_width_;
+  uint32_t num_alu_lanes_;
+  uint32_t num_alu_blocks_;
+  uint32_t num_fpu_lanes_;
+  uint32_t num_fpu_blocks_;
+  uint32_t num_lsu_lanes_;
+  uint32_t num_sfu_lanes_;
+  uint32_t vlen_;
+  uint32_t num_vpu_lanes_;
+  uint32_t ibuf_size_;
+  uint32_t lsuq_size_;
+  uint32_t gpr_num_banks_;
+  uint32_t gpr_num_ports_;
+  uint32_t num_opcs_;
+  uint32_t num_icaches_;
+  uint32_t icache_size_;
+  uint32_t icache_num_ways_;
+  uint32_t num_dcaches_;
+  uint32_t dcache_size_;
+  uint32_t dcache_num_ways_;
+  uint32_t dcache_num_banks_;
+  uint32_t dcache_mshr_size_;
+  uint32_t l2_cache_size_;
+  uint32_t l2_num_ways_;
+  uint32_t l2_num_banks_;
+  uint32_t l2_mshr_size_;
+  uint32_t l3_cache_size_;
+  uint32_t l3_num_ways_;
+  uint32_t l3_num_banks_;
+  uint32_t l3_mshr_size_;
+  uint32_t memory_banks_;
+
+  // functional unit latencies and initiation intervals, in cycles
+  uint32_t alu_latency_;
+  uint32_t alu_ii_;
+  uint32_t imul_latency_;
+  uint32_t imul_ii_;
+  uint32_t idiv_latency_;
+  uint32_t idiv_ii_;
+  uint32_t fncp_latency_;
+  uint32_t fncp_ii_;
+  uint32_t fma_latency_;
+  uint32_t fma_ii_;
+  uint32_t fdiv_latency_;
+  uint32_t fdiv_ii_;
+  uint32_t fsqrt_latency_;
+  uint32_t fsqrt_ii_;
+  uint32_t fcvt_latency_;
+  uint32_t fcvt_ii_;
+
+  std::set<std::string> overrides_;
+
+  bool set(const std::string& name, uint32_t value);
+
+  void update_derived();
+
+  bool validate() const;
   
 public:
   Arch(uint16_t num_threads, uint16_t num_warps, uint16_t num_cores, uint16_t num_clusters)   
@@ -40,15 +100,80 @@ public:
     , num_warps_(num_warps)
     , num_cores_(num_cores)
     , num_clusters_(num_clusters)
-    , vsize_(16)
     , num_regs_(32)
     , num_csrs_(4096)
     , num_barriers_(NUM_BARRIERS)
     , ipdom_size_((num_threads-1) * 2)
-  {}
+    , issue_width_(ISSUE_WIDTH)
+    , num_alu_lanes_(NUM_ALU_LANES)
+    , num_alu_blocks_(NUM_ALU_BLOCKS)
+    , num_fpu_lanes_(NUM_FPU_LANES)
+    , num_fpu_blocks_(NUM_FPU_BLOCKS)
+    , num_lsu_lanes_(NUM_LSU_LANES)
+    , num_sfu_lanes_(NUM_SFU_LANES)
+    , vlen_(128)
+    , num_vpu_lanes_(4)
+    , ibuf_size_(IBUF_SIZE)
+    , lsuq_size_(LSUQ_SIZE)
+    , gpr_num_banks_(1)
+    , gpr_num_ports_(1)
+    , num_opcs_(1)
+    , num_icaches_(NUM_ICACHES)
+    , icache_size_(ICACHE_SIZE)
+    , icache_num_ways_(ICACHE_NUM_WAYS)
+    , num_dcaches_(NUM_DCACHES)
+    , dcache_size_(DCACHE_SIZE)
+    , dcache_num_ways_(DCACHE_NUM_WAYS)
+    , dcache_num_banks_(DCACHE_NUM_BANKS)
+    , dcache_mshr_size_(DCACHE_MSHR_SIZE)
+    , l2_cache_size_(L2_CACHE_SIZE)
+    , l2_num_ways_(L2_NUM_WAYS)
+    , l2_num_banks_(L2_NUM_BANKS)
+    , l2_mshr_size_(L2_MSHR_SIZE)
+    , l3_cache_size_(L3_CACHE_SIZE)
+    , l3_num_ways_(L3_NUM_WAYS)
+    , l3_num_banks_(L3_NUM_BANKS)
+    , l3_mshr_size_(L3_MSHR_SIZE)
+    , memory_banks_(MEMORY_BANKS)
+    // latencies include the unit's input stage; the integer divider is
+    // iterative, as are FPnew's divide and square root units
+    , alu_latency_(LATENCY_IMUL+1)
+    , alu_ii_(1)
+    , imul_latency_(LATENCY_IMUL+1)
+    , imul_ii_(1)
+    , idiv_latency_(XLEN+1)
+    , idiv_ii_(XLEN)
+    , fncp_latency_(LATENCY_FNCP)
+    , fncp_ii_(1)
+    , fma_latency_(LATENCY_FMA+1)
+    , fma_ii_(1)
+    , fdiv_latency_(LATENCY_FDIV+1)
+#ifdef FPU_FPNEW
+    , fdiv_ii_(LATENCY_FDIV)
+#else
+    , fdiv_ii_(1)
+#endif
+    , fsqrt_latency_(LATENCY_FSQRT+1)
+#ifdef FPU_FPNEW
+    , fsqrt_ii_(LATENCY_FSQRT)
+#else
+    , fsqrt_ii_(1)
+#endif
+    , fcvt_latency_(LATENCY_FCVT+1)
+    , fcvt_ii_(1)
+  {
+    this->update_derived();
+  }
 
-  uint16_t vsize() const { 
-    return vsize_; 
+  // Override parameters from a "name=value[,name=value...]" list.
+  // Parameters derived from an overridden one in VX_config.h (e.g. issue_width
+  // from warps) follow it unless they are overridden as well.
+  // Returns false with an error message on unknown names or invalid values.
+  bool configure(const std::string& config);
+
+  // vector register width in bits
+  uint32_t vlen() const { 
+    return vlen_; 
   }
 
   uint16_t num_regs() const {
@@ -82,6 +207,159 @@ public:
   uint16_t num_clusters() const {
     return num_clusters_;
   }
+
+  uint32_t issue_width() const {
+    return issue_width_;
+  }
+
+  uint32_t num_alu_lanes() const {
+    return num_alu_lanes_;
+  }
+
+  uint32_t num_alu_blocks() const {
+    return num_alu_blocks_;
+  }
+
+  uint32_t num_fpu_lanes() const {
+    return num_fpu_lanes_;
+  }
+
+  uint32_t num_fpu_blocks() const {
+    return num_fpu_blocks_;
+  }
+
+  uint32_t num_lsu_lanes() const {
+    return num_lsu_lanes_;
+  }
+
+  uint32_t num_sfu_lanes() const {
+    return num_sfu_lanes_;
+  }
+
+  // elements the vector unit processes per cycle
+  uint32_t num_vpu_lanes() const {
+    return num_vpu_lanes_;
+  }
+
+  uint32_t ibuf_size() const {
+    return ibuf_size_;
+  }
+
+  uint32_t lsuq_size() const {
+    return lsuq_size_;
+  }
+
+  // register file banks and read ports per bank of an issue slot
+  uint32_t gpr_num_banks() const {
+    return gpr_num_banks_;
+  }
+
+  uint32_t gpr_num_ports() const {
+    return gpr_num_ports_;
+  }
+
+  // operand collectors per issue slot
+  uint32_t num_opcs() const {
+    return num_opcs_;
+  }
+
+  uint32_t num_icaches() const {
+    return num_icaches_;
+  }
+
+  uint32_t icache_size() const {
+    return icache_size_;
+  }
+
+  uint32_t icache_num_ways() const {
+    return icache_num_ways_;
+  }
+
+  uint32_t num_dcaches() const {
+    return num_dcaches_;
+  }
+
+  uint32_t dcache_size() const {
+    return dcache_size_;
+  }
+
+  uint32_t dcache_num_ways() const {
+    return dcache_num_ways_;
+  }
+
+  uint32_t dcache_num_banks() const {
+    return dcache_num_banks_;
+  }
+
+  uint32_t dcache_mshr_size() const {
+    return dcache_mshr_size_;
+  }
+
+  uint32_t l2_cache_size() const {
+    return l2_cache_size_;
+  }
+
+  uint32_t l2_num_ways() const {
+    return l2_num_ways_;
+  }
+
+  uint32_t l2_num_banks() const {
+    return l2_num_banks_;
+  }
+
+  uint32_t l2_mshr_size() const {
+    return l2_mshr_size_;
+  }
+
+  uint32_t l3_cache_size() const {
+    return l3_cache_size_;
+  }
+
+  uint32_t l3_num_ways() const {
+    return l3_num_ways_;
+  }
+
+  uint32_t l3_num_banks() const {
+    return l3_num_banks_;
+  }
+
+  uint32_t l3_mshr_size() const {
+    return l3_mshr_size_;
+  }
+
+  uint32_t memory_banks() const {
+    return memory_banks_;
+  }
+
+  // cycles from the unit's input to its result
+  uint32_t fu_latency(FuType fu_type) const {
+    switch (fu_type) {
+    case FuType::ALU:   return alu_latency_;
+    case FuType::IMUL:  return imul_latency_;
+    case FuType::IDIV:  return idiv_latency_;
+    case FuType::FNCP:  return fncp_latency_;
+    case FuType::FMA:   return fma_latency_;
+    case FuType::FDIV:  return fdiv_latency_;
+    case FuType::FSQRT: return fsqrt_latency_;
+    case FuType::FCVT:  return fcvt_latency_;
+    default: std::abort();
+    }
+  }
+
+  // cycles between two inputs accepted by the unit, 1 if fully pipelined
+  uint32_t fu_ii(FuType fu_type) const {
+    switch (fu_type) {
+    case FuType::ALU:   return alu_ii_;
+    case FuType::IMUL:  return imul_ii_;
+    case FuType::IDIV:  return idiv_ii_;
+    case FuType::FNCP:  return fncp_ii_;
+    case FuType::FMA:   return fma_ii_;
+    case FuType::FDIV:  return fdiv_ii_;
+    case FuType::FSQRT: return fsqrt_ii_;
+    case FuType::FCVT:  return fcvt_ii_;
+    default: std::abort();
+    }
+  }
 };
 
 }
\ No newline at end of file
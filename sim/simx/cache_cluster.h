@@ -35,7 +35,8 @@ public:
         , CoreRspPorts(num_units, std::vector<SimPort<MemRsp>>(num_requests, this))
         , MemReqPort(this)
         , MemRspPort(this)
-        , caches_(MAX(num_caches, 0x1)) {
+        , caches_(MAX(num_caches, 0x1))
+        , num_units_(num_units) {
 
         CacheSim::Config config2(config);
         if (0 == num_caches) {
@@ -91,6 +92,18 @@ public:
     
     void tick() {}
 
+    bool warm(uint32_t unit, uint64_t addr, bool write) {
+        // same unit to cache mapping as the memory arbiters
+        uint32_t units_per_cache = 1 << log2ceil(num_units_ / caches_.size());
+        return caches_.at(unit / units_per_cache)->warm(addr, write);
+    }
+
+    void miss_callback(const CacheSim::MissCallback& callback) {
+        for (auto cache : caches_) {
+            cache->miss_callback(callback);
+        }
+    }
+
     CacheSim::PerfStats perf_stats() const {
         CacheSim::PerfStats perf;
         for (auto cache : caches_) {
@@ -101,6 +114,7 @@ public:
     
 private:
     std::vector<CacheSim::Ptr> caches_;
+    uint32_t num_units_;
 };
 
 }
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include "cache_sim.h"
+#include "cache_trace.h"
 #include "debug.h"
 #include "types.h"
 #include <util.h>
@@ -19,6 +20,7 @@
 #include <vector>
 #include <list>
 #include <queue>
+#include <memory>
 
 using namespace vortex;
 
@@ -131,6 +133,33 @@ struct set_t {
             line.clear();
         }
     }
+
+    // tag lookup, updating the LRU counters
+    bool lookup(uint64_t tag, uint32_t* hit_line_id, uint32_t* repl_line_id, bool* found_free_line) {
+        bool hit = false;
+        uint32_t max_cnt = 0;
+        for (uint32_t i = 0, n = lines.size(); i < n; ++i) {
+            auto& line = lines.at(i);
+            if (line.valid) {
+                if (line.tag == tag) {
+                    line.lru_ctr = 0;                        
+                    *hit_line_id = i;
+                    hit = true;
+                } else {
+                    ++line.lru_ctr;
+                }
+                // free lines take precedence over the LRU victim
+                if (!*found_free_line && max_cnt < line.lru_ctr) {
+                    max_cnt = line.lru_ctr;
+                    *repl_line_id = i;
+                }
+            } else if (!*found_free_line) {
+                *found_free_line = true;
+                *repl_line_id = i;
+            }
+        }
+        return hit;
+    }
 };
 
 struct bank_req_port_t {
@@ -298,6 +327,8 @@ private:
     uint64_t pending_read_reqs_;
     uint64_t pending_write_reqs_;
     uint64_t pending_fill_reqs_;
+    std::unique_ptr<CacheTraceWriter> trace_writer_;
+    MissCallback miss_cb_;
 
 public:
     Impl(CacheSim* simobject, const Config& config) 
@@ -343,6 +374,9 @@ public:
 
         // calculate cache initialization cycles
         init_cycles_ = params_.sets_per_bank * params_.lines_per_set;
+
+        // optional request trace capture
+        trace_writer_.reset(CacheTraceWriter::Create(simobject->name(), config.num_inputs));
     }
 
     void reset() {
@@ -417,6 +451,9 @@ public:
 
             // check cache bypassing
             if (core_req.type == AddrType::IO) {
+                if (trace_writer_) {
+                    trace_writer_->write(core_req_port.arrival_time(), req_id, core_req);
+                }
                 // send bypass request
                 this->processBypassRequest(core_req, req_id);
                 // remove request
@@ -474,6 +511,10 @@ public:
             else
                 ++perf_stats_.reads;
 
+            if (trace_writer_) {
+                trace_writer_->write(core_req_port.arrival_time(), req_id, core_req);
+            }
+
             // remove request
             DT(3, simobject_->name() << "-core-" << core_req);
             auto time = core_req_port.pop();
@@ -488,6 +529,64 @@ public:
         return perf_stats_;
     }
 
+    void miss_callback(const MissCallback& callback) {
+        miss_cb_ = callback;
+    }
+
+    bool warm(uint64_t addr, bool write, bool update_stats) {
+        if (config_.bypass)
+            return true;
+
+        if (update_stats) {
+            if (write)
+                ++perf_stats_.writes;
+            else
+                ++perf_stats_.reads;
+        }
+
+        auto bank_id = params_.addr_bank_id(addr);
+        auto set_id  = params_.addr_set_id(addr);
+        auto tag     = params_.addr_tag(addr);
+
+        auto& set = banks_.at(bank_id).sets.at(set_id);
+
+        bool found_free_line = false;            
+        uint32_t hit_line_id = 0;
+        uint32_t repl_line_id = 0;            
+        bool hit = set.lookup(tag, &hit_line_id, &repl_line_id, &found_free_line);
+
+        if (write) {
+            if (config_.write_through) {
+                if (update_stats && !hit)
+                    ++perf_stats_.write_misses;
+                return true;
+            }
+            if (hit) {
+                set.lines.at(hit_line_id).dirty = true;
+                return false;
+            }
+        } else if (hit) {
+            return false;
+        }
+
+        auto& line = set.lines.at(repl_line_id);
+        if (update_stats) {
+            if (write)
+                ++perf_stats_.write_misses;
+            else
+                ++perf_stats_.read_misses;
+            if (!found_free_line && line.dirty)
+                ++perf_stats_.evictions;
+        }
+
+        // allocate the line as the fill would
+        line.valid = true;
+        line.tag   = tag;
+        line.dirty = write;
+        line.lru_ctr = 0;
+        return true;
+    }
+
 private:
     
     void processBypassResponse(const MemRsp& mem_rsp) {
@@ -531,6 +630,7 @@ private:
                 auto& line  = set.lines.at(entry.line_id);
                 line.valid  = true;
                 line.tag    = entry.bank_req.tag;
+                line.lru_ctr = 0;
                 --pending_fill_reqs_;
             } break;
             case bank_req_t::Replay: {
@@ -546,34 +646,14 @@ private:
                 }
             } break;
             case bank_req_t::Core: {        
-                bool hit = false;
                 bool found_free_line = false;            
                 uint32_t hit_line_id = 0;
                 uint32_t repl_line_id = 0;            
-                uint32_t max_cnt = 0;
 
                 auto& set = bank.sets.at(pipeline_req.set_id);
 
                 // tag lookup                
-                for (uint32_t i = 0, n = set.lines.size(); i < n; ++i) {
-                    auto& line = set.lines.at(i);
-                    if (line.valid) {
-                        if (line.tag == pipeline_req.tag) {
-                            line.lru_ctr = 0;                        
-                            hit_line_id = i;
-                            hit = true;
-                        } else {
-                            ++line.lru_ctr;
-                        }
-                        if (max_cnt < line.lru_ctr) {
-                            max_cnt = line.lru_ctr;
-                            repl_line_id = i;
-                        }
-                    } else {                    
-                        found_free_line = true;
-                        repl_line_id = i;
-                    }
-                }
+                bool hit = set.lookup(pipeline_req.tag, &hit_line_id, &repl_line_id, &found_free_line);
 
                 if (hit) {     
                     //
@@ -610,10 +690,14 @@ private:
                     //
                     // Miss handling   
                     //
-                    if (pipeline_req.write)
+                    if (pipeline_req.write) {
                         ++perf_stats_.write_misses;
-                    else
+                    } else {
                         ++perf_stats_.read_misses;
+                        if (miss_cb_) {
+                            miss_cb_(pipeline_req.uuid);
+                        }
+                    }
 
                     if (!found_free_line && !config_.write_through) {
                         // write back dirty line
@@ -704,4 +788,12 @@ void CacheSim::tick() {
 
 const CacheSim::PerfStats& CacheSim::perf_stats() const {
     return impl_->perf_stats();
+}
+
+bool CacheSim::warm(uint64_t addr, bool write, bool update_stats) {
+    return impl_->warm(addr, write, update_stats);
+}
+
+void CacheSim::miss_callback(const MissCallback& callback) {
+    impl_->miss_callback(callback);
 }
\ No newline at end of file
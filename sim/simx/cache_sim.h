@@ -74,6 +74,8 @@ public:
         }
     };
 
+    typedef std::function<void (uint64_t uuid)> MissCallback;
+
     std::vector<SimPort<MemReq>> CoreReqPorts;
     std::vector<SimPort<MemRsp>> CoreRspPorts;
     SimPort<MemReq>              MemReqPort;
@@ -87,6 +89,15 @@ public:
     void tick();
 
     const PerfStats& perf_stats() const;
+
+    // functional access used for sampling warm-up and trace replay: updates
+    // the tag array without timing, and the access and miss counters when
+    // update_stats is set; returns true if the next level is accessed
+    bool warm(uint64_t addr, bool write, bool update_stats = false);
+
+    // called with the request uuid on every read miss of the tag array,
+    // never for a bypassed cache or uncached requests
+    void miss_callback(const MissCallback& callback);
     
 private:
     class Impl;
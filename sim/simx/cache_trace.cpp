@@ -0,0 +1,113 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cache_trace.h"
+#include <iostream>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
+
+using namespace vortex;
+
+static constexpr uint32_t TRACE_VERSION = 1;
+
+CacheTraceWriter* CacheTraceWriter::Create(const std::string& cache_name, uint32_t num_inputs) {
+  static std::mutex s_mutex;
+  static std::unordered_map<std::string, uint32_t> s_instances;
+
+  auto dirname = getenv("SIMX_CACHE_TRACE");
+  if (nullptr == dirname || 0 == dirname[0])
+    return nullptr;
+
+  auto filter = getenv("SIMX_CACHE_TRACE_FILTER");
+  if (filter && std::string::npos == cache_name.find(filter))
+    return nullptr;
+
+  mkdir(dirname, 0755);
+
+  // each simulated device writes its own traces
+  uint32_t instance;
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    instance = s_instances[cache_name]++;
+  }
+  auto filename = std::string(dirname) + "/" + cache_name;
+  if (instance != 0) {
+    filename += "." + std::to_string(instance);
+  }
+  return new CacheTraceWriter(filename + ".trace.gz", num_inputs);
+}
+
+CacheTraceWriter::CacheTraceWriter(const std::string& filename, uint32_t num_inputs) {
+  buffer_.reserve(BUFFER_SIZE);
+  // favor speed over ratio, the records are highly redundant anyway
+  file_ = gzopen(filename.c_str(), "wb1");
+  if (nullptr == file_) {
+    std::cout << "Error: cannot create cache trace " << filename << std::endl;
+    return;
+  }
+  cache_trace_header_t header;
+  memcpy(header.magic, "VXCT", 4);
+  header.version = TRACE_VERSION;
+  header.num_inputs = num_inputs;
+  header.reserved = 0;
+  gzwrite(file_, &header, sizeof(header));
+}
+
+CacheTraceWriter::~CacheTraceWriter() {
+  this->flush();
+  if (file_) {
+    gzclose(file_);
+  }
+}
+
+void CacheTraceWriter::flush() {
+  if (file_ && !buffer_.empty()) {
+    gzwrite(file_, buffer_.data(), buffer_.size() * sizeof(cache_trace_record_t));
+  }
+  buffer_.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CacheTraceReader::CacheTraceReader() : file_(nullptr) {}
+
+CacheTraceReader::~CacheTraceReader() {
+  if (file_) {
+    gzclose(file_);
+  }
+}
+
+bool CacheTraceReader::open(const std::string& filename) {
+  file_ = gzopen(filename.c_str(), "rb");
+  if (nullptr == file_) {
+    std::cout << "Error: cannot open cache trace " << filename << std::endl;
+    return false;
+  }
+  gzbuffer(file_, 1 << 20);
+  if (gzread(file_, &header_, sizeof(header_)) != sizeof(header_)
+   || memcmp(header_.magic, "VXCT", 4) != 0
+   || header_.version != TRACE_VERSION) {
+    std::cout << "Error: invalid cache trace " << filename << std::endl;
+    return false;
+  }
+  return true;
+}
+
+uint32_t CacheTraceReader::read(cache_trace_record_t* records, uint32_t max_records) {
+  int bytes = gzread(file_, records, max_records * sizeof(cache_trace_record_t));
+  if (bytes <= 0)
+    return 0;
+  return bytes / sizeof(cache_trace_record_t);
+}
@@ -0,0 +1,90 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "types.h"
+
+namespace vortex {
+
+// Cache request trace record (little-endian, 32 bytes).
+struct cache_trace_record_t {
+  uint64_t cycle;   // arrival cycle at the cache input
+  uint64_t addr;
+  uint64_t uuid;
+  uint32_t cid;
+  uint16_t input;   // cache input port
+  uint8_t  write;
+  uint8_t  type;    // AddrType
+};
+
+static_assert(sizeof(cache_trace_record_t) == 32, "invalid trace record size");
+
+struct cache_trace_header_t {
+  char     magic[4]; // "VXCT"
+  uint32_t version;
+  uint32_t num_inputs;
+  uint32_t reserved;
+};
+
+// Captures the requests accepted by a cache into a gzip-compressed binary
+// trace, for offline replay with cachesim-replay.
+class CacheTraceWriter {
+public:
+  // returns a writer if SIMX_CACHE_TRACE names an output directory and the cache
+  // name contains SIMX_CACHE_TRACE_FILTER (when set), nullptr otherwise
+  static CacheTraceWriter* Create(const std::string& cache_name, uint32_t num_inputs);
+
+  CacheTraceWriter(const std::string& filename, uint32_t num_inputs);
+  ~CacheTraceWriter();
+
+  void write(uint64_t cycle, uint32_t input, const MemReq& req) {
+    buffer_.push_back({cycle, req.addr, req.uuid, req.cid, (uint16_t)input, req.write, (uint8_t)req.type});
+    if (buffer_.size() == BUFFER_SIZE) {
+      this->flush();
+    }
+  }
+
+private:
+
+  static constexpr uint32_t BUFFER_SIZE = 16384;
+
+  void flush();
+
+  gzFile file_;
+  std::vector<cache_trace_record_t> buffer_;
+};
+
+class CacheTraceReader {
+public:
+  CacheTraceReader();
+  ~CacheTraceReader();
+
+  bool open(const std::string& filename);
+
+  // reads up to max_records records, returns the number of records read
+  uint32_t read(cache_trace_record_t* records, uint32_t max_records);
+
+  uint32_t num_inputs() const {
+    return header_.num_inputs;
+  }
+
+private:
+  gzFile file_;
+  cache_trace_header_t header_;
+};
+
+}
@@ -0,0 +1,387 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline cache trace replay.
+// Feeds a request trace captured with SIMX_CACHE_TRACE through one or more
+// CacheSim configurations, each simulated on its own host thread.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <bitmanip.h>
+#include "cache_sim.h"
+#include "cache_trace.h"
+
+using namespace vortex;
+
+static void show_usage() {
+  std::cout << "Usage: cachesim-replay [-c <name=value,...>: cache configuration, can be repeated] [-t: timing] [-l <latency>: memory latency] [-j <jobs>] [-h: help] <trace>" << std::endl;
+  std::cout << "  configuration keys: size, line, word, ways, banks, ports, mshr, latency, wb (write-back)" << std::endl;
+  std::cout << "  size, line, word, ways and banks must be powers of two, banks <= 128, ports <= line/word, mshr <= 65535, latency <= 255" << std::endl;
+}
+
+struct replay_config_t {
+  std::string name;
+  uint32_t size    = 16384;
+  uint32_t line    = 64;
+  uint32_t word    = 4;
+  uint32_t ways    = 4;
+  uint32_t banks   = 1;
+  uint32_t ports   = 1;
+  uint32_t mshr    = 16;
+  uint32_t latency = 2;
+  uint32_t wb      = 0;
+
+  bool parse(const std::string& str) {
+    name = str;
+    std::stringstream ss(str);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+      auto pos = entry.find('=');
+      if (pos == std::string::npos) {
+        std::cout << "Error: missing value for '" << entry << "'" << std::endl;
+        return false;
+      }
+      auto key = entry.substr(0, pos);
+      uint32_t* field;
+      uint32_t max_value;
+      bool pow2;
+      if (key == "size") { field = &size; max_value = 1u << 31; pow2 = true; }
+      else if (key == "line") { field = &line; max_value = 1u << 31; pow2 = true; }
+      else if (key == "word") { field = &word; max_value = 1u << 31; pow2 = true; }
+      else if (key == "ways") { field = &ways; max_value = 1u << 31; pow2 = true; }
+      else if (key == "banks") { field = &banks; max_value = 128; pow2 = true; }
+      else if (key == "ports") { field = &ports; max_value = 255; pow2 = false; }
+      else if (key == "mshr") { field = &mshr; max_value = 65535; pow2 = false; }
+      else if (key == "latency") { field = &latency; max_value = 255; pow2 = false; }
+      else if (key == "wb") { field = &wb; max_value = 1; pow2 = false; }
+      else {
+        std::cout << "Error: unknown configuration key '" << key << "'" << std::endl;
+        return false;
+      }
+      auto str_value = entry.c_str() + pos + 1;
+      char* end;
+      errno = 0;
+      auto value = std::strtoull(str_value, &end, 0);
+      if (end == str_value || *end != '\0' || errno != 0 || strchr(str_value, '-')) {
+        std::cout << "Error: invalid " << key << " value '" << str_value << "'" << std::endl;
+        return false;
+      }
+      if (value > max_value) {
+        std::cout << "Error: " << key << "=" << value << " exceeds the maximum of " << max_value << std::endl;
+        return false;
+      }
+      if (pow2 && !ispow2(value)) {
+        std::cout << "Error: " << key << "=" << value << " must be a non-zero power of two" << std::endl;
+        return false;
+      }
+      *field = (uint32_t)value;
+    }
+    return this->validate();
+  }
+
+  // cross-field checks for what CacheSim only asserts on
+  bool validate() const {
+    if (word > line) {
+      std::cout << "Error: word=" << word << " is larger than line=" << line << std::endl;
+      return false;
+    }
+    if ((uint64_t)line * ways * banks > size) {
+      std::cout << "Error: size=" << size << " is smaller than line*ways*banks=" << (uint64_t)line * ways * banks << std::endl;
+      return false;
+    }
+    if (ports == 0 || ports > line / word) {
+      std::cout << "Error: ports=" << ports << " must be between 1 and line/word=" << (line / word) << std::endl;
+      return false;
+    }
+    if (mshr == 0) {
+      std::cout << "Error: mshr must be non-zero" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  CacheSim::Config cache_config(uint32_t num_inputs) const {
+    return CacheSim::Config{
+      false,
+      (uint8_t)log2ceil(size),  // C
+      (uint8_t)log2ceil(line),  // B
+      (uint8_t)log2ceil(word),  // W
+      (uint8_t)log2ceil(ways),  // A
+      XLEN,                     // address bits
+      (uint8_t)banks,           // number of banks
+      (uint8_t)ports,           // number of ports
+      (uint8_t)num_inputs,      // number of inputs
+      (0 == wb),                // write-through
+      false,                    // write response
+      0,                        // victim size
+      (uint16_t)mshr,           // mshr
+      (uint8_t)latency,         // pipeline latency
+    };
+  }
+};
+
+struct replay_result_t {
+  CacheSim::PerfStats stats;
+  uint64_t cycles = 0;
+  double   seconds = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Injects the trace requests at their recorded arrival cycle and models the
+// next memory level with a fixed latency.
+class ReplayDriver : public SimObject<ReplayDriver> {
+public:
+  std::vector<SimPort<MemReq>> CoreReqPorts;
+  std::vector<SimPort<MemRsp>> CoreRspPorts;
+  SimPort<MemReq> MemReqPort;
+  SimPort<MemRsp> MemRspPort;
+
+  ReplayDriver(const SimContext& ctx,
+               const std::vector<cache_trace_record_t>& trace,
+               uint32_t num_inputs,
+               uint32_t mem_latency)
+    : SimObject<ReplayDriver>(ctx, "replay-driver")
+    , CoreReqPorts(num_inputs, this)
+    , CoreRspPorts(num_inputs, this)
+    , MemReqPort(this)
+    , MemRspPort(this)
+    , trace_(trace)
+    , mem_latency_(mem_latency)
+    , base_cycle_(0)
+    , index_(0)
+    , pending_reads_(0)
+  {
+    // arrival cycles are only ordered per input, start from the earliest one
+    if (!trace.empty()) {
+      base_cycle_ = std::min_element(trace.begin(), trace.end(), [](const cache_trace_record_t& a, const cache_trace_record_t& b) {
+        return a.cycle < b.cycle;
+      })->cycle;
+    }
+  }
+
+  void reset() {
+    index_ = 0;
+    pending_reads_ = 0;
+  }
+
+  void tick() {
+    auto cycles = SimPlatform::instance().cycles();
+
+    // inject requests
+    while (index_ < trace_.size()) {
+      auto& rec = trace_.at(index_);
+      if ((rec.cycle - base_cycle_) > cycles)
+        break;
+      MemReq req(rec.addr, rec.write, (AddrType)rec.type, index_, rec.cid, rec.uuid);
+      CoreReqPorts.at(rec.input % CoreReqPorts.size()).send(req, 1);
+      if (!rec.write) {
+        ++pending_reads_;
+      }
+      ++index_;
+    }
+
+    // drain responses
+    for (auto& port : CoreRspPorts) {
+      if (port.empty())
+        continue;
+      port.pop();
+      --pending_reads_;
+    }
+
+    // next level memory
+    if (!MemReqPort.empty()) {
+      auto& mem_req = MemReqPort.front();
+      if (!mem_req.write) {
+        MemRspPort.send(MemRsp{mem_req.tag, mem_req.cid, mem_req.uuid}, mem_latency_);
+      }
+      MemReqPort.pop();
+    }
+  }
+
+  bool done() const {
+    return index_ == trace_.size() && 0 == pending_reads_;
+  }
+
+private:
+  const std::vector<cache_trace_record_t>& trace_;
+  uint32_t mem_latency_;
+  uint64_t base_cycle_;
+  uint64_t index_;
+  uint64_t pending_reads_;
+};
+
+static void replay_functional(const std::vector<cache_trace_record_t>& trace,
+                              const replay_config_t& config,
+                              uint32_t num_inputs,
+                              replay_result_t* result) {
+  SimPlatform platform;
+  SimPlatformScope platform_scope(&platform);
+  auto cache = CacheSim::Create("cache", config.cache_config(num_inputs));
+  platform.reset();
+  for (auto& rec : trace) {
+    if (rec.type == (uint8_t)AddrType::IO)
+      continue;
+    cache->warm(rec.addr, rec.write, true);
+  }
+  result->stats = cache->perf_stats();
+  platform.finalize();
+}
+
+static void replay_timing(const std::vector<cache_trace_record_t>& trace,
+                          const replay_config_t& config,
+                          uint32_t num_inputs,
+                          uint32_t mem_latency,
+                          replay_result_t* result) {
+  SimPlatform platform;
+  SimPlatformScope platform_scope(&platform);
+  auto cache = CacheSim::Create("cache", config.cache_config(num_inputs));
+  auto driver = SimPlatform::instance().create_object<ReplayDriver>(trace, num_inputs, mem_latency);
+  for (uint32_t i = 0; i < num_inputs; ++i) {
+    driver->CoreReqPorts.at(i).bind(&cache->CoreReqPorts.at(i));
+    cache->CoreRspPorts.at(i).bind(&driver->CoreRspPorts.at(i));
+  }
+  cache->MemReqPort.bind(&driver->MemReqPort);
+  driver->MemRspPort.bind(&cache->MemRspPort);
+
+  platform.reset();
+  while (!driver->done()) {
+    platform.tick();
+  }
+  result->stats = cache->perf_stats();
+  result->cycles = platform.cycles();
+  platform.finalize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv) {
+  std::vector<replay_config_t> configs;
+  bool timing = false;
+  uint32_t mem_latency = 100;
+  uint32_t jobs = std::thread::hardware_concurrency();
+
+  int c;
+  while ((c = getopt(argc, argv, "c:tl:j:h?")) != -1) {
+    switch (c) {
+    case 'c': {
+      replay_config_t config;
+      if (!config.parse(optarg)) {
+        std::cout << "Error: invalid cache configuration " << optarg << std::endl;
+        return -1;
+      }
+      configs.push_back(config);
+    } break;
+    case 't':
+      timing = true;
+      break;
+    case 'l':
+      mem_latency = atoi(optarg);
+      break;
+    case 'j':
+      jobs = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      return 0;
+    default:
+      show_usage();
+      return -1;
+    }
+  }
+
+  if (optind >= argc) {
+    show_usage();
+    return -1;
+  }
+
+  if (configs.empty()) {
+    configs.push_back(replay_config_t());
+    configs.back().name = "default";
+  }
+
+  // load the trace once, it is shared by all configurations
+  std::vector<cache_trace_record_t> trace;
+  CacheTraceReader reader;
+  if (!reader.open(argv[optind]))
+    return -1;
+  {
+    std::vector<cache_trace_record_t> chunk(65536);
+    uint32_t count;
+    while ((count = reader.read(chunk.data(), chunk.size())) != 0) {
+      trace.insert(trace.end(), chunk.begin(), chunk.begin() + count);
+    }
+  }
+  auto num_inputs = reader.num_inputs();
+  if (num_inputs == 0 || num_inputs > 255) {
+    std::cout << "Error: invalid number of inputs " << num_inputs << " in " << argv[optind] << std::endl;
+    return -1;
+  }
+
+  std::vector<replay_result_t> results(configs.size());
+  std::atomic<uint32_t> next(0);
+  auto worker = [&]() {
+    for (uint32_t i; (i = next++) < configs.size();) {
+      auto start = std::chrono::steady_clock::now();
+      if (timing) {
+        replay_timing(trace, configs.at(i), num_inputs, mem_latency, &results.at(i));
+      } else {
+        replay_functional(trace, configs.at(i), num_inputs, &results.at(i));
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      results.at(i).seconds = elapsed.count();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0, n = std::max<uint32_t>(1, std::min<uint32_t>(jobs, configs.size())); i < n; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::cout << "config,requests,reads,writes,read_misses,write_misses,evictions,hit_ratio";
+  if (timing) {
+    std::cout << ",cycles,bank_stalls,mshr_stalls,avg_mem_latency";
+  }
+  std::cout << ",mreqs_per_sec" << std::endl;
+  for (uint32_t i = 0; i < configs.size(); ++i) {
+    auto& stats = results.at(i).stats;
+    auto accesses = stats.reads + stats.writes;
+    auto misses = stats.read_misses + stats.write_misses;
+    std::cout << "\"" << configs.at(i).name << "\"," << trace.size()
+              << "," << stats.reads << "," << stats.writes
+              << "," << stats.read_misses << "," << stats.write_misses
+              << "," << stats.evictions
+              << "," << std::fixed << std::setprecision(4) << (accesses ? (1.0 - double(misses) / accesses) : 0.0);
+    if (timing) {
+      std::cout << "," << results.at(i).cycles
+                << "," << stats.bank_stalls << "," << stats.mshr_stalls
+                << "," << std::setprecision(2) << (stats.read_misses ? double(stats.mem_latency) / stats.read_misses : 0.0);
+    }
+    std::cout << "," << std::setprecision(2) << (trace.size() / results.at(i).seconds / 1e6) << std::endl;
+  }
+
+  return 0;
+}
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include "cluster.h"
+#include "processor_impl.h"
 
 using namespace vortex;
 
@@ -35,18 +36,18 @@ Cluster::Cluster(const SimContext& ctx,
   snprintf(sname, 100, "cluster%d-l2cache", cluster_id);
   l2cache_ = CacheSim::Create(sname, CacheSim::Config{
     !L2_ENABLED,
-    log2ceil(L2_CACHE_SIZE), // C
+    (uint8_t)log2ceil(arch.l2_cache_size()), // C
     log2ceil(MEM_BLOCK_SIZE), // B
-    log2ceil(L2_NUM_WAYS),  // W
+    (uint8_t)log2ceil(arch.l2_num_ways()), // W
     0,                      // A
     XLEN,                   // address bits  
-    L2_NUM_BANKS,           // number of banks
+    (uint8_t)arch.l2_num_banks(), // number of banks
     1,                      // number of ports
     5,                      // request size 
     true,                   // write-through
     false,                  // write response
     0,                      // victim size
-    L2_MSHR_SIZE,           // mshr
+    (uint16_t)arch.l2_mshr_size(), // mshr
     2,                      // pipeline latency
   });
 
@@ -54,12 +55,12 @@ Cluster::Cluster(const SimContext& ctx,
   this->mem_rsp_port.bind(&l2cache_->MemRspPort);
 
   snprintf(sname, 100, "cluster%d-icaches", cluster_id);
-  icaches_ = CacheCluster::Create(sname, num_cores, NUM_ICACHES, 1, CacheSim::Config{
+  icaches_ = CacheCluster::Create(sname, num_cores, arch.num_icaches(), 1, CacheSim::Config{
     !ICACHE_ENABLED,
-    log2ceil(ICACHE_SIZE),  // C
+    (uint8_t)log2ceil(arch.icache_size()), // C
     log2ceil(L1_LINE_SIZE), // B
     log2ceil(sizeof(uint32_t)), // W
-    log2ceil(ICACHE_NUM_WAYS),// A
+    (uint8_t)log2ceil(arch.icache_num_ways()), // A
     XLEN,                   // address bits    
     1,                      // number of banks
     1,                      // number of ports
@@ -75,26 +76,31 @@ Cluster::Cluster(const SimContext& ctx,
   l2cache_->CoreRspPorts.at(0).bind(&icaches_->MemRspPort);
 
   snprintf(sname, 100, "cluster%d-dcaches", cluster_id);
-  dcaches_ = CacheCluster::Create(sname, num_cores, NUM_DCACHES, NUM_LSU_LANES, CacheSim::Config{
+  dcaches_ = CacheCluster::Create(sname, num_cores, arch.num_dcaches(), arch.num_lsu_lanes(), CacheSim::Config{
     !DCACHE_ENABLED,
-    log2ceil(DCACHE_SIZE),  // C
+    (uint8_t)log2ceil(arch.dcache_size()), // C
     log2ceil(L1_LINE_SIZE), // B
     log2ceil(sizeof(Word)), // W
-    log2ceil(DCACHE_NUM_WAYS),// A
+    (uint8_t)log2ceil(arch.dcache_num_ways()), // A
     XLEN,                   // address bits    
-    DCACHE_NUM_BANKS,       // number of banks
+    (uint8_t)arch.dcache_num_banks(), // number of banks
     1,                      // number of ports
-    DCACHE_NUM_BANKS,       // number of inputs
+    (uint8_t)arch.dcache_num_banks(), // number of inputs
     true,                   // write-through
     false,                  // write response
     0,                      // victim size
-    DCACHE_MSHR_SIZE,       // mshr
+    (uint16_t)arch.dcache_mshr_size(), // mshr
     4,                      // pipeline latency
   });
 
   dcaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(1));
   l2cache_->CoreRspPorts.at(1).bind(&dcaches_->MemRspPort);
 
+  // attach profiling and tracing
+  processor->observe_cache(*icaches_, Profiler::ICACHE, cluster_id);
+  processor->observe_cache(*dcaches_, Profiler::DCACHE, cluster_id);
+  processor->observe_cache(*l2cache_, Profiler::L2CACHE, cluster_id);
+
   ///////////////////////////////////////////////////////////////////////////
 
   // create shared memory blocks
@@ -103,8 +109,8 @@ Cluster::Cluster(const SimContext& ctx,
     sharedmems_.at(i) = SharedMem::Create(sname, SharedMem::Config{
       (1 << SMEM_LOG_SIZE),
       sizeof(Word),
-      NUM_LSU_LANES, 
-      NUM_LSU_LANES,
+      arch.num_lsu_lanes(),
+      arch.num_lsu_lanes(),
       false
     });
   }
@@ -122,7 +128,7 @@ Cluster::Cluster(const SimContext& ctx,
     cores_.at(i)->icache_req_ports.at(0).bind(&icaches_->CoreReqPorts.at(i).at(0));
     icaches_->CoreRspPorts.at(i).at(0).bind(&cores_.at(i)->icache_rsp_ports.at(0));      
 
-    for (uint32_t j = 0; j < NUM_LSU_LANES; ++j) {
+    for (uint32_t j = 0; j < arch.num_lsu_lanes(); ++j) {
       snprintf(sname, 100, "cluster%d-smem_demux%d_%d", cluster_id, i, j);
       auto smem_demux = SMemDemux::Create(sname);
       
@@ -205,6 +211,52 @@ ProcessorImpl* Cluster::processor() const {
   return processor_;
 }
 
+Core::PerfStats Cluster::core_perf_stats() const {
+  Core::PerfStats perf;
+  for (auto& core : cores_) {
+    perf += core->perf_stats();
+  }
+  return perf;
+}
+
+void Cluster::drain(bool enable) {
+  for (auto& core : cores_) {
+    core->drain(enable);
+  }
+}
+
+uint64_t Cluster::warm(uint64_t count) {
+  uint64_t instrs = 0;
+  for (auto& core : cores_) {
+    instrs += core->warm(count);
+  }
+  return instrs;
+}
+
+bool Cluster::save(Checkpoint* checkpoint) const {
+  for (auto& core : cores_) {
+    if (!core->save(checkpoint))
+      return false;
+  }
+  return true;
+}
+
+bool Cluster::sharedmem_written() const {
+  for (auto& sharedmem : sharedmems_) {
+    if (sharedmem->num_writes() != 0)
+      return true;
+  }
+  return false;
+}
+
+void Cluster::warm_cache(uint32_t core_index, uint64_t addr, bool write, bool icache) {
+  auto& l1cache = icache ? icaches_ : dcaches_;
+  if (l1cache->warm(core_index, addr, write)
+   && l2cache_->warm(addr, write)) {
+    processor_->warm_l3cache(addr, write);
+  }
+}
+
 Cluster::PerfStats Cluster::perf_stats() const {
   Cluster::PerfStats perf;
   perf.icache = icaches_->perf_stats();
@@ -68,6 +68,20 @@ public:
   ProcessorImpl* processor() const;
 
   Cluster::PerfStats perf_stats() const;
+
+  Core::PerfStats core_perf_stats() const;
+
+  void drain(bool enable);
+
+  // functional warming, returns the number of executed thread instructions
+  uint64_t warm(uint64_t count);
+
+  void warm_cache(uint32_t core_index, uint64_t addr, bool write, bool icache);
+
+  bool save(Checkpoint* checkpoint) const;
+
+  // true once a kernel stored to local memory, which checkpoints do not hold
+  bool sharedmem_written() const;
   
 private:
   uint32_t                     cluster_id_;  
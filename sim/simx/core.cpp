@@ -36,8 +36,8 @@ Core::Core(const SimContext& ctx,
     : SimObject(ctx, "core")
     , icache_req_ports(1, this)
     , icache_rsp_ports(1, this)
-    , dcache_req_ports(NUM_LSU_LANES, this)
-    , dcache_rsp_ports(NUM_LSU_LANES, this)
+    , dcache_req_ports(arch.num_lsu_lanes(), this)
+    , dcache_rsp_ports(arch.num_lsu_lanes(), this)
     , core_id_(core_id)
     , arch_(arch)
     , dcrs_(dcrs)
@@ -45,18 +45,21 @@ Core::Core(const SimContext& ctx,
     , warps_(arch.num_warps())
     , barriers_(arch.num_barriers(), 0)
     , fcsrs_(arch.num_warps(), 0)
-    , ibuffers_(ISSUE_WIDTH, IBUF_SIZE)
+    , ibuffers_(arch.issue_width(), arch.ibuf_size())
     , scoreboard_(arch_) 
-    , operands_(ISSUE_WIDTH)
+    , operands_(arch.issue_width())
     , dispatchers_((uint32_t)ExeType::MAX)
     , exe_units_((uint32_t)ExeType::MAX)
     , sharedmem_(sharedmem)
     , fetch_latch_("fetch")
     , decode_latch_("decode")
     , pending_icache_(arch_.num_warps())
-    , committed_traces_(ISSUE_WIDTH, nullptr)
+    , committed_traces_(arch.issue_width(), nullptr)
     , csrs_(arch.num_warps())
     , cluster_(cluster)
+    , profiler_(cluster->processor()->profiler())
+    , tracer_(cluster->processor()->tracer())
+    , reuse_profiler_(cluster->processor()->reuse_profiler())
 {  
   for (uint32_t i = 0; i < arch_.num_warps(); ++i) {
     csrs_.at(i).resize(arch.num_threads());
@@ -66,21 +69,23 @@ Core::Core(const SimContext& ctx,
     warps_.at(i) = std::make_shared<Warp>(this, i);
   }
 
-  for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
-    operands_.at(i) = SimPlatform::instance().create_object<Operand>();
+  for (uint32_t i = 0; i < arch_.issue_width(); ++i) {
+    operands_.at(i) = SimPlatform::instance().create_object<Operand>(arch);
   }
 
   // initialize dispatchers
-  dispatchers_.at((int)ExeType::ALU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, NUM_ALU_BLOCKS, NUM_ALU_LANES);
-  dispatchers_.at((int)ExeType::FPU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, NUM_FPU_BLOCKS, NUM_FPU_LANES);
-  dispatchers_.at((int)ExeType::LSU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, 1, NUM_LSU_LANES);
-  dispatchers_.at((int)ExeType::SFU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, 1, NUM_SFU_LANES);
+  dispatchers_.at((int)ExeType::ALU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, arch.num_alu_blocks(), arch.num_alu_lanes());
+  dispatchers_.at((int)ExeType::FPU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, arch.num_fpu_blocks(), arch.num_fpu_lanes());
+  dispatchers_.at((int)ExeType::LSU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, 1, arch.num_lsu_lanes());
+  dispatchers_.at((int)ExeType::SFU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, 1, arch.num_sfu_lanes());
+  dispatchers_.at((int)ExeType::VPU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, 1, arch.num_threads());
   
   // initialize execute units
   exe_units_.at((int)ExeType::ALU) = SimPlatform::instance().create_object<AluUnit>(this);
   exe_units_.at((int)ExeType::FPU) = SimPlatform::instance().create_object<FpuUnit>(this);
   exe_units_.at((int)ExeType::LSU) = SimPlatform::instance().create_object<LsuUnit>(this);
   exe_units_.at((int)ExeType::SFU) = SimPlatform::instance().create_object<SfuUnit>(this);
+  exe_units_.at((int)ExeType::VPU) = SimPlatform::instance().create_object<VpuUnit>(this);
 
   this->reset();
 }
@@ -122,6 +127,7 @@ void Core::reset() {
   issued_instrs_ = 0;
   committed_instrs_ = 0;
   exited_ = false;
+  draining_ = false;
   perf_stats_ = PerfStats();
   pending_ifetches_ = 0;
 }
@@ -134,11 +140,22 @@ void Core::tick() {
   this->fetch();
   this->schedule();
 
+  // warp cycles spent with inactive lanes
+  for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
+    if (active_warps_.test(wid)
+     && warps_.at(wid)->getActiveThreads() != arch_.num_threads()) {
+      ++perf_stats_.diverged_cycles;
+    }
+  }
+
   ++perf_stats_.cycles;
   DPN(2, std::flush);  
 }
 
 void Core::schedule() {
+  if (draining_)
+    return;
+
   int scheduled_warp = -1;
 
   // find next ready warp
@@ -162,6 +179,10 @@ void Core::schedule() {
 
   DT(3, "pipeline-schedule: " << *trace);
 
+  if (tracer_) {
+    tracer_->stage(trace, PipelineStage::SCHEDULE);
+  }
+
   // advance to fetch stage
   fetch_latch_.push(trace);
   ++issued_instrs_;
@@ -194,6 +215,9 @@ void Core::fetch() {
   mem_req.uuid  = trace->uuid;
   icache_req_ports.at(0).send(mem_req, 1);    
   DT(3, "icache-req: addr=0x" << std::hex << mem_req.addr << ", tag=" << mem_req.tag << ", " << *trace);    
+  if (tracer_) {
+    tracer_->stage(trace, PipelineStage::FETCH);
+  }
   fetch_latch_.pop();    
   ++pending_ifetches_;   
   ++perf_stats_.ifetches;
@@ -206,7 +230,7 @@ void Core::decode() {
   auto trace = decode_latch_.front();
 
   // check ibuffer capacity
-  auto& ibuffer = ibuffers_.at(trace->wid % ISSUE_WIDTH);
+  auto& ibuffer = ibuffers_.at(trace->wid % arch_.issue_width());
   if (ibuffer.full()) {
     if (!trace->log_once(true)) {
       DT(3, "*** ibuffer-stall: " << *trace);
@@ -232,6 +256,10 @@ void Core::decode() {
 
   DT(3, "pipeline-decode: " << *trace);
 
+  if (tracer_) {
+    tracer_->stage(trace, PipelineStage::DECODE);
+  }
+
   // insert to ibuffer 
   ibuffer.push(trace);
 
@@ -240,7 +268,7 @@ void Core::decode() {
 
 void Core::issue() {   
   // operands to dispatch
-  for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+  for (uint32_t i = 0; i < arch_.issue_width(); ++i) {
     auto& operand = operands_.at(i);    
     if (operand->Output.empty())
       continue;
@@ -252,11 +280,14 @@ void Core::issue() {
       if (!trace->log_once(true)) {
         DT(3, "*** dispatch-stall: " << *trace);
       }
+      if (profiler_) {
+        profiler_->dispatch_stall(trace);
+      }
     }
   }
 
   // issue ibuffer instructions
-  for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+  for (uint32_t i = 0; i < arch_.issue_width(); ++i) {
     auto& ibuffer = ibuffers_.at(i);
     if (ibuffer.empty())
       continue;
@@ -277,6 +308,9 @@ void Core::issue() {
         DTN(3, "}, " << *trace << std::endl);
       }
       ++perf_stats_.scrb_stalls;
+      if (profiler_) {
+        profiler_->scrb_stall(trace);
+      }
       continue;
     } else {
       trace->log_once(false);
@@ -289,6 +323,13 @@ void Core::issue() {
 
     DT(3, "pipeline-scoreboard: " << *trace);
 
+    if (profiler_) {
+      profiler_->issue(trace);
+    }
+    if (tracer_) {
+      tracer_->stage(trace, PipelineStage::ISSUE);
+    }
+
     // to operand stage
     operands_.at(i)->Input.send(trace, 1);
 
@@ -300,10 +341,13 @@ void Core::execute() {
   for (uint32_t i = 0; i < (uint32_t)ExeType::MAX; ++i) {
     auto& dispatch = dispatchers_.at(i);
     auto& exe_unit = exe_units_.at(i);
-    for (uint32_t j = 0; j < ISSUE_WIDTH; ++j) {
+    for (uint32_t j = 0; j < arch_.issue_width(); ++j) {
       if (dispatch->Outputs.at(j).empty())
         continue;
       auto trace = dispatch->Outputs.at(j).front();
+      if (tracer_) {
+        tracer_->stage(trace, PipelineStage::EXECUTE);
+      }
       exe_unit->Inputs.at(j).send(trace, 1);
       dispatch->Outputs.at(j).pop();
     }
@@ -312,7 +356,7 @@ void Core::execute() {
 
 void Core::commit() {
   // process completed instructions 
-  for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+  for (uint32_t i = 0; i < arch_.issue_width(); ++i) {
     auto trace = committed_traces_.at(i);
     if (!trace)
       continue;
@@ -331,7 +375,18 @@ void Core::commit() {
       assert(committed_instrs_ <= issued_instrs_);
       ++committed_instrs_;
 
-      perf_stats_.instrs += trace->tmask.count();
+      uint32_t active_threads = trace->tmask.count();
+      perf_stats_.instrs += active_threads;
+      ++perf_stats_.warp_instrs;
+      if (active_threads != arch_.num_threads()) {
+        ++perf_stats_.diverged_instrs;
+      }
+      // active lanes histogram in quarters of the warp width
+      ++perf_stats_.lanes_hist[(active_threads * 4 - 1) / arch_.num_threads()];
+    }
+
+    if (tracer_) {
+      tracer_->commit(trace);
     }
 
     // delete the trace
@@ -342,7 +397,7 @@ void Core::commit() {
  for (uint32_t i = 0; i < (uint32_t)ExeType::MAX; ++i) {
     uint32_t ii = (commit_exe_ + i) % (uint32_t)ExeType::MAX;
     auto& exe_unit = exe_units_.at(ii);
-    for (uint32_t j = 0; j < ISSUE_WIDTH; ++j) {
+    for (uint32_t j = 0; j < arch_.issue_width(); ++j) {
       auto committed_trace = committed_traces_.at(j); 
       if (committed_trace)
         continue;
@@ -357,6 +412,77 @@ void Core::commit() {
   ++commit_exe_;
 }
 
+uint64_t Core::warm(uint64_t count) {
+  uint64_t instrs = 0;
+  uint32_t local_id = core_id_ % arch_.num_cores();
+  while (instrs < count && !exited_) {
+    bool progress = false;
+    for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw && instrs < count; ++wid) {
+      if (!active_warps_.test(wid) || stalled_warps_.test(wid))
+        continue;
+
+      auto trace = warps_.at(wid)->eval();
+
+      cluster_->warm_cache(local_id, trace->PC, false, true);
+
+      if (trace->exe_type == ExeType::LSU 
+       && trace->lsu_type != LsuType::FENCE) {
+        auto trace_data = std::dynamic_pointer_cast<LsuTraceData>(trace->data);
+        bool is_write = (trace->lsu_type == LsuType::STORE);
+        for (uint32_t t = 0, nt = arch_.num_threads(); t < nt; ++t) {
+          if (!trace->tmask.test(t))
+            continue;
+          if (!trace_data->vec_addrs.empty()) {
+            for (auto& mem_addr : trace_data->vec_addrs.at(t)) {
+              if (this->get_addr_type(mem_addr.addr) == AddrType::Global) {
+                cluster_->warm_cache(local_id, mem_addr.addr, is_write, false);
+              }
+            }
+            continue;
+          }
+          auto addr = trace_data->mem_addrs.at(t).addr;
+          if (this->get_addr_type(addr) == AddrType::Global) {
+            cluster_->warm_cache(local_id, addr, is_write, false);
+          }
+        }
+      }
+
+      if (trace->exe_type == ExeType::SFU 
+       && trace->sfu_type == SfuType::BAR) {
+        // the warp stays suspended until the barrier is released
+        auto trace_data = std::dynamic_pointer_cast<SFUTraceData>(trace->data);
+        stalled_warps_.set(wid);
+        this->barrier(trace_data->bar.id, trace_data->bar.count, wid);
+      }
+
+      instrs += trace->tmask.count();
+      delete trace;
+      progress = true;
+    }
+    if (!progress)
+      break;
+  }
+  return instrs;
+}
+
+bool Core::save(Checkpoint* checkpoint) const {
+  if (stalled_warps_.any())
+    return false;
+  for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
+    if (active_warps_.test(wid) && !warps_.at(wid)->converged())
+      return false;
+  }
+  for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
+    auto& state = checkpoint->warp(core_id_, wid);
+    warps_.at(wid)->save(&state);
+    if (!active_warps_.test(wid)) {
+      state.tmask = 0;
+    }
+    state.fcsr = fcsrs_.at(wid);
+  }
+  return true;
+}
+
 void Core::wspawn(uint32_t num_warps, Word nextPC) {
   uint32_t active_warps = std::min<uint32_t>(num_warps, arch_.num_warps());
   DP(3, "*** Activate " << (active_warps-1) << " warps at PC: " << std::hex << nextPC);
@@ -497,6 +623,14 @@ uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
     return (fcsrs_.at(wid) >> 5);
   case VX_CSR_FCSR:
     return fcsrs_.at(wid);
+  case VX_CSR_VSTART:
+  case VX_CSR_VXSAT:
+  case VX_CSR_VXRM:
+  case VX_CSR_VCSR:
+  case VX_CSR_VL:
+  case VX_CSR_VTYPE:
+  case VX_CSR_VLENB:
+    return warps_.at(wid)->get_vcsr(addr, tid);
   case VX_CSR_MHARTID: // global thread ID
     return (core_id_ * arch_.num_warps() + wid) * arch_.num_threads() + tid;
   case VX_CSR_THREAD_ID: // thread ID
@@ -545,6 +679,14 @@ uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         case VX_CSR_MPM_FPU_ST_H:  return perf_stats_.fpu_stalls >> 32; 
         case VX_CSR_MPM_SFU_ST:    return perf_stats_.sfu_stalls & 0xffffffff; 
         case VX_CSR_MPM_SFU_ST_H:  return perf_stats_.sfu_stalls >> 32; 
+        case VX_CSR_MPM_OPDS_BANK_ST:
+        case VX_CSR_MPM_OPDS_BANK_ST_H: {
+          Operand::PerfStats opds_perf;
+          for (auto& operand : operands_) {
+            opds_perf += operand->perf_stats();
+          }
+          return (addr == VX_CSR_MPM_OPDS_BANK_ST) ? (opds_perf.bank_conflicts & 0xffffffff) : (opds_perf.bank_conflicts >> 32);
+        }
         
         case VX_CSR_MPM_IFETCHES:  return perf_stats_.ifetches & 0xffffffff; 
         case VX_CSR_MPM_IFETCHES_H: return perf_stats_.ifetches >> 32; 
@@ -556,6 +698,48 @@ uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         case VX_CSR_MPM_IFETCH_LAT_H: return perf_stats_.ifetch_latency >> 32; 
         case VX_CSR_MPM_LOAD_LAT:  return perf_stats_.load_latency & 0xffffffff; 
         case VX_CSR_MPM_LOAD_LAT_H: return perf_stats_.load_latency >> 32;
+
+        case VX_CSR_MPM_WARP_INSTRS: return perf_stats_.warp_instrs & 0xffffffff;
+        case VX_CSR_MPM_WARP_INSTRS_H: return perf_stats_.warp_instrs >> 32;
+        case VX_CSR_MPM_DIVERGED_INSTRS: return perf_stats_.diverged_instrs & 0xffffffff;
+        case VX_CSR_MPM_DIVERGED_INSTRS_H: return perf_stats_.diverged_instrs >> 32;
+        case VX_CSR_MPM_DIVERGED_CYCLES: return perf_stats_.diverged_cycles & 0xffffffff;
+        case VX_CSR_MPM_DIVERGED_CYCLES_H: return perf_stats_.diverged_cycles >> 32;
+        case VX_CSR_MPM_SPLITS:    return perf_stats_.splits & 0xffffffff;
+        case VX_CSR_MPM_SPLITS_H:  return perf_stats_.splits >> 32;
+        case VX_CSR_MPM_DIVERGENT_SPLITS: return perf_stats_.divergent_splits & 0xffffffff;
+        case VX_CSR_MPM_DIVERGENT_SPLITS_H: return perf_stats_.divergent_splits >> 32;
+        case VX_CSR_MPM_IPDOM_DEPTH: return perf_stats_.ipdom_depth & 0xffffffff;
+        case VX_CSR_MPM_IPDOM_DEPTH_H: return perf_stats_.ipdom_depth >> 32;
+        case VX_CSR_MPM_LANES_Q1:  return perf_stats_.lanes_hist[0] & 0xffffffff;
+        case VX_CSR_MPM_LANES_Q1_H: return perf_stats_.lanes_hist[0] >> 32;
+        case VX_CSR_MPM_LANES_Q2:  return perf_stats_.lanes_hist[1] & 0xffffffff;
+        case VX_CSR_MPM_LANES_Q2_H: return perf_stats_.lanes_hist[1] >> 32;
+        case VX_CSR_MPM_LANES_Q3:  return perf_stats_.lanes_hist[2] & 0xffffffff;
+        case VX_CSR_MPM_LANES_Q3_H: return perf_stats_.lanes_hist[2] >> 32;
+        case VX_CSR_MPM_LANES_Q4:  return perf_stats_.lanes_hist[3] & 0xffffffff;
+        case VX_CSR_MPM_LANES_Q4_H: return perf_stats_.lanes_hist[3] >> 32;
+
+        case VX_CSR_MPM_IDIV_BUSY: return perf_stats_.fu_busy[(int)FuType::IDIV] & 0xffffffff;
+        case VX_CSR_MPM_IDIV_BUSY_H: return perf_stats_.fu_busy[(int)FuType::IDIV] >> 32;
+        case VX_CSR_MPM_IDIV_ST:   return perf_stats_.fu_stalls[(int)FuType::IDIV] & 0xffffffff;
+        case VX_CSR_MPM_IDIV_ST_H: return perf_stats_.fu_stalls[(int)FuType::IDIV] >> 32;
+        case VX_CSR_MPM_FDIV_BUSY: return perf_stats_.fu_busy[(int)FuType::FDIV] & 0xffffffff;
+        case VX_CSR_MPM_FDIV_BUSY_H: return perf_stats_.fu_busy[(int)FuType::FDIV] >> 32;
+        case VX_CSR_MPM_FDIV_ST:   return perf_stats_.fu_stalls[(int)FuType::FDIV] & 0xffffffff;
+        case VX_CSR_MPM_FDIV_ST_H: return perf_stats_.fu_stalls[(int)FuType::FDIV] >> 32;
+        case VX_CSR_MPM_FSQRT_BUSY: return perf_stats_.fu_busy[(int)FuType::FSQRT] & 0xffffffff;
+        case VX_CSR_MPM_FSQRT_BUSY_H: return perf_stats_.fu_busy[(int)FuType::FSQRT] >> 32;
+        case VX_CSR_MPM_FSQRT_ST:  return perf_stats_.fu_stalls[(int)FuType::FSQRT] & 0xffffffff;
+        case VX_CSR_MPM_FSQRT_ST_H: return perf_stats_.fu_stalls[(int)FuType::FSQRT] >> 32;
+        case VX_CSR_MPM_FU_ST:
+        case VX_CSR_MPM_FU_ST_H: {
+          uint64_t fu_stalls = 0;
+          for (uint32_t i = 0; i < (uint32_t)FuType::MAX; ++i) {
+            fu_stalls += perf_stats_.fu_stalls[i];
+          }
+          return (addr == VX_CSR_MPM_FU_ST) ? (fu_stalls & 0xffffffff) : (fu_stalls >> 32);
+        }
        }
       } break; 
       case VX_DCR_MPM_CLASS_MEM: {
@@ -620,6 +804,22 @@ uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         case VX_CSR_MPM_MEM_LAT_H:   return proc_perf.mem_latency >> 32;
         }
       } break;
+      case VX_DCR_MPM_CLASS_SIMX: {
+        Operand::PerfStats opds_perf;
+        for (auto& operand : operands_) {
+          opds_perf += operand->perf_stats();
+        }
+        switch (addr) {
+        case VX_CSR_MPM_OPDS_OCC:   return opds_perf.occupancy & 0xffffffff;
+        case VX_CSR_MPM_OPDS_OCC_H: return opds_perf.occupancy >> 32;
+        case VX_CSR_MPM_OPDS_ST:    return opds_perf.stalls & 0xffffffff;
+        case VX_CSR_MPM_OPDS_ST_H:  return opds_perf.stalls >> 32;
+        case VX_CSR_MPM_VPU_BUSY:   return perf_stats_.vpu_busy & 0xffffffff;
+        case VX_CSR_MPM_VPU_BUSY_H: return perf_stats_.vpu_busy >> 32;
+        case VX_CSR_MPM_VPU_ST:     return perf_stats_.vpu_busy_stalls & 0xffffffff;
+        case VX_CSR_MPM_VPU_ST_H:   return perf_stats_.vpu_busy_stalls >> 32;
+        }
+      } break;
       }
     } else {
       std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << std::endl;
@@ -630,7 +830,6 @@ uint32_t Core::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
 }
 
 void Core::set_csr(uint32_t addr, uint32_t value, uint32_t tid, uint32_t wid) {
-  __unused (tid);
   switch (addr) {
   case VX_CSR_FFLAGS:
     fcsrs_.at(wid) = (fcsrs_.at(wid) & ~0x1F) | (value & 0x1F);
@@ -641,6 +840,12 @@ void Core::set_csr(uint32_t addr, uint32_t value, uint32_t tid, uint32_t wid) {
   case VX_CSR_FCSR:
     fcsrs_.at(wid) = value & 0xff;
     break;
+  case VX_CSR_VSTART:
+  case VX_CSR_VXSAT:
+  case VX_CSR_VXRM:
+  case VX_CSR_VCSR:
+    warps_.at(wid)->set_vcsr(addr, value, tid);
+    break;
   case VX_CSR_SATP:
   case VX_CSR_MSTATUS:
   case VX_CSR_MEDELEG:
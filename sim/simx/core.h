@@ -21,6 +21,7 @@
 #include <unordered_map>
 #include <memory>
 #include <set>
+#include <algorithm>
 #include <simobject.h>
 #include "debug.h"
 #include "types.h"
@@ -41,6 +42,9 @@
 namespace vortex {
 
 class Cluster;
+class Profiler;
+class Tracer;
+class ReuseProfiler;
 
 class Core : public SimObject<Core> {
 public:
@@ -53,11 +57,23 @@ public:
     uint64_t lsu_stalls;
     uint64_t fpu_stalls;
     uint64_t sfu_stalls;
+    uint64_t vpu_stalls;
     uint64_t ifetches;
     uint64_t loads;
     uint64_t stores;
     uint64_t ifetch_latency;
     uint64_t load_latency;
+    uint64_t warp_instrs;
+    uint64_t diverged_instrs;
+    uint64_t diverged_cycles;
+    uint64_t splits;
+    uint64_t divergent_splits;
+    uint64_t ipdom_depth;
+    uint64_t lanes_hist[4];
+    uint64_t fu_busy[(int)FuType::MAX];   // cycles each iterative unit (ii > 1) was occupied
+    uint64_t fu_stalls[(int)FuType::MAX]; // cycles an input waited on a busy unit
+    uint64_t vpu_busy;                    // cycles the vector pipes could not accept an input
+    uint64_t vpu_busy_stalls;             // cycles a vector input waited on a busy pipe
 
     PerfStats() 
       : cycles(0)
@@ -68,12 +84,57 @@ public:
       , lsu_stalls(0)
       , fpu_stalls(0)
       , sfu_stalls(0)
+      , vpu_stalls(0)
       , ifetches(0)
       , loads(0)
       , stores(0)
       , ifetch_latency(0)
       , load_latency(0)
+      , warp_instrs(0)
+      , diverged_instrs(0)
+      , diverged_cycles(0)
+      , splits(0)
+      , divergent_splits(0)
+      , ipdom_depth(0)
+      , lanes_hist()
+      , fu_busy()
+      , fu_stalls()
+      , vpu_busy(0)
+      , vpu_busy_stalls(0)
     {}
+
+    PerfStats& operator+=(const PerfStats& rhs) {
+      this->cycles         += rhs.cycles;
+      this->instrs         += rhs.instrs;
+      this->ibuf_stalls    += rhs.ibuf_stalls;
+      this->scrb_stalls    += rhs.scrb_stalls;
+      this->alu_stalls     += rhs.alu_stalls;
+      this->lsu_stalls     += rhs.lsu_stalls;
+      this->fpu_stalls     += rhs.fpu_stalls;
+      this->sfu_stalls     += rhs.sfu_stalls;
+      this->vpu_stalls     += rhs.vpu_stalls;
+      this->ifetches       += rhs.ifetches;
+      this->loads          += rhs.loads;
+      this->stores         += rhs.stores;
+      this->ifetch_latency += rhs.ifetch_latency;
+      this->load_latency   += rhs.load_latency;
+      this->warp_instrs    += rhs.warp_instrs;
+      this->diverged_instrs += rhs.diverged_instrs;
+      this->diverged_cycles += rhs.diverged_cycles;
+      this->splits         += rhs.splits;
+      this->divergent_splits += rhs.divergent_splits;
+      this->ipdom_depth    = std::max(this->ipdom_depth, rhs.ipdom_depth);
+      for (uint32_t i = 0; i < 4; ++i) {
+        this->lanes_hist[i] += rhs.lanes_hist[i];
+      }
+      for (uint32_t i = 0; i < (uint32_t)FuType::MAX; ++i) {
+        this->fu_busy[i]   += rhs.fu_busy[i];
+        this->fu_stalls[i] += rhs.fu_stalls[i];
+      }
+      this->vpu_busy        += rhs.vpu_busy;
+      this->vpu_busy_stalls += rhs.vpu_busy_stalls;
+      return *this;
+    }
   };
 
   std::vector<SimPort<MemReq>> icache_req_ports;
@@ -139,6 +200,23 @@ public:
 
   bool check_exit(Word* exitcode, bool riscv_test) const;
 
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  // stop scheduling new instructions so that the pipeline drains
+  void drain(bool enable) {
+    draining_ = enable;
+  }
+
+  // functional warming: execute up to <count> thread instructions without
+  // pipeline timing, only updating the cache tags; the pipeline must be drained
+  uint64_t warm(uint64_t count);
+
+  // save the warps state into a checkpoint, fails if a warp is diverged or
+  // waiting on a barrier since the RTL cannot restore either
+  bool save(Checkpoint* checkpoint) const;
+
 private:
 
   void schedule();
@@ -179,6 +257,7 @@ private:
   uint64_t issued_instrs_;
   uint64_t committed_instrs_;
   bool exited_;
+  bool draining_;
 
   uint64_t pending_ifetches_;
 
@@ -190,6 +269,10 @@ private:
   
   Cluster* cluster_;
 
+  Profiler* profiler_;
+  Tracer* tracer_;
+  ReuseProfiler* reuse_profiler_;
+
   uint32_t commit_exe_;
 
   friend class Warp;
@@ -197,6 +280,8 @@ private:
   friend class AluUnit;
   friend class FpuUnit;
   friend class SfuUnit;
+  friend class VpuUnit;
+  friend class FuOccupancy;
 };
 
 } // namespace vortex
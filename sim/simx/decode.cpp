@@ -24,6 +24,7 @@
 #include "decode.h"
 #include "arch.h"
 #include "instr.h"
+#include "vec_exec.h"
 
 using namespace vortex;
 
@@ -80,7 +81,7 @@ enum Constants {
   shift_vmop  = shift_func7 + width_vmask,
   shift_vnf   = shift_vmop + width_mop,
   shift_func6 = shift_func7 + width_vmask,
-  shift_vset  = shift_func7 + width_func6,
+  shift_vset_kind = 30,
 
   mask_opcode = (1 << width_opcode) - 1,  
   mask_reg    = (1 << width_reg)   - 1,
@@ -91,6 +92,7 @@ enum Constants {
   mask_i_imm  = (1 << width_i_imm) - 1,
   mask_j_imm  = (1 << width_j_imm) - 1,
   mask_v_imm  = (1 << width_v_imm) - 1,
+  mask_vtype_ivli = (1 << (width_v_imm - 1)) - 1,
 };
 
 static const char* op_string(const Instr &instr) {
@@ -231,19 +233,17 @@ static const char* op_string(const Instr &instr) {
   case Opcode::FENCE: return "FENCE";
   case Opcode::FL: 
     switch (func3) {
-    case 0x1: return "VL";
     case 0x2: return "FLW";
     case 0x3: return "FLD";
     default: 
-      std::abort();
+      return VecExec::op_name(instr);
     }
   case Opcode::FS: 
     switch (func3) {
-    case 0x1: return "VS";
     case 0x2: return "FSW";
     case 0x3: return "FSD";
     default: 
-      std::abort();
+      return VecExec::op_name(instr);
     }
   case Opcode::AMO: {
     auto amo_type = func7 >> 2;
@@ -391,7 +391,7 @@ static const char* op_string(const Instr &instr) {
   case Opcode::FMSUB:   return func2 ? "FMSUB.D" : "FMSUB.S";
   case Opcode::FMNMADD: return func2 ? "FNMADD.D" : "FNMADD.S";
   case Opcode::FMNMSUB: return func2 ? "FNMSUB.D" : "FNMSUB.S";
-  case Opcode::VSET:    return "VSET";
+  case Opcode::VSET:    return VecExec::op_name(instr);
   case Opcode::EXT1:
     switch (func7) {
     case 0:
@@ -458,7 +458,18 @@ std::ostream &operator<<(std::ostream &os, const Instr &instr) {
 
 Decoder::Decoder(const Arch&) {}
 
-std::shared_ptr<Instr> Decoder::decode(uint32_t code) const {  
+std::shared_ptr<Instr> Decoder::decode(uint32_t code) const {
+  auto it = cache_.find(code);
+  if (it != cache_.end())
+    return it->second;
+  auto instr = this->decode_instr(code);
+  if (instr) {
+    cache_.emplace(code, instr);
+  }
+  return instr;
+}
+
+std::shared_ptr<Instr> Decoder::decode_instr(uint32_t code) const {  
   auto instr = std::make_shared<Instr>();
   auto op = Opcode((code >> shift_opcode) & mask_opcode);
   instr->setOpcode(op);
@@ -665,46 +676,82 @@ std::shared_ptr<Instr> Decoder::decode(uint32_t code) const {
   case InstType::V_TYPE:
     switch (op) {
     case Opcode::VSET: {
-      instr->setDestReg(rd, RegType::Vector);
-      instr->addSrcReg(rs1, RegType::Vector);
       instr->setFunc3(func3);
       if (func3 == 7) {
-        instr->setImm(!(code >> shift_vset));
-        if (instr->getImm()) {
-          auto immed = (code >> shift_rs2) & mask_v_imm;
-          instr->setImm(immed);
-          instr->setVlmul(immed & 0x3);
-          instr->setVediv((immed >> 4) & 0x3);
-          instr->setVsew((immed >> 2) & 0x3);
+        // vsetvli, vsetivli, vsetvl
+        auto kind = code >> shift_vset_kind;
+        instr->setFunc2(kind);
+        instr->setDestReg(rd, RegType::Integer);
+        if (kind == 3) {
+          instr->addSrcReg(rs1, RegType::None);
+          instr->setImm((code >> shift_rs2) & mask_vtype_ivli);
+        } else if (kind == 2) {
+          instr->addSrcReg(rs1, RegType::Integer);
+          instr->addSrcReg(rs2, RegType::Integer);
         } else {
-          instr->addSrcReg(rs2, RegType::Vector);
+          instr->addSrcReg(rs1, RegType::Integer);
+          instr->setImm((code >> shift_rs2) & mask_v_imm);
         }
       } else {
+        // vs1 holds a sub-opcode in the unary groups
+        bool unary = (func3 == 2 && (func6 == 0x10 || func6 == 0x12 || func6 == 0x14))
+                  || (func3 == 1 && (func6 == 0x10 || func6 == 0x12 || func6 == 0x13));
+        switch (func3) {
+        case 0: case 1: case 2: // OPIVV, OPFVV, OPMVV
+          instr->addSrcReg(rs1, unary ? RegType::None : RegType::Vector);
+          break;
+        case 4: case 6: // OPIVX, OPMVX
+          instr->addSrcReg(rs1, RegType::Integer);
+          break;
+        case 5: // OPFVF
+          instr->addSrcReg(rs1, RegType::Float);
+          break;
+        default: // OPIVI
+          instr->addSrcReg(rs1, RegType::None);
+          break;
+        }
         instr->addSrcReg(rs2, RegType::Vector);
+        if (func3 == 2 && func6 == 0x10) {
+          // vmv.x.s, vcpop.m, vfirst.m
+          instr->setDestReg(rd, RegType::Integer);
+        } else if (func3 == 1 && func6 == 0x10) {
+          // vfmv.f.s
+          instr->setDestReg(rd, RegType::Float);
+        } else {
+          instr->setDestReg(rd, RegType::Vector);
+        }
         instr->setVmask((code >> shift_func7) & 0x1);
         instr->setFunc6(func6);
       }
     } break;
 
     case Opcode::FL:
-      instr->setDestReg(rd, RegType::Vector);
-      instr->addSrcReg(rs1, RegType::Vector);
-      instr->setVlsWidth(func3);
-      instr->addSrcReg(rs2, RegType::Vector);
-      instr->setVmask(code >> shift_func7);
-      instr->setVmop((code >> shift_vmop) & mask_func3);
-      instr->setVnf((code >> shift_vnf) & mask_func3);
-      break;
-
-    case Opcode::FS:
-      instr->setVs3(rd);
-      instr->addSrcReg(rs1, RegType::Vector);
+    case Opcode::FS: {
+      // mop with mew in bit 2
+      auto mop = (code >> shift_vmop) & mask_func3;
+      if (op == Opcode::FL) {
+        instr->setDestReg(rd, RegType::Vector);
+      } else {
+        instr->setVs3(rd);
+      }
+      instr->addSrcReg(rs1, RegType::Integer);
+      switch (mop & 0x3) {
+      case 0: // unit-stride, rs2 holds lumop/sumop
+        instr->addSrcReg(rs2, RegType::None);
+        break;
+      case 2: // strided
+        instr->addSrcReg(rs2, RegType::Integer);
+        break;
+      default: // indexed
+        instr->addSrcReg(rs2, RegType::Vector);
+        break;
+      }
+      instr->setFunc3(func3);
       instr->setVlsWidth(func3);
-      instr->addSrcReg(rs2, RegType::Vector);
-      instr->setVmask(code >> shift_func7);
-      instr->setVmop((code >> shift_vmop) & mask_func3);
+      instr->setVmask((code >> shift_func7) & 0x1);
+      instr->setVmop(mop);
       instr->setVnf((code >> shift_vnf) & mask_func3);
-      break;
+    } break;
 
     default:
       std::abort();
@@ -15,6 +15,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 namespace vortex {
 
@@ -26,6 +27,13 @@ public:
   Decoder(const Arch &);    
   
   std::shared_ptr<Instr> decode(uint32_t code) const;
+
+private:
+
+  std::shared_ptr<Instr> decode_instr(uint32_t code) const;
+
+  // decoded instructions indexed by encoding, kept across kernel launches
+  mutable std::unordered_map<uint32_t, std::shared_ptr<Instr>> cache_;
 };
 
 }
\ No newline at end of file
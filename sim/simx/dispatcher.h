@@ -24,14 +24,14 @@ public:
 
     Dispatcher(const SimContext& ctx, const Arch& arch, uint32_t buf_size, uint32_t block_size, uint32_t num_lanes) 
         : SimObject<Dispatcher>(ctx, "Dispatcher") 
-        , Outputs(ISSUE_WIDTH, this)
-        , Inputs_(ISSUE_WIDTH, this)
+        , Outputs(arch.issue_width(), this)
+        , Inputs_(arch.issue_width(), this)
         , arch_(arch)
-        , queues_(ISSUE_WIDTH, std::queue<pipeline_trace_t*>())
+        , queues_(arch.issue_width(), std::queue<pipeline_trace_t*>())
         , buf_size_(buf_size)        
         , block_size_(block_size)        
         , num_lanes_(num_lanes)        
-        , batch_count_(ISSUE_WIDTH / block_size)
+        , batch_count_(arch.issue_width() / block_size)
         , pid_count_(arch.num_threads() / num_lanes)
         , batch_idx_(0)
         , start_p_(block_size, 0)
@@ -47,7 +47,7 @@ public:
     }
 
     virtual void tick() {
-        for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+        for (uint32_t i = 0; i < arch_.issue_width(); ++i) {
             auto& queue = queues_.at(i);
             if (queue.empty())
                 continue;
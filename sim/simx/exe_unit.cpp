@@ -21,31 +21,92 @@
 #include "core.h"
 #include "constants.h"
 #include "cache_sim.h"
+#include "profiler.h"
 
 using namespace vortex;
 
-AluUnit::AluUnit(const SimContext& ctx, Core* core) : ExeUnit(ctx, core, "ALU") {}
+ExeUnit::ExeUnit(const SimContext& ctx, Core* core, const char* name) 
+    : SimObject<ExeUnit>(ctx, name) 
+    , Inputs(core->arch().issue_width(), this)
+    , Outputs(core->arch().issue_width(), this)
+    , core_(core)
+    , issue_width_(core->arch().issue_width())
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FuOccupancy::FuOccupancy(Core* core, uint32_t num_blocks)
+    : core_(core)
+    , busy_until_(num_blocks)
+{
+    for (uint32_t i = 0; i < (uint32_t)FuType::MAX; ++i) {
+        latency_[i] = core->arch().fu_latency((FuType)i);
+        ii_[i] = core->arch().fu_ii((FuType)i);
+    }
+    this->reset();
+}
+
+void FuOccupancy::reset() {
+    for (auto& block : busy_until_) {
+        block.fill(0);
+    }
+}
+
+bool FuOccupancy::acquire(uint32_t block, FuType fu_type) {
+    auto cycles = SimPlatform::instance().cycles();
+    auto& busy_until = busy_until_.at(block).at((int)fu_type);
+    if (cycles < busy_until) {
+        ++core_->perf_stats_.fu_stalls[(int)fu_type];
+        return false;
+    }
+    auto ii = ii_[(int)fu_type];
+    busy_until = cycles + ii;
+    // a fully pipelined unit is never busy
+    if (ii > 1) {
+        core_->perf_stats_.fu_busy[(int)fu_type] += ii;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+AluUnit::AluUnit(const SimContext& ctx, Core* core) 
+    : ExeUnit(ctx, core, "ALU")
+    , fu_occupancy_(core, core->arch().num_alu_blocks())
+    , num_blocks_(core->arch().num_alu_blocks())
+{}
+
+void AluUnit::reset() {
+    fu_occupancy_.reset();
+}
     
 void AluUnit::tick() {    
-    for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+    for (uint32_t i = 0; i < issue_width_; ++i) {
         auto& input = Inputs.at(i);
         if (input.empty()) 
             continue;
         auto& output = Outputs.at(i);
         auto trace = input.front();
+        FuType fu_type;
         switch (trace->alu_type) {
         case AluType::ARITH:        
         case AluType::BRANCH:
         case AluType::SYSCALL:
+            fu_type = FuType::ALU;
+            break;
         case AluType::IMUL:
-            output.send(trace, LATENCY_IMUL+1);
+            fu_type = FuType::IMUL;
             break;
         case AluType::IDIV:
-            output.send(trace, XLEN+1);
+            fu_type = FuType::IDIV;
             break;
         default:
             std::abort();
         }
+        // issue slots share the units of their block
+        if (!fu_occupancy_.acquire(i % num_blocks_, fu_type))
+            continue;
+        output.send(trace, fu_occupancy_.latency(fu_type));
         DT(3, "pipeline-execute: op=" << trace->alu_type << ", " << *trace);
         if (trace->eop && trace->fetch_stall) {
             assert(core_->stalled_warps_.test(trace->wid));
@@ -58,34 +119,46 @@ void AluUnit::tick() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-FpuUnit::FpuUnit(const SimContext& ctx, Core* core) : ExeUnit(ctx, core, "FPU") {}
+FpuUnit::FpuUnit(const SimContext& ctx, Core* core) 
+    : ExeUnit(ctx, core, "FPU")
+    , fu_occupancy_(core, core->arch().num_fpu_blocks())
+    , num_blocks_(core->arch().num_fpu_blocks())
+{}
+
+void FpuUnit::reset() {
+    fu_occupancy_.reset();
+}
     
 void FpuUnit::tick() {
-    for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
+    for (uint32_t i = 0; i < issue_width_; ++i) {
         auto& input = Inputs.at(i);
         if (input.empty()) 
             continue;
         auto& output = Outputs.at(i);
         auto trace = input.front();
+        FuType fu_type;
         switch (trace->fpu_type) {
         case FpuType::FNCP:
-            output.send(trace, 2);
+            fu_type = FuType::FNCP;
             break;
         case FpuType::FMA:
-            output.send(trace, LATENCY_FMA+1);
+            fu_type = FuType::FMA;
             break;
         case FpuType::FDIV:
-            output.send(trace, LATENCY_FDIV+1);
+            fu_type = FuType::FDIV;
             break;
         case FpuType::FSQRT:
-            output.send(trace, LATENCY_FSQRT+1);
+            fu_type = FuType::FSQRT;
             break;
         case FpuType::FCVT:
-            output.send(trace, LATENCY_FCVT+1);
+            fu_type = FuType::FCVT;
             break;
         default:
             std::abort();
         }    
+        if (!fu_occupancy_.acquire(i % num_blocks_, fu_type))
+            continue;
+        output.send(trace, fu_occupancy_.latency(fu_type));
         DT(3, "pipeline-execute: op=" << trace->fpu_type << ", " << *trace);
         auto time = input.pop();
         core_->perf_stats_.fpu_stalls += (SimPlatform::instance().cycles() - time);
@@ -96,17 +169,21 @@ void FpuUnit::tick() {
 
 LsuUnit::LsuUnit(const SimContext& ctx, Core* core) 
     : ExeUnit(ctx, core, "LSU")
-    , pending_rd_reqs_(LSUQ_SIZE)
-    , num_lanes_(NUM_LSU_LANES)     
+    , pending_rd_reqs_(core->arch().lsuq_size())
+    , num_lanes_(core->arch().num_lsu_lanes())     
     , pending_loads_(0)
     , fence_lock_(false)
     , input_idx_(0)
+    , vec_round_(0)
+    , vec_tag_(0)
+    , vec_input_(0)
 {}
 
 void LsuUnit::reset() {
     pending_rd_reqs_.clear();
     pending_loads_ = 0;
     fence_lock_ = false;
+    vec_round_ = 0;
 }
 
 void LsuUnit::tick() {    
@@ -125,7 +202,10 @@ void LsuUnit::tick() {
         assert(entry.count);
         --entry.count; // track remaining addresses 
         if (0 == entry.count) {
-            int iw = trace->wid % ISSUE_WIDTH;
+            if (core_->profiler_) {
+                core_->profiler_->mem_latency(trace, SimPlatform::instance().cycles() - entry.issue_time);
+            }
+            int iw = trace->wid % issue_width_;
             auto& output = Outputs.at(iw);
             output.send(trace, 1);
             pending_rd_reqs_.release(mem_rsp.tag);
@@ -146,7 +226,10 @@ void LsuUnit::tick() {
         assert(entry.count);
         --entry.count; // track remaining addresses 
         if (0 == entry.count) {
-            int iw = trace->wid % ISSUE_WIDTH;
+            if (core_->profiler_) {
+                core_->profiler_->mem_latency(trace, SimPlatform::instance().cycles() - entry.issue_time);
+            }
+            int iw = trace->wid % issue_width_;
             auto& output = Outputs.at(iw);
             output.send(trace, 1);
             pending_rd_reqs_.release(mem_rsp.tag);
@@ -159,7 +242,7 @@ void LsuUnit::tick() {
         // wait for all pending memory operations to complete
         if (!pending_rd_reqs_.empty())
             return;
-        int iw = fence_state_->wid % ISSUE_WIDTH;
+        int iw = fence_state_->wid % issue_width_;
         auto& output = Outputs.at(iw);
         output.send(fence_state_, 1);
         fence_lock_ = false;
@@ -167,8 +250,10 @@ void LsuUnit::tick() {
     }    
 
     // check input queue
-    for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
-        int iw = (input_idx_ + i) % ISSUE_WIDTH;
+    for (uint32_t i = 0; i < issue_width_; ++i) {
+        int iw = (input_idx_ + i) % issue_width_;
+        if (vec_round_ != 0 && (uint32_t)iw != vec_input_)
+            continue; // finish the vector access in progress first
         auto& input = Inputs.at(iw);
         if (input.empty())
             continue;
@@ -190,7 +275,7 @@ void LsuUnit::tick() {
         }
 
         // check pending queue capacity    
-        if (pending_rd_reqs_.full()) {
+        if (0 == vec_round_ && pending_rd_reqs_.full()) {
             if (!trace->log_once(true)) {
                 DT(3, "*** " << this->name() << "-lsu-queue-stall: " << *trace);
             }
@@ -201,6 +286,70 @@ void LsuUnit::tick() {
         
         bool is_write = (trace->lsu_type == LsuType::STORE);
 
+        if (!trace_data->vec_addrs.empty()) {
+            // vector access: every cycle, each lane sends the next cache line of its thread
+            if (0 == vec_round_) {
+                uint32_t count = 0;
+                for (uint32_t t = 0; t < num_lanes_; ++t) {
+                    if (trace->tmask.test(t0 + t)) {
+                        count += trace_data->vec_addrs.at(t0 + t).size();
+                    }
+                }
+                if (0 == count) {
+                    // no active element
+                    output.send(trace, 1);
+                    auto time = input.pop();
+                    core_->perf_stats_.lsu_stalls += (SimPlatform::instance().cycles() - time);
+                    break;
+                }
+                vec_tag_ = pending_rd_reqs_.allocate({trace, count, SimPlatform::instance().cycles()});
+                vec_input_ = iw;
+            }
+            bool done = true;
+            for (uint32_t t = 0; t < num_lanes_; ++t) {
+                if (!trace->tmask.test(t0 + t))
+                    continue;
+                auto& addrs = trace_data->vec_addrs.at(t0 + t);
+                if (vec_round_ >= addrs.size())
+                    continue;
+
+                auto& dcache_req_port = core_->dcache_req_ports.at(t);
+                auto mem_addr = addrs.at(vec_round_);
+
+                MemReq mem_req;
+                mem_req.addr  = mem_addr.addr;
+                mem_req.write = is_write;
+                mem_req.type  = core_->get_addr_type(mem_addr.addr);
+                mem_req.tag   = vec_tag_;
+                mem_req.cid   = trace->cid;
+                mem_req.uuid  = trace->uuid;
+
+                dcache_req_port.send(mem_req, 2);
+                DT(3, "dcache-req: addr=0x" << std::hex << mem_req.addr << ", tag=" << vec_tag_ 
+                    << ", lsu_type=" << trace->lsu_type << ", tid=" << t << ", addr_type=" << mem_req.type << ", " << *trace);
+
+                ++pending_loads_;
+                ++core_->perf_stats_.loads;
+                done &= (vec_round_ + 1 >= addrs.size());
+            }
+            if (!done) {
+                ++vec_round_;
+                break;
+            }
+            vec_round_ = 0;
+
+            // do not wait on writes
+            if (is_write) {
+                pending_rd_reqs_.release(vec_tag_);
+                output.send(trace, 1);
+                ++core_->perf_stats_.stores;
+            }
+
+            auto time = input.pop();
+            core_->perf_stats_.lsu_stalls += (SimPlatform::instance().cycles() - time);
+            break;
+        }
+
         // duplicates detection
         bool is_dup = false;
         if (trace->tmask.test(t0)) {
@@ -223,7 +372,7 @@ void LsuUnit::tick() {
             addr_count = trace->tmask.count();
         }
 
-        auto tag = pending_rd_reqs_.allocate({trace, addr_count});
+        auto tag = pending_rd_reqs_.allocate({trace, addr_count, SimPlatform::instance().cycles()});
 
         for (uint32_t t = 0; t < num_lanes_; ++t) {
             if (!trace->tmask.test(t0 + t))
@@ -269,6 +418,89 @@ void LsuUnit::tick() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+VpuUnit::VpuUnit(const SimContext& ctx, Core* core) 
+    : ExeUnit(ctx, core, "VPU")
+    , num_lanes_(core->arch().num_vpu_lanes())
+    , vregs_(core->arch().num_warps())
+    , input_idx_(0)
+{
+    for (uint32_t i = 0; i < (uint32_t)FuType::MAX; ++i) {
+        latency_[i] = core->arch().fu_latency((FuType)i);
+        ii_[i] = core->arch().fu_ii((FuType)i);
+    }
+    this->reset();
+}
+
+void VpuUnit::reset() {
+    busy_until_.fill(0);
+    for (auto& regs : vregs_) {
+        regs.fill({0, 0});
+    }
+    input_idx_ = 0;
+}
+
+void VpuUnit::tick() {
+    auto cycles = SimPlatform::instance().cycles();
+    for (uint32_t i = 0; i < issue_width_; ++i) {
+        int iw = (input_idx_ + i) % issue_width_;
+        auto& input = Inputs.at(iw);
+        if (input.empty())
+            continue;
+        auto& output = Outputs.at(iw);
+        auto trace = input.front();
+        auto trace_data = std::dynamic_pointer_cast<VpuTraceData>(trace->data);
+        int fu = (int)trace_data->fu_type;
+
+        // the pipe is still streaming the previous instruction
+        if (cycles < busy_until_[fu]) {
+            ++core_->perf_stats_.vpu_busy_stalls;
+            continue;
+        }
+
+        auto groups = std::max<uint32_t>((trace_data->elements + num_lanes_ - 1) / num_lanes_, 1);
+        uint64_t occupancy = uint64_t(groups) * ii_[fu];
+
+        // sources still in flight: chained ones gate the first and the last
+        // element group, the others have to be complete
+        auto& regs = vregs_.at(trace->wid);
+        uint64_t start = cycles;
+        uint64_t src_last = 0;
+        for (uint32_t r = 0; r < MAX_NUM_REGS; ++r) {
+            if (!trace->used_vregs.test(r) || regs[r].last_ready < cycles)
+                continue;
+            if (trace_data->chainable) {
+                start = std::max(start, regs[r].first_ready);
+                src_last = std::max(src_last, regs[r].last_ready);
+            } else {
+                start = std::max(start, regs[r].last_ready + 1);
+            }
+        }
+        uint64_t last_issue = std::max(start + occupancy - ii_[fu], src_last);
+        uint64_t first_ready = start + latency_[fu];
+        uint64_t last_ready = last_issue + latency_[fu];
+        busy_until_[fu] = last_issue + ii_[fu];
+        core_->perf_stats_.vpu_busy += occupancy;
+
+        if (trace->wb && trace->rdest_type == RegType::Vector) {
+            for (uint32_t r = 0; r < trace->rdest_count; ++r) {
+                regs[trace->rdest + r] = {trace_data->chainable ? first_ready : last_ready, last_ready};
+            }
+            if (trace_data->chainable) {
+                core_->scoreboard_.chain(trace);
+            }
+        }
+
+        output.send(trace, last_ready - cycles);
+        DT(3, "pipeline-execute: fu=" << trace_data->fu_type << ", elements=" << trace_data->elements 
+            << ", chained=" << (src_last != 0) << ", start=" << start << ", done=" << last_ready << ", " << *trace);
+        auto time = input.pop();
+        core_->perf_stats_.vpu_stalls += (cycles - time);
+    }
+    ++input_idx_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SfuUnit::SfuUnit(const SimContext& ctx, Core* core) 
     : ExeUnit(ctx, core, "SFU")
     , input_idx_(0)
@@ -276,8 +508,8 @@ SfuUnit::SfuUnit(const SimContext& ctx, Core* core)
     
 void SfuUnit::tick() {
     // check input queue
-    for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
-        int iw = (input_idx_ + i) % ISSUE_WIDTH;        
+    for (uint32_t i = 0; i < issue_width_; ++i) {
+        int iw = (input_idx_ + i) % issue_width_;        
         auto& input = Inputs.at(iw);
         if (input.empty())
             continue;
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <array>
 #include <simobject.h>
 #include "pipeline.h"
 #include "cache_sim.h"
@@ -21,17 +22,35 @@ namespace vortex {
 
 class Core;
 
+// Occupancy of the functional units of the ALU or FPU blocks. A unit accepts
+// a new input every initiation interval; inputs arriving earlier are left in
+// their queue and counted as structural stalls.
+class FuOccupancy {
+public:
+    FuOccupancy(Core* core, uint32_t num_blocks);
+
+    void reset();
+
+    // reserves the unit for its initiation interval, returns false if busy
+    bool acquire(uint32_t block, FuType fu_type);
+
+    uint32_t latency(FuType fu_type) const {
+        return latency_[(int)fu_type];
+    }
+
+private:
+    Core* core_;
+    std::array<uint32_t, (int)FuType::MAX> latency_;
+    std::array<uint32_t, (int)FuType::MAX> ii_;
+    std::vector<std::array<uint64_t, (int)FuType::MAX>> busy_until_; // [block][unit]
+};
+
 class ExeUnit : public SimObject<ExeUnit> {
 public:
     std::vector<SimPort<pipeline_trace_t*>> Inputs;
     std::vector<SimPort<pipeline_trace_t*>> Outputs;
 
-    ExeUnit(const SimContext& ctx, Core* core, const char* name) 
-        : SimObject<ExeUnit>(ctx, name) 
-        , Inputs(ISSUE_WIDTH, this)
-        , Outputs(ISSUE_WIDTH, this)
-        , core_(core)
-    {}
+    ExeUnit(const SimContext& ctx, Core* core, const char* name);
     
     virtual ~ExeUnit() {}
 
@@ -41,6 +60,7 @@ public:
 
 protected:
     Core* core_;
+    uint32_t issue_width_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -48,8 +68,14 @@ protected:
 class AluUnit : public ExeUnit {
 public:
     AluUnit(const SimContext& ctx, Core*);
+
+    void reset();
     
     void tick();
+
+private:
+    FuOccupancy fu_occupancy_;
+    uint32_t num_blocks_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -57,8 +83,14 @@ public:
 class FpuUnit : public ExeUnit {
 public:
     FpuUnit(const SimContext& ctx, Core*);
+
+    void reset();
     
     void tick();
+
+private:
+    FuOccupancy fu_occupancy_;
+    uint32_t num_blocks_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -75,6 +107,7 @@ private:
     struct pending_req_t {
       pipeline_trace_t* trace;
       uint32_t count;
+      uint64_t issue_time;
     };
     HashTable<pending_req_t> pending_rd_reqs_;    
     uint32_t num_lanes_;
@@ -82,6 +115,37 @@ private:
     uint64_t pending_loads_;
     bool fence_lock_;
     uint32_t input_idx_;
+    uint32_t vec_round_;  // next cache line of the vector access in progress
+    uint32_t vec_tag_;
+    uint32_t vec_input_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Lane-parallel vector unit. Each functional unit type is a pipe that takes
+// num_vpu_lanes elements every initiation interval, so an instruction holds
+// its pipe for ceil(elements / lanes) intervals. Element-wise producers are
+// chained: a consumer may start once the first elements of its sources are
+// out, and its last elements complete after the producer's last ones.
+class VpuUnit : public ExeUnit {
+public:
+    VpuUnit(const SimContext& ctx, Core*);
+
+    void reset();
+
+    void tick();
+
+private:
+    struct vreg_timing_t {
+      uint64_t first_ready; // cycle the first elements are available
+      uint64_t last_ready;  // cycle the whole register is written
+    };
+    uint32_t num_lanes_;
+    std::array<uint32_t, (int)FuType::MAX> latency_;
+    std::array<uint32_t, (int)FuType::MAX> ii_;
+    std::array<uint64_t, (int)FuType::MAX> busy_until_;
+    std::vector<std::array<vreg_timing_t, MAX_NUM_REGS>> vregs_; // [warp][reg]
+    uint32_t input_idx_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,7 @@
 #include "warp.h"
 #include "instr.h"
 #include "core.h"
+#include "profiler.h"
 
 using namespace vortex;
 
@@ -74,7 +75,6 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
 
   auto func2  = instr.getFunc2();
   auto func3  = instr.getFunc3();
-  auto func6  = instr.getFunc6();
   auto func7  = instr.getFunc7();
 
   auto opcode = instr.getOpcode();
@@ -83,7 +83,6 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
   auto rsrc1  = instr.getRSrc(1);
   auto rsrc2  = instr.getRSrc(2);
   auto immsrc = sext((Word)instr.getImm(), 32);
-  auto vmask  = instr.getVmask();
 
   auto num_threads = arch_.num_threads();
 
@@ -129,7 +128,7 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
         DPN(2, "}" << std::endl);
         break;
       case RegType::Vector:
-        // TODO:
+        // read by the vector model
         break;
       case RegType::None:
         break;
@@ -645,6 +644,11 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
   }
   case L_INST:
   case FL: {
+    if (opcode == FL && func3 != 2 && func3 != 3) {
+      // RVV loads
+      this->execute_vector(instr, trace);
+      break;
+    }
     trace->exe_type = ExeType::LSU;    
     trace->lsu_type = LsuType::LOAD;
     trace->used_iregs.set(rsrc0);
@@ -687,28 +691,17 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           std::abort();      
         }
       }
-    } else {
-      auto &vd = vreg_file_.at(rdest);
-      switch (instr.getVlsWidth()) {
-      case 6: {
-        for (uint32_t i = 0; i < vl_; i++) {
-          Word mem_addr = ((rsdata[i][0].i) & 0xFFFFFFFC) + (i * vtype_.vsew / 8);
-          Word mem_data = 0;
-          core_->dcache_read(&mem_data, mem_addr, 4);
-          Word *result_ptr = (Word *)(vd.data() + i);
-          *result_ptr = mem_data;
-        }
-        break;
-      } 
-      default:
-        std::abort();
-      }
     }
     rd_write = true;
     break;
   }
   case S_INST:   
   case FS: {
+    if (opcode == FS && func3 != 2 && func3 != 3) {
+      // RVV stores
+      this->execute_vector(instr, trace);
+      break;
+    }
     trace->exe_type = ExeType::LSU;    
     trace->lsu_type = LsuType::STORE;
     trace->used_iregs.set(rsrc0);
@@ -736,20 +729,6 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           std::abort();
         }
       }
-    } else {
-      for (uint32_t i = 0; i < vl_; i++) {
-        uint64_t mem_addr = rsdata[i][0].i + (i * vtype_.vsew / 8);        
-        switch (instr.getVlsWidth()) {
-        case 6: {
-          // store word and unit strided (not checking for unit stride)          
-          uint32_t mem_data = *(uint32_t *)(vreg_file_.at(instr.getVs3()).data() + i);
-          core_->dcache_write(&mem_data, mem_addr, 4);
-          break;
-        } 
-        default:
-          std::abort();
-        }          
-      }
     }
     break;
   }
@@ -1361,6 +1340,12 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           ipdom_stack_.emplace(tmask_);
           // push else's thread mask onto the stack
           ipdom_stack_.emplace(else_tmask, next_pc);
+          ++core_->perf_stats_.divergent_splits;
+          core_->perf_stats_.ipdom_depth = std::max<uint64_t>(core_->perf_stats_.ipdom_depth, ipdom_stack_.size());
+        }
+        ++core_->perf_stats_.splits;
+        if (core_->profiler_) {
+          core_->profiler_->split(trace, is_divergent);
         }
         // return divergent state
         for (uint32_t t = thread_start; t < num_threads; ++t) {
@@ -1386,7 +1371,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
             next_pc = ipdom_stack_.top().PC;
           }          
           ipdom_stack_.pop();
-        }    
+        }
+        if (core_->profiler_) {
+          core_->profiler_->join(trace, is_divergent != 0);
+        }
       } break;
       case 4: {
         // BAR
@@ -1412,7 +1400,10 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
           next_tmask &= pred;
         } else {
           next_tmask = ireg_file_.at(thread_start).at(rsrc1);
-        }      
+        }
+        if (core_->profiler_) {
+          core_->profiler_->split(trace, pred.any() && pred != tmask_);
+        }
       } break;
       default:
         std::abort();
@@ -1448,853 +1439,8 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
     }
   } break;
   case VSET: {
-    uint32_t VLEN = arch_.vsize() * 8;
-    uint32_t VLMAX = (instr.getVlmul() * VLEN) / instr.getVsew();
-    switch (func3) {
-    case 0: // vector-vector
-      switch (func6) {
-      case 0: {
-        auto& vr1 = vreg_file_.at(rsrc0);
-        auto& vr2 = vreg_file_.at(rsrc1);
-        auto& vd = vreg_file_.at(rdest);
-        auto& mask = vreg_file_.at(0);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t emask = *(uint8_t *)(mask.data() + i);
-            uint8_t value = emask & 0x1;
-            if (vmask || (!vmask && value)) {
-              uint8_t first  = *(uint8_t *)(vr1.data() + i);
-              uint8_t second = *(uint8_t *)(vr2.data() + i);
-              uint8_t result = first + second;
-              DP(3, "Adding " << first << " + " << second << " = " << result);
-              *(uint8_t *)(vd.data() + i) = result;
-            }
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t emask = *(uint16_t *)(mask.data() + i);
-            uint16_t value = emask & 0x1;
-            if (vmask || (!vmask && value)) {
-              uint16_t first  = *(uint16_t *)(vr1.data() + i);
-              uint16_t second = *(uint16_t *)(vr2.data() + i);
-              uint16_t result = first + second;
-              DP(3, "Adding " << first << " + " << second << " = " << result);
-              *(uint16_t *)(vd.data() + i) = result;
-            }
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t emask = *(uint32_t *)(mask.data() + i);
-            uint32_t value = emask & 0x1;
-            if (vmask || (!vmask && value)) {
-              uint32_t first  = *(uint32_t *)(vr1.data() + i);
-              uint32_t second = *(uint32_t *)(vr2.data() + i);
-              uint32_t result = first + second;
-              DP(3, "Adding " << first << " + " << second << " = " << result);
-              *(uint32_t *)(vd.data() + i) = result;
-            }
-          }
-        }                
-      } break;
-      case 24: {
-        // vmseq
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first == second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first == second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first == second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 25: { 
-        // vmsne
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first != second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first != second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first != second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 26: {
-        // vmsltu
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 27: {
-        // vmslt
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int8_t first  = *(int8_t *)(vr1.data() + i);
-            int8_t second = *(int8_t *)(vr2.data() + i);
-            int8_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int16_t first  = *(int16_t *)(vr1.data() + i);
-            int16_t second = *(int16_t *)(vr2.data() + i);
-            int16_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int32_t first  = *(int32_t *)(vr1.data() + i);
-            int32_t second = *(int32_t *)(vr2.data() + i);
-            int32_t result = (first < second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 28: {
-        // vmsleu
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 29: {
-        // vmsle
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int8_t first  = *(int8_t *)(vr1.data() + i);
-            int8_t second = *(int8_t *)(vr2.data() + i);
-            int8_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int16_t first  = *(int16_t *)(vr1.data() + i);
-            int16_t second = *(int16_t *)(vr2.data() + i);
-            int16_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int32_t first  = *(int32_t *)(vr1.data() + i);
-            int32_t second = *(int32_t *)(vr2.data() + i);
-            int32_t result = (first <= second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 30: {
-        // vmsgtu
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      case 31: {
-        // vmsgt
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int8_t first  = *(int8_t *)(vr1.data() + i);
-            int8_t second = *(int8_t *)(vr2.data() + i);
-            int8_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int16_t first  = *(int16_t *)(vr1.data() + i);
-            int16_t second = *(int16_t *)(vr2.data() + i);
-            int16_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int16_t *)(vd.data() + i) = result;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            int32_t first  = *(int32_t *)(vr1.data() + i);
-            int32_t second = *(int32_t *)(vr2.data() + i);
-            int32_t result = (first > second) ? 1 : 0;
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(int32_t *)(vd.data() + i) = result;
-          }
-        }
-      } break;
-      }
-      break;
-    case 2: {
-      switch (func6) {
-      case 24: { 
-        // vmandnot
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = (first_value & !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }            
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = (first_value & !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = (first_value & !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 25: {
-        // vmand
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = (first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = (first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = (first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 26: {
-        // vmor
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = (first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = (first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = (first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 27: { 
-        // vmxor
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = (first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = (first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = (first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 28: {
-        // vmornot
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = (first_value | !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = (first_value | !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = (first_value | !second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 29: {
-        // vmnand
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = !(first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = !(first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = !(first_value & second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 30: {
-        // vmnor
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = !(first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = !(first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = !(first_value | second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 31: {
-        // vmxnor
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t first_value  = (first & 0x1);
-            uint8_t second_value = (second & 0x1);
-            uint8_t result = !(first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t first_value  = (first & 0x1);
-            uint16_t second_value = (second & 0x1);
-            uint16_t result = !(first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t first_value  = (first & 0x1);
-            uint32_t second_value = (second & 0x1);
-            uint32_t result = !(first_value ^ second_value);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 37: {
-        // vmul
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 45: {
-        // vmacc
-        auto &vr1 = vreg_file_.at(rsrc0);
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t first  = *(uint8_t *)(vr1.data() + i);
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) += result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t first  = *(uint16_t *)(vr1.data() + i);
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) += result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t first  = *(uint32_t *)(vr1.data() + i);
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (first * second);
-            DP(3, "Comparing " << first << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) += result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      }
-    } break;
-    case 6: {
-      switch (func6) {
-      case 0: {
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (rsdata[i][0].i + second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      case 37: {
-        // vmul.vx
-        auto &vr2 = vreg_file_.at(rsrc1);
-        auto &vd = vreg_file_.at(rdest);
-        if (vtype_.vsew == 8) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint8_t second = *(uint8_t *)(vr2.data() + i);
-            uint8_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint8_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint8_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 16) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint16_t second = *(uint16_t *)(vr2.data() + i);
-            uint16_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint16_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint16_t *)(vd.data() + i) = 0;
-          }
-        } else if (vtype_.vsew == 32) {
-          for (uint32_t i = 0; i < vl_; i++) {
-            uint32_t second = *(uint32_t *)(vr2.data() + i);
-            uint32_t result = (rsdata[i][0].i * second);
-            DP(3, "Comparing " << rsdata[i][0].i << " + " << second << " = " << result);
-            *(uint32_t *)(vd.data() + i) = result;
-          }
-          for (uint32_t i = vl_; i < VLMAX; i++) {
-            *(uint32_t *)(vd.data() + i) = 0;
-          }
-        }
-      } break;
-      }
-    } break;
-    case 7: {
-      vtype_.vill  = 0;
-      vtype_.vediv = instr.getVediv();
-      vtype_.vsew  = instr.getVsew();
-      vtype_.vlmul = instr.getVlmul();
-
-      DP(3, "lmul:" << vtype_.vlmul << " sew:" << vtype_.vsew  << " ediv: " << vtype_.vediv << "rsrc_" << rsdata[0][0].i << "VLMAX" << VLMAX);
-
-      auto s0 = rsdata[0][0].u;
-      if (s0 <= VLMAX) {
-        vl_ = s0;
-      } else if (s0 < (2 * VLMAX)) {
-        vl_ = (uint32_t)ceil((s0 * 1.0) / 2.0);
-      } else if (s0 >= (2 * VLMAX)) {
-        vl_ = VLMAX;
-      }        
-      rddata[0].i = vl_;
-    } break;
-    default:
-      std::abort();
-    }
-  } break;    
+    this->execute_vector(instr, trace);
+  } break;
   default:
     std::abort();
   }
@@ -2358,4 +1504,155 @@ void Warp::execute(const Instr &instr, pipeline_trace_t *trace) {
       core_->active_warps_.reset(warp_id_);
     }
   }
-}
\ No newline at end of file
+}
+namespace {
+
+// vector loads and stores go through the same memory path as the scalar ones
+class CoreVecMem : public VecMem {
+public:
+  CoreVecMem(Core* core) : core_(core) {}
+
+  void read(void* data, uint64_t addr, uint32_t size) override {
+    core_->dcache_read(data, addr, size);
+  }
+
+  void write(const void* data, uint64_t addr, uint32_t size) override {
+    core_->dcache_write(data, addr, size);
+  }
+
+private:
+  Core* core_;
+};
+
+}
+
+void Warp::execute_vector(const Instr &instr, pipeline_trace_t *trace) {
+  auto opcode = instr.getOpcode();
+  auto num_threads = arch_.num_threads();
+  bool is_mem = (opcode == FL || opcode == FS);
+  bool is_vset = (opcode == VSET && instr.getFunc3() == 7);
+
+  LsuTraceData::Ptr lsu_data;
+  if (is_mem) {
+    lsu_data = std::make_shared<LsuTraceData>(num_threads);
+    lsu_data->vec_addrs.resize(num_threads);
+  }
+
+  CoreVecMem mem(core_);
+  VecResult result;
+  uint32_t elements = 0;
+  RegMask vregs_read, vregs_written;
+
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    if (!tmask_.test(t))
+      continue;
+
+    // scalar operands, x registers sign-extended to 64 bits
+    uint64_t rsdata[2] = {0, 0};
+    for (uint32_t i = 0; i < 2 && i < instr.getNRSrc(); ++i) {
+      auto reg = instr.getRSrc(i);
+      switch (instr.getRSType(i)) {
+      case RegType::Integer:
+        rsdata[i] = int64_t(WordI(ireg_file_.at(t).at(reg)));
+        break;
+      case RegType::Float:
+        rsdata[i] = freg_file_.at(t).at(reg);
+        break;
+      default:
+        break;
+      }
+    }
+
+    uint32_t frm = core_->get_csr(VX_CSR_FRM, t, warp_id_);
+    uint32_t fflags = 0;
+    if (!vec_exec_.execute(instr, &vec_states_.at(t), rsdata[0], rsdata[1], frm, &fflags, &mem, &result)) {
+      std::cout << "Error: illegal vector instruction " << instr << ", at PC=0x" << std::hex << PC_ 
+                << ", vtype=0x" << vec_states_.at(t).vtype << std::dec << ", vl=" << vec_states_.at(t).vl << std::endl;
+      std::abort();
+    }
+    update_fcrs(fflags, core_, t, warp_id_);
+
+    if (result.scalar_wb) {
+      auto rdest = instr.getRDest();
+      if (instr.getRDType() == RegType::Float) {
+        freg_file_.at(t)[rdest] = result.scalar;
+      } else if (rdest != 0) {
+        ireg_file_.at(t)[rdest] = Word(result.scalar);
+      }
+    }
+
+    if (is_mem) {
+      // one request per cache line run
+      auto& addrs = lsu_data->vec_addrs.at(t);
+      uint64_t line_mask = ~uint64_t(L1_LINE_SIZE - 1);
+      for (auto& access : result.mem_addrs) {
+        if (addrs.empty() || (addrs.back().addr & line_mask) != (access.addr & line_mask)) {
+          addrs.push_back(access);
+        }
+      }
+      if (!addrs.empty()) {
+        lsu_data->mem_addrs.at(t) = addrs.front();
+      }
+    }
+
+    elements += result.elements;
+    vregs_read |= result.vregs_read;
+    vregs_written |= result.vregs_written;
+  }
+
+  DP(3, "Vector: vl=" << vec_states_.at(0).vl << ", vtype=0x" << std::hex << vec_states_.at(0).vtype 
+     << std::dec << ", elements=" << elements);
+
+  // scalar sources
+  for (uint32_t i = 0; i < instr.getNRSrc(); ++i) {
+    switch (instr.getRSType(i)) {
+    case RegType::Integer: trace->used_iregs.set(instr.getRSrc(i)); break;
+    case RegType::Float:   trace->used_fregs.set(instr.getRSrc(i)); break;
+    default: break;
+    }
+  }
+  trace->used_vregs = vregs_read | vregs_written;
+
+  if (is_mem) {
+    trace->exe_type = ExeType::LSU;
+    trace->lsu_type = (opcode == FS) ? LsuType::STORE : LsuType::LOAD;
+    trace->data = lsu_data;
+  } else if (is_vset) {
+    trace->exe_type = ExeType::ALU;
+    trace->alu_type = AluType::ARITH;
+  } else {
+    trace->exe_type = ExeType::VPU;
+    trace->data = std::make_shared<VpuTraceData>(elements, result.fu_type, result.chainable);
+  }
+
+  // destination: a scalar register or the written vector register group
+  auto rdest = instr.getRDest();
+  if (result.scalar_wb) {
+    trace->rdest_type = instr.getRDType();
+    trace->rdest = rdest;
+    if (trace->rdest_type == RegType::Float) {
+      trace->used_fregs.set(rdest);
+      trace->wb = true;
+    } else if (rdest != 0) {
+      trace->used_iregs.set(rdest);
+      trace->wb = true;
+    }
+  } else if (vregs_written.any()) {
+    uint32_t first = 0;
+    while (!vregs_written.test(first)) {
+      ++first;
+    }
+    uint32_t last = first;
+    for (uint32_t r = first; r < MAX_NUM_REGS; ++r) {
+      if (vregs_written.test(r)) {
+        last = r;
+      }
+    }
+    trace->rdest_type = RegType::Vector;
+    trace->rdest = first;
+    trace->rdest_count = last - first + 1;
+    trace->wb = true;
+  } else {
+    trace->rdest_type = RegType::None;
+  }
+}
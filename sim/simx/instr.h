@@ -81,10 +81,7 @@ public:
     , vlsWidth_(0)
     , vMop_(0)
     , vNf_(0)
-    , vs3_(0)
-    , vlmul_(0)
-    , vsew_(0)
-    , vediv_(0)   {
+    , vs3_(0) {
     for (uint32_t i = 0; i < MAX_REG_SOURCES; ++i) {
        rsrc_type_[i] = RegType::None;
        rsrc_[i] = 0;
@@ -115,9 +112,6 @@ public:
   void setVnf(uint32_t nf) { vNf_ = nf; }
   void setVmask(uint32_t mask) { vmask_ = mask; }
   void setVs3(uint32_t vs) { vs3_ = vs; }
-  void setVlmul(uint32_t lmul) { vlmul_ = 1 << lmul; }
-  void setVsew(uint32_t sew) { vsew_ = 1 << (3+sew); }
-  void setVediv(uint32_t ediv) { vediv_ = 1 << ediv; }
   void setFunc6(uint32_t func6) { func6_ = func6; }
 
   Opcode   getOpcode() const { return opcode_; }
@@ -137,9 +131,6 @@ public:
   uint32_t getvNf() const { return vNf_; }
   uint32_t getVmask() const { return vmask_; }
   uint32_t getVs3() const { return vs3_; }
-  uint32_t getVlmul() const { return vlmul_; }
-  uint32_t getVsew() const { return vsew_; }
-  uint32_t getVediv() const { return vediv_; }
 
 private:
 
@@ -166,9 +157,6 @@ private:
   uint32_t vMop_;
   uint32_t vNf_;
   uint32_t vs3_;
-  uint32_t vlmul_;
-  uint32_t vsew_;
-  uint32_t vediv_;   
 
   friend std::ostream &operator<<(std::ostream &, const Instr&);
 };
@@ -28,20 +28,21 @@
 using namespace vortex;
 
 static void show_usage() {
-   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-r: riscv-test] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-p <name=value,...>: parameters] [-r: riscv-test] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
 uint32_t num_threads = NUM_THREADS;
 uint32_t num_warps = NUM_WARPS;
 uint32_t num_cores = NUM_CORES;
 uint32_t num_clusters = NUM_CLUSTERS;
+std::string params;
 bool showStats = false;;
 bool riscv_test = false;
 const char* program = nullptr;
 
 static void parse_args(int argc, char **argv) {
   	int c;
-  	while ((c = getopt(argc, argv, "t:w:c:g:rsh?")) != -1) {
+  	while ((c = getopt(argc, argv, "t:w:c:g:p:rsh?")) != -1) {
     	switch (c) {
       case 't':
         num_threads = atoi(optarg);
@@ -55,6 +56,11 @@ static void parse_args(int argc, char **argv) {
 		  case 'g':
         num_clusters = atoi(optarg);
         break;
+      case 'p':
+        if (!params.empty())
+          params += ',';
+        params += optarg;
+        break;
       case 'r':
         riscv_test = true;
         break;
@@ -89,6 +95,8 @@ int main(int argc, char **argv) {
   {
     // create processor configuation
     Arch arch(num_threads, num_warps, num_cores, num_clusters);
+    if (!arch.configure(params))
+      return -1;
 
     // create memory module
     RAM ram(RAM_PAGE_SIZE);
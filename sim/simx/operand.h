@@ -14,48 +14,163 @@
 #pragma once
 
 #include "pipeline.h"
-#include <queue>
+#include <vector>
 
 namespace vortex {
 
+// Operand collection stage of an issue slot. Each instruction is allocated an
+// operand collector, which reads its source registers from a banked register
+// file. Registers are interleaved across the banks by (wid + reg), so that the
+// same register of neighboring warps falls in different banks. Every cycle the
+// banks grant their read ports to the pending reads of the collectors in
+// round-robin order; a collector releases its instruction once all its
+// operands are read. A single bank, port and collector models the RTL, which
+// reads one register per cycle.
 class Operand : public SimObject<Operand> {
 public:
+    struct PerfStats {
+        uint64_t reads;
+        uint64_t bank_conflicts; // reads denied by a busy bank
+        uint64_t occupancy;      // busy collectors, summed over cycles
+        uint64_t stalls;         // cycles an instruction waited for a collector
+
+        PerfStats() 
+            : reads(0)
+            , bank_conflicts(0)
+            , occupancy(0)
+            , stalls(0)
+        {}
+
+        PerfStats& operator+=(const PerfStats& rhs) {
+            this->reads          += rhs.reads;
+            this->bank_conflicts += rhs.bank_conflicts;
+            this->occupancy      += rhs.occupancy;
+            this->stalls         += rhs.stalls;
+            return *this;
+        }
+    };
+
     SimPort<pipeline_trace_t*> Input;
     SimPort<pipeline_trace_t*> Output;
 
-    Operand(const SimContext& ctx) 
+    Operand(const SimContext& ctx, const Arch& arch) 
         : SimObject<Operand>(ctx, "Operand") 
         , Input(this)
         , Output(this)
+        , num_banks_(arch.gpr_num_banks())
+        , num_ports_(arch.gpr_num_ports())
+        , collectors_(arch.num_opcs())
+        , bank_reads_(arch.gpr_num_banks())
+        , rr_idx_(0)
     {}
     
     virtual ~Operand() {}
 
-    virtual void reset() {}
+    virtual void reset() {
+        for (auto& collector : collectors_) {
+            collector.trace = nullptr;
+            collector.banks.clear();
+        }
+        rr_idx_ = 0;
+        perf_stats_ = PerfStats();
+    }
 
     virtual void tick() {
-        if (Input.empty())
-            return;
-        auto trace = Input.front();
-
-        int delay = 1;
-        for (int i = 0; i < MAX_NUM_REGS; ++i) {
-            bool is_iregs = trace->used_iregs.test(i);
-            bool is_fregs = trace->used_fregs.test(i);
-            bool is_vregs = trace->used_vregs.test(i);
-            if (is_iregs || is_fregs || is_vregs) {
-                if (is_iregs && i == 0)
-                    continue;
-                ++delay;
+        // allocate a collector to the next instruction, collectors released
+        // this cycle are available from the next one
+        if (!Input.empty()) {
+            auto trace = Input.front();
+            auto collector = this->free_collector();
+            if (collector) {
+                this->allocate(collector, trace);
+                Input.pop();
+            } else {
+                ++perf_stats_.stalls;
+            }
+        }
+
+        // arbitrate the bank read ports
+        std::fill(bank_reads_.begin(), bank_reads_.end(), 0);
+        uint32_t num_collectors = collectors_.size();
+        for (uint32_t i = 0; i < num_collectors; ++i) {
+            auto& collector = collectors_.at((rr_idx_ + i) % num_collectors);
+            if (collector.trace == nullptr)
+                continue;
+            ++perf_stats_.occupancy;
+            if (collector.alloc_cycle == SimPlatform::instance().cycles())
+                continue;
+            for (auto it = collector.banks.begin(); it != collector.banks.end();) {
+                auto& reads = bank_reads_.at(*it);
+                if (reads < num_ports_) {
+                    ++reads;
+                    ++perf_stats_.reads;
+                    it = collector.banks.erase(it);
+                } else {
+                    ++perf_stats_.bank_conflicts;
+                    ++it;
+                }
+            }
+            if (collector.banks.empty()) {
+                Output.send(collector.trace, 1);
+                DT(3, "pipeline-operands: " << *collector.trace);
+                collector.trace = nullptr;
             }
         }
+        rr_idx_ = (rr_idx_ + 1) % num_collectors;
+    };
 
-        Output.send(trace, delay);
-        
-        DT(3, "pipeline-operands: " << *trace);
+    const PerfStats& perf_stats() const {
+        return perf_stats_;
+    }
 
-        Input.pop();
+private:
+
+    struct collector_t {
+        pipeline_trace_t* trace;
+        uint64_t alloc_cycle;
+        std::vector<uint32_t> banks; // banks of the pending reads
+        collector_t() : trace(nullptr), alloc_cycle(0) {}
     };
+
+    collector_t* free_collector() {
+        for (auto& collector : collectors_) {
+            if (collector.trace == nullptr)
+                return &collector;
+        }
+        return nullptr;
+    }
+
+    void allocate(collector_t* collector, pipeline_trace_t* trace) {
+        // the register file holds the integer, FP and vector registers in
+        // this order
+        collector->banks.clear();
+        for (uint32_t i = 0; i < MAX_NUM_REGS; ++i) {
+            if (trace->used_iregs.test(i) && i != 0) {
+                collector->banks.push_back((trace->wid + i) % num_banks_);
+            }
+            if (trace->used_fregs.test(i)) {
+                collector->banks.push_back((trace->wid + MAX_NUM_REGS + i) % num_banks_);
+            }
+            if (trace->used_vregs.test(i)) {
+                collector->banks.push_back((trace->wid + 2 * MAX_NUM_REGS + i) % num_banks_);
+            }
+        }
+        if (collector->banks.empty()) {
+            // nothing to read
+            Output.send(trace, 1);
+            DT(3, "pipeline-operands: " << *trace);
+            return;
+        }
+        collector->trace = trace;
+        collector->alloc_cycle = SimPlatform::instance().cycles();
+    }
+
+    uint32_t num_banks_;
+    uint32_t num_ports_;
+    std::vector<collector_t> collectors_;
+    std::vector<uint32_t> bank_reads_;
+    uint32_t rr_idx_;
+    PerfStats perf_stats_;
 };
 
-}
\ No newline at end of file
+}
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <array>
 #include <iostream>
 #include <util.h>
 #include "types.h"
@@ -33,9 +34,20 @@ public:
 struct LsuTraceData : public ITraceData {
   using Ptr = std::shared_ptr<LsuTraceData>;
   std::vector<mem_addr_size_t> mem_addrs;
+  // vector loads and stores: the cache lines each thread accesses, in order
+  std::vector<std::vector<mem_addr_size_t>> vec_addrs;
   LsuTraceData(uint32_t num_threads) : mem_addrs(num_threads) {}
 };
 
+struct VpuTraceData : public ITraceData {
+  using Ptr = std::shared_ptr<VpuTraceData>;
+  uint32_t elements;  // elements of all active threads
+  FuType   fu_type;
+  bool     chainable; // consumes and produces its elements in order
+  VpuTraceData(uint32_t elements, FuType fu_type, bool chainable) 
+    : elements(elements), fu_type(fu_type), chainable(chainable) {}
+};
+
 struct SFUTraceData : public ITraceData {
   using Ptr = std::shared_ptr<SFUTraceData>;
   struct {
@@ -45,6 +57,16 @@ struct SFUTraceData : public ITraceData {
   SFUTraceData(uint32_t bar_id, uint32_t bar_count) : bar{bar_id, bar_count} {}
 };
 
+enum class PipelineStage {
+  SCHEDULE,
+  FETCH,
+  DECODE,
+  ISSUE,
+  EXECUTE,
+  COMMIT,
+  MAX
+};
+
 struct pipeline_trace_t {
 public:
   //--
@@ -60,6 +82,7 @@ public:
   //--
   uint32_t    rdest;
   RegType     rdest_type;
+  uint32_t    rdest_count; // registers of a vector destination group
   bool        wb;
 
   //--
@@ -87,6 +110,9 @@ public:
 
   bool fetch_stall;
 
+  // stage entry cycles, only recorded when tracing
+  std::array<uint64_t, (int)PipelineStage::MAX> stage_cycles;
+
   pipeline_trace_t(uint64_t uuid, const Arch& arch) 
     : uuid(uuid)
     , arch(arch)
@@ -96,6 +122,7 @@ public:
     , PC(0)    
     , rdest(0)
     , rdest_type(RegType::None)
+    , rdest_count(1)
     , wb(false)
     , used_iregs(0)
     , used_fregs(0)
@@ -107,6 +134,7 @@ public:
     , sop(true)
     , eop(true)
     , fetch_stall(false)
+    , stage_cycles()
     , log_once_(false) 
   {}
 
@@ -119,6 +147,7 @@ public:
     , PC(rhs.PC)    
     , rdest(rhs.rdest)
     , rdest_type(rhs.rdest_type)
+    , rdest_count(rhs.rdest_count)
     , wb(rhs.wb)    
     , used_iregs(rhs.used_iregs)
     , used_fregs(rhs.used_fregs)
@@ -130,6 +159,7 @@ public:
     , sop(rhs.sop)
     , eop(rhs.eop)
     , fetch_stall(rhs.fetch_stall)
+    , stage_cycles(rhs.stage_cycles)
     , log_once_(false) 
   {}
   
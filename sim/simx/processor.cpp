@@ -17,32 +17,50 @@
 using namespace vortex;
 
 ProcessorImpl::ProcessorImpl(const Arch& arch) 
-  : arch_(arch)
+  : profiler_(Profiler::Create())
+  , tracer_(Tracer::Create())
+  , reuse_profiler_(ReuseProfiler::Create())
+  , sampler_(Sampler::Create())
+  , arch_(arch)
+  , ram_(nullptr)
+  , checkpoint_instrs_(0)
   , clusters_(arch.num_clusters())
 {
-  SimPlatform::instance().initialize();
+  SimPlatformScope platform_scope(&platform_);
+  platform_.initialize();
+
+  // SIMX_CHECKPOINT=<file>:<instrs>
+  auto checkpoint = getenv("SIMX_CHECKPOINT");
+  if (checkpoint && checkpoint[0]) {
+    checkpoint_file_ = checkpoint;
+    auto pos = checkpoint_file_.rfind(':');
+    if (pos != std::string::npos) {
+      checkpoint_instrs_ = std::strtoull(checkpoint_file_.c_str() + pos + 1, nullptr, 0);
+      checkpoint_file_ = checkpoint_file_.substr(0, pos);
+    }
+  }
 
   // create memory simulator
   memsim_ = MemSim::Create("dram", MemSim::Config{
-    MEMORY_BANKS,
+    arch.memory_banks(),
     uint32_t(arch.num_cores()) * arch.num_clusters()
   });
 
   // create L3 cache
   l3cache_ = CacheSim::Create("l3cache", CacheSim::Config{
     !L3_ENABLED,
-    log2ceil(L3_CACHE_SIZE),  // C
+    uint8_t(log2ceil(arch.l3_cache_size())), // C
     log2ceil(MEM_BLOCK_SIZE), // B
-    log2ceil(L3_NUM_WAYS),  // W
+    uint8_t(log2ceil(arch.l3_num_ways())), // W
     0,                      // A
     XLEN,                   // address bits  
-    L3_NUM_BANKS,           // number of banks
+    uint8_t(arch.l3_num_banks()), // number of banks
     1,                      // number of ports
     uint8_t(arch.num_clusters()), // request size 
     true,                   // write-through
     false,                  // write response
     0,                      // victim size
-    L3_MSHR_SIZE,           // mshr
+    uint16_t(arch.l3_mshr_size()), // mshr
     2,                      // pipeline latency
     }
   );        
@@ -65,49 +83,215 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
     perf_mem_reads_   += !req.write;
     perf_mem_writes_  += req.write;
     perf_mem_pending_reads_ += !req.write;
+    if (tracer_) {
+      tracer_->mem_req(Tracer::DRAM, 0, req);
+    }
   });
-  memsim_->MemRspPort.tx_callback([&](const MemRsp&, uint64_t cycle){
+  memsim_->MemRspPort.tx_callback([&](const MemRsp& rsp, uint64_t cycle){
     __unused (cycle);
     --perf_mem_pending_reads_;
+    if (tracer_) {
+      tracer_->mem_rsp(Tracer::DRAM, 0, rsp);
+    }
   });
 
+  this->observe_cache(*l3cache_, Profiler::L3CACHE, 0);
+
   this->reset();
 }
 
 ProcessorImpl::~ProcessorImpl() {
-  SimPlatform::instance().finalize();
+  SimPlatformScope platform_scope(&platform_);
+  if (profiler_) {
+    profiler_->dump();
+  }
+  platform_.finalize();
 }
 
 void ProcessorImpl::attach_ram(RAM* ram) {
+  ram_ = ram;
   for (auto cluster : clusters_) {
     cluster->attach_ram(ram);
   }
 }
 
 int ProcessorImpl::run(bool riscv_test) {
-  SimPlatform::instance().reset();
+  SimPlatformScope platform_scope(&platform_);
+  platform_.reset();
   this->reset();
   
-  bool done;
   Word exitcode = 0;
+  if (!checkpoint_file_.empty()) {
+    exitcode = this->run_checkpoint(riscv_test);
+  } else if (sampler_) {
+    exitcode = this->run_sampled(riscv_test);
+  } else {
+    bool done;
+    do {
+      done = this->step(riscv_test, &exitcode);
+    } while (!done);
+  }
+
+  if (profiler_) {
+    profiler_->add_cycles(platform_.cycles());
+  }
+  if (tracer_) {
+    tracer_->add_cycles(platform_.cycles());
+  }
+  if (reuse_profiler_) {
+    reuse_profiler_->dump_kernel();
+  }
+
+  return exitcode;
+}
+
+bool ProcessorImpl::step(bool riscv_test, Word* exitcode) {
+  platform_.tick();
+  bool done = true;
+  for (auto cluster : clusters_) {
+    if (cluster->running()) {
+      Word ec;   
+      if (cluster->check_exit(&ec, riscv_test)) {
+        *exitcode |= ec;
+      } else {
+        done = false;
+      }
+    }
+  }
+  perf_mem_latency_ += perf_mem_pending_reads_;
+  return done;
+}
+
+int ProcessorImpl::run_sampled(bool riscv_test) {
+  Word exitcode = 0;
+  sampler_->reset();
+  for (;;) {
+    // detailed warm-up window
+    if (this->run_detailed(riscv_test, sampler_->warmup(), &exitcode))
+      break;
+
+    // measurement window
+    auto begin = this->snapshot();
+    bool done = this->run_detailed(riscv_test, sampler_->size(), &exitcode);
+    if (!done) {
+      // a window cut short by the program exit is not representative
+      sampler_->add_sample(begin, this->snapshot());
+    }
+    if (done)
+      break;
+
+    // drain the pipeline before switching to functional mode
+    for (auto cluster : clusters_) {
+      cluster->drain(true);
+    }
+    while (!this->step(riscv_test, &exitcode));
+    for (auto cluster : clusters_) {
+      cluster->drain(false);
+    }
+    if (this->check_exit(riscv_test, &exitcode))
+      break;
+
+    // functional warming
+    sampler_->add_warmed(this->warm(sampler_->warm_count()));
+    if (this->check_exit(riscv_test, &exitcode))
+      break;
+  }
+
+  sampler_->report(std::cout, this->snapshot().core.instrs);
+  return exitcode;
+}
+
+bool ProcessorImpl::run_detailed(bool riscv_test, uint64_t instrs, Word* exitcode) {
+  auto start = this->snapshot().core.instrs;
+  bool done;
   do {
-    SimPlatform::instance().tick();
-    done = true;
+    done = this->step(riscv_test, exitcode);
+  } while (!done && (this->snapshot().core.instrs - start) < instrs);
+  return done;
+}
+
+int ProcessorImpl::run_checkpoint(bool riscv_test) {
+  // fast-forward functionally, then keep going until every warp has
+  // reconverged and left its barriers so that the RTL can restore the state
+  Word exitcode = 0;
+  uint64_t instrs = this->warm(checkpoint_instrs_);
+  Checkpoint checkpoint(XLEN, arch_.num_cores() * arch_.num_clusters(), arch_.num_warps(), arch_.num_threads());
+  for (;;) {
+    if (this->check_exit(riscv_test, &exitcode)) {
+      std::cout << "Warning: program exited after " << instrs << " instructions, no checkpoint written" << std::endl;
+      return exitcode;
+    }
+    bool restorable = true;
     for (auto cluster : clusters_) {
-      if (cluster->running()) {
-        Word ec;   
-        if (cluster->check_exit(&ec, riscv_test)) {
-          exitcode |= ec;
-        } else {
-          done = false;
-        }
-      }
+      restorable &= cluster->save(&checkpoint);
+    }
+    if (restorable)
+      break;
+    auto progress = this->warm(1);
+    if (0 == progress) {
+      std::cout << "Error: checkpoint fast-forward deadlocked after " << instrs << " instructions" << std::endl;
+      return -1;
+    }
+    instrs += progress;
+  }
+
+  // the local memory content cannot be restored in the RTL yet
+  for (auto cluster : clusters_) {
+    if (cluster->sharedmem_written()) {
+      std::cout << "Error: the kernel wrote to local memory after " << instrs << " instructions, it cannot be checkpointed" << std::endl;
+      return -1;
     }
-    perf_mem_latency_ += perf_mem_pending_reads_;
-  } while (!done);
+  }
 
+  for (uint32_t addr = VX_DCR_BASE_STATE_BEGIN; addr < VX_DCR_BASE_STATE_END; ++addr) {
+    checkpoint.dcrs().emplace_back(addr, dcrs_.base_dcrs.read(addr));
+  }
+  if (!checkpoint.save(checkpoint_file_, *ram_))
+    return -1;
+
+  std::cout << "Checkpoint " << checkpoint_file_ << " saved after " << instrs << " instructions" << std::endl;
   return exitcode;
 }
+
+uint64_t ProcessorImpl::warm(uint64_t instrs) {
+  // interleave the cores in small chunks so that shared caches see their mixed streams
+  uint64_t count = 0;
+  while (count < instrs) {
+    uint64_t progress = 0;
+    for (auto cluster : clusters_) {
+      progress += cluster->warm(64);
+    }
+    if (0 == progress)
+      break;
+    count += progress;
+  }
+  return count;
+}
+
+void ProcessorImpl::warm_l3cache(uint64_t addr, bool write) {
+  l3cache_->warm(addr, write);
+}
+
+bool ProcessorImpl::check_exit(bool riscv_test, Word* exitcode) const {
+  Word ec = 0;
+  for (auto cluster : clusters_) {
+    Word cluster_ec;
+    if (!cluster->check_exit(&cluster_ec, riscv_test))
+      return false;
+    ec |= cluster_ec;
+  }
+  *exitcode |= ec;
+  return true;
+}
+
+Sampler::Snapshot ProcessorImpl::snapshot() const {
+  Sampler::Snapshot snapshot;
+  snapshot.cycles = platform_.cycles();
+  for (auto cluster : clusters_) {
+    snapshot.core += cluster->core_perf_stats();
+  }
+  return snapshot;
+}
  
 void ProcessorImpl::reset() {
   perf_mem_reads_ = 0;
@@ -116,6 +300,25 @@ void ProcessorImpl::reset() {
   perf_mem_pending_reads_ = 0;
 }
 
+void ProcessorImpl::observe_ports(SimPort<MemReq>& req_port, 
+                                  SimPort<MemRsp>& rsp_port, 
+                                  Profiler::CacheLevel level, 
+                                  uint32_t unit) {
+  auto tracer = tracer_.get();
+  if (!tracer)
+    return;
+  // profiler and tracer levels follow the same order
+  auto mem_level = Tracer::MemLevel(level);
+  req_port.tx_callback([tracer, mem_level, unit](const MemReq& req, uint64_t cycle){
+    __unused (cycle);
+    tracer->mem_req(mem_level, unit, req);
+  });
+  rsp_port.tx_callback([tracer, mem_level, unit](const MemRsp& rsp, uint64_t cycle){
+    __unused (cycle);
+    tracer->mem_rsp(mem_level, unit, rsp);
+  });
+}
+
 void ProcessorImpl::write_dcr(uint32_t addr, uint32_t value) {
   dcrs_.write(addr, value);
 }
@@ -18,6 +18,10 @@
 #include "constants.h"
 #include "dcrs.h"
 #include "cluster.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "reuse_profiler.h"
+#include "sampler.h"
 
 namespace vortex {
 
@@ -48,11 +52,64 @@ public:
 
   ProcessorImpl::PerfStats perf_stats() const;
 
+  Profiler* profiler() const {
+    return profiler_.get();
+  }
+
+  Tracer* tracer() const {
+    return tracer_.get();
+  }
+
+  ReuseProfiler* reuse_profiler() const {
+    return reuse_profiler_.get();
+  }
+
+  // attach the profiler to a cache's read misses and the tracer to its memory-side ports
+  template <typename Cache>
+  void observe_cache(Cache& cache, Profiler::CacheLevel level, uint32_t unit) {
+    auto profiler = profiler_.get();
+    if (profiler) {
+      cache.miss_callback([profiler, level](uint64_t uuid) {
+        profiler->cache_miss(level, uuid);
+      });
+    }
+    this->observe_ports(cache.MemReqPort, cache.MemRspPort, level, unit);
+  }
+
+  void warm_l3cache(uint64_t addr, bool write);
+
 private:
  
   void reset();
 
+  bool step(bool riscv_test, Word* exitcode);
+
+  void observe_ports(SimPort<MemReq>& req_port, 
+                     SimPort<MemRsp>& rsp_port, 
+                     Profiler::CacheLevel level, 
+                     uint32_t unit);
+
+  int run_sampled(bool riscv_test);
+
+  bool run_detailed(bool riscv_test, uint64_t instrs, Word* exitcode);
+
+  int run_checkpoint(bool riscv_test);
+
+  uint64_t warm(uint64_t instrs);
+
+  bool check_exit(bool riscv_test, Word* exitcode) const;
+
+  Sampler::Snapshot snapshot() const;
+
+  SimPlatform platform_;
+  std::unique_ptr<Profiler> profiler_;
+  std::unique_ptr<Tracer> tracer_;
+  std::unique_ptr<ReuseProfiler> reuse_profiler_;
+  std::unique_ptr<Sampler> sampler_;
   const Arch& arch_;
+  RAM* ram_;
+  std::string checkpoint_file_;
+  uint64_t checkpoint_instrs_;
   std::vector<std::shared_ptr<Cluster>> clusters_;
   DCRS dcrs_;
   MemSim::Ptr   memsim_;
@@ -0,0 +1,87 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "profiler.h"
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+using namespace vortex;
+
+Profiler* Profiler::Create() {
+  static std::atomic<uint32_t> s_instances(0);
+  auto filename = getenv("SIMX_PROFILE");
+  if (nullptr == filename || 0 == filename[0])
+    return nullptr;
+  // each simulated device writes its own profile
+  auto instance = s_instances++;
+  if (0 == instance)
+    return new Profiler(filename);
+  return new Profiler(std::string(filename) + "." + std::to_string(instance));
+}
+
+Profiler::Profiler(const std::string& filename) 
+  : filename_(filename)
+  , cycles_(0)
+{}
+
+Profiler::~Profiler() {
+  //--
+}
+
+int Profiler::dump() const {
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cout << "Error: cannot create profile " << filename_ << std::endl;
+    return -1;
+  }
+
+  std::vector<uint64_t> pcs;
+  pcs.reserve(pcs_.size());
+  for (auto& it : pcs_) {
+    pcs.push_back(it.first);
+  }
+  std::sort(pcs.begin(), pcs.end());
+
+  ofs << "{\"cycles\":" << cycles_;
+  ofs << ",\"levels\":[\"icache\",\"dcache\",\"l2cache\",\"l3cache\"]";
+  ofs << ",\"pcs\":[";
+  for (size_t i = 0; i < pcs.size(); ++i) {
+    auto& stats = pcs_.at(pcs.at(i));
+    if (i) ofs << ",";
+    ofs << std::endl;
+    ofs << "{\"pc\":\"0x" << std::hex << pcs.at(i) << std::dec << "\"";
+    ofs << ",\"issued\":" << stats.issued;
+    ofs << ",\"threads\":" << stats.active_threads;
+    ofs << ",\"scrb_stalls\":" << stats.scrb_stalls;
+    ofs << ",\"dispatch_stalls\":" << stats.dispatch_stalls;
+    ofs << ",\"mem_reqs\":" << stats.mem_reqs;
+    ofs << ",\"mem_latency\":" << stats.mem_latency;
+    ofs << ",\"splits\":" << stats.splits;
+    ofs << ",\"diverged\":" << stats.diverged;
+    ofs << ",\"joins\":" << stats.joins;
+    ofs << ",\"misses\":[";
+    for (int l = 0; l < NUM_CACHE_LEVELS; ++l) {
+      if (l) ofs << ",";
+      ofs << stats.cache_misses[l];
+    }
+    ofs << "]}";
+  }
+  ofs << std::endl << "]}" << std::endl;
+  return 0;
+}
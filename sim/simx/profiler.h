@@ -0,0 +1,133 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "pipeline.h"
+
+namespace vortex {
+
+// Per-PC hot-spot profiler.
+// Pipeline events are keyed by the trace PC; cache misses only carry the
+// request uuid, which encodes (global warp id, per-warp PC index) in its low
+// 32 bits, so the profiler keeps that mapping to attribute them back to a PC.
+class Profiler {
+public:
+  enum CacheLevel {
+    ICACHE,
+    DCACHE,
+    L2CACHE,
+    L3CACHE,
+    NUM_CACHE_LEVELS
+  };
+
+  struct PCStats {
+    uint64_t issued;
+    uint64_t active_threads;
+    uint64_t scrb_stalls;
+    uint64_t dispatch_stalls;
+    uint64_t mem_reqs;
+    uint64_t mem_latency;
+    uint64_t cache_misses[NUM_CACHE_LEVELS];
+    uint64_t splits;
+    uint64_t diverged;
+    uint64_t joins;
+
+    PCStats()
+      : issued(0)
+      , active_threads(0)
+      , scrb_stalls(0)
+      , dispatch_stalls(0)
+      , mem_reqs(0)
+      , mem_latency(0)
+      , cache_misses()
+      , splits(0)
+      , diverged(0)
+      , joins(0)
+    {}
+  };
+
+  // returns a profiler if SIMX_PROFILE names an output file, nullptr otherwise
+  static Profiler* Create();
+
+  Profiler(const std::string& filename);
+  ~Profiler();
+
+  void fetch(const pipeline_trace_t* trace) {
+    if (0 == (trace->uuid >> 32)) {
+      // first occurrence of this PC in its warp
+      uuid_pcs_[uint32_t(trace->uuid)] = trace->PC;
+    }
+  }
+
+  void issue(const pipeline_trace_t* trace) {
+    auto& stats = pcs_[trace->PC];
+    ++stats.issued;
+    stats.active_threads += trace->tmask.count();
+  }
+
+  void scrb_stall(const pipeline_trace_t* trace) {
+    ++pcs_[trace->PC].scrb_stalls;
+  }
+
+  void dispatch_stall(const pipeline_trace_t* trace) {
+    ++pcs_[trace->PC].dispatch_stalls;
+  }
+
+  void mem_latency(const pipeline_trace_t* trace, uint64_t latency) {
+    auto& stats = pcs_[trace->PC];
+    ++stats.mem_reqs;
+    stats.mem_latency += latency;
+  }
+
+  // SPLIT or PRED execution, divergent when it disabled some active threads
+  void split(const pipeline_trace_t* trace, bool divergent) {
+    auto& stats = pcs_[trace->PC];
+    ++stats.splits;
+    if (divergent) {
+      ++stats.diverged;
+    }
+  }
+
+  // JOIN execution, counted when it pops the IPDOM stack
+  void join(const pipeline_trace_t* trace, bool divergent) {
+    if (divergent) {
+      ++pcs_[trace->PC].joins;
+    }
+  }
+
+  void cache_miss(CacheLevel level, uint64_t uuid) {
+    auto it = uuid_pcs_.find(uint32_t(uuid));
+    if (it == uuid_pcs_.end())
+      return;
+    ++pcs_[it->second].cache_misses[level];
+  }
+
+  void add_cycles(uint64_t cycles) {
+    cycles_ += cycles;
+  }
+
+  // write the profile as JSON, one PC record per line
+  int dump() const;
+
+private:
+  std::unordered_map<uint64_t, PCStats> pcs_;
+  std::unordered_map<uint32_t, uint64_t> uuid_pcs_;
+  std::string filename_;
+  uint64_t cycles_;
+};
+
+}
@@ -0,0 +1,228 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "reuse_profiler.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <bitmanip.h>
+#include <VX_config.h>
+
+using namespace vortex;
+
+ReuseProfiler* ReuseProfiler::Create() {
+  static std::atomic<uint32_t> s_instances(0);
+  auto value = getenv("SIMX_REUSE");
+  if (nullptr == value || 0 == value[0])
+    return nullptr;
+
+  // SIMX_REUSE=<file>[:<line size>]
+  std::string filename(value);
+  uint32_t line_size = L1_LINE_SIZE;
+  auto pos = filename.rfind(':');
+  if (pos != std::string::npos) {
+    line_size = std::strtoul(filename.c_str() + pos + 1, nullptr, 0);
+    filename = filename.substr(0, pos);
+  }
+  if (0 == line_size || 0 != (line_size & (line_size - 1))) {
+    std::cout << "Error: invalid reuse profiler line size " << line_size << std::endl;
+    return nullptr;
+  }
+
+  // each simulated device writes its own profile
+  auto instance = s_instances++;
+  if (0 != instance) {
+    filename += "." + std::to_string(instance);
+  }
+  return new ReuseProfiler(filename, line_size);
+}
+
+ReuseProfiler::ReuseProfiler(const std::string& filename, uint32_t line_size)
+  : filename_(filename)
+  , line_bits_(log2ceil(line_size))
+  , kernel_(0)
+{
+  // start a new output file
+  std::ofstream ofs(filename_, std::ios::trunc);
+  this->reset();
+}
+
+ReuseProfiler::~ReuseProfiler() {
+  //--
+}
+
+void ReuseProfiler::reset() {
+  nodes_.assign(1, node_t{0, 0, 0, 0});
+  free_nodes_.clear();
+  root_ = 0;
+  lines_.clear();
+  accesses_ = 0;
+  cold_misses_ = 0;
+  memset(histogram_, 0, sizeof(histogram_));
+}
+
+void ReuseProfiler::access(const uint64_t* addrs, uint32_t count) {
+  instr_lines_.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    auto line = addrs[i] >> line_bits_;
+    if (std::find(instr_lines_.begin(), instr_lines_.end(), line) != instr_lines_.end())
+      continue;
+    instr_lines_.push_back(line);
+    this->access_line(line);
+  }
+}
+
+void ReuseProfiler::access_line(uint64_t line) {
+  ++accesses_;
+
+  auto it = lines_.find(line);
+  if (it == lines_.end()) {
+    ++cold_misses_;
+  } else {
+    // lines accessed more recently are in the right subtree of the splayed node
+    auto n = it->second;
+    this->splay(n);
+    uint64_t distance = nodes_[nodes_[n].right].size;
+    uint32_t bucket = (0 == distance) ? 0 : std::min<uint32_t>(log2floor(distance) + 1, NUM_BUCKETS - 1);
+    ++histogram_[bucket];
+    this->remove_root();
+    free_nodes_.push_back(n);
+  }
+
+  // the new access is the most recent one: it becomes the root with the
+  // whole tree as its left subtree
+  uint32_t n;
+  if (!free_nodes_.empty()) {
+    n = free_nodes_.back();
+    free_nodes_.pop_back();
+  } else {
+    n = nodes_.size();
+    nodes_.push_back(node_t());
+  }
+  nodes_[n] = node_t{root_, 0, 0, nodes_[root_].size + 1};
+  if (root_) {
+    nodes_[root_].parent = n;
+  }
+  root_ = n;
+  lines_[line] = n;
+}
+
+void ReuseProfiler::update(uint32_t n) {
+  nodes_[n].size = nodes_[nodes_[n].left].size + nodes_[nodes_[n].right].size + 1;
+}
+
+void ReuseProfiler::rotate(uint32_t n) {
+  auto p = nodes_[n].parent;
+  auto g = nodes_[p].parent;
+  if (nodes_[p].left == n) {
+    nodes_[p].left = nodes_[n].right;
+    if (nodes_[n].right) {
+      nodes_[nodes_[n].right].parent = p;
+    }
+    nodes_[n].right = p;
+  } else {
+    nodes_[p].right = nodes_[n].left;
+    if (nodes_[n].left) {
+      nodes_[nodes_[n].left].parent = p;
+    }
+    nodes_[n].left = p;
+  }
+  nodes_[p].parent = n;
+  nodes_[n].parent = g;
+  if (g) {
+    if (nodes_[g].left == p) {
+      nodes_[g].left = n;
+    } else {
+      nodes_[g].right = n;
+    }
+  } else {
+    root_ = n;
+  }
+  this->update(p);
+  this->update(n);
+}
+
+void ReuseProfiler::splay(uint32_t n) {
+  while (nodes_[n].parent) {
+    auto p = nodes_[n].parent;
+    auto g = nodes_[p].parent;
+    if (g) {
+      bool zigzig = (nodes_[g].left == p) == (nodes_[p].left == n);
+      this->rotate(zigzig ? p : n);
+    }
+    this->rotate(n);
+  }
+}
+
+void ReuseProfiler::remove_root() {
+  auto left = nodes_[root_].left;
+  auto right = nodes_[root_].right;
+  nodes_[left].parent = 0;
+  nodes_[right].parent = 0;
+  if (0 == left) {
+    root_ = right;
+    return;
+  }
+  // join: splay the most recent node of the left subtree and hang the right one
+  auto m = left;
+  while (nodes_[m].right) {
+    m = nodes_[m].right;
+  }
+  root_ = left;
+  this->splay(m);
+  nodes_[m].right = right;
+  if (right) {
+    nodes_[right].parent = m;
+  }
+  this->update(m);
+}
+
+int ReuseProfiler::dump_kernel() {
+  std::ofstream ofs(filename_, std::ios::app);
+  if (!ofs) {
+    std::cout << "Error: cannot write reuse profile " << filename_ << std::endl;
+    return -1;
+  }
+
+  // one JSON object per kernel
+  uint32_t last = 0;
+  for (uint32_t b = 0; b < NUM_BUCKETS; ++b) {
+    if (histogram_[b])
+      last = b;
+  }
+  ofs << "{\"kernel\": " << kernel_
+      << ", \"line_size\": " << (1u << line_bits_)
+      << ", \"accesses\": " << accesses_
+      << ", \"lines\": " << lines_.size()
+      << ", \"cold_misses\": " << cold_misses_
+      << ", \"histogram\": [";
+  for (uint32_t b = 0; b <= last; ++b) {
+    ofs << (b ? ", " : "") << histogram_[b];
+  }
+  // a fully-associative LRU cache of 2^k lines misses on cold accesses and on
+  // distances >= 2^k, i.e. on the buckets above k
+  ofs << "], \"mrc\": [";
+  uint64_t misses = accesses_;
+  for (uint32_t k = 0; k <= last; ++k) {
+    misses -= histogram_[k];
+    ofs << (k ? ", " : "") << "{\"size\": " << (uint64_t(1) << (k + line_bits_))
+        << ", \"miss_ratio\": " << (accesses_ ? double(misses) / accesses_ : 0.0) << "}";
+  }
+  ofs << "]}" << std::endl;
+
+  ++kernel_;
+  this->reset();
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace vortex {
+
+// Reuse (LRU stack) distance profiler.
+// Global memory accesses are tracked at cache-line granularity; the distance
+// of an access is the number of distinct lines touched since the previous
+// access to the same line. Last-access times are kept in a splay tree with
+// subtree sizes, so that each access costs amortized O(log n). The log2
+// histogram gives the exact miss ratio of a fully-associative LRU cache of
+// every power-of-two size in one pass.
+class ReuseProfiler {
+public:
+  // returns a profiler if SIMX_REUSE names an output file, nullptr otherwise
+  static ReuseProfiler* Create();
+
+  ReuseProfiler(const std::string& filename, uint32_t line_size);
+  ~ReuseProfiler();
+
+  // record the addresses accessed by one instruction, lines touched by
+  // several threads are counted once as the LSU coalesces them
+  void access(const uint64_t* addrs, uint32_t count);
+
+  // append the current kernel histogram to the output file and reset
+  int dump_kernel();
+
+private:
+
+  static constexpr uint32_t NUM_BUCKETS = 48;
+
+  struct node_t {
+    uint32_t left;
+    uint32_t right;
+    uint32_t parent;
+    uint32_t size;
+  };
+
+  void access_line(uint64_t line);
+
+  void update(uint32_t n);
+  void rotate(uint32_t n);
+  void splay(uint32_t n);
+  void remove_root();
+
+  void reset();
+
+  std::string filename_;
+  uint32_t line_bits_;
+  uint32_t kernel_;
+
+  // splay tree ordered by last-access time, node 0 is the null sentinel
+  std::vector<node_t> nodes_;
+  std::vector<uint32_t> free_nodes_;
+  uint32_t root_;
+  std::unordered_map<uint64_t, uint32_t> lines_;
+
+  std::vector<uint64_t> instr_lines_;
+  uint64_t accesses_;
+  uint64_t cold_misses_;
+  uint64_t histogram_[NUM_BUCKETS];
+};
+
+}
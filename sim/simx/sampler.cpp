@@ -0,0 +1,145 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "sampler.h"
+#include <stdlib.h>
+#include <math.h>
+#include <iomanip>
+
+using namespace vortex;
+
+// 95% confidence, normal approximation
+#define CONFIDENCE_Z 1.96
+
+namespace {
+
+struct estimate_t {
+  double mean;
+  double error;
+};
+
+template <typename F>
+estimate_t estimate(size_t n, const F& f) {
+  estimate_t est{0, 0};
+  if (0 == n)
+    return est;
+  for (size_t i = 0; i < n; ++i) {
+    est.mean += f(i);
+  }
+  est.mean /= n;
+  if (n > 1) {
+    double var = 0;
+    for (size_t i = 0; i < n; ++i) {
+      double d = f(i) - est.mean;
+      var += d * d;
+    }
+    var /= (n - 1);
+    est.error = CONFIDENCE_Z * sqrt(var / n);
+  }
+  return est;
+}
+
+}
+
+Sampler* Sampler::Create() {
+  auto config = getenv("SIMX_SAMPLING");
+  if (nullptr == config || 0 == config[0])
+    return nullptr;
+
+  uint64_t size = 10000;
+  uint64_t warmup = 20000;
+  char* next = nullptr;
+  uint64_t period = strtoull(config, &next, 0);
+  if (next && *next == ':') {
+    size = strtoull(next + 1, &next, 0);
+    if (next && *next == ':') {
+      warmup = strtoull(next + 1, &next, 0);
+    }
+  }
+  if (0 == size || period <= (size + warmup)) {
+    std::cout << "Error: invalid SIMX_SAMPLING=" << config 
+              << ", the period should exceed the window and warm-up sizes" << std::endl;
+    std::abort();
+  }
+  return new Sampler(period, size, warmup);
+}
+
+Sampler::Sampler(uint64_t period, uint64_t size, uint64_t warmup) 
+  : period_(period)
+  , size_(size)
+  , warmup_(warmup)
+  , warmed_instrs_(0)
+{}
+
+void Sampler::reset() {
+  samples_.clear();
+  warmed_instrs_ = 0;
+}
+
+void Sampler::add_sample(const Snapshot& begin, const Snapshot& end) {
+  sample_t sample;
+  sample.instrs = end.core.instrs - begin.core.instrs;
+  sample.cycles = end.cycles - begin.cycles;
+  sample.stalls[STALL_IBUF] = end.core.ibuf_stalls - begin.core.ibuf_stalls;
+  sample.stalls[STALL_SCRB] = end.core.scrb_stalls - begin.core.scrb_stalls;
+  sample.stalls[STALL_ALU]  = end.core.alu_stalls - begin.core.alu_stalls;
+  sample.stalls[STALL_LSU]  = end.core.lsu_stalls - begin.core.lsu_stalls;
+  sample.stalls[STALL_FPU]  = end.core.fpu_stalls - begin.core.fpu_stalls;
+  sample.stalls[STALL_SFU]  = end.core.sfu_stalls - begin.core.sfu_stalls;
+  sample.stalls[STALL_VPU]  = end.core.vpu_stalls - begin.core.vpu_stalls;
+  if (0 == sample.instrs)
+    return;
+  samples_.push_back(sample);
+}
+
+void Sampler::report(std::ostream& os, uint64_t detailed_instrs) const {
+  static const char* stall_names[] = {
+    "ibuffer", "scoreboard", "alu", "lsu", "fpu", "sfu", "vpu"
+  };
+
+  auto n = samples_.size();
+  auto total_instrs = detailed_instrs + warmed_instrs_;
+
+  os << std::fixed << std::setprecision(6);
+  os << "SAMPLING: samples=" << n
+     << ", instrs=" << total_instrs
+     << ", detailed=" << detailed_instrs
+     << ", warmed=" << warmed_instrs_ << std::endl;
+  if (0 == n) {
+    os << "SAMPLING: no complete measurement window, increase the run length or reduce the period" << std::endl;
+    return;
+  }
+
+  // per-instruction rates are averaged over equal-size windows
+  auto cpi = estimate(n, [&](size_t i) {
+    return double(samples_.at(i).cycles) / samples_.at(i).instrs;
+  });
+  double ipc = 1.0 / cpi.mean;
+  double ipc_lo = 1.0 / (cpi.mean + cpi.error);
+  double ipc_hi = (cpi.mean > cpi.error) ? 1.0 / (cpi.mean - cpi.error) : INFINITY;
+
+  os << "SAMPLING: IPC=" << ipc << " (95% CI " << ipc_lo << " - " << ipc_hi << ")"
+     << ", cycles=" << uint64_t(cpi.mean * total_instrs) 
+     << " (+/- " << uint64_t(cpi.error * total_instrs) << ")" << std::endl;
+
+  for (int s = 0; s < NUM_STALLS; ++s) {
+    auto rate = estimate(n, [&](size_t i) {
+      return double(samples_.at(i).stalls[s]) / samples_.at(i).instrs;
+    });
+    os << "SAMPLING: " << stall_names[s] << "_stalls/instr=" << rate.mean 
+       << " (+/- " << rate.error << ")" << std::endl;
+  }
+
+  os << std::defaultfloat;
+}
@@ -0,0 +1,96 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <vector>
+#include <iostream>
+#include "core.h"
+
+namespace vortex {
+
+// SMARTS-style sampling.
+// Execution alternates between functional warming (instructions and cache tag
+// updates only) and short detailed windows: a warm-up window that refills the
+// pipeline and queues, followed by a measurement window. Whole-run IPC and
+// stall rates are extrapolated from the measurement windows.
+class Sampler {
+public:
+  struct Snapshot {
+    uint64_t cycles;
+    Core::PerfStats core;
+  };
+
+  // returns a sampler if SIMX_SAMPLING=<period>[:<size>[:<warmup>]] is set, nullptr otherwise
+  static Sampler* Create();
+
+  Sampler(uint64_t period, uint64_t size, uint64_t warmup);
+
+  // thread instructions between the start of two measurement windows
+  uint64_t period() const {
+    return period_;
+  }
+
+  // thread instructions per measurement window
+  uint64_t size() const {
+    return size_;
+  }
+
+  // thread instructions of detailed warm-up before each measurement window
+  uint64_t warmup() const {
+    return warmup_;
+  }
+
+  // thread instructions of functional warming per period
+  uint64_t warm_count() const {
+    return period_ - size_ - warmup_;
+  }
+
+  void reset();
+
+  void add_sample(const Snapshot& begin, const Snapshot& end);
+
+  void add_warmed(uint64_t instrs) {
+    warmed_instrs_ += instrs;
+  }
+
+  void report(std::ostream& os, uint64_t detailed_instrs) const;
+
+private:
+
+  enum {
+    STALL_IBUF,
+    STALL_SCRB,
+    STALL_ALU,
+    STALL_LSU,
+    STALL_FPU,
+    STALL_SFU,
+    STALL_VPU,
+    NUM_STALLS
+  };
+
+  struct sample_t {
+    uint64_t instrs;
+    uint64_t cycles;
+    uint64_t stalls[NUM_STALLS];
+  };
+
+  uint64_t period_;
+  uint64_t size_;
+  uint64_t warmup_;
+  std::vector<sample_t> samples_;
+  uint64_t warmed_instrs_;
+};
+
+}
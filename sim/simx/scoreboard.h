@@ -31,6 +31,7 @@ public:
         : in_use_iregs_(arch.num_warps())
         , in_use_fregs_(arch.num_warps())
         , in_use_vregs_(arch.num_warps())
+        , chained_vregs_(arch.num_warps())
     {
         this->clear();
     }
@@ -40,14 +41,26 @@ public:
             in_use_iregs_.at(i).reset();
             in_use_fregs_.at(i).reset();
             in_use_vregs_.at(i).reset();
+            chained_vregs_.at(i).reset();
         }
         owners_.clear();
     }
 
     bool in_use(pipeline_trace_t* state) const {
+        auto in_use_vregs = in_use_vregs_.at(state->wid);
+        if (state->used_vregs.any() && is_chainable(state)) {
+            // chained producers forward their elements as they complete,
+            // only the destination group still waits for its writers
+            in_use_vregs &= ~(chained_vregs_.at(state->wid) & ~dest_vregs(state));
+        }
         return (state->used_iregs & in_use_iregs_.at(state->wid)) != 0 
             || (state->used_fregs & in_use_fregs_.at(state->wid)) != 0
-            || (state->used_vregs & in_use_vregs_.at(state->wid)) != 0;
+            || (state->used_vregs & in_use_vregs) != 0;
+    }
+
+    // the vector unit started a chainable producer
+    void chain(pipeline_trace_t* state) {
+        chained_vregs_.at(state->wid) |= dest_vregs(state);
     }
 
     std::vector<reg_use_t> get_uses(pipeline_trace_t* state) const {
@@ -101,14 +114,16 @@ public:
             in_use_fregs_.at(state->wid).set(state->rdest);
             break;
         case RegType::Vector:
-            in_use_vregs_.at(state->wid).set(state->rdest);
+            in_use_vregs_.at(state->wid) |= dest_vregs(state);
             break;
         default:  
             break;
         }      
-        uint32_t tag = (state->rdest << 16) | (state->wid << 4) | (int)state->rdest_type;
-        assert(owners_.count(tag) == 0);
-        owners_[tag] = state->uuid;
+        for (uint32_t i = 0; i < state->rdest_count; ++i) {
+            uint32_t tag = ((state->rdest + i) << 16) | (state->wid << 4) | (int)state->rdest_type;
+            assert(owners_.count(tag) == 0);
+            owners_[tag] = state->uuid;
+        }
     }
 
     void release(pipeline_trace_t* state) {
@@ -121,20 +136,41 @@ public:
             in_use_fregs_.at(state->wid).reset(state->rdest);
             break;
         case RegType::Vector:
-            in_use_vregs_.at(state->wid).reset(state->rdest);
+            in_use_vregs_.at(state->wid) &= ~dest_vregs(state);
+            chained_vregs_.at(state->wid) &= ~dest_vregs(state);
             break;
         default:  
             break;
         }      
-        uint32_t tag = (state->rdest << 16) | (state->wid << 4) | (int)state->rdest_type;
-        owners_.erase(tag);
+        for (uint32_t i = 0; i < state->rdest_count; ++i) {
+            uint32_t tag = ((state->rdest + i) << 16) | (state->wid << 4) | (int)state->rdest_type;
+            owners_.erase(tag);
+        }
     }
 
 private:
 
+    static RegMask dest_vregs(pipeline_trace_t* state) {
+        RegMask mask;
+        if (state->wb && state->rdest_type == RegType::Vector) {
+            for (uint32_t i = 0; i < state->rdest_count; ++i) {
+                mask.set(state->rdest + i);
+            }
+        }
+        return mask;
+    }
+
+    static bool is_chainable(pipeline_trace_t* state) {
+        if (state->exe_type != ExeType::VPU)
+            return false;
+        auto trace_data = std::dynamic_pointer_cast<VpuTraceData>(state->data);
+        return trace_data->chainable;
+    }
+
     std::vector<RegMask> in_use_iregs_;
     std::vector<RegMask> in_use_fregs_;
     std::vector<RegMask> in_use_vregs_;
+    std::vector<RegMask> chained_vregs_;
     std::unordered_map<uint32_t, uint64_t> owners_;
 };
 
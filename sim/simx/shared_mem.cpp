@@ -27,6 +27,7 @@ protected:
     uint32_t  bank_sel_addr_start_;
     uint32_t  bank_sel_addr_end_;
     PerfStats perf_stats_;
+    uint64_t  num_writes_;
 
     uint64_t to_local_addr(uint64_t addr) {
         uint32_t total_lines = config_.capacity / config_.line_size;        
@@ -42,12 +43,14 @@ public:
         , ram_(config.capacity, config.capacity)
         , bank_sel_addr_start_(0)
         , bank_sel_addr_end_(0 + log2ceil(config.num_banks)-1)
+        , num_writes_(0)
     {}    
     
     virtual ~Impl() {}
 
     void reset() {
         perf_stats_ = PerfStats();
+        num_writes_ = 0;
     }
 
     void read(void* data, uint64_t addr, uint32_t size) {
@@ -60,6 +63,11 @@ public:
         auto s_addr = to_local_addr(addr);        
         DPH(3, "Shared Mem addr=0x" << std::hex << s_addr << std::endl);
         ram_.write(data, s_addr, size);
+        ++num_writes_;
+    }
+
+    uint64_t num_writes() const {
+        return num_writes_;
     }
 
     void tick() {
@@ -129,6 +137,10 @@ void SharedMem::write(const void* data, uint64_t addr, uint32_t size) {
     impl_->write(data, addr, size);
 }
 
+uint64_t SharedMem::num_writes() const {
+    return impl_->num_writes();
+}
+
 void SharedMem::tick() {
     impl_->tick();
 }
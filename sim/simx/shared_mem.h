@@ -59,6 +59,9 @@ public:
 
   void write(const void* data, uint64_t addr, uint32_t size);
 
+  // functional writes since reset, timed or warmed alike
+  uint64_t num_writes() const;
+
   void tick();
 
   const PerfStats& perf_stats() const;
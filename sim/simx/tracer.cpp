@@ -0,0 +1,191 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "tracer.h"
+#include <stdlib.h>
+#include <iostream>
+#include <atomic>
+#include <limits>
+
+using namespace vortex;
+
+// memory levels are shown as separate processes after the cores
+#define MEM_PID_BASE 0x10000
+
+static const char* s_stage_names[] = {
+  "schedule", "fetch", "decode", "issue", "execute"
+};
+
+static const char* s_mem_names[] = {
+  "icache", "dcache", "l2cache", "l3cache", "dram"
+};
+
+Tracer* Tracer::Create() {
+  static std::atomic<uint32_t> s_instances(0);
+  auto filename = getenv("SIMX_TRACE");
+  if (nullptr == filename || 0 == filename[0])
+    return nullptr;
+
+  // optional cycle window: SIMX_TRACE_WINDOW=<start>[:<end>]
+  uint64_t start = 0;
+  uint64_t end = std::numeric_limits<uint64_t>::max();
+  auto window = getenv("SIMX_TRACE_WINDOW");
+  if (window) {
+    char* next = nullptr;
+    start = strtoull(window, &next, 0);
+    if (next && *next == ':') {
+      end = strtoull(next + 1, nullptr, 0);
+    }
+  }
+
+  // each simulated device writes its own trace
+  auto instance = s_instances++;
+  if (0 == instance)
+    return new Tracer(filename, start, end);
+  return new Tracer(std::string(filename) + "." + std::to_string(instance), start, end);
+}
+
+Tracer::Tracer(const std::string& filename, uint64_t start, uint64_t end) 
+  : cycle_base_(0)
+  , start_(start)
+  , end_(end)
+  , file_(nullptr)
+  , mem_ids_(0)
+  , first_event_(true)
+  , done_(false)
+{
+  buffer_.reserve(BUFFER_SIZE);
+  file_ = fopen(filename.c_str(), "w");
+  if (nullptr == file_) {
+    std::cout << "Error: cannot create trace " << filename << std::endl;
+    return;
+  }
+  fprintf(file_, "{\"traceEvents\":[");
+  thread_ = std::thread(&Tracer::writer_thread, this);
+}
+
+Tracer::~Tracer() {
+  if (nullptr == file_)
+    return;
+  if (!buffer_.empty()) {
+    this->flush();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  fprintf(file_, "\n]}\n");
+  fclose(file_);
+}
+
+void Tracer::mem_rsp(MemLevel level, uint32_t unit, const MemRsp& rsp) {
+  auto it = pending_reqs_.find((unit << 3) | level);
+  if (it == pending_reqs_.end())
+    return;
+  auto& pending = it->second;
+  auto req_it = pending.find(rsp.tag);
+  if (req_it == pending.end())
+    return;
+  auto& req = req_it->second;
+  if (req.cycle >= start_ && req.cycle < end_) {
+    event_t evt;
+    evt.type = event_t::Mem;
+    evt.cid  = unit;
+    evt.wid  = level;
+    evt.threads = 0;
+    evt.uuid = req.uuid;
+    evt.addr = req.addr;
+    evt.cycles[0] = req.cycle;
+    evt.cycles[1] = this->cycles();
+    this->push(evt);
+  }
+  pending.erase(req_it);
+}
+
+void Tracer::flush() {
+  if (nullptr == file_) {
+    buffer_.clear();
+    return;
+  }
+  {
+    // block the simulation if the writer falls too far behind
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]{ return queue_.size() < MAX_PENDING_BUFFERS; });
+    queue_.emplace_back(std::move(buffer_));
+  }
+  cv_.notify_all();
+  buffer_ = std::vector<event_t>();
+  buffer_.reserve(BUFFER_SIZE);
+}
+
+void Tracer::writer_thread() {
+  for (;;) {
+    std::vector<event_t> events;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&]{ return !queue_.empty() || done_; });
+      if (queue_.empty())
+        break;
+      events = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    cv_.notify_all();
+    for (auto& evt : events) {
+      this->write(evt);
+    }
+  }
+}
+
+void Tracer::write_names(uint32_t pid, uint32_t tid, const std::string& pname, const std::string& tname) {
+  uint64_t key = (uint64_t(pid) << 32) | tid;
+  if (named_tracks_.count(key))
+    return;
+  if (0 == named_tracks_.count(uint64_t(pid) << 32 | 0xffffffff)) {
+    fprintf(file_, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%s\"}}",
+      first_event_ ? "" : ",", pid, pname.c_str());
+    first_event_ = false;
+    named_tracks_.insert(uint64_t(pid) << 32 | 0xffffffff);
+  }
+  fprintf(file_, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+    pid, tid, tname.c_str());
+  named_tracks_.insert(key);
+}
+
+void Tracer::write(const event_t& evt) {
+  if (evt.type == event_t::Instr) {
+    this->write_names(evt.cid, evt.wid, "core" + std::to_string(evt.cid), "warp" + std::to_string(evt.wid));
+    // instruction slice with one nested slice per pipeline stage
+    fprintf(file_, ",\n{\"name\":\"0x%lx\",\"cat\":\"instr\",\"ph\":\"b\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu,\"args\":{\"uuid\":%lu,\"threads\":%u}}",
+      (unsigned long)evt.addr, (unsigned long)evt.uuid, evt.cid, evt.wid, (unsigned long)evt.cycles[0], (unsigned long)evt.uuid, evt.threads);
+    for (int i = 0; i < (int)PipelineStage::COMMIT; ++i) {
+      fprintf(file_, ",\n{\"name\":\"%s\",\"cat\":\"instr\",\"ph\":\"b\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu}",
+        s_stage_names[i], (unsigned long)evt.uuid, evt.cid, evt.wid, (unsigned long)evt.cycles[i]);
+      fprintf(file_, ",\n{\"name\":\"%s\",\"cat\":\"instr\",\"ph\":\"e\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu}",
+        s_stage_names[i], (unsigned long)evt.uuid, evt.cid, evt.wid, (unsigned long)evt.cycles[i+1]);
+    }
+    fprintf(file_, ",\n{\"name\":\"0x%lx\",\"cat\":\"instr\",\"ph\":\"e\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu}",
+      (unsigned long)evt.addr, (unsigned long)evt.uuid, evt.cid, evt.wid, (unsigned long)evt.cycles[(int)PipelineStage::COMMIT]);
+  } else {
+    uint32_t pid = MEM_PID_BASE + evt.wid;
+    this->write_names(pid, evt.cid, s_mem_names[evt.wid], "unit" + std::to_string(evt.cid));
+    // async ids are shared with instructions, keep them in a separate range
+    auto id = (1ull << 63) | mem_ids_++;
+    fprintf(file_, ",\n{\"name\":\"0x%lx\",\"cat\":\"mem\",\"ph\":\"b\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu,\"args\":{\"uuid\":%lu}}",
+      (unsigned long)evt.addr, (unsigned long)id, pid, evt.cid, (unsigned long)evt.cycles[0], (unsigned long)evt.uuid);
+    fprintf(file_, ",\n{\"name\":\"0x%lx\",\"cat\":\"mem\",\"ph\":\"e\",\"id\":\"0x%lx\",\"pid\":%u,\"tid\":%u,\"ts\":%lu}",
+      (unsigned long)evt.addr, (unsigned long)id, pid, evt.cid, (unsigned long)evt.cycles[1]);
+  }
+}
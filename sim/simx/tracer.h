@@ -0,0 +1,151 @@
+// Copyright © 2019-2023
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <simobject.h>
+#include "types.h"
+#include "pipeline.h"
+
+namespace vortex {
+
+// Pipeline timeline tracer.
+// Events are appended as fixed-size binary records to a local buffer;
+// full buffers are handed to a background thread that writes them out
+// in Chrome trace-event JSON format (loadable by chrome://tracing and Perfetto).
+class Tracer {
+public:
+  enum MemLevel {
+    ICACHE,
+    DCACHE,
+    L2CACHE,
+    L3CACHE,
+    DRAM,
+    NUM_MEM_LEVELS
+  };
+
+  // returns a tracer if SIMX_TRACE names an output file, nullptr otherwise
+  static Tracer* Create();
+
+  Tracer(const std::string& filename, uint64_t start, uint64_t end);
+  ~Tracer();
+
+  void stage(pipeline_trace_t* trace, PipelineStage stage) {
+    trace->stage_cycles[(int)stage] = this->cycles();
+  }
+
+  void commit(pipeline_trace_t* trace) {
+    trace->stage_cycles[(int)PipelineStage::COMMIT] = this->cycles();
+    if (!trace->eop)
+      return;
+    auto start = trace->stage_cycles[(int)PipelineStage::SCHEDULE];
+    if (start < start_ || start >= end_)
+      return;
+    event_t evt;
+    evt.type = event_t::Instr;
+    evt.cid  = trace->cid;
+    evt.wid  = trace->wid;
+    evt.threads = trace->tmask.count();
+    evt.uuid = trace->uuid;
+    evt.addr = trace->PC;
+    for (int i = 0; i < (int)PipelineStage::MAX; ++i) {
+      evt.cycles[i] = trace->stage_cycles[i];
+    }
+    this->push(evt);
+  }
+
+  // only read requests are tracked, writes do not return a response
+  void mem_req(MemLevel level, uint32_t unit, const MemReq& req) {
+    if (req.write)
+      return;
+    auto& pending = pending_reqs_[(unit << 3) | level];
+    pending[req.tag] = {this->cycles(), req.addr, req.uuid};
+  }
+
+  void mem_rsp(MemLevel level, uint32_t unit, const MemRsp& rsp);
+
+  // accumulate the cycles of a completed run so that runs follow each other on the timeline
+  void add_cycles(uint64_t cycles) {
+    cycle_base_ += cycles;
+  }
+
+private:
+
+  struct event_t {
+    enum Type { Instr, Mem };
+    uint32_t type;
+    uint32_t cid;     // core id or memory unit
+    uint32_t wid;     // warp id or memory level
+    uint32_t threads;
+    uint64_t uuid;
+    uint64_t addr;
+    uint64_t cycles[(int)PipelineStage::MAX];
+  };
+
+  struct pending_req_t {
+    uint64_t cycle;
+    uint64_t addr;
+    uint64_t uuid;
+  };
+
+  uint64_t cycles() const {
+    return cycle_base_ + SimPlatform::instance().cycles();
+  }
+
+  void push(const event_t& evt) {
+    buffer_.push_back(evt);
+    if (buffer_.size() == BUFFER_SIZE) {
+      this->flush();
+    }
+  }
+
+  void flush();
+
+  void writer_thread();
+
+  void write(const event_t& evt);
+
+  void write_names(uint32_t pid, uint32_t tid, const std::string& pname, const std::string& tname);
+
+  static constexpr size_t BUFFER_SIZE = 64 * 1024;
+  static constexpr size_t MAX_PENDING_BUFFERS = 8;
+
+  std::unordered_map<uint32_t, std::unordered_map<uint64_t, pending_req_t>> pending_reqs_;
+  std::vector<event_t> buffer_;
+  uint64_t cycle_base_;
+  uint64_t start_;
+  uint64_t end_;
+
+  // writer state
+  FILE* file_;
+  std::deque<std::vector<event_t>> queue_;
+  std::unordered_set<uint64_t> named_tracks_;
+  uint64_t mem_ids_;
+  bool first_event_;
+  bool done_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+
+}
@@ -81,6 +81,7 @@ enum class ExeType {
   LSU,
   FPU,
   SFU,
+  VPU,
   MAX,
 };
 
@@ -90,6 +91,7 @@ inline std::ostream &operator<<(std::ostream &os, const ExeType& type) {
   case ExeType::LSU: os << "LSU"; break;
   case ExeType::FPU: os << "FPU"; break;
   case ExeType::SFU: os << "SFU"; break;
+  case ExeType::VPU: os << "VPU"; break;
   case ExeType::MAX: break;
   }
   return os;
@@ -180,6 +182,37 @@ inline std::ostream &operator<<(std::ostream &os, const FpuType& type) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// functional units of the ALU and FPU blocks, each with its own latency and
+// initiation interval
+enum class FuType {
+  ALU,
+  IMUL,
+  IDIV,
+  FNCP,
+  FMA,
+  FDIV,
+  FSQRT,
+  FCVT,
+  MAX,
+};
+
+inline std::ostream &operator<<(std::ostream &os, const FuType& type) {
+  switch (type) {
+  case FuType::ALU:   os << "ALU"; break;
+  case FuType::IMUL:  os << "IMUL"; break;
+  case FuType::IDIV:  os << "IDIV"; break;
+  case FuType::FNCP:  os << "FNCP"; break;
+  case FuType::FMA:   os << "FMA"; break;
+  case FuType::FDIV:  os << "FDIV"; break;
+  case FuType::FSQRT: os << "FSQRT"; break;
+  case FuType::FCVT:  os << "FCVT"; break;
+  case FuType::MAX:   break;
+  }
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 enum class SfuType {
   TMC,
   WSPAWN,
@@ -0,0 +1,1879 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vec_exec.h"
+#include <array>
+#include <algorithm>
+#include <string.h>
+#include <assert.h>
+#include <util.h>
+#include <rvfloats.h>
+#include "instr.h"
+
+using namespace vortex;
+
+namespace {
+
+constexpr uint32_t ELEN = 64;
+constexpr uint32_t VILL = 1u << 31;
+
+// OP-V forms, as encoded in funct3
+enum {
+  OPIVV = 0,
+  OPFVV = 1,
+  OPMVV = 2,
+  OPIVI = 3,
+  OPIVX = 4,
+  OPFVF = 5,
+  OPMVX = 6,
+  OPCFG = 7
+};
+
+#define IVV (1 << OPIVV)
+#define IVX (1 << OPIVX)
+#define IVI (1 << OPIVI)
+#define MVV (1 << OPMVV)
+#define MVX (1 << OPMVX)
+#define FVV (1 << OPFVV)
+#define FVF (1 << OPFVF)
+
+// operation flags
+enum {
+  F_UIMM    = 1 << 0, // the .vi immediate is unsigned
+  F_FP      = 1 << 1, // SEW must be 32 or 64
+  F_NOCHAIN = 1 << 2, // needs its whole sources (permutations) or produces its result last (reductions)
+  F_ANYVTYPE= 1 << 3, // legal with vill set
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// integer types of each element width
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
+
+template <typename T> struct int_of;
+#define INT_OF(U, S, W, SW) \
+  template <> struct int_of<U> { typedef U utype; typedef S stype; typedef W wtype; typedef SW swtype; }; \
+  template <> struct int_of<S> { typedef U utype; typedef S stype; typedef W wtype; typedef SW swtype; };
+INT_OF(uint8_t,   int8_t,   uint16_t,  int16_t)
+INT_OF(uint16_t,  int16_t,  uint32_t,  int32_t)
+INT_OF(uint32_t,  int32_t,  uint64_t,  int64_t)
+INT_OF(uint64_t,  int64_t,  uint128_t, int128_t)
+INT_OF(uint128_t, int128_t, void,      void)
+#undef INT_OF
+
+template <typename T> using utype_t  = typename int_of<T>::utype;
+template <typename T> using stype_t  = typename int_of<T>::stype;
+template <typename T> using wtype_t  = typename int_of<T>::wtype;
+template <typename T> using swtype_t = typename int_of<T>::swtype;
+
+template <typename T>
+constexpr uint32_t bits_of() {
+  return sizeof(T) * 8;
+}
+
+template <typename T>
+stype_t<T> smax() {
+  return stype_t<T>(utype_t<T>(~utype_t<T>(0)) >> 1);
+}
+
+template <typename T>
+stype_t<T> smin() {
+  return stype_t<T>(-smax<T>() - 1);
+}
+
+// fixed-point rounding of v >> d, as specified by vxrm
+template <typename V>
+V roundoff(V v, uint32_t d, uint32_t vxrm) {
+  if (0 == d)
+    return v;
+  typedef utype_t<V> U;
+  U u = U(v);
+  U lsb = (u >> d) & 1;
+  U half = (u >> (d - 1)) & 1;
+  U below = (d > 1) ? (u & ((U(1) << (d - 1)) - 1)) : 0;
+  U r = 0;
+  switch (vxrm) {
+  case 0: r = half; break;                                        // rnu
+  case 1: r = half & ((below != 0) | lsb); break;                 // rne
+  case 2: r = 0; break;                                           // rdn
+  case 3: r = (!lsb) & ((half | below) != 0); break;              // rod
+  }
+  return V((v >> d) + V(r));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// execution context
+
+struct Ctx {
+  const Instr& instr;
+  VecState&    st;
+  VecResult&   res;
+  VecMem*      mem;
+  uint32_t     vlen;
+  uint32_t     vlenb;
+  uint32_t     funct3;
+  uint32_t     funct6;
+  uint32_t     vd;
+  uint32_t     vs1;
+  uint32_t     vs2;
+  bool         vm;      // unmasked
+  bool         vv;      // the second operand is vs1
+  uint32_t     sew;     // in bits
+  int          lmul;    // log2
+  uint32_t     vlmax;
+  uint32_t     vl;
+  uint32_t     vstart;
+  bool         vta;
+  bool         vma;
+  uint64_t     scalar;  // rs1 or immediate operand
+  uint32_t     frm;
+  uint32_t     fflags;
+
+  Ctx(const Instr& instr, VecState& st, VecResult& res, VecMem* mem, uint32_t vlen)
+    : instr(instr), st(st), res(res), mem(mem), vlen(vlen), vlenb(vlen / 8)
+    , funct3(0), funct6(0), vd(0), vs1(0), vs2(0), vm(true), vv(false)
+    , sew(8), lmul(0), vlmax(0), vl(st.vl), vstart(st.vstart), vta(false), vma(false)
+    , scalar(0), frm(0), fflags(0)
+  {}
+
+  // loads the vtype fields, returns false if vill is set
+  bool load_vtype() {
+    if (st.vtype & VILL)
+      return false;
+    uint32_t vlmul = st.vtype & 0x7;
+    sew  = 8 << ((st.vtype >> 3) & 0x7);
+    lmul = (vlmul < 4) ? int(vlmul) : int(vlmul) - 8;
+    vta  = (st.vtype >> 6) & 0x1;
+    vma  = (st.vtype >> 7) & 0x1;
+    vlmax = (lmul >= 0) ? ((vlen / sew) << lmul) : ((vlen / sew) >> -lmul);
+    return true;
+  }
+
+  bool active(uint32_t i) const {
+    return vm || this->mask_bit(0, i);
+  }
+
+  bool mask_bit(uint32_t reg, uint32_t i) const {
+    return (st.vregs[reg * vlenb + i / 8] >> (i % 8)) & 0x1;
+  }
+
+  template <typename T>
+  T get(uint32_t reg, uint32_t i) const {
+    T value;
+    memcpy(&value, &st.vregs[reg * vlenb + i * sizeof(T)], sizeof(T));
+    return value;
+  }
+
+  // second operand: vs1 element or the scalar/immediate
+  template <typename T>
+  T src1(uint32_t i) const {
+    return vv ? this->get<T>(vs1, i) : T(scalar);
+  }
+
+  // number of registers of a group of elements of width eew, or zero if the
+  // resulting EMUL is out of range
+  uint32_t group_size(uint32_t eew) const {
+    int emul = lmul + log2floor(eew) - log2floor(sew);
+    if (emul < -3 || emul > 3)
+      return 0;
+    return (emul > 0) ? (1 << emul) : 1;
+  }
+
+  bool check_group(uint32_t reg, uint32_t nregs) const {
+    return nregs != 0 && 0 == (reg % nregs) && (reg + nregs) <= 32;
+  }
+
+  // validates a source register group and records its use
+  bool src(uint32_t reg, uint32_t eew) {
+    return this->src_regs(reg, this->group_size(eew));
+  }
+
+  bool src_regs(uint32_t reg, uint32_t nregs) {
+    if (!this->check_group(reg, nregs))
+      return false;
+    for (uint32_t r = 0; r < nregs; ++r) {
+      res.vregs_read.set(reg + r);
+    }
+    return true;
+  }
+};
+
+// Destination register group. Results are written to a copy that is
+// committed at the end, so sources overlapping the destination are read
+// unmodified.
+class Dest {
+public:
+  Dest(Ctx& c, uint32_t reg, uint32_t nregs)
+    : c_(c)
+    , reg_(reg)
+    , data_(c.st.vregs.begin() + reg * c.vlenb, c.st.vregs.begin() + (reg + nregs) * c.vlenb)
+  {
+    for (uint32_t r = 0; r < nregs; ++r) {
+      c.res.vregs_written.set(reg + r);
+    }
+  }
+
+  template <typename T>
+  uint32_t size() const {
+    return data_.size() / sizeof(T);
+  }
+
+  template <typename T>
+  T get(uint32_t i) const {
+    T value;
+    memcpy(&value, &data_[i * sizeof(T)], sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  void set(uint32_t i, T value) {
+    memcpy(&data_[i * sizeof(T)], &value, sizeof(T));
+  }
+
+  bool get_bit(uint32_t i) const {
+    return (data_[i / 8] >> (i % 8)) & 0x1;
+  }
+
+  void set_bit(uint32_t i, bool value) {
+    data_[i / 8] = (data_[i / 8] & ~(1 << (i % 8))) | (value << (i % 8));
+  }
+
+  void commit() {
+    std::copy(data_.begin(), data_.end(), c_.st.vregs.begin() + reg_ * c_.vlenb);
+  }
+
+private:
+  Ctx& c_;
+  uint32_t reg_;
+  std::vector<Byte> data_;
+};
+
+// destination group of elements of width eew, masked instructions cannot
+// write v0 unless the result is a mask
+bool check_dest(Ctx& c, uint32_t reg, uint32_t nregs) {
+  if (!c.check_group(reg, nregs))
+    return false;
+  return c.vm || reg != 0;
+}
+
+// runs body(i) on the active body elements, applies the mask policy to the
+// inactive ones and the tail policy up to the end of the destination group
+template <typename T, typename F>
+void for_each(Ctx& c, Dest& d, const F& body) {
+  if (c.vstart >= c.vl)
+    return;
+  for (uint32_t i = c.vstart; i < c.vl; ++i) {
+    if (!c.active(i)) {
+      if (c.vma) {
+        d.set<T>(i, T(~T(0)));
+      }
+      continue;
+    }
+    body(i);
+  }
+  if (c.vta) {
+    for (uint32_t i = c.vl, n = d.size<T>(); i < n; ++i) {
+      d.set<T>(i, T(~T(0)));
+    }
+  }
+}
+
+// same for mask results, the tail extends to VLEN bits
+template <typename F>
+void for_each_bit(Ctx& c, Dest& d, bool masked, const F& body) {
+  if (c.vstart >= c.vl)
+    return;
+  for (uint32_t i = c.vstart; i < c.vl; ++i) {
+    if (masked && !c.active(i)) {
+      if (c.vma) {
+        d.set_bit(i, true);
+      }
+      continue;
+    }
+    d.set_bit(i, body(i));
+  }
+  if (c.vta) {
+    for (uint32_t i = c.vl; i < c.vlen; ++i) {
+      d.set_bit(i, true);
+    }
+  }
+}
+
+template <typename F>
+bool by_sew(uint32_t sew, const F& f) {
+  switch (sew) {
+  case 8:  return f(uint8_t());
+  case 16: return f(uint16_t());
+  case 32: return f(uint32_t());
+  case 64: return f(uint64_t());
+  default: return false;
+  }
+}
+
+// SEW up to 32, for the widening and narrowing operations
+template <typename F>
+bool by_sew_narrow(uint32_t sew, const F& f) {
+  switch (sew) {
+  case 8:  return f(uint8_t());
+  case 16: return f(uint16_t());
+  case 32: return f(uint32_t());
+  default: return false;
+  }
+}
+
+template <typename F>
+bool by_fsew(uint32_t sew, const F& f) {
+  switch (sew) {
+  case 32: return f(uint32_t());
+  case 64: return f(uint64_t());
+  default: return false;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// integer element operations: a is the vs2 element, b the vs1 element or
+// scalar and d the old destination element
+
+#define VOP2(name, expr) \
+  struct name { \
+    template <typename T> \
+    static T eval(T a, T b, Ctx& c) { \
+      using S [[maybe_unused]] = stype_t<T>; \
+      using W [[maybe_unused]] = wtype_t<T>; \
+      using SW [[maybe_unused]] = swtype_t<T>; \
+      __unused (c); \
+      return T(expr); \
+    } \
+  };
+
+#define VCMP(name, expr) \
+  struct name { \
+    template <typename T> \
+    static bool eval(T a, T b, Ctx& c) { \
+      using S [[maybe_unused]] = stype_t<T>; \
+      __unused (c); \
+      return (expr); \
+    } \
+  };
+
+#define VOP3(name, expr) \
+  struct name { \
+    template <typename T> \
+    static T eval(T a, T b, T d, Ctx& c) { \
+      using W [[maybe_unused]] = wtype_t<T>; \
+      __unused (c); \
+      return T(expr); \
+    } \
+  };
+
+#define SHAMT(T, b) (uint32_t(b) & (bits_of<T>() - 1))
+
+VOP2(OpAdd,   W(a) + W(b))
+VOP2(OpSub,   W(a) - W(b))
+VOP2(OpRSub,  W(b) - W(a))
+VOP2(OpMinu,  std::min(a, b))
+VOP2(OpMin,   std::min(S(a), S(b)))
+VOP2(OpMaxu,  std::max(a, b))
+VOP2(OpMax,   std::max(S(a), S(b)))
+VOP2(OpAnd,   a & b)
+VOP2(OpOr,    a | b)
+VOP2(OpXor,   a ^ b)
+VOP2(OpSll,   W(a) << SHAMT(T, b))
+VOP2(OpSrl,   a >> SHAMT(T, b))
+VOP2(OpSra,   S(a) >> SHAMT(T, b))
+VOP2(OpMul,   W(a) * W(b))
+VOP2(OpMulhu, (W(a) * W(b)) >> bits_of<T>())
+VOP2(OpMulh,  (SW(S(a)) * SW(S(b))) >> bits_of<T>())
+VOP2(OpMulhsu,(SW(S(a)) * SW(W(b))) >> bits_of<T>())
+VOP2(OpDivu,  (b == 0) ? T(~T(0)) : T(a / b))
+VOP2(OpDiv,   (b == 0) ? T(~T(0)) : ((S(a) == smin<T>() && S(b) == -1) ? a : T(SW(S(a)) / SW(S(b)))))
+VOP2(OpRemu,  (b == 0) ? a : T(a % b))
+VOP2(OpRem,   (b == 0) ? a : ((S(a) == smin<T>() && S(b) == -1) ? T(0) : T(SW(S(a)) % SW(S(b)))))
+
+// fixed point
+VOP2(OpSaddu, (W(a) + W(b) > W(T(~T(0)))) ? (c.st.vxsat = 1, T(~T(0))) : T(a + b))
+VOP2(OpSadd,  (SW(S(a)) + SW(S(b)) > SW(smax<T>())) ? (c.st.vxsat = 1, T(smax<T>()))
+            : (SW(S(a)) + SW(S(b)) < SW(smin<T>())) ? (c.st.vxsat = 1, T(smin<T>()))
+            : T(a + b))
+VOP2(OpSsubu, (a < b) ? (c.st.vxsat = 1, T(0)) : T(a - b))
+VOP2(OpSsub,  (SW(S(a)) - SW(S(b)) > SW(smax<T>())) ? (c.st.vxsat = 1, T(smax<T>()))
+            : (SW(S(a)) - SW(S(b)) < SW(smin<T>())) ? (c.st.vxsat = 1, T(smin<T>()))
+            : T(a - b))
+VOP2(OpAaddu, roundoff(W(a) + W(b), 1, c.st.vxrm))
+VOP2(OpAadd,  roundoff(SW(S(a)) + SW(S(b)), 1, c.st.vxrm))
+VOP2(OpAsubu, roundoff(SW(W(a)) - SW(W(b)), 1, c.st.vxrm))
+VOP2(OpAsub,  roundoff(SW(S(a)) - SW(S(b)), 1, c.st.vxrm))
+VOP2(OpSsrl,  roundoff(a, SHAMT(T, b), c.st.vxrm))
+VOP2(OpSsra,  roundoff(S(a), SHAMT(T, b), c.st.vxrm))
+VOP2(OpSmul,  (S(a) == smin<T>() && S(b) == smin<T>()) ? (c.st.vxsat = 1, T(smax<T>()))
+            : T(roundoff(SW(S(a)) * SW(S(b)), bits_of<T>() - 1, c.st.vxrm)))
+
+VCMP(OpSeq,   a == b)
+VCMP(OpSne,   a != b)
+VCMP(OpSltu,  a < b)
+VCMP(OpSlt,   S(a) < S(b))
+VCMP(OpSleu,  a <= b)
+VCMP(OpSle,   S(a) <= S(b))
+VCMP(OpSgtu,  a > b)
+VCMP(OpSgt,   S(a) > S(b))
+
+// multiply-add, vd = +/-(vs1 * vs2) + vd or +/-(vs1 * vd) + vs2
+VOP3(OpMacc,  W(b) * W(a) + W(d))
+VOP3(OpNmsac, W(d) - W(b) * W(a))
+VOP3(OpMadd,  W(b) * W(d) + W(a))
+VOP3(OpNmsub, W(a) - W(b) * W(d))
+
+// reductions, a is the accumulator
+VOP2(OpRedAnd, a & b)
+VOP2(OpRedOr,  a | b)
+VOP2(OpRedXor, a ^ b)
+
+// mask logical, a is the vs2 bit and b the vs1 bit
+VOP2(OpMandn, a & ~b)
+VOP2(OpMand,  a & b)
+VOP2(OpMor,   a | b)
+VOP2(OpMxor,  a ^ b)
+VOP2(OpMorn,  a | ~b)
+VOP2(OpMnand, ~(a & b))
+VOP2(OpMnor,  ~(a | b))
+VOP2(OpMxnor, ~(a ^ b))
+
+#undef VOP2
+#undef VCMP
+#undef VOP3
+
+///////////////////////////////////////////////////////////////////////////////
+// integer handlers
+
+typedef bool (*handler_t)(Ctx& c);
+
+template <typename Op>
+bool h_binary(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      d.set<T>(i, Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), c));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+template <typename Op>
+bool h_compare(Ctx& c) {
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !c.check_group(c.vd, 1))
+    return false;
+  Dest d(c, c.vd, 1);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each_bit(c, d, true, [&](uint32_t i) {
+      return Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), c);
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+template <typename Op>
+bool h_muladd(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  c.src(c.vd, c.sew);
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      d.set<T>(i, Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), d.get<T>(i), c));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+template <bool S, typename T>
+wtype_t<T> extend(T value) {
+  typedef wtype_t<T> W;
+  return S ? W(swtype_t<T>(stype_t<T>(value))) : W(value);
+}
+
+// widening vd(2*SEW) = vs2 op vs1, vs2 is 2*SEW for the .w forms
+template <bool SA, bool SB, bool WA, typename Op>
+bool h_widen(Ctx& c) {
+  uint32_t nregs = c.group_size(2 * c.sew);
+  if (!c.src(c.vs2, WA ? 2 * c.sew : c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  bool ok = by_sew_narrow(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    typedef wtype_t<T> W;
+    for_each<W>(c, d, [&](uint32_t i) {
+      W a = WA ? c.get<W>(c.vs2, i) : extend<SA>(c.get<T>(c.vs2, i));
+      W b = extend<SB>(c.src1<T>(i));
+      d.set<W>(i, Op::eval(a, b, c));
+    });
+    return true;
+  });
+  if (ok) {
+    d.commit();
+  }
+  return ok;
+}
+
+// widening multiply-add, vd(2*SEW) += vs1 * vs2
+template <bool S1, bool S2>
+bool h_widen_macc(Ctx& c) {
+  uint32_t nregs = c.group_size(2 * c.sew);
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  c.src(c.vd, 2 * c.sew);
+  Dest d(c, c.vd, nregs);
+  bool ok = by_sew_narrow(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    typedef wtype_t<T> W;
+    for_each<W>(c, d, [&](uint32_t i) {
+      W a = extend<S2>(c.get<T>(c.vs2, i));
+      W b = extend<S1>(c.src1<T>(i));
+      d.set<W>(i, W(b * a + d.get<W>(i)));
+    });
+    return true;
+  });
+  if (ok) {
+    d.commit();
+  }
+  return ok;
+}
+
+// narrowing shifts, vd(SEW) = vs2(2*SEW) >> vs1
+template <bool SIGNED, bool CLIP>
+bool h_narrow(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, 2 * c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  bool ok = by_sew_narrow(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    typedef wtype_t<T> W;
+    typedef swtype_t<T> SW;
+    for_each<T>(c, d, [&](uint32_t i) {
+      W a = c.get<W>(c.vs2, i);
+      uint32_t shamt = uint32_t(c.src1<T>(i)) & (2 * bits_of<T>() - 1);
+      if (!CLIP) {
+        d.set<T>(i, SIGNED ? T(SW(a) >> shamt) : T(a >> shamt));
+      } else if (SIGNED) {
+        SW r = roundoff(SW(a), shamt, c.st.vxrm);
+        if (r > SW(smax<T>()) || r < SW(smin<T>())) {
+          c.st.vxsat = 1;
+          r = (r < 0) ? SW(smin<T>()) : SW(smax<T>());
+        }
+        d.set<T>(i, T(r));
+      } else {
+        W r = roundoff(a, shamt, c.st.vxrm);
+        if (r > W(T(~T(0)))) {
+          c.st.vxsat = 1;
+          r = W(T(~T(0)));
+        }
+        d.set<T>(i, T(r));
+      }
+    });
+    return true;
+  });
+  if (ok) {
+    d.commit();
+  }
+  return ok;
+}
+
+// vadc/vsbc: vd = vs2 +/- vs1 +/- v0, all body elements are active
+template <bool SUB>
+bool h_carry(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (c.vm || 0 == c.vd || !c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !c.check_group(c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  c.vm = true;
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      T a = c.get<T>(c.vs2, i);
+      T b = c.src1<T>(i);
+      T carry = c.mask_bit(0, i);
+      d.set<T>(i, SUB ? T(a - b - carry) : T(a + b + carry));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vmadc/vmsbc: carry or borrow out, with v0 as carry in when masked
+template <bool SUB>
+bool h_carry_out(Ctx& c) {
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !c.check_group(c.vd, 1))
+    return false;
+  Dest d(c, c.vd, 1);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    typedef wtype_t<T> W;
+    for_each_bit(c, d, false, [&](uint32_t i) {
+      W a = c.get<T>(c.vs2, i);
+      W b = c.src1<T>(i);
+      W carry = c.vm ? 0 : c.mask_bit(0, i);
+      return SUB ? (a < b + carry) : (((a + b + carry) >> bits_of<T>()) != 0);
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vmerge, and vmv.v when unmasked
+bool h_merge(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if ((c.vm && c.vs2 != 0) || (!c.vm && !c.src(c.vs2, c.sew))
+   || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  bool vm = c.vm;
+  c.vm = true;
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      bool sel = vm || c.mask_bit(0, i);
+      d.set<T>(i, sel ? c.src1<T>(i) : c.get<T>(c.vs2, i));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vzext/vsext, the source has SEW/factor bits
+bool h_extend(Ctx& c) {
+  uint32_t factor, sign;
+  switch (c.vs1) {
+  case 0x02: factor = 8; sign = 0; break;
+  case 0x03: factor = 8; sign = 1; break;
+  case 0x04: factor = 4; sign = 0; break;
+  case 0x05: factor = 4; sign = 1; break;
+  case 0x06: factor = 2; sign = 0; break;
+  case 0x07: factor = 2; sign = 1; break;
+  default: return false;
+  }
+  uint32_t src_eew = c.sew / factor;
+  uint32_t nregs = c.group_size(c.sew);
+  if (src_eew < 8 || !c.src(c.vs2, src_eew) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      uint64_t value = 0;
+      switch (src_eew) {
+      case 8:  value = sign ? uint64_t(int64_t(c.get<int8_t>(c.vs2, i))) : c.get<uint8_t>(c.vs2, i); break;
+      case 16: value = sign ? uint64_t(int64_t(c.get<int16_t>(c.vs2, i))) : c.get<uint16_t>(c.vs2, i); break;
+      case 32: value = sign ? uint64_t(int64_t(c.get<int32_t>(c.vs2, i))) : c.get<uint32_t>(c.vs2, i); break;
+      }
+      d.set<T>(i, T(value));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// single-width integer reductions: vd[0] = op(vs1[0], vs2[*])
+template <typename Op>
+bool h_reduce(Ctx& c) {
+  if (c.vstart != 0 || !c.src(c.vs2, c.sew) || !c.src_regs(c.vs1, 1) || !c.check_group(c.vd, 1))
+    return false;
+  if (0 == c.vl)
+    return true;
+  Dest d(c, c.vd, 1);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    T acc = c.get<T>(c.vs1, 0);
+    for (uint32_t i = 0; i < c.vl; ++i) {
+      if (c.active(i)) {
+        acc = Op::eval(acc, c.get<T>(c.vs2, i), c);
+      }
+    }
+    d.set<T>(0, acc);
+    if (c.vta) {
+      for (uint32_t i = 1, n = d.size<T>(); i < n; ++i) {
+        d.set<T>(i, T(~T(0)));
+      }
+    }
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// widening integer sums: vd[0](2*SEW) = vs1[0](2*SEW) + vs2[*]
+template <bool SIGNED>
+bool h_reduce_widen(Ctx& c) {
+  if (c.vstart != 0 || !c.src(c.vs2, c.sew) || !c.src_regs(c.vs1, 1) || !c.check_group(c.vd, 1))
+    return false;
+  if (0 == c.vl)
+    return true;
+  Dest d(c, c.vd, 1);
+  bool ok = by_sew_narrow(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    typedef wtype_t<T> W;
+    W acc = c.get<W>(c.vs1, 0);
+    for (uint32_t i = 0; i < c.vl; ++i) {
+      if (c.active(i)) {
+        acc = W(acc + extend<SIGNED>(c.get<T>(c.vs2, i)));
+      }
+    }
+    d.set<W>(0, acc);
+    if (c.vta) {
+      for (uint32_t i = 1, n = d.size<W>(); i < n; ++i) {
+        d.set<W>(i, W(~W(0)));
+      }
+    }
+    return true;
+  });
+  if (ok) {
+    d.commit();
+  }
+  return ok;
+}
+
+// mask-register logical operations
+template <typename Op>
+bool h_mask_logical(Ctx& c) {
+  if (!c.vm || !c.src_regs(c.vs2, 1) || !c.src_regs(c.vs1, 1) || !c.check_group(c.vd, 1))
+    return false;
+  Dest d(c, c.vd, 1);
+  for_each_bit(c, d, false, [&](uint32_t i) {
+    return (Op::eval(uint8_t(c.mask_bit(c.vs2, i)), uint8_t(c.mask_bit(c.vs1, i)), c) & 0x1) != 0;
+  });
+  d.commit();
+  return true;
+}
+
+// VWXUNARY0: vmv.x.s, vcpop.m, vfirst.m
+bool h_wxunary0(Ctx& c) {
+  switch (c.vs1) {
+  case 0x00: { // vmv.x.s
+    if (!c.vm || !c.src_regs(c.vs2, 1))
+      return false;
+    int64_t value = 0;
+    switch (c.sew) {
+    case 8:  value = c.get<int8_t>(c.vs2, 0); break;
+    case 16: value = c.get<int16_t>(c.vs2, 0); break;
+    case 32: value = c.get<int32_t>(c.vs2, 0); break;
+    case 64: value = c.get<int64_t>(c.vs2, 0); break;
+    }
+    c.res.scalar = value;
+    c.res.elements = 1;
+    break;
+  }
+  case 0x10:   // vcpop.m
+  case 0x11: { // vfirst.m
+    if (c.vstart != 0 || !c.src_regs(c.vs2, 1))
+      return false;
+    uint64_t count = 0;
+    int64_t first = -1;
+    for (uint32_t i = 0; i < c.vl; ++i) {
+      if (c.active(i) && c.mask_bit(c.vs2, i)) {
+        if (first < 0) {
+          first = i;
+        }
+        ++count;
+      }
+    }
+    c.res.scalar = (c.vs1 == 0x10) ? count : uint64_t(first);
+    break;
+  }
+  default:
+    return false;
+  }
+  c.res.scalar_wb = true;
+  return true;
+}
+
+// VRXUNARY0: vmv.s.x
+bool h_rxunary0(Ctx& c) {
+  if (c.vs2 != 0 || !c.vm || !c.check_group(c.vd, 1))
+    return false;
+  Dest d(c, c.vd, 1);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    if (c.vstart < c.vl) {
+      d.set<T>(0, T(c.scalar));
+      if (c.vta) {
+        for (uint32_t i = 1, n = d.size<T>(); i < n; ++i) {
+          d.set<T>(i, T(~T(0)));
+        }
+      }
+    }
+    return true;
+  });
+  d.commit();
+  c.res.elements = 1;
+  return true;
+}
+
+// VMUNARY0: vmsbf.m, vmsof.m, vmsif.m, viota.m, vid.v
+bool h_munary0(Ctx& c) {
+  switch (c.vs1) {
+  case 0x01:   // vmsbf.m
+  case 0x02:   // vmsof.m
+  case 0x03: { // vmsif.m
+    if (c.vstart != 0 || !c.src_regs(c.vs2, 1) || !c.check_group(c.vd, 1) || c.vd == c.vs2 || (!c.vm && c.vd == 0))
+      return false;
+    Dest d(c, c.vd, 1);
+    bool found = false;
+    for_each_bit(c, d, true, [&](uint32_t i) {
+      bool bit = c.mask_bit(c.vs2, i);
+      bool value;
+      switch (c.vs1) {
+      case 0x01: value = !found && !bit; break;
+      case 0x02: value = !found && bit; break;
+      default:   value = !found; break;
+      }
+      found |= bit;
+      return value;
+    });
+    d.commit();
+    return true;
+  }
+  case 0x10: { // viota.m
+    uint32_t nregs = c.group_size(c.sew);
+    if (c.vstart != 0 || !c.src_regs(c.vs2, 1) || !check_dest(c, c.vd, nregs))
+      return false;
+    Dest d(c, c.vd, nregs);
+    by_sew(c.sew, [&](auto t) {
+      typedef decltype(t) T;
+      uint64_t count = 0;
+      for_each<T>(c, d, [&](uint32_t i) {
+        d.set<T>(i, T(count));
+        count += c.mask_bit(c.vs2, i);
+      });
+      return true;
+    });
+    d.commit();
+    c.res.chainable = false;
+    return true;
+  }
+  case 0x11: { // vid.v
+    uint32_t nregs = c.group_size(c.sew);
+    if (c.vs2 != 0 || !check_dest(c, c.vd, nregs))
+      return false;
+    Dest d(c, c.vd, nregs);
+    by_sew(c.sew, [&](auto t) {
+      typedef decltype(t) T;
+      for_each<T>(c, d, [&](uint32_t i) {
+        d.set<T>(i, T(i));
+      });
+      return true;
+    });
+    d.commit();
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+// slides: vd[i + offset] = vs2[i] (up) or vd[i] = vs2[i + offset] (down);
+// vslide1up/vslide1down shift by one and insert the scalar
+template <bool UP, bool ONE>
+bool h_slide(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, c.sew) || !check_dest(c, c.vd, nregs))
+    return false;
+  if (UP && c.vd == c.vs2)
+    return false;
+  uint64_t offset = ONE ? 1 : c.scalar;
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    if (UP) {
+      uint32_t vstart = c.vstart;
+      if (!ONE && offset > c.vstart) {
+        // elements below the offset are unchanged
+        c.vstart = uint32_t(std::min<uint64_t>(offset, c.vl));
+      }
+      for_each<T>(c, d, [&](uint32_t i) {
+        d.set<T>(i, (ONE && 0 == i) ? T(c.scalar) : c.get<T>(c.vs2, uint32_t(i - offset)));
+      });
+      c.vstart = vstart;
+    } else {
+      for_each<T>(c, d, [&](uint32_t i) {
+        if (ONE && (i + 1) == c.vl) {
+          d.set<T>(i, T(c.scalar));
+        } else {
+          uint64_t j = i + offset;
+          d.set<T>(i, (j < c.vlmax) ? c.get<T>(c.vs2, uint32_t(j)) : T(0));
+        }
+      });
+    }
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vrgather.vv/vx/vi and vrgatherei16.vv
+template <bool EI16>
+bool h_gather(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  uint32_t idx_eew = EI16 ? 16 : c.sew;
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, idx_eew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  if (c.vd == c.vs2 || (c.vv && c.vd == c.vs1))
+    return false;
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      uint64_t idx;
+      if (!c.vv) {
+        idx = c.scalar;
+      } else if (EI16) {
+        idx = c.get<uint16_t>(c.vs1, i);
+      } else {
+        idx = c.get<T>(c.vs1, i);
+      }
+      d.set<T>(i, (idx < c.vlmax) ? c.get<T>(c.vs2, uint32_t(idx)) : T(0));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vcompress.vm: packs the vs2 elements selected by vs1
+bool h_compress(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.vm || c.vstart != 0 || !c.src(c.vs2, c.sew) || !c.src_regs(c.vs1, 1) || !check_dest(c, c.vd, nregs)
+   || c.vd == c.vs2 || c.vd == c.vs1)
+    return false;
+  Dest d(c, c.vd, nregs);
+  by_sew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < c.vl; ++i) {
+      if (c.mask_bit(c.vs1, i)) {
+        d.set<T>(count++, c.get<T>(c.vs2, i));
+      }
+    }
+    if (c.vta) {
+      for (uint32_t i = count, n = d.size<T>(); i < n; ++i) {
+        d.set<T>(i, T(~T(0)));
+      }
+    }
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// vsmul.vv/vx, or vmv<nr>r.v in the .vi form
+bool h_smul_mvnr(Ctx& c) {
+  if (c.funct3 != OPIVI)
+    return h_binary<OpSmul>(c);
+  uint32_t nr = uint32_t(c.scalar) + 1;
+  if (!c.vm || (nr != 1 && nr != 2 && nr != 4 && nr != 8)
+   || !c.src_regs(c.vs2, nr) || !c.check_group(c.vd, nr))
+    return false;
+  Dest d(c, c.vd, nr);
+  uint32_t eew_bytes = (c.st.vtype & VILL) ? 1 : c.sew / 8;
+  for (uint32_t i = c.vstart * eew_bytes, n = nr * c.vlenb; i < n; ++i) {
+    d.set<uint8_t>(i, c.st.vregs[c.vs2 * c.vlenb + i]);
+  }
+  d.commit();
+  c.res.elements = nr * c.vlenb / eew_bytes;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// floating-point element operations, a is the vs2 element and b the vs1
+// element or scalar
+
+#define FOP2(name, fn_s, fn_d) \
+  struct name { \
+    static uint32_t eval(uint32_t a, uint32_t b, Ctx& c) { \
+      uint32_t fflags = 0; \
+      auto r = fn_s; \
+      c.fflags |= fflags; \
+      return r; \
+    } \
+    static uint64_t eval(uint64_t a, uint64_t b, Ctx& c) { \
+      uint32_t fflags = 0; \
+      auto r = fn_d; \
+      c.fflags |= fflags; \
+      return r; \
+    } \
+  };
+
+#define FOP3(name, fn_s, fn_d) \
+  struct name { \
+    static uint32_t eval(uint32_t a, uint32_t b, uint32_t d, Ctx& c) { \
+      uint32_t fflags = 0; \
+      auto r = fn_s; \
+      c.fflags |= fflags; \
+      return r; \
+    } \
+    static uint64_t eval(uint64_t a, uint64_t b, uint64_t d, Ctx& c) { \
+      uint32_t fflags = 0; \
+      auto r = fn_d; \
+      c.fflags |= fflags; \
+      return r; \
+    } \
+  };
+
+FOP2(FAdd,   rv_fadd_s(a, b, c.frm, &fflags),  rv_fadd_d(a, b, c.frm, &fflags))
+FOP2(FSub,   rv_fsub_s(a, b, c.frm, &fflags),  rv_fsub_d(a, b, c.frm, &fflags))
+FOP2(FRSub,  rv_fsub_s(b, a, c.frm, &fflags),  rv_fsub_d(b, a, c.frm, &fflags))
+FOP2(FMul,   rv_fmul_s(a, b, c.frm, &fflags),  rv_fmul_d(a, b, c.frm, &fflags))
+FOP2(FDiv,   rv_fdiv_s(a, b, c.frm, &fflags),  rv_fdiv_d(a, b, c.frm, &fflags))
+FOP2(FRDiv,  rv_fdiv_s(b, a, c.frm, &fflags),  rv_fdiv_d(b, a, c.frm, &fflags))
+FOP2(FMin,   rv_fmin_s(a, b, &fflags),         rv_fmin_d(a, b, &fflags))
+FOP2(FMax,   rv_fmax_s(a, b, &fflags),         rv_fmax_d(a, b, &fflags))
+FOP2(FSgnj,  rv_fsgnj_s(a, b),                 rv_fsgnj_d(a, b))
+FOP2(FSgnjn, rv_fsgnjn_s(a, b),                rv_fsgnjn_d(a, b))
+FOP2(FSgnjx, rv_fsgnjx_s(a, b),                rv_fsgnjx_d(a, b))
+
+FOP2(FEq,    rv_feq_s(a, b, &fflags),          rv_feq_d(a, b, &fflags))
+FOP2(FNe,    !rv_feq_s(a, b, &fflags),         !rv_feq_d(a, b, &fflags))
+FOP2(FLt,    rv_flt_s(a, b, &fflags),          rv_flt_d(a, b, &fflags))
+FOP2(FLe,    rv_fle_s(a, b, &fflags),          rv_fle_d(a, b, &fflags))
+FOP2(FGt,    rv_flt_s(b, a, &fflags),          rv_flt_d(b, a, &fflags))
+FOP2(FGe,    rv_fle_s(b, a, &fflags),          rv_fle_d(b, a, &fflags))
+
+// d is the old destination element
+FOP3(FMacc,  rv_fmadd_s(b, a, d, c.frm, &fflags),  rv_fmadd_d(b, a, d, c.frm, &fflags))
+FOP3(FNmacc, rv_fnmadd_s(b, a, d, c.frm, &fflags), rv_fnmadd_d(b, a, d, c.frm, &fflags))
+FOP3(FMsac,  rv_fmsub_s(b, a, d, c.frm, &fflags),  rv_fmsub_d(b, a, d, c.frm, &fflags))
+FOP3(FNmsac, rv_fnmsub_s(b, a, d, c.frm, &fflags), rv_fnmsub_d(b, a, d, c.frm, &fflags))
+FOP3(FMadd,  rv_fmadd_s(b, d, a, c.frm, &fflags),  rv_fmadd_d(b, d, a, c.frm, &fflags))
+FOP3(FNmadd, rv_fnmadd_s(b, d, a, c.frm, &fflags), rv_fnmadd_d(b, d, a, c.frm, &fflags))
+FOP3(FMsub,  rv_fmsub_s(b, d, a, c.frm, &fflags),  rv_fmsub_d(b, d, a, c.frm, &fflags))
+FOP3(FNmsub, rv_fnmsub_s(b, d, a, c.frm, &fflags), rv_fnmsub_d(b, d, a, c.frm, &fflags))
+
+#undef FOP2
+#undef FOP3
+
+///////////////////////////////////////////////////////////////////////////////
+// floating-point handlers
+
+template <typename Op>
+bool h_fbinary(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  by_fsew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      d.set<T>(i, Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), c));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+template <typename Op>
+bool h_fcompare(Ctx& c) {
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !c.check_group(c.vd, 1))
+    return false;
+  Dest d(c, c.vd, 1);
+  by_fsew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each_bit(c, d, true, [&](uint32_t i) {
+      return Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), c) != 0;
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+template <typename Op>
+bool h_fmuladd(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if (!c.src(c.vs2, c.sew) || (c.vv && !c.src(c.vs1, c.sew)) || !check_dest(c, c.vd, nregs))
+    return false;
+  c.src(c.vd, c.sew);
+  Dest d(c, c.vd, nregs);
+  by_fsew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      d.set<T>(i, Op::eval(c.get<T>(c.vs2, i), c.src1<T>(i), d.get<T>(i), c));
+    });
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+// widening FP operations are only defined for SEW=32
+template <bool WA, typename Op>
+bool h_fwiden(Ctx& c) {
+  uint32_t nregs = c.group_size(64);
+  if (c.sew != 32 || !c.src(c.vs2, WA ? 64 : 32) || (c.vv && !c.src(c.vs1, 32)) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  for_each<uint64_t>(c, d, [&](uint32_t i) {
+    uint64_t a = WA ? c.get<uint64_t>(c.vs2, i) : rv_ftod(c.get<uint32_t>(c.vs2, i));
+    uint64_t b = rv_ftod(c.src1<uint32_t>(i));
+    d.set<uint64_t>(i, Op::eval(a, b, c));
+  });
+  d.commit();
+  return true;
+}
+
+template <typename Op>
+bool h_fwiden_macc(Ctx& c) {
+  uint32_t nregs = c.group_size(64);
+  if (c.sew != 32 || !c.src(c.vs2, 32) || (c.vv && !c.src(c.vs1, 32)) || !check_dest(c, c.vd, nregs))
+    return false;
+  c.src(c.vd, 64);
+  Dest d(c, c.vd, nregs);
+  for_each<uint64_t>(c, d, [&](uint32_t i) {
+    uint64_t a = rv_ftod(c.get<uint32_t>(c.vs2, i));
+    uint64_t b = rv_ftod(c.src1<uint32_t>(i));
+    d.set<uint64_t>(i, Op::eval(a, b, d.get<uint64_t>(i), c));
+  });
+  d.commit();
+  return true;
+}
+
+// FP reductions, evaluated in element order
+template <typename Op>
+bool h_freduce(Ctx& c) {
+  if (c.vstart != 0 || !c.src(c.vs2, c.sew) || !c.src_regs(c.vs1, 1) || !c.check_group(c.vd, 1))
+    return false;
+  if (0 == c.vl)
+    return true;
+  Dest d(c, c.vd, 1);
+  by_fsew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    T acc = c.get<T>(c.vs1, 0);
+    for (uint32_t i = 0; i < c.vl; ++i) {
+      if (c.active(i)) {
+        acc = Op::eval(acc, c.get<T>(c.vs2, i), c);
+      }
+    }
+    d.set<T>(0, acc);
+    if (c.vta) {
+      for (uint32_t i = 1, n = d.size<T>(); i < n; ++i) {
+        d.set<T>(i, T(~T(0)));
+      }
+    }
+    return true;
+  });
+  d.commit();
+  return true;
+}
+
+bool h_fwreduce(Ctx& c) {
+  if (c.sew != 32 || c.vstart != 0 || !c.src(c.vs2, 32) || !c.src_regs(c.vs1, 1) || !c.check_group(c.vd, 1))
+    return false;
+  if (0 == c.vl)
+    return true;
+  Dest d(c, c.vd, 1);
+  uint64_t acc = c.get<uint64_t>(c.vs1, 0);
+  for (uint32_t i = 0; i < c.vl; ++i) {
+    if (c.active(i)) {
+      acc = FAdd::eval(acc, rv_ftod(c.get<uint32_t>(c.vs2, i)), c);
+    }
+  }
+  d.set<uint64_t>(0, acc);
+  if (c.vta) {
+    for (uint32_t i = 1, n = d.size<uint64_t>(); i < n; ++i) {
+      d.set<uint64_t>(i, ~uint64_t(0));
+    }
+  }
+  d.commit();
+  return true;
+}
+
+// VWFUNARY0: vfmv.f.s
+bool h_wfunary0(Ctx& c) {
+  if (c.vs1 != 0 || !c.vm || !c.src_regs(c.vs2, 1))
+    return false;
+  c.res.scalar = (32 == c.sew) ? (0xffffffff00000000 | c.get<uint32_t>(c.vs2, 0)) : c.get<uint64_t>(c.vs2, 0);
+  c.res.scalar_wb = true;
+  c.res.elements = 1;
+  return true;
+}
+
+// VRFUNARY0: vfmv.s.f
+bool h_rfunary0(Ctx& c) {
+  return h_rxunary0(c);
+}
+
+// saturating FP to integer conversions to a narrower integer
+template <typename T>
+T saturate_int(int64_t value, bool is_signed, Ctx& c, uint32_t fflags) {
+  int64_t lo = is_signed ? int64_t(smin<T>()) : 0;
+  int64_t hi = is_signed ? int64_t(smax<T>()) : int64_t(T(~T(0)));
+  if (value < lo || value > hi) {
+    c.fflags |= 0x10; // invalid
+    return T(value < lo ? lo : hi);
+  }
+  c.fflags |= fflags;
+  return T(value);
+}
+
+// VFUNARY0: conversions
+bool h_funary0(Ctx& c) {
+  uint32_t op = c.vs1;
+  uint32_t kind = op >> 3; // 0: single-width, 1: widening, 2: narrowing
+  uint32_t sub = op & 0x7;
+  uint32_t frm = c.frm;
+  if (sub == 6 || sub == 7) {
+    frm = 1; // rtz
+  } else if (sub == 5 || (sub == 4 && kind == 0)) {
+    return false; // vfncvt.rod.f.f.w is not supported
+  }
+  bool to_int   = (sub == 0 || sub == 1 || sub == 6 || sub == 7);
+  bool from_int = (sub == 2 || sub == 3);
+  bool is_signed = (sub == 1 || sub == 3 || sub == 7);
+  uint32_t src_eew = (kind == 2) ? 2 * c.sew : c.sew;
+  uint32_t dst_eew = (kind == 1) ? 2 * c.sew : c.sew;
+  if (kind > 2 || dst_eew > ELEN || src_eew > ELEN)
+    return false;
+  // FP operands must be 32 or 64 bits wide
+  uint32_t fp_eew = to_int ? src_eew : (from_int ? dst_eew : 0);
+  if (fp_eew != 0 && fp_eew != 32 && fp_eew != 64)
+    return false;
+  if (!to_int && !from_int && (src_eew != 32 && src_eew != 64))
+    return false; // f.f conversions
+  uint32_t nregs = c.group_size(dst_eew);
+  if (!c.src(c.vs2, src_eew) || !check_dest(c, c.vd, nregs))
+    return false;
+  auto convert = [&](uint64_t a) -> uint64_t {
+    uint32_t fflags = 0;
+    uint64_t r = 0;
+    if (to_int) {
+      if (src_eew == 32) {
+        if (dst_eew == 64) {
+          r = is_signed ? rv_ftol_s(uint32_t(a), frm, &fflags) : rv_ftolu_s(uint32_t(a), frm, &fflags);
+        } else if (dst_eew == 32) {
+          r = is_signed ? rv_ftoi_s(uint32_t(a), frm, &fflags) : rv_ftou_s(uint32_t(a), frm, &fflags);
+        } else {
+          uint32_t fflags32 = 0;
+          int64_t v = is_signed ? int64_t(rv_ftol_s(uint32_t(a), frm, &fflags32))
+                                : int64_t(std::min<uint64_t>(rv_ftolu_s(uint32_t(a), frm, &fflags32), 0x7fffffffffffffff));
+          return saturate_int<uint16_t>(v, is_signed, c, fflags32);
+        }
+      } else {
+        if (dst_eew == 64) {
+          r = is_signed ? rv_ftol_d(a, frm, &fflags) : rv_ftolu_d(a, frm, &fflags);
+        } else {
+          r = is_signed ? rv_ftoi_d(a, frm, &fflags) : rv_ftou_d(a, frm, &fflags);
+        }
+      }
+    } else if (from_int) {
+      if (dst_eew == 32) {
+        if (src_eew == 64) {
+          r = is_signed ? rv_ltof_s(a, frm, &fflags) : rv_lutof_s(a, frm, &fflags);
+        } else if (src_eew == 32) {
+          r = is_signed ? rv_itof_s(uint32_t(a), frm, &fflags) : rv_utof_s(uint32_t(a), frm, &fflags);
+        } else {
+          uint32_t v = is_signed ? uint32_t(int32_t(int16_t(a))) : uint32_t(uint16_t(a));
+          r = is_signed ? rv_itof_s(v, frm, &fflags) : rv_utof_s(v, frm, &fflags);
+        }
+      } else {
+        if (src_eew == 64) {
+          r = is_signed ? rv_ltof_d(a, frm, &fflags) : rv_lutof_d(a, frm, &fflags);
+        } else {
+          r = is_signed ? rv_itof_d(uint32_t(a), frm, &fflags) : rv_utof_d(uint32_t(a), frm, &fflags);
+        }
+      }
+    } else {
+      // f.f conversions, the scalar FCVT.S.D/FCVT.D.S helpers
+      r = (dst_eew == 64) ? rv_ftod(uint32_t(a)) : rv_dtof(a);
+    }
+    c.fflags |= fflags;
+    return r;
+  };
+  Dest d(c, c.vd, nregs);
+  by_sew(dst_eew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      uint64_t a = 0;
+      switch (src_eew) {
+      case 16: a = c.get<uint16_t>(c.vs2, i); break;
+      case 32: a = c.get<uint32_t>(c.vs2, i); break;
+      case 64: a = c.get<uint64_t>(c.vs2, i); break;
+      }
+      d.set<T>(i, T(convert(a)));
+    });
+    return true;
+  });
+  d.commit();
+  c.res.fu_type = FuType::FCVT;
+  return true;
+}
+
+// VFUNARY1: vfsqrt.v, vfclass.v
+bool h_funary1(Ctx& c) {
+  uint32_t nregs = c.group_size(c.sew);
+  if ((c.vs1 != 0x00 && c.vs1 != 0x10) || !c.src(c.vs2, c.sew) || !check_dest(c, c.vd, nregs))
+    return false;
+  Dest d(c, c.vd, nregs);
+  bool is_sqrt = (c.vs1 == 0x00);
+  by_fsew(c.sew, [&](auto t) {
+    typedef decltype(t) T;
+    for_each<T>(c, d, [&](uint32_t i) {
+      T a = c.get<T>(c.vs2, i);
+      uint32_t fflags = 0;
+      T r;
+      if (sizeof(T) == 4) {
+        r = T(is_sqrt ? rv_fsqrt_s(uint32_t(a), c.frm, &fflags) : rv_fclss_s(uint32_t(a)));
+      } else {
+        r = T(is_sqrt ? rv_fsqrt_d(uint64_t(a), c.frm, &fflags) : rv_fclss_d(uint64_t(a)));
+      }
+      c.fflags |= fflags;
+      d.set<T>(i, r);
+    });
+    return true;
+  });
+  d.commit();
+  c.res.fu_type = is_sqrt ? FuType::FSQRT : FuType::FNCP;
+  return true;
+}
+
+// vfslide1up/vfslide1down
+template <bool UP>
+bool h_fslide1(Ctx& c) {
+  return h_slide<UP, true>(c);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// operation tables, indexed by funct6
+
+struct vop_t {
+  uint32_t    funct6;
+  uint32_t    forms;
+  uint32_t    flags;
+  const char* name;
+  FuType      fu_type;
+  handler_t   handler;
+};
+
+const vop_t opi_ops[] = {
+  {0x00, IVV|IVX|IVI, 0,         "VADD",      FuType::ALU,  h_binary<OpAdd>},
+  {0x02, IVV|IVX,     0,         "VSUB",      FuType::ALU,  h_binary<OpSub>},
+  {0x03, IVX|IVI,     0,         "VRSUB",     FuType::ALU,  h_binary<OpRSub>},
+  {0x04, IVV|IVX,     0,         "VMINU",     FuType::ALU,  h_binary<OpMinu>},
+  {0x05, IVV|IVX,     0,         "VMIN",      FuType::ALU,  h_binary<OpMin>},
+  {0x06, IVV|IVX,     0,         "VMAXU",     FuType::ALU,  h_binary<OpMaxu>},
+  {0x07, IVV|IVX,     0,         "VMAX",      FuType::ALU,  h_binary<OpMax>},
+  {0x09, IVV|IVX|IVI, 0,         "VAND",      FuType::ALU,  h_binary<OpAnd>},
+  {0x0a, IVV|IVX|IVI, 0,         "VOR",       FuType::ALU,  h_binary<OpOr>},
+  {0x0b, IVV|IVX|IVI, 0,         "VXOR",      FuType::ALU,  h_binary<OpXor>},
+  {0x0c, IVV|IVX|IVI, F_UIMM|F_NOCHAIN, "VRGATHER", FuType::ALU, h_gather<false>},
+  {0x0e, IVV,         F_NOCHAIN, "VRGATHEREI16", FuType::ALU, h_gather<true>},
+  {0x0e, IVX|IVI,     F_UIMM|F_NOCHAIN, "VSLIDEUP", FuType::ALU, h_slide<true, false>},
+  {0x0f, IVX|IVI,     F_UIMM|F_NOCHAIN, "VSLIDEDOWN", FuType::ALU, h_slide<false, false>},
+  {0x10, IVV|IVX|IVI, 0,         "VADC",      FuType::ALU,  h_carry<false>},
+  {0x11, IVV|IVX|IVI, 0,         "VMADC",     FuType::ALU,  h_carry_out<false>},
+  {0x12, IVV|IVX,     0,         "VSBC",      FuType::ALU,  h_carry<true>},
+  {0x13, IVV|IVX,     0,         "VMSBC",     FuType::ALU,  h_carry_out<true>},
+  {0x17, IVV|IVX|IVI, 0,         "VMERGE",    FuType::ALU,  h_merge},
+  {0x18, IVV|IVX|IVI, 0,         "VMSEQ",     FuType::ALU,  h_compare<OpSeq>},
+  {0x19, IVV|IVX|IVI, 0,         "VMSNE",     FuType::ALU,  h_compare<OpSne>},
+  {0x1a, IVV|IVX,     0,         "VMSLTU",    FuType::ALU,  h_compare<OpSltu>},
+  {0x1b, IVV|IVX,     0,         "VMSLT",     FuType::ALU,  h_compare<OpSlt>},
+  {0x1c, IVV|IVX|IVI, 0,         "VMSLEU",    FuType::ALU,  h_compare<OpSleu>},
+  {0x1d, IVV|IVX|IVI, 0,         "VMSLE",     FuType::ALU,  h_compare<OpSle>},
+  {0x1e, IVX|IVI,     0,         "VMSGTU",    FuType::ALU,  h_compare<OpSgtu>},
+  {0x1f, IVX|IVI,     0,         "VMSGT",     FuType::ALU,  h_compare<OpSgt>},
+  {0x20, IVV|IVX|IVI, 0,         "VSADDU",    FuType::ALU,  h_binary<OpSaddu>},
+  {0x21, IVV|IVX|IVI, 0,         "VSADD",     FuType::ALU,  h_binary<OpSadd>},
+  {0x22, IVV|IVX,     0,         "VSSUBU",    FuType::ALU,  h_binary<OpSsubu>},
+  {0x23, IVV|IVX,     0,         "VSSUB",     FuType::ALU,  h_binary<OpSsub>},
+  {0x25, IVV|IVX|IVI, F_UIMM,    "VSLL",      FuType::ALU,  h_binary<OpSll>},
+  {0x27, IVV|IVX,     0,         "VSMUL",     FuType::IMUL, h_smul_mvnr},
+  {0x27, IVI,         F_ANYVTYPE,"VMVNR",     FuType::ALU,  h_smul_mvnr},
+  {0x28, IVV|IVX|IVI, F_UIMM,    "VSRL",      FuType::ALU,  h_binary<OpSrl>},
+  {0x29, IVV|IVX|IVI, F_UIMM,    "VSRA",      FuType::ALU,  h_binary<OpSra>},
+  {0x2a, IVV|IVX|IVI, F_UIMM,    "VSSRL",     FuType::ALU,  h_binary<OpSsrl>},
+  {0x2b, IVV|IVX|IVI, F_UIMM,    "VSSRA",     FuType::ALU,  h_binary<OpSsra>},
+  {0x2c, IVV|IVX|IVI, F_UIMM,    "VNSRL",     FuType::ALU,  h_narrow<false, false>},
+  {0x2d, IVV|IVX|IVI, F_UIMM,    "VNSRA",     FuType::ALU,  h_narrow<true, false>},
+  {0x2e, IVV|IVX|IVI, F_UIMM,    "VNCLIPU",   FuType::ALU,  h_narrow<false, true>},
+  {0x2f, IVV|IVX|IVI, F_UIMM,    "VNCLIP",    FuType::ALU,  h_narrow<true, true>},
+  {0x30, IVV,         F_NOCHAIN, "VWREDSUMU", FuType::ALU,  h_reduce_widen<false>},
+  {0x31, IVV,         F_NOCHAIN, "VWREDSUM",  FuType::ALU,  h_reduce_widen<true>},
+};
+
+const vop_t opm_ops[] = {
+  {0x00, MVV,         F_NOCHAIN, "VREDSUM",   FuType::ALU,  h_reduce<OpAdd>},
+  {0x01, MVV,         F_NOCHAIN, "VREDAND",   FuType::ALU,  h_reduce<OpRedAnd>},
+  {0x02, MVV,         F_NOCHAIN, "VREDOR",    FuType::ALU,  h_reduce<OpRedOr>},
+  {0x03, MVV,         F_NOCHAIN, "VREDXOR",   FuType::ALU,  h_reduce<OpRedXor>},
+  {0x04, MVV,         F_NOCHAIN, "VREDMINU",  FuType::ALU,  h_reduce<OpMinu>},
+  {0x05, MVV,         F_NOCHAIN, "VREDMIN",   FuType::ALU,  h_reduce<OpMin>},
+  {0x06, MVV,         F_NOCHAIN, "VREDMAXU",  FuType::ALU,  h_reduce<OpMaxu>},
+  {0x07, MVV,         F_NOCHAIN, "VREDMAX",   FuType::ALU,  h_reduce<OpMax>},
+  {0x08, MVV|MVX,     0,         "VAADDU",    FuType::ALU,  h_binary<OpAaddu>},
+  {0x09, MVV|MVX,     0,         "VAADD",     FuType::ALU,  h_binary<OpAadd>},
+  {0x0a, MVV|MVX,     0,         "VASUBU",    FuType::ALU,  h_binary<OpAsubu>},
+  {0x0b, MVV|MVX,     0,         "VASUB",     FuType::ALU,  h_binary<OpAsub>},
+  {0x0e, MVX,         F_NOCHAIN, "VSLIDE1UP", FuType::ALU,  h_slide<true, true>},
+  {0x0f, MVX,         F_NOCHAIN, "VSLIDE1DOWN", FuType::ALU, h_slide<false, true>},
+  {0x10, MVV,         F_NOCHAIN, "VWXUNARY0", FuType::ALU,  h_wxunary0},
+  {0x10, MVX,         0,         "VMV.S.X",   FuType::ALU,  h_rxunary0},
+  {0x12, MVV,         0,         "VXUNARY0",  FuType::ALU,  h_extend},
+  {0x14, MVV,         0,         "VMUNARY0",  FuType::ALU,  h_munary0},
+  {0x17, MVV,         F_NOCHAIN, "VCOMPRESS", FuType::ALU,  h_compress},
+  {0x18, MVV,         0,         "VMANDN",    FuType::ALU,  h_mask_logical<OpMandn>},
+  {0x19, MVV,         0,         "VMAND",     FuType::ALU,  h_mask_logical<OpMand>},
+  {0x1a, MVV,         0,         "VMOR",      FuType::ALU,  h_mask_logical<OpMor>},
+  {0x1b, MVV,         0,         "VMXOR",     FuType::ALU,  h_mask_logical<OpMxor>},
+  {0x1c, MVV,         0,         "VMORN",     FuType::ALU,  h_mask_logical<OpMorn>},
+  {0x1d, MVV,         0,         "VMNAND",    FuType::ALU,  h_mask_logical<OpMnand>},
+  {0x1e, MVV,         0,         "VMNOR",     FuType::ALU,  h_mask_logical<OpMnor>},
+  {0x1f, MVV,         0,         "VMXNOR",    FuType::ALU,  h_mask_logical<OpMxnor>},
+  {0x20, MVV|MVX,     0,         "VDIVU",     FuType::IDIV, h_binary<OpDivu>},
+  {0x21, MVV|MVX,     0,         "VDIV",      FuType::IDIV, h_binary<OpDiv>},
+  {0x22, MVV|MVX,     0,         "VREMU",     FuType::IDIV, h_binary<OpRemu>},
+  {0x23, MVV|MVX,     0,         "VREM",      FuType::IDIV, h_binary<OpRem>},
+  {0x24, MVV|MVX,     0,         "VMULHU",    FuType::IMUL, h_binary<OpMulhu>},
+  {0x25, MVV|MVX,     0,         "VMUL",      FuType::IMUL, h_binary<OpMul>},
+  {0x26, MVV|MVX,     0,         "VMULHSU",   FuType::IMUL, h_binary<OpMulhsu>},
+  {0x27, MVV|MVX,     0,         "VMULH",     FuType::IMUL, h_binary<OpMulh>},
+  {0x29, MVV|MVX,     0,         "VMADD",     FuType::IMUL, h_muladd<OpMadd>},
+  {0x2b, MVV|MVX,     0,         "VNMSUB",    FuType::IMUL, h_muladd<OpNmsub>},
+  {0x2d, MVV|MVX,     0,         "VMACC",     FuType::IMUL, h_muladd<OpMacc>},
+  {0x2f, MVV|MVX,     0,         "VNMSAC",    FuType::IMUL, h_muladd<OpNmsac>},
+  {0x30, MVV|MVX,     0,         "VWADDU",    FuType::ALU,  h_widen<false, false, false, OpAdd>},
+  {0x31, MVV|MVX,     0,         "VWADD",     FuType::ALU,  h_widen<true, true, false, OpAdd>},
+  {0x32, MVV|MVX,     0,         "VWSUBU",    FuType::ALU,  h_widen<false, false, false, OpSub>},
+  {0x33, MVV|MVX,     0,         "VWSUB",     FuType::ALU,  h_widen<true, true, false, OpSub>},
+  {0x34, MVV|MVX,     0,         "VWADDU.W",  FuType::ALU,  h_widen<false, false, true, OpAdd>},
+  {0x35, MVV|MVX,     0,         "VWADD.W",   FuType::ALU,  h_widen<true, true, true, OpAdd>},
+  {0x36, MVV|MVX,     0,         "VWSUBU.W",  FuType::ALU,  h_widen<false, false, true, OpSub>},
+  {0x37, MVV|MVX,     0,         "VWSUB.W",   FuType::ALU,  h_widen<true, true, true, OpSub>},
+  {0x38, MVV|MVX,     0,         "VWMULU",    FuType::IMUL, h_widen<false, false, false, OpMul>},
+  {0x3a, MVV|MVX,     0,         "VWMULSU",   FuType::IMUL, h_widen<true, false, false, OpMul>},
+  {0x3b, MVV|MVX,     0,         "VWMUL",     FuType::IMUL, h_widen<true, true, false, OpMul>},
+  {0x3c, MVV|MVX,     0,         "VWMACCU",   FuType::IMUL, h_widen_macc<false, false>},
+  {0x3d, MVV|MVX,     0,         "VWMACC",    FuType::IMUL, h_widen_macc<true, true>},
+  {0x3e, MVX,         0,         "VWMACCUS",  FuType::IMUL, h_widen_macc<false, true>},
+  {0x3f, MVV|MVX,     0,         "VWMACCSU",  FuType::IMUL, h_widen_macc<true, false>},
+};
+
+const vop_t opf_ops[] = {
+  {0x00, FVV|FVF,     F_FP,      "VFADD",     FuType::FMA,  h_fbinary<FAdd>},
+  {0x01, FVV,         F_FP|F_NOCHAIN, "VFREDUSUM", FuType::FMA, h_freduce<FAdd>},
+  {0x02, FVV|FVF,     F_FP,      "VFSUB",     FuType::FMA,  h_fbinary<FSub>},
+  {0x03, FVV,         F_FP|F_NOCHAIN, "VFREDOSUM", FuType::FMA, h_freduce<FAdd>},
+  {0x04, FVV|FVF,     F_FP,      "VFMIN",     FuType::FNCP, h_fbinary<FMin>},
+  {0x05, FVV,         F_FP|F_NOCHAIN, "VFREDMIN", FuType::FNCP, h_freduce<FMin>},
+  {0x06, FVV|FVF,     F_FP,      "VFMAX",     FuType::FNCP, h_fbinary<FMax>},
+  {0x07, FVV,         F_FP|F_NOCHAIN, "VFREDMAX", FuType::FNCP, h_freduce<FMax>},
+  {0x08, FVV|FVF,     F_FP,      "VFSGNJ",    FuType::FNCP, h_fbinary<FSgnj>},
+  {0x09, FVV|FVF,     F_FP,      "VFSGNJN",   FuType::FNCP, h_fbinary<FSgnjn>},
+  {0x0a, FVV|FVF,     F_FP,      "VFSGNJX",   FuType::FNCP, h_fbinary<FSgnjx>},
+  {0x0e, FVF,         F_FP|F_NOCHAIN, "VFSLIDE1UP", FuType::FNCP, h_fslide1<true>},
+  {0x0f, FVF,         F_FP|F_NOCHAIN, "VFSLIDE1DOWN", FuType::FNCP, h_fslide1<false>},
+  {0x10, FVV,         F_FP|F_NOCHAIN, "VFMV.F.S", FuType::FNCP, h_wfunary0},
+  {0x10, FVF,         F_FP,      "VFMV.S.F",  FuType::FNCP, h_rfunary0},
+  {0x12, FVV,         0,         "VFUNARY0",  FuType::FCVT, h_funary0},
+  {0x13, FVV,         F_FP,      "VFUNARY1",  FuType::FSQRT, h_funary1},
+  {0x17, FVF,         F_FP,      "VFMERGE",   FuType::FNCP, h_merge},
+  {0x18, FVV|FVF,     F_FP,      "VMFEQ",     FuType::FNCP, h_fcompare<FEq>},
+  {0x19, FVV|FVF,     F_FP,      "VMFLE",     FuType::FNCP, h_fcompare<FLe>},
+  {0x1b, FVV|FVF,     F_FP,      "VMFLT",     FuType::FNCP, h_fcompare<FLt>},
+  {0x1c, FVV|FVF,     F_FP,      "VMFNE",     FuType::FNCP, h_fcompare<FNe>},
+  {0x1d, FVF,         F_FP,      "VMFGT",     FuType::FNCP, h_fcompare<FGt>},
+  {0x1f, FVF,         F_FP,      "VMFGE",     FuType::FNCP, h_fcompare<FGe>},
+  {0x20, FVV|FVF,     F_FP,      "VFDIV",     FuType::FDIV, h_fbinary<FDiv>},
+  {0x21, FVF,         F_FP,      "VFRDIV",    FuType::FDIV, h_fbinary<FRDiv>},
+  {0x24, FVV|FVF,     F_FP,      "VFMUL",     FuType::FMA,  h_fbinary<FMul>},
+  {0x27, FVF,         F_FP,      "VFRSUB",    FuType::FMA,  h_fbinary<FRSub>},
+  {0x28, FVV|FVF,     F_FP,      "VFMADD",    FuType::FMA,  h_fmuladd<FMadd>},
+  {0x29, FVV|FVF,     F_FP,      "VFNMADD",   FuType::FMA,  h_fmuladd<FNmadd>},
+  {0x2a, FVV|FVF,     F_FP,      "VFMSUB",    FuType::FMA,  h_fmuladd<FMsub>},
+  {0x2b, FVV|FVF,     F_FP,      "VFNMSUB",   FuType::FMA,  h_fmuladd<FNmsub>},
+  {0x2c, FVV|FVF,     F_FP,      "VFMACC",    FuType::FMA,  h_fmuladd<FMacc>},
+  {0x2d, FVV|FVF,     F_FP,      "VFNMACC",   FuType::FMA,  h_fmuladd<FNmacc>},
+  {0x2e, FVV|FVF,     F_FP,      "VFMSAC",    FuType::FMA,  h_fmuladd<FMsac>},
+  {0x2f, FVV|FVF,     F_FP,      "VFNMSAC",   FuType::FMA,  h_fmuladd<FNmsac>},
+  {0x30, FVV|FVF,     F_FP,      "VFWADD",    FuType::FMA,  h_fwiden<false, FAdd>},
+  {0x31, FVV,         F_FP|F_NOCHAIN, "VFWREDUSUM", FuType::FMA, h_fwreduce},
+  {0x32, FVV|FVF,     F_FP,      "VFWSUB",    FuType::FMA,  h_fwiden<false, FSub>},
+  {0x33, FVV,         F_FP|F_NOCHAIN, "VFWREDOSUM", FuType::FMA, h_fwreduce},
+  {0x34, FVV|FVF,     F_FP,      "VFWADD.W",  FuType::FMA,  h_fwiden<true, FAdd>},
+  {0x36, FVV|FVF,     F_FP,      "VFWSUB.W",  FuType::FMA,  h_fwiden<true, FSub>},
+  {0x38, FVV|FVF,     F_FP,      "VFWMUL",    FuType::FMA,  h_fwiden<false, FMul>},
+  {0x3c, FVV|FVF,     F_FP,      "VFWMACC",   FuType::FMA,  h_fwiden_macc<FMacc>},
+  {0x3d, FVV|FVF,     F_FP,      "VFWNMACC",  FuType::FMA,  h_fwiden_macc<FNmacc>},
+  {0x3e, FVV|FVF,     F_FP,      "VFWMSAC",   FuType::FMA,  h_fwiden_macc<FMsac>},
+  {0x3f, FVV|FVF,     F_FP,      "VFWNMSAC",  FuType::FMA,  h_fwiden_macc<FNmsac>},
+};
+
+// the operation of an OP-V encoding, or null if reserved
+const vop_t* find_op(uint32_t funct3, uint32_t funct6) {
+  // [funct3][funct6], built on first use
+  static const std::array<std::array<const vop_t*, 64>, 7> table = [] {
+    std::array<std::array<const vop_t*, 64>, 7> t{};
+    auto add = [&](const vop_t* ops, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        for (uint32_t f3 = 0; f3 < 7; ++f3) {
+          if (ops[i].forms & (1 << f3)) {
+            assert(nullptr == t[f3][ops[i].funct6]);
+            t[f3][ops[i].funct6] = &ops[i];
+          }
+        }
+      }
+    };
+    add(opi_ops, sizeof(opi_ops) / sizeof(opi_ops[0]));
+    add(opm_ops, sizeof(opm_ops) / sizeof(opm_ops[0]));
+    add(opf_ops, sizeof(opf_ops) / sizeof(opf_ops[0]));
+    return t;
+  }();
+  if (funct3 >= 7)
+    return nullptr;
+  return table[funct3][funct6];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// configuration and memory instructions
+
+bool exec_vsetvl(Ctx& c) {
+  auto& instr = c.instr;
+  uint32_t kind = instr.getFunc2(); // bits [31:30]
+  uint64_t vtype;
+  uint64_t avl;
+  uint32_t rs1 = instr.getRSrc(0);
+  if (3 == kind) {
+    // vsetivli
+    vtype = instr.getImm();
+    avl = rs1;
+  } else {
+    // vsetvli, vsetvl
+    vtype = (kind & 0x2) ? c.res.scalar : instr.getImm();
+    if (rs1 != 0) {
+      avl = Word(c.scalar);
+    } else if (instr.getRDest() != 0) {
+      avl = ~uint64_t(0);
+    } else {
+      avl = c.st.vl;
+    }
+  }
+  c.res.scalar = 0;
+
+  uint32_t vsew = (vtype >> 3) & 0x7;
+  uint32_t vlmul = vtype & 0x7;
+  int lmul = (vlmul < 4) ? int(vlmul) : int(vlmul) - 8;
+  bool vill = (vtype >> 8) != 0 || vsew > 3 || 4 == vlmul || lmul < int(vsew) - 3;
+  if (vill) {
+    c.st.vtype = VILL;
+    c.st.vl = 0;
+  } else {
+    c.st.vtype = uint32_t(vtype);
+    c.load_vtype();
+    c.st.vl = uint32_t(std::min<uint64_t>(avl, c.vlmax));
+  }
+  c.st.vstart = 0;
+  c.res.scalar = c.st.vl;
+  c.res.scalar_wb = true;
+  c.res.elements = 0;
+  return true;
+}
+
+uint32_t width_to_eew(uint32_t width) {
+  switch (width) {
+  case 0: return 8;
+  case 5: return 16;
+  case 6: return 32;
+  case 7: return 64;
+  default: return 0;
+  }
+}
+
+bool exec_memory(Ctx& c, bool is_store) {
+  auto& instr = c.instr;
+  uint32_t eew   = width_to_eew(instr.getVlsWidth());
+  uint32_t mop   = instr.getVmop();
+  uint32_t nf    = instr.getvNf() + 1;
+  uint32_t umop  = instr.getRSrc(1);
+  uint32_t vd    = is_store ? instr.getVs3() : instr.getRDest();
+  uint64_t base  = Word(c.scalar);
+  if (0 == eew || mop > 3 || !c.mem)
+    return false;
+
+  c.res.is_load  = !is_store;
+  c.res.is_store = is_store;
+  c.res.chainable = false;
+  c.res.fu_type = FuType::ALU;
+
+  auto access = [&](uint64_t addr, Byte* data, uint32_t size) {
+    addr = Word(addr);
+    if (is_store) {
+      c.mem->write(data, addr, size);
+    } else {
+      c.mem->read(data, addr, size);
+    }
+    c.res.mem_addrs.push_back({addr, size});
+  };
+
+  if (0 == mop && 0x08 == umop) {
+    // whole register: vl<nf>re<eew>.v, vs<nf>r.v
+    if (!c.vm || (nf != 1 && nf != 2 && nf != 4 && nf != 8) || (is_store && eew != 8))
+      return false;
+    if (is_store ? !c.src_regs(vd, nf) : !c.check_group(vd, nf))
+      return false;
+    uint32_t eew_bytes = eew / 8;
+    uint32_t evl = nf * c.vlenb / eew_bytes;
+    if (is_store) {
+      for (uint32_t i = c.vstart; i < evl; ++i) {
+        access(base + i * eew_bytes, &c.st.vregs[vd * c.vlenb + i * eew_bytes], eew_bytes);
+      }
+    } else {
+      Dest d(c, vd, nf);
+      for (uint32_t i = c.vstart; i < evl; ++i) {
+        Byte data[8];
+        access(base + i * eew_bytes, data, eew_bytes);
+        for (uint32_t b = 0; b < eew_bytes; ++b) {
+          d.set<uint8_t>(i * eew_bytes + b, data[b]);
+        }
+      }
+      d.commit();
+    }
+    c.res.elements = evl;
+    return true;
+  }
+
+  if (!c.load_vtype())
+    return false;
+
+  if (0 == mop && 0x0b == umop) {
+    // vlm.v, vsm.v
+    if (!c.vm || eew != 8 || nf != 1)
+      return false;
+    uint32_t evl = (c.vl + 7) / 8;
+    if (is_store) {
+      if (!c.src_regs(vd, 1))
+        return false;
+      for (uint32_t i = c.vstart; i < evl; ++i) {
+        access(base + i, &c.st.vregs[vd * c.vlenb + i], 1);
+      }
+    } else {
+      if (!c.check_group(vd, 1))
+        return false;
+      Dest d(c, vd, 1);
+      for (uint32_t i = c.vstart; i < evl; ++i) {
+        Byte data;
+        access(base + i, &data, 1);
+        d.set<uint8_t>(i, data);
+      }
+      if (c.vta) {
+        for (uint32_t i = evl; i < c.vlenb; ++i) {
+          d.set<uint8_t>(i, 0xff);
+        }
+      }
+      d.commit();
+    }
+    c.res.elements = evl;
+    return true;
+  }
+
+  if (0 == mop && umop != 0x00 && umop != 0x10)
+    return false; // fault-only-first loads never fault here
+
+  // data and index element widths
+  bool indexed = (mop & 0x1);
+  uint32_t data_eew = indexed ? c.sew : eew;
+  uint32_t data_regs = c.group_size(data_eew);
+  if (0 == data_regs || nf * data_regs > 8 || (vd + nf * data_regs) > 32 || 0 != (vd % data_regs))
+    return false;
+  if (!c.vm && 0 == vd && !is_store)
+    return false;
+  if (indexed && !c.src(c.vs2, eew))
+    return false;
+  uint32_t data_bytes = data_eew / 8;
+  int64_t stride = (2 == mop) ? int64_t(c.res.scalar) : int64_t(nf * data_bytes);
+
+  auto elem_addr = [&](uint32_t i, uint32_t f) -> uint64_t {
+    uint64_t offset;
+    if (indexed) {
+      switch (eew) {
+      case 8:  offset = c.get<uint8_t>(c.vs2, i); break;
+      case 16: offset = c.get<uint16_t>(c.vs2, i); break;
+      case 32: offset = c.get<uint32_t>(c.vs2, i); break;
+      default: offset = c.get<uint64_t>(c.vs2, i); break;
+      }
+    } else {
+      offset = uint64_t(stride) * i;
+    }
+    return base + offset + f * data_bytes;
+  };
+
+  if (is_store) {
+    for (uint32_t f = 0; f < nf; ++f) {
+      c.src_regs(vd + f * data_regs, data_regs);
+    }
+    for (uint32_t i = c.vstart; i < c.vl; ++i) {
+      if (!c.active(i))
+        continue;
+      for (uint32_t f = 0; f < nf; ++f) {
+        uint32_t reg = vd + f * data_regs;
+        access(elem_addr(i, f), &c.st.vregs[reg * c.vlenb + i * data_bytes], data_bytes);
+      }
+    }
+  } else {
+    for (uint32_t f = 0; f < nf; ++f) {
+      Dest d(c, vd + f * data_regs, data_regs);
+      by_sew(data_eew, [&](auto t) {
+        typedef decltype(t) T;
+        for_each<T>(c, d, [&](uint32_t i) {
+          T value;
+          access(elem_addr(i, f), reinterpret_cast<Byte*>(&value), data_bytes);
+          d.set<T>(i, value);
+        });
+        return true;
+      });
+      d.commit();
+    }
+  }
+  c.res.elements = (c.vl > c.vstart) ? (c.vl - c.vstart) * nf : 0;
+  return true;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VecState::reset() {
+  std::fill(vregs.begin(), vregs.end(), 0);
+  vl = 0;
+  vtype = VILL;
+  vstart = 0;
+  vxrm = 0;
+  vxsat = 0;
+}
+
+VecExec::VecExec(uint32_t vlen)
+  : vlen_(vlen)
+  , vlenb_(vlen / 8)
+{}
+
+bool VecExec::execute(const Instr& instr,
+                      VecState* state,
+                      uint64_t rs1,
+                      uint64_t rs2,
+                      uint32_t frm,
+                      uint32_t* fflags,
+                      VecMem* mem,
+                      VecResult* result) const {
+  *result = VecResult();
+  Ctx c(instr, *state, *result, mem, vlen_);
+  c.frm = frm;
+  c.vm  = instr.getVmask() != 0;
+  c.vd  = instr.getRDest();
+  c.vs1 = instr.getRSrc(0);
+  c.vs2 = instr.getRSrc(1);
+  c.scalar = rs1;
+  // the second scalar operand (vsetvl vtype, strided load stride) is passed in the result
+  result->scalar = rs2;
+
+  bool ok = false;
+  auto opcode = instr.getOpcode();
+  if (opcode == Opcode::FL || opcode == Opcode::FS) {
+    if (!c.vm) {
+      result->vregs_read.set(0);
+    }
+    ok = exec_memory(c, opcode == Opcode::FS);
+    result->scalar = 0;
+  } else if (instr.getFunc3() == OPCFG) {
+    ok = exec_vsetvl(c);
+  } else {
+    result->scalar = 0;
+    c.funct3 = instr.getFunc3();
+    c.funct6 = instr.getFunc6();
+    c.vv = (c.funct3 == OPIVV || c.funct3 == OPMVV || c.funct3 == OPFVV);
+    auto op = find_op(c.funct3, c.funct6);
+    if (nullptr == op)
+      return false;
+    bool has_vtype = c.load_vtype();
+    if (!has_vtype && !(op->flags & F_ANYVTYPE))
+      return false;
+    if ((op->flags & F_FP) && c.sew != 32 && c.sew != 64)
+      return false;
+    switch (c.funct3) {
+    case OPIVI:
+      c.scalar = (op->flags & F_UIMM) ? (c.vs1 & 0x1f) : uint64_t(int64_t(sext(c.vs1, 5)));
+      break;
+    case OPFVF:
+      if (32 == c.sew && (rs1 >> 32) != 0xffffffff) {
+        c.scalar = 0x7fc00000; // not NaN-boxed
+      }
+      break;
+    default:
+      break;
+    }
+    result->fu_type = op->fu_type;
+    result->chainable = !(op->flags & F_NOCHAIN);
+    result->elements = (c.vl > c.vstart) ? (c.vl - c.vstart) : 0;
+    if (!c.vm) {
+      result->vregs_read.set(0);
+    }
+    ok = op->handler(c);
+  }
+  if (!ok)
+    return false;
+
+  state->vstart = 0;
+  *fflags = c.fflags;
+  return true;
+}
+
+const char* VecExec::op_name(const Instr& instr) {
+  auto opcode = instr.getOpcode();
+  if (opcode == Opcode::FL || opcode == Opcode::FS) {
+    bool is_store = (opcode == Opcode::FS);
+    switch (instr.getVmop()) {
+    case 0:
+      switch (instr.getRSrc(1)) {
+      case 0x08: return is_store ? "VSR" : "VLRE";
+      case 0x0b: return is_store ? "VSM" : "VLM";
+      case 0x10: return "VLEFF";
+      default:   return is_store ? "VSE" : "VLE";
+      }
+    case 1: return is_store ? "VSUXEI" : "VLUXEI";
+    case 2: return is_store ? "VSSE" : "VLSE";
+    default: return is_store ? "VSOXEI" : "VLOXEI";
+    }
+  }
+  if (instr.getFunc3() == OPCFG) {
+    switch (instr.getFunc2()) {
+    case 2:  return "VSETVL";
+    case 3:  return "VSETIVLI";
+    default: return "VSETVLI";
+    }
+  }
+  auto op = find_op(instr.getFunc3(), instr.getFunc6());
+  return op ? op->name : "VUNKNOWN";
+}
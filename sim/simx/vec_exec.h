@@ -0,0 +1,106 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "types.h"
+
+namespace vortex {
+
+class Instr;
+
+// memory accessed by the vector loads and stores
+class VecMem {
+public:
+  virtual ~VecMem() {}
+  virtual void read(void* data, uint64_t addr, uint32_t size) = 0;
+  virtual void write(const void* data, uint64_t addr, uint32_t size) = 0;
+};
+
+// RVV state of a thread: the vector register file and the vector CSRs
+struct VecState {
+  std::vector<Byte> vregs; // 32 registers of VLENB bytes
+  uint32_t vl;
+  uint32_t vtype;  // vill is kept in bit 31
+  uint32_t vstart;
+  uint32_t vxrm;
+  uint32_t vxsat;
+
+  VecState(uint32_t vlenb) : vregs(32 * vlenb) {
+    this->reset();
+  }
+
+  void reset();
+};
+
+// what a vector instruction did on one thread, for the timing model
+struct VecResult {
+  FuType   fu_type;       // vector unit pipe
+  uint32_t elements;      // elements processed
+  bool     chainable;     // reads its sources in element order
+  RegMask  vregs_read;
+  RegMask  vregs_written;
+  bool     scalar_wb;     // writes the scalar destination register
+  uint64_t scalar;
+  bool     is_load;
+  bool     is_store;
+  std::vector<mem_addr_size_t> mem_addrs; // in element order
+
+  VecResult()
+    : fu_type(FuType::ALU)
+    , elements(0)
+    , chainable(true)
+    , scalar_wb(false)
+    , scalar(0)
+    , is_load(false)
+    , is_store(false)
+  {}
+};
+
+// Functional model of the RVV 1.0 instructions (Zve64d, VLEN set at runtime,
+// ELEN=64): vsetvl*, integer, fixed-point, floating-point, mask, permutation,
+// reduction and unit-stride/strided/indexed/segment/whole-register memory
+// instructions, with LMUL register groups and the vta/vma policies (agnostic
+// elements are filled with ones). Each thread of a warp is a vector hart.
+// Not supported: FP16 elements, vfrec7/vfrsqrt7 and vfncvt.rod.
+class VecExec {
+public:
+  VecExec(uint32_t vlen);
+
+  uint32_t vlenb() const {
+    return vlenb_;
+  }
+
+  // executes the instruction on a thread; rs1 and rs2 are the values of the
+  // scalar sources (x registers sign-extended, f registers as stored), frm is
+  // the dynamic rounding mode and fflags returns the exception flags. Returns
+  // false for reserved encodings and illegal vtype, register group or
+  // element width combinations.
+  bool execute(const Instr& instr,
+               VecState* state,
+               uint64_t rs1,
+               uint64_t rs2,
+               uint32_t frm,
+               uint32_t* fflags,
+               VecMem* mem,
+               VecResult* result) const;
+
+  static const char* op_name(const Instr& instr);
+
+private:
+  uint32_t vlen_;
+  uint32_t vlenb_;
+};
+
+}
@@ -20,6 +20,8 @@
 
 #include "instr.h"
 #include "core.h"
+#include "profiler.h"
+#include "reuse_profiler.h"
 
 using namespace vortex;
 
@@ -29,7 +31,8 @@ Warp::Warp(Core *core, uint32_t warp_id)
     , core_(core)
     , ireg_file_(core->arch().num_threads(), std::vector<Word>(core->arch().num_regs()))
     , freg_file_(core->arch().num_threads(), std::vector<uint64_t>(core->arch().num_regs()))
-    , vreg_file_(core->arch().num_threads(), std::vector<Byte>(core->arch().vsize()))
+    , vec_states_(core->arch().num_threads(), VecState(core->arch().vlen() / 8))
+    , vec_exec_(core->arch().vlen())
 {
   this->reset();
 }
@@ -48,25 +51,68 @@ void Warp::reset() {
     for (auto& reg : freg_file_.at(i)) {
       reg = 0;
     }
-    for (auto& reg : vreg_file_.at(i)) {
-      reg = 0;
-    }
+    vec_states_.at(i).reset();
   }
   uui_gen_.reset();
 }
 
+void Warp::save(Checkpoint::warp_t* state) const {
+  state->pc = PC_;
+  state->tmask = tmask_.to_ulong();
+  for (uint32_t t = 0, nt = arch_.num_threads(); t < nt; ++t) {
+    for (uint32_t r = 0; r < Checkpoint::NUM_REGS; ++r) {
+      state->iregs.at(t * Checkpoint::NUM_REGS + r) = ireg_file_.at(t).at(r);
+      state->fregs.at(t * Checkpoint::NUM_REGS + r) = freg_file_.at(t).at(r);
+    }
+  }
+}
+
+uint32_t Warp::get_vcsr(uint32_t addr, uint32_t tid) const {
+  auto& state = vec_states_.at(tid);
+  switch (addr) {
+  case VX_CSR_VSTART: return state.vstart;
+  case VX_CSR_VXSAT:  return state.vxsat;
+  case VX_CSR_VXRM:   return state.vxrm;
+  case VX_CSR_VCSR:   return (state.vxrm << 1) | state.vxsat;
+  case VX_CSR_VL:     return state.vl;
+  case VX_CSR_VTYPE:  return state.vtype;
+  case VX_CSR_VLENB:  return vec_exec_.vlenb();
+  default:
+    std::abort();
+  }
+}
+
+void Warp::set_vcsr(uint32_t addr, uint32_t value, uint32_t tid) {
+  auto& state = vec_states_.at(tid);
+  switch (addr) {
+  case VX_CSR_VSTART: state.vstart = value; break;
+  case VX_CSR_VXSAT:  state.vxsat = value & 0x1; break;
+  case VX_CSR_VXRM:   state.vxrm = value & 0x3; break;
+  case VX_CSR_VCSR:
+    state.vxsat = value & 0x1;
+    state.vxrm = (value >> 1) & 0x3;
+    break;
+  default:
+    // vl, vtype and vlenb are read-only
+    std::abort();
+  }
+}
+
 pipeline_trace_t* Warp::eval() {
   assert(tmask_.any());
 
-#ifndef NDEBUG
-  uint32_t instr_uuid = uui_gen_.get_uuid(PC_);
-  uint32_t g_wid = core_->id() * arch_.num_warps() + warp_id_;
-  uint32_t instr_id  = instr_uuid & 0xffff;
-  uint32_t instr_ref = instr_uuid >> 16;
-  uint64_t uuid = (uint64_t(instr_ref) << 32) | (g_wid << 16) | instr_id;
-#else
   uint64_t uuid = 0;
+#ifdef NDEBUG
+  // release builds only tag instructions when profiling or tracing
+  if (core_->profiler_ || core_->tracer_)
 #endif
+  {
+    uint32_t instr_uuid = uui_gen_.get_uuid(PC_);
+    uint32_t g_wid = core_->id() * arch_.num_warps() + warp_id_;
+    uint32_t instr_id  = instr_uuid & 0xffff;
+    uint32_t instr_ref = instr_uuid >> 16;
+    uuid = (uint64_t(instr_ref) << 32) | (g_wid << 16) | instr_id;
+  }
   
   DPH(1, "Fetch: cid=" << core_->id() << ", wid=" << warp_id_ << ", tmask=");
   for (uint32_t i = 0, n = arch_.num_threads(); i < n; ++i)
@@ -94,10 +140,52 @@ pipeline_trace_t* Warp::eval() {
   trace->tmask = tmask_;
   trace->rdest = instr->getRDest();
   trace->rdest_type = instr->getRDType();
+
+  if (core_->profiler_) {
+    core_->profiler_->fetch(trace);
+  }
     
   // Execute
   this->execute(*instr, trace);
 
+  if (core_->reuse_profiler_
+   && trace->exe_type == ExeType::LSU
+   && trace->lsu_type != LsuType::FENCE) {
+    auto trace_data = std::dynamic_pointer_cast<LsuTraceData>(trace->data);
+    uint64_t addrs[MAX_NUM_THREADS];
+    if (!trace_data->vec_addrs.empty()) {
+      // vector accesses: one warp access per round of thread requests
+      for (uint32_t i = 0; ; ++i) {
+        uint32_t count = 0;
+        bool pending = false;
+        for (uint32_t t = 0, nt = arch_.num_threads(); t < nt; ++t) {
+          auto& thread_addrs = trace_data->vec_addrs.at(t);
+          if (!trace->tmask.test(t) || i >= thread_addrs.size())
+            continue;
+          pending = true;
+          auto addr = thread_addrs.at(i).addr;
+          if (core_->get_addr_type(addr) == AddrType::Global) {
+            addrs[count++] = addr;
+          }
+        }
+        if (!pending)
+          break;
+        core_->reuse_profiler_->access(addrs, count);
+      }
+    } else {
+      uint32_t count = 0;
+      for (uint32_t t = 0, nt = arch_.num_threads(); t < nt; ++t) {
+        if (!trace->tmask.test(t))
+          continue;
+        auto addr = trace_data->mem_addrs.at(t).addr;
+        if (core_->get_addr_type(addr) == AddrType::Global) {
+          addrs[count++] = addr;
+        }
+      }
+      core_->reuse_profiler_->access(addrs, count);
+    }
+  }
+
   DP(5, "Register state:");
   for (uint32_t i = 0; i < arch_.num_regs(); ++i) {
     DPN(5, "  %r" << std::setfill('0') << std::setw(2) << std::dec << i << ':');
@@ -16,7 +16,9 @@
 
 #include <vector>
 #include <stack>
+#include <checkpoint.h>
 #include "types.h"
+#include "vec_exec.h"
 
 namespace vortex {
 
@@ -42,13 +44,6 @@ struct DomStackEntry {
   bool fallthrough;
 };
 
-struct vtype {
-  uint32_t vill;
-  uint32_t vediv;
-  uint32_t vsew;
-  uint32_t vlmul;
-};
-
 class Warp {
 public:
   Warp(Core *core, uint32_t warp_id);
@@ -75,10 +70,27 @@ public:
     return tmask_.to_ulong();
   }
 
+  uint32_t getActiveThreads() const {
+    return tmask_.count();
+  }
+
   Word getIRegValue(uint32_t reg) const {
     return ireg_file_.at(0).at(reg);
   }
 
+  // all threads have reconverged
+  bool converged() const {
+    return ipdom_stack_.empty();
+  }
+
+  // copy the PC, thread mask and register files into a checkpoint
+  void save(Checkpoint::warp_t* state) const;
+
+  // vector CSRs of a thread
+  uint32_t get_vcsr(uint32_t addr, uint32_t tid) const;
+
+  void set_vcsr(uint32_t addr, uint32_t value, uint32_t tid);
+
   uint64_t incr_instrs() {
     return issued_instrs_++;
   }
@@ -89,6 +101,8 @@ private:
 
   void execute(const Instr &instr, pipeline_trace_t *trace);
 
+  void execute_vector(const Instr &instr, pipeline_trace_t *trace);
+
   UUIDGenerator uui_gen_;
   
   uint32_t warp_id_;
@@ -101,11 +115,10 @@ private:
 
   std::vector<std::vector<Word>>     ireg_file_;
   std::vector<std::vector<uint64_t>> freg_file_;
-  std::vector<std::vector<Byte>>     vreg_file_;
+  std::vector<VecState>              vec_states_;
   std::stack<DomStackEntry>          ipdom_stack_;
 
-  struct vtype vtype_;
-  uint32_t vl_;
+  VecExec vec_exec_;
 };
 
 }
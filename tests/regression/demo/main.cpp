@@ -19,19 +19,24 @@
 
 const char* kernel_file = "kernel.bin";
 uint32_t count = 0;
+uint32_t repeat = 1;
+bool zero_copy = false;
 
 vx_device_h device = nullptr;
+vx_kernel_h kernel = nullptr;
 std::vector<uint8_t> staging_buf;
+uint8_t* staging_ptr = nullptr;
+uint8_t* pinned_buf = nullptr;
 kernel_arg_t kernel_arg = {};
 
 static void show_usage() {
    std::cout << "Vortex Test." << std::endl;
-   std::cout << "Usage: [-k: kernel] [-n words] [-h: help]" << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n words] [-r relaunches] [-z: zero-copy] [-h: help]" << std::endl;
 }
 
 static void parse_args(int argc, char **argv) {
   int c;
-  while ((c = getopt(argc, argv, "n:k:h?")) != -1) {
+  while ((c = getopt(argc, argv, "n:k:r:zh?")) != -1) {
     switch (c) {
     case 'n':
       count = atoi(optarg);
@@ -39,6 +44,12 @@ static void parse_args(int argc, char **argv) {
     case 'k':
       kernel_file = optarg;
       break;
+    case 'r':
+      repeat = atoi(optarg);
+      break;
+    case 'z':
+      zero_copy = true;
+      break;
     case 'h':
     case '?': {
       show_usage();
@@ -56,8 +67,17 @@ void cleanup() {
     vx_mem_free(device, kernel_arg.src0_addr);
     vx_mem_free(device, kernel_arg.src1_addr);
     vx_mem_free(device, kernel_arg.dst_addr);
+    if (pinned_buf) {
+      vx_mem_unpin(device, pinned_buf);
+    }
+    if (kernel) {
+      vx_kernel_release(device, kernel);
+    }
     vx_dev_close(device);
   }
+  if (pinned_buf) {
+    free(pinned_buf);
+  }
 }
 
 int run_test(const kernel_arg_t& kernel_arg,
@@ -73,13 +93,13 @@ int run_test(const kernel_arg_t& kernel_arg,
 
   // download destination buffer
   std::cout << "download destination buffer" << std::endl;
-  RT_CHECK(vx_copy_from_dev(device, staging_buf.data(), kernel_arg.dst_addr, buf_size));
+  RT_CHECK(vx_copy_from_dev(device, staging_ptr, kernel_arg.dst_addr, buf_size));
 
   // verify result
   std::cout << "verify result" << std::endl;  
   {
     int errors = 0;
-    auto buf_ptr = (int32_t*)staging_buf.data();
+    auto buf_ptr = (int32_t*)staging_ptr;
     for (uint32_t i = 0; i < num_points; ++i) {
       int ref = i + i; 
       int cur = buf_ptr[i];
@@ -125,7 +145,9 @@ int main(int argc, char *argv[]) {
 
   // upload program
   std::cout << "upload program" << std::endl;  
-  RT_CHECK(vx_upload_kernel_file(device, kernel_file));
+  uint64_t kernel_base_addr;
+  RT_CHECK(vx_dev_caps(device, VX_CAPS_KERNEL_BASE_ADDR, &kernel_base_addr));
+  RT_CHECK(vx_kernel_register_file(device, kernel_file, kernel_base_addr, &kernel));
 
   // allocate device memory
   std::cout << "allocate device memory" << std::endl;
@@ -143,49 +165,65 @@ int main(int argc, char *argv[]) {
   // allocate staging buffer  
   std::cout << "allocate staging buffer" << std::endl;    
   uint32_t alloc_size = std::max<uint32_t>(buf_size, sizeof(kernel_arg_t));
-  staging_buf.resize(alloc_size);
+  if (zero_copy) {
+    // pinned buffers must be page-aligned
+    alloc_size = (alloc_size + 4095) & ~4095;
+    if (posix_memalign((void**)&pinned_buf, 4096, alloc_size) != 0) {
+      std::cout << "Error: out of host memory!" << std::endl;
+      cleanup();
+      return -1;
+    }
+    RT_CHECK(vx_mem_pin(device, pinned_buf, alloc_size));
+    staging_ptr = pinned_buf;
+  } else {
+    staging_buf.resize(alloc_size);
+    staging_ptr = staging_buf.data();
+  }
   
   // upload kernel argument
   std::cout << "upload kernel argument" << std::endl;
   {
-    auto buf_ptr = (int*)staging_buf.data();
+    auto buf_ptr = (int*)staging_ptr;
     memcpy(buf_ptr, &kernel_arg, sizeof(kernel_arg_t));
-    RT_CHECK(vx_copy_to_dev(device, KERNEL_ARG_DEV_MEM_ADDR, staging_buf.data(), sizeof(kernel_arg_t)));
+    RT_CHECK(vx_copy_to_dev(device, KERNEL_ARG_DEV_MEM_ADDR, staging_ptr, sizeof(kernel_arg_t)));
   }
 
   // upload source buffer0
   {
     std::cout << "upload source buffer0" << std::endl;
-    auto buf_ptr = (int32_t*)staging_buf.data();
+    auto buf_ptr = (int32_t*)staging_ptr;
     for (uint32_t i = 0; i < num_points; ++i) {
       buf_ptr[i] = i-1;
     }
-    RT_CHECK(vx_copy_to_dev(device, kernel_arg.src0_addr, staging_buf.data(), buf_size));
+    RT_CHECK(vx_copy_to_dev(device, kernel_arg.src0_addr, staging_ptr, buf_size));
   }
 
   // upload source buffer1
   {
     std::cout << "upload source buffer1" << std::endl;
-    auto buf_ptr = (int32_t*)staging_buf.data();
+    auto buf_ptr = (int32_t*)staging_ptr;
     for (uint32_t i = 0; i < num_points; ++i) {
       buf_ptr[i] = i+1;
     }   
-    RT_CHECK(vx_copy_to_dev(device, kernel_arg.src1_addr, staging_buf.data(), buf_size));
+    RT_CHECK(vx_copy_to_dev(device, kernel_arg.src1_addr, staging_ptr, buf_size));
   }
 
   // clear destination buffer
   {
     std::cout << "clear destination buffer" << std::endl;      
-    auto buf_ptr = (int32_t*)staging_buf.data();
+    auto buf_ptr = (int32_t*)staging_ptr;
     for (uint32_t i = 0; i < num_points; ++i) {
       buf_ptr[i] = 0xdeadbeef;
     }  
-    RT_CHECK(vx_copy_to_dev(device, kernel_arg.dst_addr, staging_buf.data(), buf_size));  
+    RT_CHECK(vx_copy_to_dev(device, kernel_arg.dst_addr, staging_ptr, buf_size));  
   }
 
-  // run tests
-  std::cout << "run tests" << std::endl;
-  RT_CHECK(run_test(kernel_arg, buf_size, num_points));
+  // run tests, relaunching the registered kernel by handle
+  for (uint32_t i = 0; i < repeat; ++i) {
+    std::cout << "run tests" << std::endl;
+    RT_CHECK(vx_kernel_select(device, kernel));
+    RT_CHECK(run_test(kernel_arg, buf_size, num_points));
+  }
 
   // cleanup
   std::cout << "cleanup" << std::endl;  
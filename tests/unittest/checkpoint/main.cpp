@@ -0,0 +1,138 @@
+#include <checkpoint.h>
+#include <mem.h>
+#include <stdio.h>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed!\n", #_expr);                   \
+     return -1;                                                 \
+   } while (false)
+
+using namespace vortex;
+
+static const char* CKPT_FILE = "test.ckpt";
+static const uint32_t PAGE_SIZE = 4096;
+
+// writes a copy of the checkpoint file with one 32-bit field replaced
+static void patch_header(const char* filename, uint32_t offset, uint32_t value) {
+  std::ifstream ifs(CKPT_FILE, std::ios::binary);
+  std::vector<char> content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  memcpy(content.data() + offset, &value, sizeof(uint32_t));
+  std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+  ofs.write(content.data(), content.size());
+}
+
+int main() {
+  const uint32_t num_cores = 2, num_warps = 4, num_threads = 4;
+
+  // sparse memory image spanning several pages, including a partial one
+  RAM ram(PAGE_SIZE);
+  std::vector<uint8_t> data(3 * PAGE_SIZE + 100);
+  for (uint32_t i = 0; i < data.size(); ++i) {
+    data[i] = uint8_t(i * 7 + 3);
+  }
+  ram.write(data.data(), 0x80000000, data.size());
+  uint64_t word = 0x0123456789abcdefull;
+  ram.write(&word, 0x10, sizeof(word));
+
+  Checkpoint checkpoint(64, num_cores, num_warps, num_threads);
+  checkpoint.dcrs().emplace_back(1, 0x80000000);
+  checkpoint.dcrs().emplace_back(2, 0xdeadbeef);
+  for (uint32_t c = 0; c < num_cores; ++c) {
+    for (uint32_t w = 0; w < num_warps; ++w) {
+      auto& warp = checkpoint.warp(c, w);
+      warp.pc = 0x80000000 + (c * num_warps + w) * 4;
+      warp.tmask = (w == 3) ? 0 : ((1u << num_threads) - 1);
+      warp.fcsr = w;
+      for (uint32_t i = 0; i < warp.iregs.size(); ++i) {
+        warp.iregs[i] = (uint64_t(c) << 48) | (uint64_t(w) << 32) | i;
+        warp.fregs[i] = ~warp.iregs[i];
+      }
+    }
+  }
+  RT_CHECK(checkpoint.save(CKPT_FILE, ram));
+
+  // round trip
+  RAM ram2(PAGE_SIZE);
+  uint8_t stale = 0x55;
+  ram2.write(&stale, 0x40000000, 1);
+  Checkpoint restored;
+  RT_CHECK(restored.load(CKPT_FILE, &ram2));
+  RT_CHECK(restored.xlen() == 64);
+  RT_CHECK(restored.num_cores() == num_cores);
+  RT_CHECK(restored.num_warps() == num_warps);
+  RT_CHECK(restored.num_threads() == num_threads);
+  RT_CHECK(restored.dcrs() == checkpoint.dcrs());
+  for (uint32_t c = 0; c < num_cores; ++c) {
+    for (uint32_t w = 0; w < num_warps; ++w) {
+      auto& a = checkpoint.warp(c, w);
+      auto& b = restored.warp(c, w);
+      RT_CHECK(a.pc == b.pc && a.tmask == b.tmask && a.fcsr == b.fcsr);
+      RT_CHECK(a.iregs == b.iregs && a.fregs == b.fregs);
+    }
+  }
+  RT_CHECK(restored.reg(1, 2, 3, 5) == checkpoint.warp(1, 2).iregs.at(3 * Checkpoint::NUM_REGS + 5));
+  RT_CHECK(restored.reg(1, 2, 3, 37) == checkpoint.warp(1, 2).fregs.at(3 * Checkpoint::NUM_REGS + 5));
+
+  std::vector<uint8_t> data2(data.size());
+  ram2.read(data2.data(), 0x80000000, data2.size());
+  RT_CHECK(data2 == data);
+  uint64_t word2 = 0;
+  ram2.read(&word2, 0x10, sizeof(word2));
+  RT_CHECK(word2 == word);
+  // loading replaces the previous content, unmapped pages read as "baadf00d"
+  uint8_t cleared = 0;
+  ram2.read(&cleared, 0x40000000, 1);
+  RT_CHECK(cleared == 0x0d);
+
+  // corrupt headers are rejected before anything is allocated from them
+  // (header fields: magic, version, xlen, num_cores, num_warps, num_threads, num_dcrs)
+  const struct { uint32_t offset; uint32_t value; } corruptions[] = {
+    {4,  2},           // version
+    {8,  48},          // xlen
+    {12, 0},           // num_cores
+    {12, 0xffffffff},  // num_cores
+    {16, 0x10000},     // num_warps, fits the bound but not the file
+    {20, 0xffffffff},  // num_threads
+    {24, 0x40000000},  // num_dcrs
+  };
+  // memory image page size, after the header, the DCRs and the warps
+  uint32_t ram_offset = 32 + 2 * 8 + num_cores * num_warps * (16 + 2 * num_threads * Checkpoint::NUM_REGS * 8);
+  patch_header("bad.ckpt", ram_offset, 3);
+  {
+    Checkpoint bad;
+    RAM ram3(PAGE_SIZE);
+    RT_CHECK(!bad.load("bad.ckpt", &ram3));
+  }
+  for (auto& corruption : corruptions) {
+    patch_header("bad.ckpt", corruption.offset, corruption.value);
+    Checkpoint bad;
+    RAM ram3(PAGE_SIZE);
+    RT_CHECK(!bad.load("bad.ckpt", &ram3));
+  }
+
+  // truncated memory image
+  {
+    std::ifstream ifs(CKPT_FILE, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::ofstream ofs("bad.ckpt", std::ios::binary | std::ios::trunc);
+    ofs.write(content.data(), content.size() - 10);
+  }
+  {
+    Checkpoint bad;
+    RAM ram3(PAGE_SIZE);
+    RT_CHECK(!bad.load("bad.ckpt", &ram3));
+  }
+
+  remove(CKPT_FILE);
+  remove("bad.ckpt");
+
+  printf("PASSED!\n");
+
+  return 0;
+}
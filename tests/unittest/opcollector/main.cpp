@@ -0,0 +1,140 @@
+#include <operand.h>
+#include <stdio.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+using namespace vortex;
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed!\n", #_expr);                   \
+     return -1;                                                 \
+   } while (false)
+
+// synthetic instruction: warp id and source registers
+struct instr_t {
+  uint32_t wid;
+  std::vector<uint32_t> iregs;
+  std::vector<uint32_t> fregs;
+};
+
+// runs a trace through a single operand stage, all instructions are queued at
+// cycle zero; returns the cycles each one spent in the stage
+static std::vector<uint64_t> run(const std::string& config,
+                                 const std::vector<instr_t>& instrs,
+                                 Operand::PerfStats* perf_stats) {
+  Arch arch(NUM_THREADS, NUM_WARPS, 1, 1);
+  if (!arch.configure(config)) {
+    std::abort();
+  }
+
+  SimPlatform platform;
+  SimPlatformScope scope(&platform);
+  auto operand = Operand::Create(arch);
+  platform.reset();
+
+  std::vector<std::unique_ptr<pipeline_trace_t>> traces;
+  for (auto& instr : instrs) {
+    auto trace = new pipeline_trace_t(traces.size(), arch);
+    trace->wid = instr.wid;
+    for (auto r : instr.iregs) {
+      trace->used_iregs.set(r);
+    }
+    for (auto r : instr.fregs) {
+      trace->used_fregs.set(r);
+    }
+    traces.emplace_back(trace);
+    operand->Input.send(trace, 1);
+  }
+
+  auto start = platform.cycles();
+  std::vector<uint64_t> latencies(instrs.size(), 0);
+  uint32_t pending = instrs.size();
+  while (pending != 0 && platform.cycles() < 1000) {
+    platform.tick();
+    while (!operand->Output.empty()) {
+      auto trace = operand->Output.front();
+      latencies.at(trace->uuid) = platform.cycles() - start;
+      operand->Output.pop();
+      --pending;
+    }
+  }
+  *perf_stats = operand->perf_stats();
+  platform.finalize();
+  return latencies;
+}
+
+int main() {
+  Operand::PerfStats perf;
+
+  // reference: an instruction without operands
+  auto base = run("", {{0, {}, {}}}, &perf).at(0);
+  RT_CHECK(base != 0);
+  RT_CHECK(perf.reads == 0 && perf.occupancy == 0);
+
+  // single bank and port: one register per cycle, x0 is not read
+  {
+    auto lat = run("", {{0, {1, 2}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 2);
+    RT_CHECK(perf.reads == 2);
+    RT_CHECK(perf.bank_conflicts == 1);
+    RT_CHECK(perf.occupancy == 3);
+  }
+  {
+    auto lat = run("", {{0, {0, 1}, {3}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 2);
+    RT_CHECK(perf.reads == 2);
+  }
+
+  // single collector: the next instruction waits for it
+  {
+    auto lat = run("", {{0, {1}, {}}, {1, {1}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 1);
+    RT_CHECK(lat.at(1) == lat.at(0) + 2);
+    RT_CHECK(perf.stalls != 0);
+  }
+
+  // banked: registers in different banks are read in parallel
+  {
+    auto lat = run("gpr_num_banks=4", {{0, {1, 2}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 1);
+    RT_CHECK(perf.bank_conflicts == 0);
+  }
+
+  // banked: registers in the same bank conflict unless there are enough ports
+  {
+    auto lat = run("gpr_num_banks=4", {{0, {1, 5}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 2);
+    RT_CHECK(perf.bank_conflicts == 1);
+    lat = run("gpr_num_banks=4,gpr_num_ports=2", {{0, {1, 5}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 1);
+    RT_CHECK(perf.bank_conflicts == 0);
+  }
+
+  // banks are interleaved by warp: the same registers of another warp do not conflict
+  {
+    auto lat = run("gpr_num_banks=4,num_opcs=2", {{0, {1, 5}, {}}, {1, {1, 5}, {}}}, &perf);
+    RT_CHECK(lat.at(0) == base + 2);
+    RT_CHECK(lat.at(1) == base + 3);
+    RT_CHECK(perf.bank_conflicts == 2);
+    RT_CHECK(perf.stalls == 0);
+    auto lat_same = run("gpr_num_banks=4,num_opcs=2", {{0, {1, 5}, {}}, {0, {1, 5}, {}}}, &perf);
+    RT_CHECK(perf.bank_conflicts > 2);
+    RT_CHECK(std::max(lat_same.at(0), lat_same.at(1)) > lat.at(1));
+  }
+
+  // collectors compete for the same bank
+  {
+    auto lat = run("gpr_num_banks=4,num_opcs=2", {{0, {1, 5}, {}}, {0, {9}, {}}}, &perf);
+    RT_CHECK(perf.reads == 3);
+    RT_CHECK(perf.bank_conflicts != 0);
+    RT_CHECK(std::max(lat.at(0), lat.at(1)) == base + 3);
+  }
+
+  printf("PASSED!\n");
+
+  return 0;
+}
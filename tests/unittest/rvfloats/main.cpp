@@ -0,0 +1,98 @@
+#include <rvfloats.h>
+#include <stdio.h>
+#include <random>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed!\n", #_expr);                   \
+     return -1;                                                 \
+   } while (false)
+
+#define NUM_SAMPLES 1000000
+
+static std::mt19937_64 rng(0);
+
+// random operands, biased toward the values the host FPU path must hand over
+// to SoftFloat: zeros, infinities, NaNs, subnormals and results that overflow
+// or underflow
+static uint32_t gen_f32() {
+  uint32_t sign = (rng() & 1) << 31;
+  uint32_t frac = rng() & 0x7fffff;
+  switch (rng() % 10) {
+  case 0: return sign;                                 // zero
+  case 1: return sign | 0x7f800000;                    // infinity
+  case 2: return sign | 0x7f800000 | (frac | 1);       // NaN
+  case 3: return sign | frac;                          // subnormal
+  case 4: return sign | (uint32_t(1 + rng() % 24) << 23) | frac;   // tiny
+  case 5: return sign | (uint32_t(230 + rng() % 25) << 23) | frac; // huge
+  case 6: return sign | (uint32_t(126 + rng() % 3) << 23) | (frac & ~0xfff); // short mantissa
+  default: return sign | (uint32_t(1 + rng() % 254) << 23) | frac; // normal
+  }
+}
+
+static uint64_t gen_f64() {
+  uint64_t sign = (rng() & 1) << 63;
+  uint64_t frac = rng() & 0xfffffffffffffull;
+  switch (rng() % 10) {
+  case 0: return sign;
+  case 1: return sign | 0x7ff0000000000000ull;
+  case 2: return sign | 0x7ff0000000000000ull | (frac | 1);
+  case 3: return sign | frac;
+  case 4: return sign | (uint64_t(1 + rng() % 53) << 52) | frac;
+  case 5: return sign | (uint64_t(1990 + rng() % 57) << 52) | frac;
+  case 6: return sign | (uint64_t(1022 + rng() % 3) << 52) | (frac & ~0xffffffull);
+  default: return sign | (uint64_t(1 + rng() % 2046) << 52) | frac;
+  }
+}
+
+// evaluates the operation with the host FPU path and with SoftFloat only;
+// results and exception flags must match bit for bit
+template <typename T, typename F>
+static bool check(const char* name, uint32_t frm, F op) {
+  uint32_t fflags_n = 0, fflags_s = 0;
+  rv_native_fpu(true);
+  T r_n = op(frm, &fflags_n);
+  rv_native_fpu(false);
+  T r_s = op(frm, &fflags_s);
+  if (r_n == r_s && fflags_n == fflags_s)
+    return true;
+  printf("%s (frm=%d): native=0x%llx/0x%x, softfloat=0x%llx/0x%x\n", name, frm,
+         (unsigned long long)r_n, fflags_n, (unsigned long long)r_s, fflags_s);
+  return false;
+}
+
+int main() {
+  for (int i = 0; i < NUM_SAMPLES; ++i) {
+    uint32_t frm = rng() % 5; // RNE, RTZ, RDN, RUP, RMM
+    {
+      auto a = gen_f32(), b = gen_f32(), c = gen_f32();
+      RT_CHECK(check<uint32_t>("fadd.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fadd_s(a, b, rm, f); }));
+      RT_CHECK(check<uint32_t>("fsub.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fsub_s(a, b, rm, f); }));
+      RT_CHECK(check<uint32_t>("fmul.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmul_s(a, b, rm, f); }));
+      RT_CHECK(check<uint32_t>("fdiv.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fdiv_s(a, b, rm, f); }));
+      RT_CHECK(check<uint32_t>("fsqrt.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fsqrt_s(a, rm, f); }));
+      RT_CHECK(check<uint32_t>("fmadd.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmadd_s(a, b, c, rm, f); }));
+      RT_CHECK(check<uint32_t>("fmsub.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmsub_s(a, b, c, rm, f); }));
+      RT_CHECK(check<uint32_t>("fnmadd.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fnmadd_s(a, b, c, rm, f); }));
+      RT_CHECK(check<uint32_t>("fnmsub.s", frm, [&](uint32_t rm, uint32_t* f) { return rv_fnmsub_s(a, b, c, rm, f); }));
+    }
+    {
+      auto a = gen_f64(), b = gen_f64(), c = gen_f64();
+      RT_CHECK(check<uint64_t>("fadd.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fadd_d(a, b, rm, f); }));
+      RT_CHECK(check<uint64_t>("fsub.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fsub_d(a, b, rm, f); }));
+      RT_CHECK(check<uint64_t>("fmul.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmul_d(a, b, rm, f); }));
+      RT_CHECK(check<uint64_t>("fdiv.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fdiv_d(a, b, rm, f); }));
+      RT_CHECK(check<uint64_t>("fsqrt.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fsqrt_d(a, rm, f); }));
+      RT_CHECK(check<uint64_t>("fmadd.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmadd_d(a, b, c, rm, f); }));
+      RT_CHECK(check<uint64_t>("fmsub.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fmsub_d(a, b, c, rm, f); }));
+      RT_CHECK(check<uint64_t>("fnmadd.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fnmadd_d(a, b, c, rm, f); }));
+      RT_CHECK(check<uint64_t>("fnmsub.d", frm, [&](uint32_t rm, uint32_t* f) { return rv_fnmsub_d(a, b, c, rm, f); }));
+    }
+  }
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <simobject.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed!\n", #_expr);                   \
+     return -1;                                                 \
+   } while (false)
+
+// forwards a token around a loop of ports, counting hops
+class Relay : public SimObject<Relay> {
+public:
+  SimPort<uint32_t> Input;
+  SimPort<uint32_t> Output;
+
+  Relay(const SimContext& ctx, uint32_t delay) 
+    : SimObject<Relay>(ctx, "relay")
+    , Input(this)
+    , Output(this)
+    , delay_(delay)
+    , hops_(0)
+  {}
+
+  void reset() {
+    hops_ = 0;
+  }
+
+  void tick() {
+    if (Input.empty())
+      return;
+    auto token = Input.front();
+    Input.pop();
+    ++hops_;
+    Output.send(token + 1, delay_);
+  }
+
+  uint64_t hops() const {
+    return hops_;
+  }
+
+private:
+  uint32_t delay_;
+  uint64_t hops_;
+};
+
+struct Device {
+  SimPlatform  platform;
+  Relay::Ptr   relay;
+
+  Device(uint32_t delay) {
+    SimPlatformScope scope(&platform);
+    relay = Relay::Create(delay);
+    relay->Output.bind(&relay->Input);
+  }
+
+  ~Device() {
+    SimPlatformScope scope(&platform);
+    platform.finalize();
+  }
+
+  void run(uint64_t cycles) {
+    SimPlatformScope scope(&platform);
+    platform.reset();
+    relay->Output.send(0, 1);
+    while (platform.cycles() < cycles) {
+      platform.tick();
+    }
+  }
+};
+
+int main() {
+  const uint32_t num_devices = 4;
+  const uint64_t num_cycles = 100000;
+
+  std::vector<std::unique_ptr<Device>> devices;
+  for (uint32_t i = 0; i < num_devices; ++i) {
+    devices.emplace_back(new Device(i + 1));
+  }
+
+  // run all devices concurrently, one thread per device
+  std::vector<std::thread> threads;
+  for (auto& device : devices) {
+    threads.emplace_back([&]{ device->run(num_cycles); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // each device must match a standalone run of the same model
+  for (uint32_t i = 0; i < num_devices; ++i) {
+    auto& device = devices.at(i);
+    Device reference(i + 1);
+    reference.run(num_cycles);
+    RT_CHECK(device->platform.cycles() == num_cycles);
+    RT_CHECK(device->relay->hops() == reference.relay->hops());
+  }
+
+  // nothing leaked into the default platform
+  RT_CHECK(SimPlatform::instance().cycles() == 0);
+
+  devices.clear();
+
+  printf("PASSED!\n");
+
+  return 0;
+}
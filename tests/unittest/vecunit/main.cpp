@@ -0,0 +1,498 @@
+#include <vec_exec.h>
+#include <decode.h>
+#include <instr.h>
+#include <arch.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace vortex;
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     if (_expr)                                                 \
+       break;                                                   \
+     printf("Error: '%s' failed!\n", #_expr);                   \
+     return -1;                                                 \
+   } while (false)
+
+#define VLEN 128
+
+// vtype fields
+#define E8   (0 << 3)
+#define E16  (1 << 3)
+#define E32  (2 << 3)
+#define E64  (3 << 3)
+#define M1   0
+#define M2   1
+#define M4   2
+#define MF2  7
+#define TA   (1 << 6)
+#define MA   (1 << 7)
+
+// instruction encodings
+static uint32_t vsetvli(uint32_t rd, uint32_t rs1, uint32_t vtypei) {
+  return (vtypei << 20) | (rs1 << 15) | (7 << 12) | (rd << 7) | 0x57;
+}
+
+static uint32_t vsetivli(uint32_t rd, uint32_t uimm, uint32_t vtypei) {
+  return (3u << 30) | (vtypei << 20) | (uimm << 15) | (7 << 12) | (rd << 7) | 0x57;
+}
+
+static uint32_t vsetvl(uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (1u << 31) | (rs2 << 20) | (rs1 << 15) | (7 << 12) | (rd << 7) | 0x57;
+}
+
+enum { OPIVV = 0, OPFVV = 1, OPMVV = 2, OPIVI = 3, OPIVX = 4, OPFVF = 5, OPMVX = 6 };
+
+static uint32_t opv(uint32_t funct6, uint32_t funct3, uint32_t vd, uint32_t vs2, uint32_t vs1, bool vm = true) {
+  return (funct6 << 26) | (uint32_t(vm) << 25) | (vs2 << 20) | ((vs1 & 0x1f) << 15) | (funct3 << 12) | (vd << 7) | 0x57;
+}
+
+static uint32_t width_code(uint32_t eew) {
+  switch (eew) {
+  case 8:  return 0;
+  case 16: return 5;
+  case 32: return 6;
+  default: return 7;
+  }
+}
+
+static uint32_t vmem(bool store, uint32_t eew, uint32_t nf, uint32_t mop, uint32_t vd, uint32_t rs1, uint32_t rs2, bool vm = true) {
+  return ((nf - 1) << 29) | (mop << 26) | (uint32_t(vm) << 25) | (rs2 << 20) | (rs1 << 15)
+       | (width_code(eew) << 12) | (vd << 7) | (store ? 0x27 : 0x07);
+}
+
+// flat memory at address zero
+class RamMem : public VecMem {
+public:
+  RamMem() : ram_(4096, 0) {}
+
+  void read(void* data, uint64_t addr, uint32_t size) override {
+    memcpy(data, ram_.data() + addr, size);
+  }
+
+  void write(const void* data, uint64_t addr, uint32_t size) override {
+    memcpy(ram_.data() + addr, data, size);
+  }
+
+  template <typename T> T get(uint64_t addr) const {
+    T value;
+    memcpy(&value, ram_.data() + addr, sizeof(T));
+    return value;
+  }
+
+  template <typename T> void set(uint64_t addr, T value) {
+    memcpy(ram_.data() + addr, &value, sizeof(T));
+  }
+
+private:
+  std::vector<uint8_t> ram_;
+};
+
+// a single vector hart with its scalar registers
+class Hart {
+public:
+  Hart(const Arch& arch)
+    : decoder_(arch)
+    , exec_(VLEN)
+    , state_(VLEN / 8)
+  {
+    memset(x_, 0, sizeof(x_));
+    memset(f_, 0, sizeof(f_));
+  }
+
+  // executes an instruction, returns false if it is illegal
+  bool run(uint32_t code) {
+    auto instr = decoder_.decode(code);
+    uint64_t rsdata[2] = {0, 0};
+    for (uint32_t i = 0; i < 2 && i < instr->getNRSrc(); ++i) {
+      auto reg = instr->getRSrc(i);
+      switch (instr->getRSType(i)) {
+      case RegType::Integer: rsdata[i] = x_[reg]; break;
+      case RegType::Float:   rsdata[i] = f_[reg]; break;
+      default: break;
+      }
+    }
+    uint32_t fflags = 0;
+    VecResult result;
+    if (!exec_.execute(*instr, &state_, rsdata[0], rsdata[1], 0, &fflags, &mem_, &result))
+      return false;
+    result_ = result;
+    if (result.scalar_wb) {
+      if (instr->getRDType() == RegType::Float) {
+        f_[instr->getRDest()] = result.scalar;
+      } else if (instr->getRDest() != 0) {
+        x_[instr->getRDest()] = result.scalar;
+      }
+    }
+    return true;
+  }
+
+  template <typename T> T vreg(uint32_t reg, uint32_t idx) const {
+    T value;
+    memcpy(&value, state_.vregs.data() + reg * exec_.vlenb() + idx * sizeof(T), sizeof(T));
+    return value;
+  }
+
+  template <typename T> void set_vreg(uint32_t reg, uint32_t idx, T value) {
+    memcpy(state_.vregs.data() + reg * exec_.vlenb() + idx * sizeof(T), &value, sizeof(T));
+  }
+
+  // fills a register group with a byte pattern
+  void fill(uint32_t reg, uint32_t count, uint8_t value) {
+    memset(state_.vregs.data() + reg * exec_.vlenb(), value, count * exec_.vlenb());
+  }
+
+  uint64_t x_[32];
+  uint64_t f_[32];
+  RamMem mem_;
+  VecState& state() { return state_; }
+  const VecResult& result() const { return result_; }
+
+private:
+  Decoder   decoder_;
+  VecExec   exec_;
+  VecState  state_;
+  VecResult result_;
+};
+
+static int test_vsetvl(const Arch& arch) {
+  Hart h(arch);
+  // vl = min(avl, VLMAX)
+  h.x_[10] = 10;
+  RT_CHECK(h.run(vsetvli(5, 10, E32 | M1)));
+  RT_CHECK(h.x_[5] == 4 && h.state().vl == 4);
+  RT_CHECK(h.run(vsetvli(5, 10, E8 | M2)));
+  RT_CHECK(h.x_[5] == 10);
+  // rs1 = x0 and rd != x0 requests VLMAX
+  RT_CHECK(h.run(vsetvli(5, 0, E8 | M4)));
+  RT_CHECK(h.x_[5] == 64);
+  RT_CHECK(h.run(vsetivli(5, 3, E64 | M1 | TA | MA)));
+  RT_CHECK(h.x_[5] == 2 && h.state().vtype == (E64 | M1 | TA | MA));
+  // fractional LMUL
+  RT_CHECK(h.run(vsetivli(5, 31, E16 | MF2)));
+  RT_CHECK(h.x_[5] == 4);
+  // vsetvl takes vtype from a register
+  h.x_[11] = E16 | M2;
+  RT_CHECK(h.run(vsetvl(5, 10, 11)));
+  RT_CHECK(h.x_[5] == 10 && h.state().vtype == (E16 | M2));
+  // reserved LMUL and SEW > ELEN * LMUL set vill
+  RT_CHECK(h.run(vsetvli(5, 10, E32 | 4)));
+  RT_CHECK(h.x_[5] == 0 && (h.state().vtype >> 31) == 1);
+  RT_CHECK(h.run(vsetvli(5, 10, E64 | MF2)));
+  RT_CHECK(h.x_[5] == 0 && (h.state().vtype >> 31) == 1);
+  // arithmetic is illegal with vill set
+  RT_CHECK(!h.run(opv(0x00, OPIVV, 1, 2, 3)));
+  return 0;
+}
+
+static int test_memory(const Arch& arch) {
+  Hart h(arch);
+  for (uint32_t i = 0; i < 16; ++i) {
+    h.mem_.set<uint32_t>(0x100 + 4 * i, 100 + i);
+    h.mem_.set<uint32_t>(0x200 + 4 * i, 1000 * i);
+  }
+  h.x_[10] = 8;
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M2)));
+  // unit-stride over a register group
+  h.x_[11] = 0x100;
+  h.x_[12] = 0x200;
+  h.x_[13] = 0x300;
+  RT_CHECK(h.run(vmem(false, 32, 1, 0, 2, 11, 0)));
+  RT_CHECK(h.run(vmem(false, 32, 1, 0, 4, 12, 0)));
+  RT_CHECK(h.result().vregs_written == RegMask(0x30));
+  RT_CHECK(h.run(opv(0x00, OPIVV, 6, 2, 4)));  // vadd.vv v6, v2, v4
+  RT_CHECK(h.run(vmem(true, 32, 1, 0, 6, 13, 0)));
+  for (uint32_t i = 0; i < 8; ++i) {
+    RT_CHECK(h.mem_.get<uint32_t>(0x300 + 4 * i) == 100 + i + 1000 * i);
+  }
+  RT_CHECK(h.mem_.get<uint32_t>(0x300 + 4 * 8) == 0);
+  RT_CHECK(h.result().is_store && h.result().mem_addrs.size() == 8);
+
+  // strided: every third word
+  h.x_[14] = 12;
+  h.x_[10] = 4;
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  RT_CHECK(h.run(vmem(false, 32, 1, 2, 8, 11, 14)));
+  for (uint32_t i = 0; i < 4; ++i) {
+    RT_CHECK(h.vreg<uint32_t>(8, i) == 100 + 3 * i);
+  }
+
+  // indexed with byte offsets
+  h.set_vreg<uint32_t>(9, 0, 12);
+  h.set_vreg<uint32_t>(9, 1, 0);
+  h.set_vreg<uint32_t>(9, 2, 40);
+  h.set_vreg<uint32_t>(9, 3, 4);
+  RT_CHECK(h.run(vmem(false, 32, 1, 1, 10, 11, 9)));
+  RT_CHECK(h.vreg<uint32_t>(10, 0) == 103);
+  RT_CHECK(h.vreg<uint32_t>(10, 1) == 100);
+  RT_CHECK(h.vreg<uint32_t>(10, 2) == 110);
+  RT_CHECK(h.vreg<uint32_t>(10, 3) == 101);
+
+  // two-field segments deinterleave
+  RT_CHECK(h.run(vmem(false, 32, 2, 0, 12, 11, 0)));
+  for (uint32_t i = 0; i < 4; ++i) {
+    RT_CHECK(h.vreg<uint32_t>(12, i) == 100 + 2 * i);
+    RT_CHECK(h.vreg<uint32_t>(13, i) == 101 + 2 * i);
+  }
+
+  // whole register load ignores vl
+  h.x_[10] = 1;
+  RT_CHECK(h.run(vsetvli(0, 10, E8 | M1)));
+  RT_CHECK(h.run(vmem(false, 8, 1, 0, 14, 12, 0x08)));
+  for (uint32_t i = 0; i < 4; ++i) {
+    RT_CHECK(h.vreg<uint32_t>(14, i) == 1000 * i);
+  }
+
+  // reserved memory mode with mew set
+  RT_CHECK(!h.run(vmem(false, 32, 1, 4, 8, 11, 0)));
+  return 0;
+}
+
+static int test_policies(const Arch& arch) {
+  Hart h(arch);
+  h.x_[10] = 3;
+  // tail and mask undisturbed
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  h.fill(1, 1, 0xaa);
+  h.set_vreg<uint8_t>(0, 0, 0x5);  // v0.mask = 101
+  for (uint32_t i = 0; i < 4; ++i) {
+    h.set_vreg<uint32_t>(2, i, i);
+  }
+  RT_CHECK(h.run(opv(0x00, OPIVI, 1, 2, 7, false)));  // vadd.vi v1, v2, 7, v0.t
+  RT_CHECK(h.vreg<uint32_t>(1, 0) == 7);
+  RT_CHECK(h.vreg<uint32_t>(1, 1) == 0xaaaaaaaa);
+  RT_CHECK(h.vreg<uint32_t>(1, 2) == 9);
+  RT_CHECK(h.vreg<uint32_t>(1, 3) == 0xaaaaaaaa);
+
+  // agnostic elements are set to ones
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1 | TA | MA)));
+  h.fill(1, 1, 0xaa);
+  RT_CHECK(h.run(opv(0x00, OPIVI, 1, 2, -1, false)));
+  RT_CHECK(h.vreg<uint32_t>(1, 0) == 0xffffffff);
+  RT_CHECK(h.vreg<uint32_t>(1, 1) == 0xffffffff);
+  RT_CHECK(h.vreg<uint32_t>(1, 2) == 1);
+  RT_CHECK(h.vreg<uint32_t>(1, 3) == 0xffffffff);
+
+  // a masked destination may not overlap v0
+  RT_CHECK(!h.run(opv(0x00, OPIVI, 0, 2, 1, false)));
+  // misaligned register group
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M2)));
+  RT_CHECK(!h.run(opv(0x00, OPIVV, 3, 4, 6)));
+  return 0;
+}
+
+static int test_integer(const Arch& arch) {
+  Hart h(arch);
+  h.x_[10] = 4;
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  int32_t a[4] = {5, -7, 0x7fffffff, -3};
+  for (uint32_t i = 0; i < 4; ++i) {
+    h.set_vreg<int32_t>(2, i, a[i]);
+  }
+
+  // vmul.vx
+  h.x_[11] = 3;
+  RT_CHECK(h.run(opv(0x25, OPMVX, 3, 2, 11)));
+  RT_CHECK(h.vreg<int32_t>(3, 0) == 15 && h.vreg<int32_t>(3, 1) == -21);
+
+  // vsll.vi uses an unsigned immediate
+  RT_CHECK(h.run(opv(0x25, OPIVI, 3, 2, 4)));
+  RT_CHECK(h.vreg<int32_t>(3, 0) == 80);
+
+  // vsadd.vx saturates and sets vxsat
+  h.x_[11] = 1;
+  RT_CHECK(h.run(opv(0x21, OPIVX, 4, 2, 11)));
+  RT_CHECK(h.vreg<int32_t>(4, 2) == 0x7fffffff && h.vreg<int32_t>(4, 0) == 6);
+  RT_CHECK(h.state().vxsat == 1);
+
+  // vssrl.vi rounds with vxrm: 5 >> 1 is 3 in rnu and 2 in rdn
+  h.state().vxrm = 0;
+  RT_CHECK(h.run(opv(0x2a, OPIVI, 5, 2, 1)));
+  RT_CHECK(h.vreg<uint32_t>(5, 0) == 3);
+  h.state().vxrm = 2;
+  RT_CHECK(h.run(opv(0x2a, OPIVI, 5, 2, 1)));
+  RT_CHECK(h.vreg<uint32_t>(5, 0) == 2);
+
+  // vmacc.vv
+  for (uint32_t i = 0; i < 4; ++i) {
+    h.set_vreg<int32_t>(6, i, 10);
+  }
+  RT_CHECK(h.run(opv(0x2d, OPMVV, 6, 2, 2)));
+  RT_CHECK(h.vreg<int32_t>(6, 0) == 35 && h.vreg<int32_t>(6, 1) == 59);
+
+  // vwadd.vv widens into a register pair
+  RT_CHECK(h.run(opv(0x31, OPMVV, 8, 2, 2)));
+  RT_CHECK(h.result().vregs_written == RegMask(0x300));
+  RT_CHECK(h.vreg<int64_t>(8, 1) == -14);
+  RT_CHECK(h.vreg<int64_t>(9, 0) == 0xfffffffell);
+
+  // vnsrl.wi narrows back
+  RT_CHECK(h.run(opv(0x2c, OPIVI, 10, 8, 1)));
+  RT_CHECK(h.vreg<int32_t>(10, 1) == -7 && h.vreg<int32_t>(10, 2) == 0x7fffffff);
+
+  // vzext.vf2
+  h.x_[10] = 4;
+  RT_CHECK(h.run(vsetvli(0, 10, E16 | M1)));
+  h.set_vreg<uint16_t>(12, 0, 0xff80);
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  RT_CHECK(h.run(opv(0x12, OPMVV, 13, 12, 6)));
+  RT_CHECK(h.vreg<uint32_t>(13, 0) == 0xff80);
+
+  // vredsum.vs
+  h.set_vreg<int32_t>(14, 0, 100);
+  RT_CHECK(h.run(opv(0x00, OPMVV, 15, 2, 14)));
+  RT_CHECK(h.vreg<uint32_t>(15, 0) == uint32_t(100 + 5 - 7 - 3) + 0x7fffffffu);
+  RT_CHECK(!h.result().chainable);
+
+  // vadc.vvm / vmadc.vv
+  h.set_vreg<uint8_t>(0, 0, 0x3);
+  RT_CHECK(h.run(opv(0x10, OPIVV, 16, 2, 2, false)));
+  RT_CHECK(h.vreg<int32_t>(16, 0) == 11 && h.vreg<int32_t>(16, 2) == -2 && h.vreg<int32_t>(16, 3) == -6);
+  RT_CHECK(h.run(opv(0x11, OPIVV, 17, 2, 2)));
+  RT_CHECK((h.vreg<uint8_t>(17, 0) & 0xf) == 0xa);
+
+  // vmerge.vim / vmv.v.x
+  RT_CHECK(h.run(opv(0x17, OPIVI, 18, 2, 9, false)));
+  RT_CHECK(h.vreg<int32_t>(18, 0) == 9 && h.vreg<int32_t>(18, 2) == 0x7fffffff);
+  h.x_[11] = 42;
+  RT_CHECK(h.run(opv(0x17, OPIVX, 18, 0, 11)));
+  RT_CHECK(h.vreg<int32_t>(18, 3) == 42);
+
+  // vdiv by zero
+  h.x_[11] = 0;
+  RT_CHECK(h.run(opv(0x21, OPMVX, 19, 2, 11)));
+  RT_CHECK(h.vreg<int32_t>(19, 0) == -1);
+  return 0;
+}
+
+static int test_mask(const Arch& arch) {
+  Hart h(arch);
+  h.x_[10] = 8;
+  RT_CHECK(h.run(vsetvli(0, 10, E16 | M1)));
+  for (uint32_t i = 0; i < 8; ++i) {
+    h.set_vreg<int16_t>(2, i, int16_t(i) - 4);
+  }
+  // vmslt.vx v1, v2, x0
+  RT_CHECK(h.run(opv(0x1b, OPIVX, 1, 2, 0)));
+  RT_CHECK(h.vreg<uint8_t>(1, 0) == 0x0f);
+
+  // vcpop.m and vfirst.m
+  h.set_vreg<uint8_t>(3, 0, 0x58);
+  RT_CHECK(h.run(opv(0x10, OPMVV, 5, 3, 0x10)));
+  RT_CHECK(h.x_[5] == 3 && h.result().scalar_wb);
+  RT_CHECK(h.run(opv(0x10, OPMVV, 5, 3, 0x11)));
+  RT_CHECK(h.x_[5] == 3);
+  h.set_vreg<uint8_t>(3, 0, 0);
+  RT_CHECK(h.run(opv(0x10, OPMVV, 5, 3, 0x11)));
+  RT_CHECK(h.x_[5] == ~uint64_t(0) || h.x_[5] == 0xffffffff);
+
+  // vmnand.mm
+  h.set_vreg<uint8_t>(3, 0, 0xf0);
+  RT_CHECK(h.run(opv(0x1d, OPMVV, 4, 1, 3)));
+  RT_CHECK(h.vreg<uint8_t>(4, 0) == 0xff);
+
+  // viota.m and vid.v
+  h.set_vreg<uint8_t>(3, 0, 0x55);
+  RT_CHECK(h.run(opv(0x14, OPMVV, 6, 3, 0x10)));
+  RT_CHECK(h.vreg<uint16_t>(6, 3) == 2 && h.vreg<uint16_t>(6, 7) == 4);
+  RT_CHECK(h.run(opv(0x14, OPMVV, 7, 0, 0x11)));
+  RT_CHECK(h.vreg<uint16_t>(7, 5) == 5);
+
+  // vmsbf.m
+  h.set_vreg<uint8_t>(3, 0, 0x10);
+  RT_CHECK(h.run(opv(0x14, OPMVV, 8, 3, 0x01)));
+  RT_CHECK(h.vreg<uint8_t>(8, 0) == 0x0f);
+  return 0;
+}
+
+static int test_permute(const Arch& arch) {
+  Hart h(arch);
+  h.x_[10] = 4;
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  for (uint32_t i = 0; i < 4; ++i) {
+    h.set_vreg<uint32_t>(2, i, 10 + i);
+    h.set_vreg<uint32_t>(3, i, 0xff);
+  }
+  // vslideup.vi keeps the elements below the offset
+  RT_CHECK(h.run(opv(0x0e, OPIVI, 3, 2, 2)));
+  RT_CHECK(h.vreg<uint32_t>(3, 1) == 0xff && h.vreg<uint32_t>(3, 2) == 10 && h.vreg<uint32_t>(3, 3) == 11);
+
+  // vslidedown.vi reads zeros past VLMAX
+  RT_CHECK(h.run(opv(0x0f, OPIVI, 4, 2, 3)));
+  RT_CHECK(h.vreg<uint32_t>(4, 0) == 13 && h.vreg<uint32_t>(4, 1) == 0);
+
+  // vslide1down.vx
+  h.x_[11] = 99;
+  RT_CHECK(h.run(opv(0x0f, OPMVX, 5, 2, 11)));
+  RT_CHECK(h.vreg<uint32_t>(5, 0) == 11 && h.vreg<uint32_t>(5, 3) == 99);
+
+  // vrgather.vv with an out of range index
+  h.set_vreg<uint32_t>(6, 0, 3);
+  h.set_vreg<uint32_t>(6, 1, 0);
+  h.set_vreg<uint32_t>(6, 2, 100);
+  h.set_vreg<uint32_t>(6, 3, 1);
+  RT_CHECK(h.run(opv(0x0c, OPIVV, 7, 2, 6)));
+  RT_CHECK(h.vreg<uint32_t>(7, 0) == 13 && h.vreg<uint32_t>(7, 1) == 10);
+  RT_CHECK(h.vreg<uint32_t>(7, 2) == 0 && h.vreg<uint32_t>(7, 3) == 11);
+  RT_CHECK(!h.result().chainable);
+
+  // vrgather may not overlap its sources
+  RT_CHECK(!h.run(opv(0x0c, OPIVV, 2, 2, 6)));
+
+  // vcompress.vm
+  h.set_vreg<uint8_t>(1, 0, 0xa);
+  RT_CHECK(h.run(opv(0x17, OPMVV, 8, 2, 1)));
+  RT_CHECK(h.vreg<uint32_t>(8, 0) == 11 && h.vreg<uint32_t>(8, 1) == 13);
+
+  // vmv.x.s / vmv.s.x
+  RT_CHECK(h.run(opv(0x10, OPMVV, 12, 2, 0)));
+  RT_CHECK(h.x_[12] == 10);
+  h.x_[11] = 7;
+  RT_CHECK(h.run(opv(0x10, OPMVX, 9, 0, 11)));
+  RT_CHECK(h.vreg<uint32_t>(9, 0) == 7);
+  return 0;
+}
+
+static int test_float(const Arch& arch) {
+  Hart h(arch);
+  h.x_[10] = 2;
+  RT_CHECK(h.run(vsetvli(0, 10, E32 | M1)));
+  float a = 1.5f, b = 2.25f;
+  uint32_t ua, ub;
+  memcpy(&ua, &a, 4);
+  memcpy(&ub, &b, 4);
+  h.set_vreg<uint32_t>(2, 0, ua);
+  h.set_vreg<uint32_t>(2, 1, ub);
+  // vfadd.vf with a NaN-boxed scalar
+  h.f_[1] = 0xffffffff00000000ull | ub;
+  RT_CHECK(h.run(opv(0x00, OPFVF, 3, 2, 1)));
+  float r;
+  uint32_t ur = h.vreg<uint32_t>(3, 0);
+  memcpy(&r, &ur, 4);
+  RT_CHECK(r == 3.75f);
+  // vfmv.f.s boxes the result
+  RT_CHECK(h.run(opv(0x10, OPFVV, 2, 3, 0)));
+  RT_CHECK(h.f_[2] == (0xffffffff00000000ull | ur));
+  // FP16 elements are not supported
+  RT_CHECK(h.run(vsetvli(0, 10, E16 | M1)));
+  RT_CHECK(!h.run(opv(0x00, OPFVV, 3, 2, 2)));
+  return 0;
+}
+
+int main() {
+  Arch arch(NUM_THREADS, NUM_WARPS, 1, 1);
+
+  RT_CHECK(0 == test_vsetvl(arch));
+  RT_CHECK(0 == test_memory(arch));
+  RT_CHECK(0 == test_policies(arch));
+  RT_CHECK(0 == test_integer(arch));
+  RT_CHECK(0 == test_mask(arch));
+  RT_CHECK(0 == test_permute(arch));
+  RT_CHECK(0 == test_float(arch));
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -1,5 +1,11 @@
 #include <malloc.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
 
 #define RT_CHECK(_expr)                                         \
    do {                                                         \
@@ -15,7 +21,119 @@ static uint64_t maxAddress = 0xffffffff;
 static uint32_t pageAlign  = 4096; 
 static uint32_t blockAlign = 64;
 
-int main() {
+static uint32_t churn_live = 10000;
+static uint32_t churn_ops  = 1000000;
+
+static void show_usage() {
+   printf("Usage: [-n live buffers] [-o churn operations] [-h: help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:o:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      churn_live = atoi(optarg);
+      break;
+    case 'o':
+      churn_ops = atoi(optarg);
+      break;
+    case 'h':
+    case '?': {
+      show_usage();
+      exit(0);
+    } break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// random alloc/free sequence checked against a shadow map for alignment and overlaps
+static int test_random() {
+    vortex::MemoryAllocator allocator(minAddress, maxAddress, pageAlign, blockAlign);
+    std::mt19937 rng(0);
+    std::map<uint64_t, uint64_t> live;
+
+    for (int i = 0; i < 20000; ++i) {
+        if (live.empty() || (rng() % 3) != 0) {
+            uint64_t size = 1 + (rng() % 3) * (rng() % 8192);
+            uint64_t addr;
+            RT_CHECK(allocator.allocate(size, &addr));
+            if (addr % blockAlign) {
+                printf("error: misaligned address 0x%lx\n", addr);
+                return -1;
+            }
+            auto next = live.lower_bound(addr);
+            if ((next != live.end() && next->first < addr + size)
+             || (next != live.begin() && std::prev(next)->second > addr)) {
+                printf("error: overlapping block at 0x%lx\n", addr);
+                return -1;
+            }
+            live.emplace(addr, addr + size);
+        } else {
+            auto it = live.begin();
+            std::advance(it, rng() % live.size());
+            RT_CHECK(allocator.release(it->first));
+            live.erase(it);
+        }
+    }
+
+    // invalid and double release must be rejected
+    uint64_t addr;
+    RT_CHECK(allocator.allocate(64, &addr));
+    RT_CHECK(allocator.release(addr));
+    if (0 == allocator.release(addr)) {
+        printf("error: double release not detected\n");
+        return -1;
+    }
+
+    for (auto& block : live) {
+        RT_CHECK(allocator.release(block.first));
+    }
+
+    if (allocator.allocated() != 0) {
+        printf("error: leaked %ld bytes\n", allocator.allocated());
+        return -1;
+    }
+
+    return 0;
+}
+
+// alloc/free churn over a large set of live buffers
+static int bench_churn() {
+    vortex::MemoryAllocator allocator(minAddress, maxAddress, pageAlign, blockAlign);
+    std::mt19937 rng(0);
+    std::vector<uint64_t> live(churn_live);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (auto& addr : live) {
+        RT_CHECK(allocator.allocate(64 + (rng() % 4096), &addr));
+    }
+
+    for (uint32_t i = 0; i < churn_ops; ++i) {
+        auto& addr = live.at(rng() % churn_live);
+        RT_CHECK(allocator.release(addr));
+        RT_CHECK(allocator.allocate(64 + (rng() % 4096), &addr));
+    }
+
+    for (auto addr : live) {
+        RT_CHECK(allocator.release(addr));
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    double elapsed = std::chrono::duration<double>(t1 - t0).count();
+    uint64_t ops = 2 * (uint64_t(churn_live) + churn_ops);
+    printf("churn: live=%d, ops=%ld, time=%.3f s, %.1f ns/op\n", 
+        churn_live, ops, elapsed, (elapsed * 1e9) / ops);
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    parse_args(argc, argv);
 
     auto allocator = new vortex::MemoryAllocator(
         minAddress, maxAddress, pageAlign, blockAlign
@@ -46,6 +164,10 @@ int main() {
 
     delete allocator;
 
+    RT_CHECK(test_random());
+
+    RT_CHECK(bench_churn());
+
     printf("PASSED!\n");
 
     return 0;
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <vortex.h>
+#include <xrt_mock.h>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+     exit(-1);                                                  \
+   } while (false)
+
+// xilinx_u50 platform layout
+#define LG2_NUM_BANKS 4
+#define NUM_BANKS     (1 << LG2_NUM_BANKS)
+#define BLOCK_SIZE    64
+
+static uint64_t total_syncs() {
+  uint64_t syncs = 0;
+  for (int b = 0; b < NUM_BANKS; ++b) {
+    auto bo = xrt_mock::registry().find(b);
+    if (bo) {
+      syncs += bo->syncs;
+    }
+  }
+  return syncs;
+}
+
+static int test_transfer(vx_device_h device, uint64_t size, std::mt19937& rng) {
+  uint64_t dev_addr;
+  RT_CHECK(vx_mem_alloc(device, size, VX_MEM_TYPE_GLOBAL, &dev_addr));
+
+  uint64_t asize = (size + BLOCK_SIZE - 1) & ~uint64_t(BLOCK_SIZE - 1);
+  std::vector<uint8_t> src(asize), dst(asize);
+  for (auto& value : src) {
+    value = rng();
+  }
+
+  // upload issues at most one write+sync per bank
+  auto syncs = total_syncs();
+  RT_CHECK(vx_copy_to_dev(device, dev_addr, src.data(), size));
+  auto upload_syncs = total_syncs() - syncs;
+  if (upload_syncs > NUM_BANKS) {
+    std::cout << "error: upload of " << size << " bytes issued " << upload_syncs << " syncs" << std::endl;
+    return 1;
+  }
+
+  // check interleaved block placement in device memory
+  uint64_t num_blocks = asize / BLOCK_SIZE;
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    uint64_t block_addr = dev_addr / BLOCK_SIZE + i;
+    auto bo = xrt_mock::registry().find(block_addr % NUM_BANKS);
+    uint8_t block[BLOCK_SIZE];
+    bo->device.read(block, (block_addr >> LG2_NUM_BANKS) * BLOCK_SIZE, BLOCK_SIZE);
+    if (0 != memcmp(block, src.data() + i * BLOCK_SIZE, BLOCK_SIZE)) {
+      std::cout << "error: block " << i << " of " << size << " bytes misplaced" << std::endl;
+      return 1;
+    }
+  }
+
+  // round trip
+  syncs = total_syncs();
+  RT_CHECK(vx_copy_from_dev(device, dst.data(), dev_addr, size));
+  auto download_syncs = total_syncs() - syncs;
+  if (download_syncs > NUM_BANKS) {
+    std::cout << "error: download of " << size << " bytes issued " << download_syncs << " syncs" << std::endl;
+    return 1;
+  }
+  if (0 != memcmp(src.data(), dst.data(), size)) {
+    std::cout << "error: round trip of " << size << " bytes mismatched" << std::endl;
+    return 1;
+  }
+
+  RT_CHECK(vx_mem_free(device, dev_addr));
+
+  return 0;
+}
+
+int main() {
+  std::mt19937 rng(0);
+
+  vx_device_h device = nullptr;
+  RT_CHECK(vx_dev_open(&device));
+
+  // keep one allocation live to retain the bank buffers
+  uint64_t guard_addr;
+  RT_CHECK(vx_mem_alloc(device, BLOCK_SIZE, VX_MEM_TYPE_GLOBAL, &guard_addr));
+
+  int errors = 0;
+  uint64_t sizes[] = {4, BLOCK_SIZE, 3 * BLOCK_SIZE + 5, NUM_BANKS * BLOCK_SIZE,
+                      (NUM_BANKS + 3) * BLOCK_SIZE, 100000, 4 << 20};
+  for (auto size : sizes) {
+    errors += test_transfer(device, size, rng);
+  }
+
+  RT_CHECK(vx_mem_free(device, guard_addr));
+  RT_CHECK(vx_dev_close(device));
+
+  if (errors != 0) {
+    std::cout << "Found " << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+  return 0;
+}